@@ -0,0 +1,164 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "AggregatedMetric.hpp"
+
+#include "pal/PAL.hpp"
+#include "pal/TaskDispatcher.hpp"
+#include "system/MetricAggregator.hpp"
+
+#include <memory>
+#include <mutex>
+
+namespace MAT_NS_BEGIN
+{
+
+    namespace Models {
+
+        /// <summary>
+        /// Series of one AggregatedMetric, logged every interval from the PAL worker
+        /// thread. A scheduled flush holds a reference, so the series outlives an
+        /// AggregatedMetric destroyed while its flush runs.
+        /// </summary>
+        class AggregatedMetricImpl : public std::enable_shared_from_this<AggregatedMetricImpl>
+        {
+        public:
+            AggregatedMetricImpl(AggregatedMetricData const& metricData, unsigned intervalInSec, EventProperties const& properties, ILogger* logger) :
+                m_metricData(metricData),
+                m_properties(properties),
+                m_logger(logger),
+                m_intervalMs(intervalInSec * 1000),
+                m_startTimeMs(PAL::getMonotonicTimeMs()),
+                m_stopped(false)
+            {
+            }
+
+            void Start()
+            {
+                if ((m_logger != nullptr) && (m_intervalMs > 0))
+                {
+                    m_taskDispatcher = PAL::getDefaultTaskDispatcher();
+                    Schedule();
+                }
+            }
+
+            void Stop()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    Flush();
+                    m_stopped = true;
+                }
+                m_flushTask.Cancel();
+            }
+
+            void Push(double value)
+            {
+                if (m_logger != nullptr)
+                {
+                    m_aggregator.push(value);
+                }
+            }
+
+        protected:
+            void Schedule()
+            {
+                m_flushTask = PAL::scheduleTask(m_taskDispatcher.get(), m_intervalMs, this, &AggregatedMetricImpl::OnTimer, shared_from_this());
+            }
+
+            void OnTimer(std::shared_ptr<AggregatedMetricImpl> self)
+            {
+                UNREFERENCED_PARAMETER(self);
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!m_stopped)
+                {
+                    Flush();
+                    Schedule();
+                }
+            }
+
+            // Called with m_lock held
+            void Flush()
+            {
+                if (m_stopped)
+                {
+                    return;
+                }
+
+                uint64_t now = PAL::getMonotonicTimeMs();
+                AggregatedMetricData metricData = m_metricData;
+                metricData.duration = static_cast<long>((now - m_startTimeMs) * 1000);
+                m_startTimeMs = now;
+                if (m_aggregator.collect(metricData))
+                {
+                    m_logger->LogAggregatedMetric(metricData, m_properties);
+                }
+            }
+
+            std::mutex                        m_lock;
+            MetricAggregator                  m_aggregator;
+            AggregatedMetricData const        m_metricData;
+            EventProperties const             m_properties;
+            ILogger*                          m_logger;
+            unsigned const                    m_intervalMs;
+            uint64_t                          m_startTimeMs;
+            bool                              m_stopped;
+            std::shared_ptr<ITaskDispatcher>  m_taskDispatcher;
+            PAL::DeferredCallbackHandle       m_flushTask;
+        };
+
+        // The public class keeps a pointer to the owning reference, as its layout is part of the ABI
+        static std::shared_ptr<AggregatedMetricImpl>& impl(void* p)
+        {
+            return *static_cast<std::shared_ptr<AggregatedMetricImpl>*>(p);
+        }
+
+        static void* createImpl(AggregatedMetricData const& metricData, unsigned intervalInSec, EventProperties const& eventProperties, ILogger* pLogger)
+        {
+            auto holder = new std::shared_ptr<AggregatedMetricImpl>(
+                std::make_shared<AggregatedMetricImpl>(metricData, intervalInSec, eventProperties, pLogger));
+            (*holder)->Start();
+            return holder;
+        }
+
+        AggregatedMetric::AggregatedMetric(std::string const& name,
+            std::string const& units,
+            unsigned const intervalInSec,
+            EventProperties const& eventProperties,
+            ILogger* pLogger) :
+            AggregatedMetric(name, units, intervalInSec, std::string(), std::string(), std::string(), eventProperties, pLogger)
+        {
+        }
+
+        AggregatedMetric::AggregatedMetric(std::string const& name,
+            std::string const& units,
+            unsigned const intervalInSec,
+            std::string const& instanceName,
+            std::string const& objectClass,
+            std::string const& objectId,
+            EventProperties const& eventProperties,
+            ILogger* pLogger)
+        {
+            AggregatedMetricData metricData(name, 0, 0);
+            metricData.units = units;
+            metricData.instanceName = instanceName;
+            metricData.objectClass = objectClass;
+            metricData.objectId = objectId;
+            m_pAggregatedMetricImpl = createImpl(metricData, intervalInSec, eventProperties, pLogger);
+        }
+
+        AggregatedMetric::~AggregatedMetric()
+        {
+            impl(m_pAggregatedMetricImpl)->Stop();
+            delete &impl(m_pAggregatedMetricImpl);
+        }
+
+        void AggregatedMetric::PushMetric(double value)
+        {
+            impl(m_pAggregatedMetricImpl)->Push(value);
+        }
+
+    } // Models
+
+} MAT_NS_END
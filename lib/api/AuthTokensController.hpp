@@ -10,6 +10,7 @@
 #include "pal/PAL.hpp"
 #include "IAuthTokensController.hpp"
 
+#include <atomic>
 #include <map>
 #include <vector>
 
@@ -72,12 +73,18 @@ namespace MAT_NS_BEGIN
         /// <param name="ticketValue">Ticketvalue</param>
         virtual std::map<TicketType, std::string>&  GetUserTokens() override;
 
+        /// <summary>
+        /// Gets a counter incremented by every call to SetTicketToken, Clear and SetStrictMode.
+        /// </summary>
+        virtual uint64_t  GetVersion() override;
+
     private:
         MATSDK_LOG_DECL_COMPONENT_CLASS();
         std::map<TicketType, std::string> m_deviceTokens;
         std::map<TicketType, std::string> m_userTokens;
         std::vector<std::string> m_tickets;
         bool m_IsStrictModeEnabled;
+        std::atomic<uint64_t> m_version;
     };
 
 
@@ -436,6 +436,38 @@ namespace MAT_NS_BEGIN
         m_commonContextFields[name] = value;
     }
 
+    bool ContextFieldsProvider::ReplaceCommonField(const std::string& name, const EventProperty& expected, const EventProperty& value)
+    {
+        LOCKGUARD(m_lock);
+        auto it = m_commonContextFields.find(name);
+        if (it == m_commonContextFields.end() || !(it->second == expected))
+        {
+            return false;
+        }
+        it->second = value;
+        return true;
+    }
+
+    bool ContextFieldsProvider::GetField(const std::string& name, EventProperty& value)
+    {
+        {
+            LOCKGUARD(m_lock);
+            auto common = m_commonContextFields.find(name);
+            if (common != m_commonContextFields.end())
+            {
+                value = common->second;
+                return true;
+            }
+            auto custom = m_customContextFields.find(name);
+            if (custom != m_customContextFields.end())
+            {
+                value = custom->second;
+                return true;
+            }
+        }
+        return (m_parent != nullptr) && m_parent->GetField(name, value);
+    }
+
     void ContextFieldsProvider::SetCustomField(const std::string& name, const EventProperty& value)
     {
         LOCKGUARD(m_lock);
@@ -28,7 +28,20 @@ namespace MAT_NS_BEGIN
         ContextFieldsProvider& operator=(ContextFieldsProvider const& copy);
 
         virtual void SetCommonField(const std::string&  name, const EventProperty&  value) override;
+
+        /// <summary>
+        /// Sets a common field only if it still holds the expected value, so that a value
+        /// the SDK fills in late does not override one set by the application meanwhile.
+        /// </summary>
+        /// <returns>true if the field was set.</returns>
+        bool ReplaceCommonField(const std::string& name, const EventProperty& expected, const EventProperty& value);
         void writeToRecord(::CsProtocol::Record& record, bool commonOnly = false);
+
+        /// <summary>
+        /// Looks up a common or custom field of this context or of its parents.
+        /// </summary>
+        /// <returns>true if the field is set.</returns>
+        bool GetField(const std::string& name, EventProperty& value);
         virtual void SetCustomField(const std::string&  name, const EventProperty&  value) override;
 
         virtual void SetParentContext(ContextFieldsProvider* parent);
@@ -5,13 +5,14 @@
 #include "CorrelationVector.hpp"
 #include "utils/StringUtils.hpp" // for SplitString and AreAllCharactersAllowlisted
 
+#include <cstring>
 #include <vector>
 #include <random>
 #include <stdexcept>
 #include <limits>
+#include <thread>
 
 using std::string;
-using std::mutex;
 using std::vector;
 
 namespace MAT_NS_BEGIN
@@ -20,200 +21,354 @@ namespace MAT_NS_BEGIN
     // This effectively means we have one less character to use.
     // (so 64 is reduced to 63 for v1 and 128 is reduced to 127 for v2).
 
-    const size_t CorrelationVector::c_maxCVLength_v1 = 63;
-    const size_t CorrelationVector::c_baseCVLength_v1 = 16;
+    constexpr size_t CorrelationVector::ValueBufferSize;
+    constexpr size_t CorrelationVector::c_maxCVLength_v1;
+    constexpr size_t CorrelationVector::c_baseCVLength_v1;
 
-    const size_t CorrelationVector::c_maxCVLength_v2 = 127;
-    const size_t CorrelationVector::c_baseCVLength_v2 = 22;
+    constexpr size_t CorrelationVector::c_maxCVLength_v2;
+    constexpr size_t CorrelationVector::c_baseCVLength_v2;
+
+    static_assert(CorrelationVector::ValueBufferSize > 127, "ValueBufferSize must hold a v2 value and its NUL");
 
     const string CorrelationVector::s_base64CharSet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
     const string CorrelationVector::s_base10CharSet = "0123456789";
     const string CorrelationVector::s_maxVectorElementValue = "4294967295";
-    
+
+    // m_state layout: generation of the base vector, odd while it is rewritten, and current vector
+    static const uint64_t c_generationOne = uint64_t(1) << 32;
+    static const uint64_t c_currentVectorMask = c_generationOne - 1;
+
+    static inline bool IsWriting(uint64_t state)
+    {
+        return (state & c_generationOne) != 0;
+    }
+
+    static inline uint32_t GetCurrentVector(uint64_t state)
+    {
+        return static_cast<uint32_t>(state & c_currentVectorMask);
+    }
+
     CorrelationVector::CorrelationVector()
     {
     }
-    
+
     bool CorrelationVector::Initialize(int version)
     {
-        std::lock_guard<mutex> lock(m_lock);
-        
         if (version != 1 && version != 2)
         {
             return false;
         }
-        
-        m_maxLength = (version == 1 ? c_maxCVLength_v1 : c_maxCVLength_v2);
-        size_t baseLength = (version == 1 ? c_baseCVLength_v1 : c_baseCVLength_v2);
-        
-        m_currentVector = 0;
-        m_baseVector = InitializeInternal(baseLength);
-        m_isInitialized = true;
-        
+
+        size_t maxLength = (version == 1 ? c_maxCVLength_v1 : c_maxCVLength_v2);
+        string baseVector = InitializeInternal(version == 1 ? c_baseCVLength_v1 : c_baseCVLength_v2);
+
+        uint64_t state = BeginWrite();
+        for (size_t i = 0; i < baseVector.length(); i++)
+        {
+            m_baseVector[i].store(baseVector[i], std::memory_order_relaxed);
+        }
+        EndWrite(state, maxLength, baseVector.length(), 0);
+
         return true;
     }
-    
+
     void CorrelationVector::Uninitialize()
     {
-        std::lock_guard<mutex> lock(m_lock);
-        
-        m_currentVector = 0;
-        m_baseVector = "";
-        m_isInitialized = false;
+        uint64_t state = BeginWrite();
+        EndWrite(state, 0, 0, 0);
     }
-    
+
     bool CorrelationVector::IsInitialized()
     {
-        return m_isInitialized;
+        return m_maxLength.load(std::memory_order_relaxed) != 0;
     }
-    
+
     string CorrelationVector::InitializeInternal(size_t baseLength)
     {
         string result = "";
         std::random_device randomDevice;
         std::uniform_int_distribution<int> base64Dist(0, 63);
-        
-        
+
+
         for (size_t i = 0; i < baseLength; i++)
         {
             result += s_base64CharSet[base64Dist(randomDevice)];
         }
-        
+
         return result;
     }
 
-    string CorrelationVector::GetNextValue()
+    void CorrelationVector::LoadSnapshot(Snapshot& snapshot, bool copyBaseVector)
     {
-        std::lock_guard<mutex> lock(m_lock);
+        for (;;)
+        {
+            snapshot.state = m_state.load(std::memory_order_acquire);
+            if (IsWriting(snapshot.state))
+            {
+                std::this_thread::yield();
+                continue;
+            }
 
-        string result = GetValueInternal();
-        IncrementInternal();
+            snapshot.maxLength = m_maxLength.load(std::memory_order_relaxed);
+            snapshot.baseLength = m_baseLength.load(std::memory_order_relaxed);
+            if (snapshot.baseLength > sizeof(snapshot.baseVector))
+            {
+                // Torn read of a base vector being rewritten, retried below
+                snapshot.baseLength = 0;
+            }
+            if (copyBaseVector)
+            {
+                for (size_t i = 0; i < snapshot.baseLength; i++)
+                {
+                    snapshot.baseVector[i] = m_baseVector[i].load(std::memory_order_relaxed);
+                }
+            }
 
-        return result;
+            // Valid if no writer has begun since, increments alone do not invalidate it
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t state = m_state.load(std::memory_order_relaxed);
+            if ((state & ~c_currentVectorMask) == (snapshot.state & ~c_currentVectorMask))
+            {
+                return;
+            }
+        }
     }
 
-    string CorrelationVector::GetValue()
+    uint64_t CorrelationVector::BeginWrite()
     {
-        std::lock_guard<mutex> lock(m_lock);
-        
-        return GetValueInternal();
+        uint64_t state = m_state.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (IsWriting(state))
+            {
+                std::this_thread::yield();
+                state = m_state.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (m_state.compare_exchange_weak(state, state + c_generationOne, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        return state;
     }
-    
-    string CorrelationVector::GetValueInternal()
+
+    void CorrelationVector::EndWrite(uint64_t previousState, size_t maxLength, size_t baseLength, uint32_t currentVector)
     {
-        if (m_isInitialized)
+        m_maxLength.store(maxLength, std::memory_order_relaxed);
+        m_baseLength.store(baseLength, std::memory_order_relaxed);
+        m_state.store(((previousState & ~c_currentVectorMask) + 2 * c_generationOne) | currentVector, std::memory_order_release);
+    }
+
+    size_t CorrelationVector::FormatValue(Snapshot const& snapshot, char* buffer, size_t size)
+    {
+        if (snapshot.maxLength == 0)
         {
-            return  m_baseVector + "." + std::to_string(m_currentVector);
+            if (size > 0)
+            {
+                buffer[0] = '\0';
+            }
+            return 0;
         }
-        return string { };
+
+        uint32_t currentVector = GetCurrentVector(snapshot.state);
+        size_t digitCount = GetDigitCount(currentVector);
+        size_t length = snapshot.baseLength + 1 + digitCount;
+        if (length >= size)
+        {
+            if (size > 0)
+            {
+                buffer[0] = '\0';
+            }
+            return 0;
+        }
+
+        // base + "." + numeric representation of the current vector
+        memcpy(buffer, snapshot.baseVector, snapshot.baseLength);
+        buffer[snapshot.baseLength] = '.';
+        for (size_t i = length; i > snapshot.baseLength + 1; i--)
+        {
+            buffer[i - 1] = static_cast<char>('0' + currentVector % 10);
+            currentVector /= 10;
+        }
+        buffer[length] = '\0';
+        return length;
     }
 
-    bool CorrelationVector::Extend()
+    string CorrelationVector::GetNextValue()
     {
-        std::lock_guard<mutex> lock(m_lock);
-        
-        bool result = false;
+        char buffer[ValueBufferSize];
+        size_t length = GetNextValue(buffer, sizeof(buffer));
+        return string(buffer, length);
+    }
 
-        if (CanExtendInternal())
+    size_t CorrelationVector::GetNextValue(char* buffer, size_t size)
+    {
+        Snapshot snapshot;
+        LoadSnapshot(snapshot, true);
+        for (;;)
         {
-            m_baseVector = GetValueInternal();
-            m_currentVector = 0;
-            result = true;
+            size_t length = FormatValue(snapshot, buffer, size);
+            if ((length == 0) || !CanIncrementInternal(snapshot))
+            {
+                return length;
+            }
+
+            uint64_t expected = snapshot.state;
+            if (m_state.compare_exchange_weak(expected, expected + 1, std::memory_order_relaxed))
+            {
+                return length;
+            }
+
+            if ((expected & ~c_currentVectorMask) == (snapshot.state & ~c_currentVectorMask))
+            {
+                // Incremented by another thread, same base vector
+                snapshot.state = expected;
+            }
+            else
+            {
+                LoadSnapshot(snapshot, true);
+            }
         }
-        
-        return result;
     }
 
-    bool CorrelationVector::Increment()
+    string CorrelationVector::GetValue()
     {
-        std::lock_guard<mutex> lock(m_lock);
-        
-        return IncrementInternal();
+        char buffer[ValueBufferSize];
+        size_t length = GetValue(buffer, sizeof(buffer));
+        return string(buffer, length);
     }
 
-    bool CorrelationVector::IncrementInternal()
+    size_t CorrelationVector::GetValue(char* buffer, size_t size)
     {
-        bool result = false;
+        Snapshot snapshot;
+        LoadSnapshot(snapshot, true);
+        return FormatValue(snapshot, buffer, size);
+    }
 
-        if (CanIncrementInternal())
+    bool CorrelationVector::Extend()
+    {
+        for (;;)
         {
-            m_currentVector++;
-            result = true;
+            Snapshot snapshot;
+            LoadSnapshot(snapshot, false);
+            if (!CanExtendInternal(snapshot))
+            {
+                return false;
+            }
+
+            // The base vector is only appended to, claim the write for this generation
+            uint64_t expected = snapshot.state;
+            if (!m_state.compare_exchange_strong(expected, expected + c_generationOne, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                continue;
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+
+            // base + "." + numeric representation of the current vector becomes the new base
+            uint32_t currentVector = GetCurrentVector(snapshot.state);
+            size_t length = snapshot.baseLength + 1 + GetDigitCount(currentVector);
+            m_baseVector[snapshot.baseLength].store('.', std::memory_order_relaxed);
+            for (size_t i = length; i > snapshot.baseLength + 1; i--)
+            {
+                m_baseVector[i - 1].store(static_cast<char>('0' + currentVector % 10), std::memory_order_relaxed);
+                currentVector /= 10;
+            }
+            EndWrite(snapshot.state, snapshot.maxLength, length, 0);
+            return true;
         }
+    }
 
-        return result;
+    bool CorrelationVector::Increment()
+    {
+        Snapshot snapshot;
+        LoadSnapshot(snapshot, false);
+        for (;;)
+        {
+            if (!CanIncrementInternal(snapshot))
+            {
+                return false;
+            }
+
+            uint64_t expected = snapshot.state;
+            if (m_state.compare_exchange_weak(expected, expected + 1, std::memory_order_relaxed))
+            {
+                return true;
+            }
+
+            if ((expected & ~c_currentVectorMask) == (snapshot.state & ~c_currentVectorMask))
+            {
+                snapshot.state = expected;
+            }
+            else
+            {
+                LoadSnapshot(snapshot, false);
+            }
+        }
     }
-    
+
     bool CorrelationVector::CanExtend()
     {
-        std::lock_guard<mutex> lock(m_lock);
-        
-        return CanExtendInternal();
+        Snapshot snapshot;
+        LoadSnapshot(snapshot, false);
+        return CanExtendInternal(snapshot);
     }
-    
+
     bool CorrelationVector::CanIncrement()
     {
-        std::lock_guard<mutex> lock(m_lock);
-        
-        return CanIncrementInternal();
+        Snapshot snapshot;
+        LoadSnapshot(snapshot, false);
+        return CanIncrementInternal(snapshot);
     }
 
-    bool CorrelationVector::CanExtendInternal()
+    bool CorrelationVector::CanExtendInternal(Snapshot const& snapshot)
     {
-        if (!m_isInitialized)
+        if (snapshot.maxLength == 0)
         {
             return false;
         }
-        
+
         // extending is appending ".0"
-        size_t newLength = GetLengthInternal(m_currentVector) + 2;
+        size_t newLength = snapshot.baseLength + 1 + GetDigitCount(GetCurrentVector(snapshot.state)) + 2;
 
-        return (newLength <= m_maxLength);
+        return (newLength <= snapshot.maxLength);
     }
 
-    bool CorrelationVector::CanIncrementInternal()
+    bool CorrelationVector::CanIncrementInternal(Snapshot const& snapshot)
     {
-        if (!m_isInitialized)
+        if (snapshot.maxLength == 0)
         {
             return false;
         }
-        
-        if (m_currentVector == std::numeric_limits<unsigned int>::max())
+
+        uint32_t currentVector = GetCurrentVector(snapshot.state);
+        if (currentVector == std::numeric_limits<unsigned int>::max())
         {
             return false;
         }
 
-        // incrementing is adding one to m_currentVector
-        size_t newLength = GetLengthInternal(m_currentVector + 1);
-        
-        return (newLength <= m_maxLength);
-    }
-    
-    size_t CorrelationVector::GetLengthInternal(size_t vectorValue)
-    {
-        size_t vectorSize = GetDigitCount(vectorValue);
-        
-        // base + "." + numeric representation of m_currentVector
-        return (m_baseVector.length() + 1 + vectorSize);
+        // incrementing is adding one to the current vector
+        size_t newLength = snapshot.baseLength + 1 + GetDigitCount(static_cast<size_t>(currentVector) + 1);
+
+        return (newLength <= snapshot.maxLength);
     }
-    
+
     size_t CorrelationVector::GetDigitCount(size_t value)
     {
         size_t digitCount = 1;
-        
+
         while (value > 9)
         {
             value /= 10;
             digitCount++;
         }
-        
+
         return digitCount;
     }
-    
+
     bool CorrelationVector::SetValue(const string& cv)
     {
-        std::lock_guard<mutex> lock(m_lock);
-        
         // handle a special case: the last character could a "!", meaning that the vector is sealed for extension
         if ((cv.length() == c_maxCVLength_v1 + 1 || cv.length() == c_maxCVLength_v2 + 1) && cv[cv.length() - 1] == '!')
         {
@@ -266,11 +421,12 @@ namespace MAT_NS_BEGIN
             return false;
         }
 
+        string baseVector;
+        unsigned long currentVector = 0;
         if (parts.size() == 1)
         {
             // init with just the base value
-            m_baseVector = parts[0];
-            m_currentVector = 0;
+            baseVector = parts[0];
         }
         else
         {
@@ -278,8 +434,6 @@ namespace MAT_NS_BEGIN
             bool parsingFailed = false;
             string vectorString = cv.substr(lastDot + 1, string::npos);
             // note: unsigned long is 32-bit on 32-bit arm devices
-            unsigned long currentVector = 0;
-            
             try
             {
                 // do a manual string comparison before trying to parse the value to avoid throwing an exception
@@ -308,13 +462,16 @@ namespace MAT_NS_BEGIN
                 return false;
             }
             
-            m_baseVector = cv.substr(0, lastDot);
-            m_currentVector = currentVector;
+            baseVector = cv.substr(0, lastDot);
         }
-        
-        m_maxLength = maxLength;
-        m_isInitialized = true;
-        
+
+        uint64_t state = BeginWrite();
+        for (size_t i = 0; i < baseVector.length(); i++)
+        {
+            m_baseVector[i].store(baseVector[i], std::memory_order_relaxed);
+        }
+        EndWrite(state, maxLength, baseVector.length(), static_cast<uint32_t>(currentVector));
+
         return true;
     }
 
@@ -9,10 +9,14 @@
 #include "LogManagerImpl.hpp"
 #include "mat/config.h"
 
+#include "bwcontrol/TokenBucketBandwidthController.hpp"
 #include "offline/LogSessionDataProvider.hpp"
 #include "offline/OfflineStorageHandler.hpp"
 
+#include "system/MemoryBudget.hpp"
+#include "system/SharedRuntime.hpp"
 #include "system/TelemetrySystem.hpp"
+#include "bond/TypedEventEncoder.hpp"
 
 #include "EventProperty.hpp"
 #include "TransmitProfiles.hpp"
@@ -275,7 +279,16 @@ namespace MAT_NS_BEGIN
 #ifdef HAVE_MAT_DEFAULT_HTTP_CLIENT
         if (m_httpClient == nullptr)
         {
-            m_httpClient = HttpClientFactory::Create();
+            if (m_logConfiguration[CFG_BOOL_SHARED_RUNTIME])
+            {
+                // One client, and its connections, for all LogManagers of the shared runtime
+                m_sharedRuntime = SharedRuntime::acquire();
+                m_httpClient = m_sharedRuntime->getHttpClient();
+            }
+            else
+            {
+                m_httpClient = HttpClientFactory::Create();
+            }
 #ifdef HAVE_MAT_WININET_HTTP_CLIENT
             HttpClient_WinInet* client = static_cast<HttpClient_WinInet*>(m_httpClient.get());
             if (client != nullptr)
@@ -298,6 +311,11 @@ namespace MAT_NS_BEGIN
 
         if (m_bandwidthController == nullptr)
         {
+            if (!m_ownBandwidthController && TokenBucketBandwidthController::IsEnabled(*m_config))
+            {
+                LOG_TRACE("BandwidthController: TokenBucket");
+                m_ownBandwidthController.reset(new TokenBucketBandwidthController(*m_config));
+            }
             m_bandwidthController = m_ownBandwidthController.get();
         }
         else
@@ -309,6 +327,14 @@ namespace MAT_NS_BEGIN
             LOG_TRACE("BandwidthController: None");
         }
 
+        m_eventSampler.Configure((*m_config)[CFG_MAP_SAMPLING]);
+
+        uint32_t memoryBudget = (*m_config)[CFG_INT_MEMORY_BUDGET];
+        if (memoryBudget > 0)
+        {
+            MemoryBudget::GetInstance().SetLimit(memoryBudget);
+        }
+
         m_offlineStorage.reset(new OfflineStorageHandler(*this, *m_config, *m_taskDispatcher));
 
 #if defined(STORE_SESSION_DB) && defined(HAVE_MAT_STORAGE)
@@ -316,6 +342,7 @@ namespace MAT_NS_BEGIN
 #else
         m_logSessionDataProvider.reset(new LogSessionDataProvider(cacheFilePath));
 #endif
+        m_systemInfoCache.reset(new SystemInfoCache(*m_offlineStorage, m_context, *m_taskDispatcher));
 
 #ifdef HAVE_MAT_AI
         if (sdkMode == SdkModeTypes::SdkModeTypes_AI)
@@ -335,6 +362,7 @@ namespace MAT_NS_BEGIN
         {
             m_system->start();
             m_isSystemStarted = true;
+            m_systemInfoCache->Start();
         }
 
 #ifdef HAVE_MAT_DEFAULT_FILTER
@@ -361,6 +389,7 @@ namespace MAT_NS_BEGIN
             client->SetMsRootCheck(m_logConfiguration[CFG_MAP_HTTP][CFG_BOOL_HTTP_MS_ROOT_CHECK]);
         }
 #endif
+        m_eventSampler.Configure(m_logConfiguration[CFG_MAP_SAMPLING]);
     };
 
     LogManagerImpl::~LogManagerImpl() noexcept
@@ -383,25 +412,30 @@ namespace MAT_NS_BEGIN
         LOCKGUARD(m_lock);
         if (m_alive)
         {
+            // Send GetLogger back to the locked path, which sees m_alive
+            m_loggerCache.clear();
+
+            // before we do anything else, move our Logger instances
+            // to the shut-down state. Calls to these loggers will be
+            // benign: before we complete their RecordShutdown() call,
+            // this LogManagerImpl is alive and well and ILogger methods
+            // should work. After that RecordShutdown(), those ILogger
+            // methods do nothing and in particular do not touch this
+            // now-defunct LogManagerImpl. sendEvent() relies on this
+            // to use m_system without m_lock.
+            for (auto& kv : m_loggers)
+            {
+                // this waits until no active calls on this logger
+                kv.second->RecordShutdown();
+            }
+
             if (m_logConfiguration[CFG_BOOL_DISABLE_ZOMBIE_LOGGERS])
             {
                 m_loggers.clear();
             }
             else
             {
-                // before we do anything else, move our Logger instances
-                // to the shut-down state and the s_deadLoggers graveyard.
-                // Calls to these loggers will be benign: before we complete
-                // their RecordShutdown() call, this LogManagerImpl is alive
-                // and well and ILogger methods should work. After that
-                // RecordShutdown(), those ILogger methods do nothing and in
-                // particular do not touch this now-defunct LogManagerImpl.
-                for (auto& kv : m_loggers)
-                {
-                    // this waits until no active calls on this logger
-                    kv.second->RecordShutdown();
-                }
-
+                // Keep the loggers in the s_deadLoggers graveyard
                 s_deadLoggers.AddMap(std::move(m_loggers));
 
                 // Ensure that AddMap clears m_loggers (it does, it should continue to).
@@ -411,9 +445,13 @@ namespace MAT_NS_BEGIN
             LOG_INFO("Tearing down modules");
             TeardownModules();
 
+            // Stops filling in system information before its storage goes away
+            m_systemInfoCache = nullptr;
+
             if (m_isSystemStarted && m_system)
             {
                 m_system->stop();
+                m_hasShutdownStats = m_system->getShutdownStats(m_shutdownStats);
                 LOG_TRACE("Telemetry system stopped");
             }
             m_system = nullptr;
@@ -423,6 +461,7 @@ namespace MAT_NS_BEGIN
             m_bandwidthController = nullptr;
 
             m_httpClient = nullptr;
+            m_sharedRuntime = nullptr;
             m_taskDispatcher = nullptr;
             m_dataViewer = nullptr;
             ClearDataInspectors();
@@ -644,14 +683,19 @@ namespace MAT_NS_BEGIN
 
     ILogger* LogManagerImpl::GetLogger(const std::string& tenantToken, const std::string& source, const std::string& scope)
     {
+        // Lock-free path for a (tenantToken, source) pair that was already requested in this exact spelling
+        size_t key = LoggerLookupCache::hash(tenantToken, source);
+        Logger* cached = m_loggerCache.find(key, tenantToken, source);
+        if (cached != nullptr)
         {
-            LOCKGUARD(m_lock);
-            if (!m_alive)
+            uint8_t level = m_diagLevelFilter.GetDefaultLevel();
+            if (level != DIAG_LEVEL_DEFAULT)
             {
-                return nullptr;
+                cached->SetLevel(level);
             }
+            return cached;
         }
-        //
+
         LOG_TRACE("GetLogger(tenantId=\"%s\", source=\"%s\")", tenantTokenToId(tenantToken).c_str(), source.c_str());
 
         std::string normalizedTenantToken = toLower(tenantToken);
@@ -666,16 +710,18 @@ namespace MAT_NS_BEGIN
         auto it = m_loggers.find(hash);
         if (it == std::end(m_loggers))
         {
-            m_loggers[hash] = std::make_unique<Logger>(
+            it = m_loggers.emplace(hash, std::make_unique<Logger>(
                 normalizedTenantToken, normalizedSource, scope,
-                *this, m_context, *m_config);
+                *this, m_context, *m_config)).first;
         }
+        Logger* logger = it->second.get();
         uint8_t level = m_diagLevelFilter.GetDefaultLevel();
         if (level != DIAG_LEVEL_DEFAULT)
         {
-            m_loggers[hash]->SetLevel(level);
+            logger->SetLevel(level);
         }
-        return m_loggers[hash].get();
+        m_loggerCache.insert(key, tenantToken, source, logger);
+        return logger;
     }
 
     /// <summary>
@@ -705,6 +751,10 @@ namespace MAT_NS_BEGIN
     /// <returns></returns>
     bool LogManagerImpl::DispatchEvent(DebugEvent evt)
     {
+        if (evt.type == DebugEventType::EVT_STORAGE_BACKPRESSURE)
+        {
+            OnBackpressure(evt.param1 != 0, static_cast<unsigned>(evt.param2));
+        }
         return m_debugEventSource.DispatchEvent(std::move(evt));
     };
 
@@ -720,26 +770,60 @@ namespace MAT_NS_BEGIN
         return m_debugEventSource.DetachEventSource(other);
     }
 
+    std::shared_ptr<IncomingEventContext> LogManagerImpl::AcquireIncomingEventContext()
+    {
+        if (!m_isSystemStarted)
+        {
+            LOCKGUARD(m_lock);
+            GetSystem();
+        }
+
+        ITelemetrySystem* system = m_system.get();
+        return (system != nullptr) ? system->createIncomingEventContext() : std::make_shared<IncomingEventContext>();
+    }
+
     void LogManagerImpl::sendEvent(IncomingEventContextPtr const& event)
     {
-        LOCKGUARD(m_lock);
-        if (GetSystem())
+        // Runs on the logging thread without m_lock, so that decoration, inspection and
+        // serialization of concurrent events proceed in parallel. m_system outlives the call:
+        // FlushAndTeardown shuts every logger down (waiting for its active calls), whether
+        // or not zombie loggers are disabled, before stopping and releasing the system.
+        // Only the deferred start needs the lock.
+        if (!m_isSystemStarted)
         {
-            if (m_customDecorator)
-            {
-                m_customDecorator->decorate(*(event->source));
-            }
+            LOCKGUARD(m_lock);
+            GetSystem();
+        }
 
-            {
-                LOCKGUARD(m_dataInspectorGuard);
+        ITelemetrySystem* system = m_system.get();
+        if (system == nullptr)
+        {
+            return;
+        }
 
-                for (const auto& dataInspector : m_dataInspectors)
-                {
-                    dataInspector->InspectRecord(*(event->source));
-                }
+        auto dataInspectors = std::atomic_load(&m_dataInspectorsSnapshot);
+
+        // Typed event fields are only visible on the record once materialized
+        if (event->partC != nullptr && (m_customDecorator || dataInspectors || !system->supportsEncodedPartC()))
+        {
+            MaterializePartC(*(event->source), *(event->partC));
+            event->partC = nullptr;
+        }
+
+        if (m_customDecorator)
+        {
+            m_customDecorator->decorate(*(event->source));
+        }
+
+        if (dataInspectors)
+        {
+            for (const auto& dataInspector : *dataInspectors)
+            {
+                dataInspector->InspectRecord(*(event->source));
             }
-            GetSystem()->sendEvent(event);
         }
+
+        system->sendEvent(event);
     }
 
     ILogController* LogManagerImpl::GetLogController()
@@ -762,6 +846,11 @@ namespace MAT_NS_BEGIN
         return m_filters;
     }
 
+    EventSampler* LogManagerImpl::GetEventSampler()
+    {
+        return &m_eventSampler;
+    }
+
     LogSessionData* LogManagerImpl::GetLogSessionData()
     {
         return (m_logSessionDataProvider) ? m_logSessionDataProvider->GetLogSessionData() : nullptr;
@@ -797,6 +886,10 @@ namespace MAT_NS_BEGIN
 
         m_system->start();
         m_isSystemStarted = true;
+        if (m_systemInfoCache)
+        {
+            m_systemInfoCache->Start();
+        }
         return m_system;
     }
 
@@ -848,12 +941,14 @@ namespace MAT_NS_BEGIN
         }
 
         m_dataInspectors.push_back(dataInspector);
+        PublishDataInspectors();
     }
 
     void LogManagerImpl::ClearDataInspectors()
     {
         LOCKGUARD(m_dataInspectorGuard);
         std::vector<std::shared_ptr<IDataInspector>>{}.swap(m_dataInspectors);
+        PublishDataInspectors();
     }
 
     void LogManagerImpl::RemoveDataInspector(const std::string& name)
@@ -866,9 +961,20 @@ namespace MAT_NS_BEGIN
         if (itDataInspector != m_dataInspectors.end())
         {
             m_dataInspectors.erase(itDataInspector);
+            PublishDataInspectors();
         }
     }
 
+    void LogManagerImpl::PublishDataInspectors()
+    {
+        std::shared_ptr<const std::vector<std::shared_ptr<IDataInspector>>> snapshot;
+        if (!m_dataInspectors.empty())
+        {
+            snapshot = std::make_shared<const std::vector<std::shared_ptr<IDataInspector>>>(m_dataInspectors);
+        }
+        std::atomic_store(&m_dataInspectorsSnapshot, snapshot);
+    }
+
     std::shared_ptr<IDataInspector> LogManagerImpl::GetDataInspector(const std::string& name) noexcept
     {
         LOCKGUARD(m_dataInspectorGuard);
@@ -879,6 +985,59 @@ namespace MAT_NS_BEGIN
         return it != m_dataInspectors.end() ? *it : nullptr;
     }
 
+    status_t LogManagerImpl::GetPipelineStageStats(PipelineStage stage, PipelineStageStats& stats)
+    {
+        LOCKGUARD(m_lock);
+        if (m_system && m_system->getPipelineStageStats(stage, stats))
+        {
+            return STATUS_SUCCESS;
+        }
+        return STATUS_ENOTSUP;
+    }
+
+    status_t LogManagerImpl::GetShutdownStats(ShutdownStats& stats)
+    {
+        LOCKGUARD(m_lock);
+        if (m_hasShutdownStats)
+        {
+            stats = m_shutdownStats;
+            return STATUS_SUCCESS;
+        }
+        return STATUS_ENOTSUP;
+    }
+
+    status_t LogManagerImpl::GetMemoryUsage(MemoryUsageStats& stats)
+    {
+        MemoryBudget::GetInstance().GetStats(stats);
+        return STATUS_SUCCESS;
+    }
+
+    status_t LogManagerImpl::SetBackpressureCallback(std::function<void(bool saturated, unsigned fillPercent)> callback)
+    {
+        LOCKGUARD(m_backpressureLock);
+        m_backpressureCallback = std::move(callback);
+        return STATUS_SUCCESS;
+    }
+
+    bool LogManagerImpl::IsSaturated() const
+    {
+        return m_saturated;
+    }
+
+    void LogManagerImpl::OnBackpressure(bool saturated, unsigned fillPercent)
+    {
+        m_saturated = saturated;
+        std::function<void(bool, unsigned)> callback;
+        {
+            LOCKGUARD(m_backpressureLock);
+            callback = m_backpressureCallback;
+        }
+        if (callback)
+        {
+            callback(saturated, fillPercent);
+        }
+    }
+
     status_t LogManagerImpl::DeleteData()
     {
 
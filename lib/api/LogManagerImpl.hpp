@@ -18,6 +18,7 @@
 
 #include "api/ContextFieldsProvider.hpp"
 #include "api/Logger.hpp"
+#include "api/LoggerLookupCache.hpp"
 
 #include "DebugEvents.hpp"
 #include <memory>
@@ -26,12 +27,15 @@
 #include "api/AuthTokensController.hpp"
 #include "api/DataViewerCollection.hpp"
 #include "filter/EventFilterCollection.hpp"
+#include "filter/EventSampler.hpp"
 
 #include "AllowedLevelsCollection.hpp"
 
 #include "IDataInspector.hpp"
 #include "offline/LogSessionDataProvider.hpp"
+#include "offline/SystemInfoCache.hpp"
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <set>
@@ -39,6 +43,7 @@
 namespace MAT_NS_BEGIN
 {
     class ITelemetrySystem;
+    class SharedRuntime;
 
     class DiagLevelFilter final
     {
@@ -123,8 +128,25 @@ namespace MAT_NS_BEGIN
         std::shared_ptr<IDecoratorModule> m_customDecorator;
 
         virtual void sendEvent(IncomingEventContextPtr const& event) = 0;
+
+        /// <summary>
+        /// Context to pass to sendEvent(), recycled once the caller releases it
+        /// </summary>
+        virtual std::shared_ptr<IncomingEventContext> AcquireIncomingEventContext()
+        {
+            return std::make_shared<IncomingEventContext>();
+        }
+
         virtual const ContextFieldsProvider& GetContext() = 0;
         virtual const DiagLevelFilter& GetLevelFilter() = 0;
+
+        /// <summary>
+        /// Ingress sampling stage run by the loggers before decorating events, nullptr if none
+        /// </summary>
+        virtual EventSampler* GetEventSampler()
+        {
+            return nullptr;
+        }
     };
 
     class Logger;
@@ -272,6 +294,7 @@ namespace MAT_NS_BEGIN
         /// </summary>
         /// <param name="event">The event.</param>
         virtual void sendEvent(IncomingEventContextPtr const& event) override;
+        virtual std::shared_ptr<IncomingEventContext> AcquireIncomingEventContext() override;
 
         void SetLevelFilter(uint8_t defaultLevel, uint8_t levelMin, uint8_t levelMax) override;
 
@@ -308,6 +331,18 @@ namespace MAT_NS_BEGIN
         virtual bool StartActivity() override;
         virtual void EndActivity() override;
 
+        virtual status_t GetPipelineStageStats(PipelineStage stage, PipelineStageStats& stats) override;
+
+        virtual status_t GetShutdownStats(ShutdownStats& stats) override;
+
+        virtual status_t GetMemoryUsage(MemoryUsageStats& stats) override;
+
+        virtual status_t SetBackpressureCallback(std::function<void(bool saturated, unsigned fillPercent)> callback) override;
+
+        virtual bool IsSaturated() const override;
+
+        virtual EventSampler* GetEventSampler() override;
+
        protected:
         std::unique_ptr<ITelemetrySystem>& GetSystem();
         void InitializeModules() noexcept;
@@ -318,9 +353,11 @@ namespace MAT_NS_BEGIN
         static DeadLoggers s_deadLoggers;
         std::recursive_mutex m_lock;
         LoggerMap m_loggers;
+        LoggerLookupCache m_loggerCache;
         ContextFieldsProvider m_context;
 
         std::shared_ptr<IHttpClient> m_httpClient;
+        std::shared_ptr<SharedRuntime> m_sharedRuntime;
         std::shared_ptr<ITaskDispatcher> m_taskDispatcher;
         std::shared_ptr<IDataViewer> m_dataViewer;
 
@@ -334,20 +371,44 @@ namespace MAT_NS_BEGIN
 
         std::unique_ptr<IOfflineStorage> m_offlineStorage;
         std::unique_ptr<LogSessionDataProvider> m_logSessionDataProvider;
-        bool m_isSystemStarted{};
+        std::unique_ptr<SystemInfoCache> m_systemInfoCache;
+        std::atomic<bool> m_isSystemStarted{};
         std::unique_ptr<ITelemetrySystem> m_system;
 
+        // Kept from the telemetry system stopped by FlushAndTeardown, guarded by m_lock
+        ShutdownStats m_shutdownStats;
+        bool m_hasShutdownStats {};
+
         bool m_alive;
 
         DebugEventSource m_debugEventSource;
         DiagLevelFilter m_diagLevelFilter;
 
         EventFilterCollection m_filters;
+        EventSampler m_eventSampler;
+
+        // Backpressure state, following the EVT_STORAGE_BACKPRESSURE events of the offline storage
+        std::atomic<bool> m_saturated{};
+        std::mutex m_backpressureLock;
+        std::function<void(bool, unsigned)> m_backpressureCallback;
+
+        /// <summary>
+        /// Records a backpressure watermark crossing and tells the callback.
+        /// </summary>
+        void OnBackpressure(bool saturated, unsigned fillPercent);
         std::vector<std::unique_ptr<IModule>> m_modules;
         DataViewerCollection m_dataViewerCollection;
         std::vector<std::shared_ptr<IDataInspector>> m_dataInspectors;
         std::recursive_mutex m_dataInspectorGuard;
 
+        // Immutable copy of m_dataInspectors read by sendEvent without taking m_dataInspectorGuard
+        std::shared_ptr<const std::vector<std::shared_ptr<IDataInspector>>> m_dataInspectorsSnapshot;
+
+        /// <summary>
+        /// Publishes the current data inspectors to sendEvent. Called with m_dataInspectorGuard held.
+        /// </summary>
+        void PublishDataInspectors();
+
         std::mutex m_pause_mutex;
         std::condition_variable m_pause_cv;
         uint64_t m_pause_active_count = 0;
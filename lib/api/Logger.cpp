@@ -7,6 +7,7 @@
 #include "CommonFields.h"
 #include "LogSessionData.hpp"
 #include "NullObjects.hpp"
+#include "bond/TypedEventEncoder.hpp"
 #include "utils/Utils.hpp"
 
 #include <algorithm>
@@ -103,7 +104,8 @@ namespace MAT_NS_BEGIN
         m_semanticApiDecorators(logManager),
         m_sessionStartTime(0),
         m_allowDotsInType(false),
-        m_resetSessionOnEnd(false)
+        m_resetSessionOnEnd(false),
+        m_hasRamQueue(true)
     {
         std::string tenantId = tenantTokenToId(m_tenantToken);
         LOG_TRACE("%p: New instance (tenantId=%s)", this, tenantId.c_str());
@@ -115,6 +117,7 @@ namespace MAT_NS_BEGIN
             m_customTypePrefix = static_cast<std::string&>(cfg[CFG_STR_COMPAT_PREFIX]);
         }
         m_resetSessionOnEnd = m_config[CFG_BOOL_SESSION_RESET_ENABLED];
+        m_hasRamQueue = static_cast<uint32_t>(m_config[CFG_INT_RAM_QUEUE_SIZE]) != 0;
 
         // Special scope "-" - means opt-out from parent context variables auto-capture.
         // It allows to detach the logger from its parent context.
@@ -257,11 +260,17 @@ namespace MAT_NS_BEGIN
             return;
         }
 
+        double popSampleScale;
+        if (!SampleEvent(properties, popSampleScale))
+        {
+            return;
+        }
+
         EventLatency latency = EventLatency_Normal;
         ::CsProtocol::Record record;
 
         const bool decorated =
-            applyCommonDecorators(record, properties, latency) &&
+            applyCommonDecorators(record, properties, latency, popSampleScale) &&
             m_semanticApiDecorators.decorateAppLifecycleMessage(record, state);
         if (!decorated)
         {
@@ -295,11 +304,25 @@ namespace MAT_NS_BEGIN
     /// </summary>
     /// <param name="properties">The properties.</param>
     void Logger::LogEvent(EventProperties const& properties)
+    {
+        logEvent(properties, false);
+    }
+
+    /// <summary>
+    /// Logs the event unless the pipeline is saturated, and reports what became of it.
+    /// </summary>
+    /// <param name="properties">The properties.</param>
+    LogEventResult Logger::TryLogEvent(EventProperties const& properties)
+    {
+        return logEvent(properties, true);
+    }
+
+    LogEventResult Logger::logEvent(EventProperties const& properties, bool shed)
     {
         ActiveLoggerCall active(*this);
         if (active.LoggerIsDead())
         {
-            return;
+            return LogEventResult_Dropped;
         }
 
         // SendAsJSON(properties, m_tenantToken);
@@ -310,7 +333,22 @@ namespace MAT_NS_BEGIN
         if (!CanEventPropertiesBeSent(properties))
         {
             DispatchEvent(DebugEventType::EVT_FILTERED);
-            return;
+            return LogEventResult_Dropped;
+        }
+
+        double popSampleScale;
+        if (!SampleEvent(properties, popSampleScale))
+        {
+            return LogEventResult_RateLimited;
+        }
+
+        // Shed before decorating, rather than queue behind a flush to disk that lags
+        if (shed && m_logManager.IsSaturated())
+        {
+            DispatchEvent(DebugEventType::EVT_DROPPED);
+            LOG_TRACE("Event %s/%s shed: the pipeline is saturated",
+                      tenantTokenToId(m_tenantToken).c_str(), properties.GetName().c_str());
+            return LogEventResult_Dropped;
         }
 
         EventLatency latency = EventLatency_Normal;
@@ -321,16 +359,87 @@ namespace MAT_NS_BEGIN
 
         ::CsProtocol::Record record;
 
-        if (!applyCommonDecorators(record, properties, latency))
+        if (!applyCommonDecorators(record, properties, latency, popSampleScale))
         {
             LOG_ERROR("Failed to log %s event %s/%s: invalid arguments provided",
                       "custom",
                       tenantTokenToId(m_tenantToken).c_str(),
                       properties.GetName().empty() ? "<unnamed>" : properties.GetName().c_str());
+            return LogEventResult_Dropped;
+        }
+
+        bool submitted = submit(record, properties);
+        DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_EVENT, size_t(latency), size_t(0), static_cast<void*>(&record), sizeof(record)));
+        if (!submitted)
+        {
+            return LogEventResult_Dropped;
+        }
+
+        if (m_hasRamQueue)
+        {
+            return LogEventResult_Accepted;
+        }
+        return (properties.GetPersistence() == EventPersistence_DoNotStoreOnDisk) ? LogEventResult_Dropped : LogEventResult_QueuedToDisk;
+    }
+
+    void Logger::LogTypedEvent(ITypedEvent const& event)
+    {
+        ActiveLoggerCall active(*this);
+        if (active.LoggerIsDead())
+        {
             return;
         }
 
-        submit(record, properties);
+        // Filters, sampling and the level check see the name, latency and persistence only
+        EventProperties properties(event.GetName());
+        properties.SetLatency(event.GetLatency());
+        properties.SetPersistence(event.GetPersistence());
+
+        LOG_TRACE("%p: LogTypedEvent(name=\"%s\", ...)", this, properties.GetName().c_str());
+
+        if (!CanEventPropertiesBeSent(properties))
+        {
+            DispatchEvent(DebugEventType::EVT_FILTERED);
+            return;
+        }
+
+        double popSampleScale;
+        if (!SampleEvent(properties, popSampleScale))
+        {
+            return;
+        }
+
+        EncodedPartC partC;
+        TypedEventEncoder encoder(partC);
+        event.VisitFields(encoder);
+        if (!encoder.Finish())
+        {
+            LOG_ERROR("Failed to log %s event %s/%s: invalid field name",
+                      "typed",
+                      tenantTokenToId(m_tenantToken).c_str(),
+                      properties.GetName().c_str());
+            DispatchEvent(DebugEvent(DebugEventType::EVT_REJECTED, size_t(REJECTED_REASON_VALIDATION_FAILED)));
+            return;
+        }
+
+        EventLatency latency = EventLatency_Normal;
+        if (properties.GetLatency() > EventLatency_Unspecified)
+        {
+            latency = properties.GetLatency();
+        }
+
+        ::CsProtocol::Record record;
+
+        if (!applyCommonDecorators(record, properties, latency, popSampleScale))
+        {
+            LOG_ERROR("Failed to log %s event %s/%s: invalid arguments provided",
+                      "typed",
+                      tenantTokenToId(m_tenantToken).c_str(),
+                      properties.GetName().c_str());
+            return;
+        }
+
+        submitEvent(record, properties, &partC);
         DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_EVENT, size_t(latency), size_t(0), static_cast<void*>(&record), sizeof(record)));
     }
 
@@ -365,11 +474,17 @@ namespace MAT_NS_BEGIN
             return;
         }
 
+        double popSampleScale;
+        if (!SampleEvent(properties, popSampleScale))
+        {
+            return;
+        }
+
         EventLatency latency = EventLatency_Normal;
         ::CsProtocol::Record record;
 
         const bool decorated =
-            applyCommonDecorators(record, properties, latency) &&
+            applyCommonDecorators(record, properties, latency, popSampleScale) &&
             m_semanticApiDecorators.decorateFailureMessage(record, signature, detail, category, id);
 
         if (!decorated)
@@ -416,11 +531,17 @@ namespace MAT_NS_BEGIN
             return;
         }
 
+        double popSampleScale;
+        if (!SampleEvent(properties, popSampleScale))
+        {
+            return;
+        }
+
         EventLatency latency = EventLatency_Normal;
         ::CsProtocol::Record record;
 
         const bool decorated =
-            applyCommonDecorators(record, properties, latency) &&
+            applyCommonDecorators(record, properties, latency, popSampleScale) &&
             m_semanticApiDecorators.decoratePageViewMessage(record, id, pageName, category, uri, referrer);
 
         if (!decorated)
@@ -470,11 +591,17 @@ namespace MAT_NS_BEGIN
             return;
         }
 
+        double popSampleScale;
+        if (!SampleEvent(properties, popSampleScale))
+        {
+            return;
+        }
+
         EventLatency latency = EventLatency_Normal;
         ::CsProtocol::Record record;
 
         const bool decorated =
-            applyCommonDecorators(record, properties, latency) &&
+            applyCommonDecorators(record, properties, latency, popSampleScale) &&
             m_semanticApiDecorators.decoratePageActionMessage(record, pageActionData);
         if (!decorated)
         {
@@ -494,7 +621,7 @@ namespace MAT_NS_BEGIN
     /// <param name="properties">The properties.</param>
     /// <param name="latency">The latency.</param>
     /// <returns></returns>
-    bool Logger::applyCommonDecorators(::CsProtocol::Record& record, EventProperties const& properties, EventLatency& latency)
+    bool Logger::applyCommonDecorators(::CsProtocol::Record& record, EventProperties const& properties, EventLatency& latency, double popSampleScale)
     {
         ActiveLoggerCall active(*this);
         if (active.LoggerIsDead())
@@ -525,15 +652,25 @@ namespace MAT_NS_BEGIN
         }
         record.iKey = m_iKey;
 
-        return m_baseDecorator.decorate(record) && m_semanticContextDecorator.decorate(record) && m_eventPropertiesDecorator.decorate(record, latency, properties);
+        if (!(m_baseDecorator.decorate(record) && m_semanticContextDecorator.decorate(record) && m_eventPropertiesDecorator.decorate(record, latency, properties)))
+        {
+            return false;
+        }
+        record.popSample *= popSampleScale;
+        return true;
     }
 
-    void Logger::submit(::CsProtocol::Record& record, const EventProperties& props)
+    bool Logger::submit(::CsProtocol::Record& record, const EventProperties& props)
+    {
+        return submitEvent(record, props, nullptr);
+    }
+
+    bool Logger::submitEvent(::CsProtocol::Record& record, const EventProperties& props, EncodedPartC const* partC)
     {
         ActiveLoggerCall active(*this);
         if (active.LoggerIsDead())
         {
-            return;
+            return false;
         }
 
         const auto policyBitFlags = props.GetPolicyBitFlags();
@@ -563,13 +700,13 @@ namespace MAT_NS_BEGIN
                     LOG_INFO("Event %s/%s dropped: no diagnostic level assigned!",
                              tenantTokenToId(m_tenantToken).c_str(), record.baseType.c_str());
                     DispatchEvent(DebugEventType::EVT_FILTERED);
-                    return;
+                    return false;
                 }
             }
             if (!levelFilter.IsLevelEnabled(level))
             {
                 DispatchEvent(DebugEventType::EVT_FILTERED);
-                return;
+                return false;
             }
         }
 
@@ -578,14 +715,17 @@ namespace MAT_NS_BEGIN
             DispatchEvent(DebugEventType::EVT_DROPPED);
             LOG_INFO("Event %s/%s dropped: calculated latency 0 (Off)",
                      tenantTokenToId(m_tenantToken).c_str(), record.baseType.c_str());
-            return;
+            return false;
         }
 
         // TODO: [MG] - check if optimization is possible in generateUuidString
-        IncomingEventContext event(PAL::generateUuidString(), m_tenantToken, latency, persistence, &record);
-        event.policyBitFlags = policyBitFlags;
+        auto event = m_logManager.AcquireIncomingEventContext();
+        event->reset(PAL::generateUuidString(), m_tenantToken, latency, persistence, &record);
+        event->policyBitFlags = policyBitFlags;
+        event->partC = partC;
 
-        m_logManager.sendEvent(&event);
+        m_logManager.sendEvent(event.get());
+        return true;
     }
 
     void Logger::onSubmitted()
@@ -623,11 +763,17 @@ namespace MAT_NS_BEGIN
             return;
         }
 
+        double popSampleScale;
+        if (!SampleEvent(properties, popSampleScale))
+        {
+            return;
+        }
+
         EventLatency latency = EventLatency_Normal;
         ::CsProtocol::Record record;
 
         const bool decorated =
-            applyCommonDecorators(record, properties, latency) &&
+            applyCommonDecorators(record, properties, latency, popSampleScale) &&
             m_semanticApiDecorators.decorateSampledMetricMessage(record, name, value, units, instanceName, objectClass, objectId);
 
         if (!decorated)
@@ -679,11 +825,17 @@ namespace MAT_NS_BEGIN
             return;
         }
 
+        double popSampleScale;
+        if (!SampleEvent(properties, popSampleScale))
+        {
+            return;
+        }
+
         EventLatency latency = EventLatency_Normal;
         ::CsProtocol::Record record;
 
         const bool decorated =
-            applyCommonDecorators(record, properties, latency) &&
+            applyCommonDecorators(record, properties, latency, popSampleScale) &&
             m_semanticApiDecorators.decorateAggregatedMetricMessage(record, metricData);
 
         if (!decorated)
@@ -717,11 +869,17 @@ namespace MAT_NS_BEGIN
             return;
         }
 
+        double popSampleScale;
+        if (!SampleEvent(properties, popSampleScale))
+        {
+            return;
+        }
+
         EventLatency latency = EventLatency_Normal;
         ::CsProtocol::Record record;
 
         bool decorated =
-            applyCommonDecorators(record, properties, latency) &&
+            applyCommonDecorators(record, properties, latency, popSampleScale) &&
             m_semanticApiDecorators.decorateTraceMessage(record, level, message);
 
         if (!decorated)
@@ -755,11 +913,17 @@ namespace MAT_NS_BEGIN
             return;
         }
 
+        double popSampleScale;
+        if (!SampleEvent(properties, popSampleScale))
+        {
+            return;
+        }
+
         EventLatency latency = EventLatency_Normal;
         ::CsProtocol::Record record;
 
         bool decorated =
-            applyCommonDecorators(record, properties, latency) &&
+            applyCommonDecorators(record, properties, latency, popSampleScale) &&
             m_semanticApiDecorators.decorateUserStateMessage(record, state, timeToLiveInMillis);
 
         if (!decorated)
@@ -861,7 +1025,7 @@ namespace MAT_NS_BEGIN
         EventLatency latency = EventLatency_RealTime;
         ::CsProtocol::Record record;
 
-        bool decorated = applyCommonDecorators(record, props, latency) &&
+        bool decorated = applyCommonDecorators(record, props, latency, 1.0) &&
                          m_semanticApiDecorators.decorateSessionMessage(record, state, m_sessionId, PAL::formatUtcTimestampMsAsISO8601(sessionFirstTime), sessionSDKUid, sessionDuration);
 
         if (!decorated)
@@ -950,6 +1114,26 @@ namespace MAT_NS_BEGIN
         return m_filters.CanEventPropertiesBeSent(properties) && m_logManager.GetEventFilters().CanEventPropertiesBeSent(properties);
     }
 
+    bool Logger::SampleEvent(EventProperties const& properties, double& popSampleScale)
+    {
+        popSampleScale = 1.0;
+        EventSampler* sampler = m_logManager.GetEventSampler();
+        if (sampler == nullptr || !sampler->IsActive())
+        {
+            return true;
+        }
+
+        EventSampler::Decision decision = sampler->Admit(properties, m_tenantToken, m_context, popSampleScale);
+        if (decision != EventSampler::Accepted)
+        {
+            LOG_TRACE("Event %s/%s shed by ingress sampling: %d",
+                      tenantTokenToId(m_tenantToken).c_str(), properties.GetName().c_str(), static_cast<int>(decision));
+            DispatchEvent(DebugEvent(DebugEventType::EVT_FILTERED, static_cast<size_t>(decision)));
+            return false;
+        }
+        return true;
+    }
+
     void Logger::RecordShutdown()
     {
         std::unique_lock<std::mutex> shutdownLock(m_shutdown_mutex);
@@ -27,6 +27,7 @@
 namespace MAT_NS_BEGIN
 {
     class BaseDecorator;
+    class EncodedPartC;
     class ILogManagerInternal;
 
     class ActiveLoggerCall;
@@ -142,6 +143,10 @@ namespace MAT_NS_BEGIN
 
         virtual void LogEvent(EventProperties const& properties) override;
 
+        virtual void LogTypedEvent(ITypedEvent const& event) override;
+
+        virtual LogEventResult TryLogEvent(EventProperties const& properties) override;
+
         virtual void LogFailure(std::string const& signature,
                                 std::string const& detail,
                                 std::string const& category,
@@ -229,14 +234,40 @@ namespace MAT_NS_BEGIN
        protected:
         bool applyCommonDecorators(::CsProtocol::Record& record,
                                    EventProperties const& properties,
-                                   MAT::EventLatency& latency);
+                                   MAT::EventLatency& latency,
+                                   double popSampleScale);
 
-        virtual void
+        /// <summary>
+        /// Hands a decorated custom event to submitEvent().
+        /// </summary>
+        /// <returns>true if the record was handed to the LogManager.</returns>
+        virtual bool
         submit(::CsProtocol::Record& record, const EventProperties& props);
 
+        /// <summary>
+        /// Shared path of LogEvent and TryLogEvent: filters, samples, decorates and submits the event.
+        /// </summary>
+        /// <param name="shed">Drop the event instead of queueing it while the pipeline is saturated.</param>
+        LogEventResult logEvent(EventProperties const& properties, bool shed);
+
+        /// <summary>
+        /// Filters the decorated record by level and latency and hands it to the LogManager,
+        /// along with the pre-encoded Part C of a typed event if partC is not null.
+        /// </summary>
+        /// <returns>true if the record was handed to the LogManager.</returns>
+        bool submitEvent(::CsProtocol::Record& record, const EventProperties& props, EncodedPartC const* partC);
+
         bool
         CanEventPropertiesBeSent(EventProperties const& properties) const noexcept;
 
+        /// <summary>
+        /// Runs the ingress sampling stage of the LogManager. Shed events are reported as EVT_FILTERED
+        /// with the EventSampler::Decision in param1.
+        /// </summary>
+        /// <param name="popSampleScale">Receives the factor to apply to the popSample of a kept event.</param>
+        /// <returns>true if the event is kept.</returns>
+        bool SampleEvent(EventProperties const& properties, double& popSampleScale);
+
         std::mutex m_lock;
 
         std::string m_tenantToken;
@@ -266,6 +297,7 @@ namespace MAT_NS_BEGIN
         std::string m_customTypePrefix;
 
         bool m_resetSessionOnEnd;
+        bool m_hasRamQueue;
         EventFilterCollection m_filters;
 
         /// m_shutdown_mutex protects shut-down state
@@ -0,0 +1,139 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef LOGGERLOOKUPCACHE_HPP
+#define LOGGERLOOKUPCACHE_HPP
+
+#include "ctmacros.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    class Logger;
+
+    /// <summary>
+    /// Maps the (tenant token, source) pair exactly as passed to GetLogger to the
+    /// Logger created for it, so that repeated lookups skip the normalization and
+    /// the owner's lock.
+    ///
+    /// The table is open-addressed and insert-only: find() may run concurrently
+    /// with anything, while insert() and clear() must be serialized by the caller.
+    /// Entries removed by clear() stay allocated until the cache is destroyed,
+    /// because a concurrent reader may still be comparing against them.
+    /// </summary>
+    class LoggerLookupCache
+    {
+    public:
+        /// Number of slots, a power of two
+        static const size_t Capacity = 128;
+        /// Inserts past this count are refused so that probe sequences stay short
+        static const size_t MaxEntries = Capacity * 3 / 4;
+
+        LoggerLookupCache() :
+            m_count(0)
+        {
+            for (auto& slot : m_slots)
+            {
+                slot.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        LoggerLookupCache(const LoggerLookupCache&) = delete;
+        LoggerLookupCache& operator=(const LoggerLookupCache&) = delete;
+
+        static size_t hash(const std::string& tenantToken, const std::string& source)
+        {
+            size_t seed = std::hash<std::string>()(tenantToken);
+            return seed ^ (std::hash<std::string>()(source) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+        }
+
+        /// <summary>
+        /// Returns the Logger cached for the pair, or nullptr. Does not lock.
+        /// </summary>
+        Logger* find(size_t key, const std::string& tenantToken, const std::string& source) const
+        {
+            for (size_t i = 0; i < Capacity; i++)
+            {
+                const Entry* entry = m_slots[(key + i) & (Capacity - 1)].load(std::memory_order_acquire);
+                if (entry == nullptr)
+                {
+                    return nullptr;
+                }
+                if (entry->key == key && entry->tenantToken == tenantToken && entry->source == source)
+                {
+                    return entry->logger;
+                }
+            }
+            return nullptr;
+        }
+
+        /// <summary>
+        /// Publishes a Logger for the pair. Returns false if the cache is full,
+        /// in which case lookups for the pair keep taking the slow path.
+        /// </summary>
+        bool insert(size_t key, const std::string& tenantToken, const std::string& source, Logger* logger)
+        {
+            if (m_count >= MaxEntries)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < Capacity; i++)
+            {
+                auto& slot = m_slots[(key + i) & (Capacity - 1)];
+                const Entry* entry = slot.load(std::memory_order_relaxed);
+                if (entry == nullptr)
+                {
+                    m_entries.emplace_back(new Entry { key, tenantToken, source, logger });
+                    slot.store(m_entries.back().get(), std::memory_order_release);
+                    m_count++;
+                    return true;
+                }
+                if (entry->key == key && entry->tenantToken == tenantToken && entry->source == source)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// Unpublishes all entries. Lookups that already found a Logger may still return it.
+        /// </summary>
+        void clear()
+        {
+            for (auto& slot : m_slots)
+            {
+                slot.store(nullptr, std::memory_order_release);
+            }
+            m_count = 0;
+        }
+
+        size_t size() const
+        {
+            return m_count;
+        }
+
+    protected:
+        struct Entry
+        {
+            size_t      key;
+            std::string tenantToken;
+            std::string source;
+            Logger*     logger;
+        };
+
+        std::atomic<const Entry*>            m_slots[Capacity];
+        std::vector<std::unique_ptr<Entry>>  m_entries;
+        size_t                               m_count;
+    };
+
+} MAT_NS_END
+
+#endif
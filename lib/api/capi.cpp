@@ -19,7 +19,9 @@
 
 #include <mutex>
 #include <map>
+#include <memory>
 #include <cstdint>
+#include <cstring>
 
 static const char * libSemver = TELEMETRY_EVENTS_VERSION;
 
@@ -28,6 +30,20 @@ using namespace MAT;
 static std::mutex mtx;
 static std::map<evt_handle_t, capi_client> clients;
 
+// Immutable index of the clients for lookups without mtx, republished under mtx on open and close
+typedef std::map<evt_handle_t, capi_client*> capi_client_index;
+static std::shared_ptr<const capi_client_index> clientIndex;
+
+static void publish_clients()
+{
+    auto index = std::make_shared<capi_client_index>();
+    for (auto& kv : clients)
+    {
+        (*index)[kv.first] = &(kv.second);
+    }
+    std::atomic_store(&clientIndex, std::shared_ptr<const capi_client_index>(index));
+}
+
 /// <summary>
 /// Convert from C API handle to internal C API client struct.
 ///
@@ -41,9 +57,13 @@ static std::map<evt_handle_t, capi_client> clients;
 /// </summary>
 capi_client * MAT::capi_get_client(evt_handle_t handle)
 {
-    LOCKGUARD(mtx);
-    const auto it = clients.find(handle);
-    return (it != clients.cend()) ? &(it->second) : nullptr;
+    const auto index = std::atomic_load(&clientIndex);
+    if (index == nullptr)
+    {
+        return nullptr;
+    }
+    const auto it = index->find(handle);
+    return (it != index->cend()) ? it->second : nullptr;
 }
 
 /// <summary>
@@ -53,6 +73,7 @@ void remove_client(evt_handle_t handle)
 {
     LOCKGUARD(mtx);
     clients.erase(handle);
+    publish_clients();
 }
 
 #define VERIFY_CLIENT_HANDLE(client, ctx)                       \
@@ -102,11 +123,18 @@ evt_status_t mat_open_core(
         isHashFound = true;
     } while (!isHashFound);
 
+    capi_client* client = nullptr;
+    {
+        LOCKGUARD(mtx);
+        client = &clients[code];
+        publish_clients();
+    }
+
     // JSON configuration must start with {
     if (config[0] == '{')
     {
         // Create new configuration object from JSON
-        clients[code].config = MAT::FromJSON(config);
+        client->config = MAT::FromJSON(config);
     }
     else
     {
@@ -114,7 +142,7 @@ evt_status_t mat_open_core(
         // That approach allows to consume the lightweght C API without JSON parser compiled in.
         std::string moduleName = "CAPI-Client-";
         moduleName += std::to_string(code);
-        clients[code].config =
+        client->config =
         {
             { CFG_STR_FACTORY_NAME, moduleName },
             { "version", "1.0.0" },
@@ -129,7 +157,7 @@ evt_status_t mat_open_core(
     }
 
     // Remember the original config string. Needed to avoid hash code collisions
-    clients[code].ctx_data = config;
+    client->ctx_data = config;
 
 #if !defined (ANDROID) || defined(ENABLE_CAPI_HTTP_CLIENT)
     // Create custom HttpClient
@@ -138,8 +166,8 @@ evt_status_t mat_open_core(
         try
         {
             auto http = std::make_shared<HttpClient_CAPI>(httpSendFn, httpCancelFn);
-            clients[code].http = http;
-            clients[code].config.AddModule(CFG_MODULE_HTTP_CLIENT, http);
+            client->http = http;
+            client->config.AddModule(CFG_MODULE_HTTP_CLIENT, http);
         }
         catch (...)
         {
@@ -153,8 +181,8 @@ evt_status_t mat_open_core(
         try
         {
             auto taskDispatcher = std::make_shared<PAL::TaskDispatcher_CAPI>(taskDispatcherQueueFn, taskDispatcherCancelFn, taskDispatcherJoinFn);
-            clients[code].taskDispatcher = taskDispatcher;
-            clients[code].config.AddModule(CFG_MODULE_TASK_DISPATCHER, taskDispatcher);
+            client->taskDispatcher = taskDispatcher;
+            client->config.AddModule(CFG_MODULE_TASK_DISPATCHER, taskDispatcher);
         }
         catch (...)
         {
@@ -162,11 +190,32 @@ evt_status_t mat_open_core(
         }
     }
 
+    // Privacy feature for OTEL C API client:
+    //
+    // C API customer that does not explicitly pass down JSON
+    //   config["config]["scope"] = COMMONFIELDS_SCOPE_ALL;
+    //
+    // should not be able to capture the host's context vars.
+    client->scope = CONTEXT_SCOPE_NONE;
+    {
+        MAT::VariantMap &config_map = client->config[CFG_MAP_FACTORY_CONFIG];
+        const auto & it = config_map.find(CFG_STR_CONTEXT_SCOPE);
+        if (it != config_map.cend())
+        {
+            client->scope = static_cast<const char *>(it->second);
+            // Specifying "*" in JSON config allows Guest C API logger to capture Host context variables
+            if (client->scope == CONTEXT_SCOPE_ALL)
+            {
+                client->scope = CONTEXT_SCOPE_EMPTY;
+            }
+        }
+    }
+
     status_t status = static_cast<status_t>(EFAULT);
-    clients[code].logmanager = LogManagerProvider::CreateLogManager(clients[code].config, status);
+    client->logmanager = LogManagerProvider::CreateLogManager(client->config, status);
 
     // Verify that the instance pointer is valid
-    if (clients[code].logmanager == nullptr)
+    if (client->logmanager == nullptr)
     {
         status = static_cast<status_t>(EFAULT);
     }
@@ -231,58 +280,110 @@ evt_status_t mat_open_with_params(evt_context_t *ctx)
 }
 
 /**
- * Marashal C struct to C++ API
+ * Marshal one C event to C++ API. The route is reused while consecutive
+ * events carry the same tenant token and source, and replaced otherwise.
  */
-evt_status_t mat_log(evt_context_t *ctx)
+static evt_status_t mat_log_event(capi_client* client, const evt_prop* evt, size_t size, std::shared_ptr<const capi_route>& route)
 {
-    VERIFY_CLIENT_HANDLE(client, ctx);
-
-    ILogConfiguration & config = client->config;
-    const evt_prop *evt = static_cast<evt_prop*>(ctx->data);
-    EventProperties props;
-    props.unpack(evt, ctx->size);
+    if (evt == nullptr)
+    {
+        return EFAULT; /* bad address */
+    }
 
-    auto m = props.GetProperties();
-    EventProperty &prop = m[COMMONFIELDS_IKEY];
-    std::string token = prop.as_string;
-    props.erase(COMMONFIELDS_IKEY);
+    // Find the routing fields in place rather than in a copy of the unpacked properties
+    const char* token = "";
+    const char* source = "";
+    if (size == 0)
+    {
+        size = SIZE_MAX;
+    }
+    for (const evt_prop* curr = evt; (size_t(curr - evt) < size) && (curr->type != TYPE_NULL); curr++)
+    {
+        if (curr->name == nullptr || curr->type != TYPE_STRING || curr->value.as_string == nullptr)
+        {
+            continue;
+        }
+        if (strcmp(curr->name, COMMONFIELDS_IKEY) == 0)
+        {
+            token = curr->value.as_string;
+        }
+        else if (strcmp(curr->name, COMMONFIELDS_EVENT_SOURCE) == 0)
+        {
+            source = curr->value.as_string;
+        }
+    }
 
-    // Privacy feature for OTEL C API client:
-    //
-    // C API customer that does not explicitly pass down JSON
-    //   config["config]["scope"] = COMMONFIELDS_SCOPE_ALL;
-    //
-    // should not be able to capture the host's context vars.
-    std::string scope = CONTEXT_SCOPE_NONE;
+    if ((route == nullptr) || (route->token != token) || (route->source != source))
     {
-        MAT::VariantMap &config_map = config[CFG_MAP_FACTORY_CONFIG];
-        const auto & it = config_map.find(CFG_STR_CONTEXT_SCOPE);
-        if (it != config_map.cend())
+        auto resolved = std::make_shared<capi_route>();
+        resolved->token = token;
+        resolved->source = source;
+        resolved->logger = client->logmanager->GetLogger(resolved->token, resolved->source, client->scope);
+        if (resolved->logger == nullptr)
         {
-            scope = static_cast<const char *>(it->second);
-            // Specifying "*" in JSON config allows Guest C API logger to capture Host context variables
-            if (scope == CONTEXT_SCOPE_ALL)
-            {
-                scope = CONTEXT_SCOPE_EMPTY;
-            }
+            return EFAULT; /* invalid address */
         }
+        resolved->logger->SetParentContext(nullptr);
+        route = resolved;
     }
 
-    const auto & it = m.find(COMMONFIELDS_EVENT_SOURCE);
-    std::string source = ((it != m.cend()) && (it->second.type == EventProperty::TYPE_STRING)) ? it->second.as_string : "";
+    EventProperties props;
+    props.unpack(evt, size);
+    props.erase(COMMONFIELDS_IKEY);
+    route->logger->LogEvent(props);
+    return EOK;
+}
 
-    ILogger *logger = client->logmanager->GetLogger(token, source, scope);
-    if (logger == nullptr)
+/**
+ * Publish the route of the last event logged, unless it is the cached one already
+ */
+static void mat_cache_route(capi_client* client, std::shared_ptr<const capi_route> const& cached, std::shared_ptr<const capi_route> const& route)
+{
+    if (route != cached)
     {
-        ctx->result = EFAULT; /* invalid address */
+        std::atomic_store(&client->route, route);
     }
-    else
+}
+
+evt_status_t mat_log(evt_context_t *ctx)
+{
+    VERIFY_CLIENT_HANDLE(client, ctx);
+    const auto cached = std::atomic_load(&client->route);
+    auto route = cached;
+    ctx->result = mat_log_event(client, static_cast<evt_prop*>(ctx->data), ctx->size, route);
+    mat_cache_route(client, cached, route);
+    return ctx->result;
+}
+
+/**
+ * Marshal a batch of C events to C++ API: the handle is resolved once, and
+ * the logger once per run of events with the same tenant token and source.
+ */
+evt_status_t mat_log_batch(evt_context_t *ctx)
+{
+    VERIFY_CLIENT_HANDLE(client, ctx);
+    evt_prop** evts = static_cast<evt_prop**>(ctx->data);
+    if ((evts == nullptr) && (ctx->size != 0))
     {
-        logger->SetParentContext(nullptr);
-        logger->LogEvent(props);
-        ctx->result = EOK;
+        ctx->result = EFAULT;
+        return ctx->result;
     }
-    return ctx->result;
+
+    const auto cached = std::atomic_load(&client->route);
+    auto route = cached;
+    evt_status_t result = EOK;
+    for (uint32_t i = 0; i < ctx->size; i++)
+    {
+        // Keep logging past a bad event, report the first failure
+        evt_status_t status = mat_log_event(client, evts[i], 0, route);
+        if ((status != EOK) && (result == EOK))
+        {
+            result = status;
+        }
+    }
+    mat_cache_route(client, cached, route);
+    ctx->result = result;
+    return result;
 }
 
 evt_status_t mat_close(evt_context_t *ctx)
@@ -386,6 +487,10 @@ extern "C" {
                 result = mat_log(ctx);
                 break;
 
+            case EVT_OP_LOG_BATCH:
+                result = mat_log_batch(ctx);
+                break;
+
             case EVT_OP_PAUSE:
                 result = mat_pause(ctx);
                 break;
@@ -6,5 +6,6 @@
 #pragma once
 #include "Common.hpp"
 #include "CompactBinaryProtocolWriter.hpp"
+#include "CompactBinaryProtocolFastWriter.hpp"
 #include "CompactBinaryProtocolReader.hpp"
 
@@ -4,6 +4,7 @@
 //
 
 #include "BondSerializer.hpp"
+#include "TypedEventEncoder.hpp"
 #include "utils/StringUtils.hpp"
 #include "utils/Utils.hpp"
 #include "bond/All.hpp"
@@ -16,9 +17,13 @@ namespace MAT_NS_BEGIN {
     bool BondSerializer::handleSerialize(IncomingEventContextPtr const& ctx)
     {
         OACR_USE_PTR(this);
+        if (ctx->partC != nullptr)
         {
-            bond_lite::CompactBinaryProtocolWriter writer(ctx->record.blob);
-            bond_lite::Serialize(writer, *ctx->source);
+            SerializeWithPartC(ctx->record.blob, *ctx->source, *ctx->partC);
+        }
+        else
+        {
+            bond_lite::SerializeFast(ctx->record.blob, *ctx->source);
         }
 
         LOG_TRACE("Event %s/%s submitted, priority %u (%s), serialized size %u bytes, ID %s",
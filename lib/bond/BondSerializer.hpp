@@ -16,6 +16,7 @@ class BondSerializer {
 
   public:
     RoutePassThrough<BondSerializer, IncomingEventContextPtr const&> serialize{this, &BondSerializer::handleSerialize};
+    StaticRouteHandler<decltype(&BondSerializer::handleSerialize), &BondSerializer::handleSerialize> serializeStatic{this};
 };
 
 
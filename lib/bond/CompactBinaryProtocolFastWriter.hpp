@@ -0,0 +1,448 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef COMPACTBINARYPROTOCOLFASTWRITER_HPP
+#define COMPACTBINARYPROTOCOLFASTWRITER_HPP
+
+#include "pal/PAL.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace bond_lite {
+
+// Two-pass alternative to CompactBinaryProtocolWriter for the generated
+// Serialize() functions: CompactBinaryProtocolSizer computes the exact
+// serialized size, then CompactBinaryProtocolFastWriter writes through a raw
+// cursor into a buffer of that size. Both follow the same encoding rules as
+// CompactBinaryProtocolWriter, so the output is bit-identical.
+
+inline uint8_t* CompactBinaryWriteVarint(uint8_t* cursor, uint64_t value)
+{
+    if (value < 128) {
+        *cursor++ = static_cast<uint8_t>(value);
+        return cursor;
+    }
+    do {
+        *cursor++ = static_cast<uint8_t>(value | 128);
+        value >>= 7;
+    } while (value > 127);
+    *cursor++ = static_cast<uint8_t>(value);
+    return cursor;
+}
+
+inline size_t CompactBinaryVarintSize(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    // ceil(significant bits / 7) without a loop
+    unsigned bits = 64 - static_cast<unsigned>(__builtin_clzll(value | 1));
+    return (bits * 9 + 64) / 64;
+#else
+    size_t size = 1;
+    while (value > 127) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+#endif
+}
+
+inline uint16_t CompactBinaryZigZag(int16_t value)
+{
+    return static_cast<uint16_t>((value << 1) ^ (value >> 15));
+}
+
+inline uint32_t CompactBinaryZigZag(int32_t value)
+{
+    return static_cast<uint32_t>((value << 1) ^ (value >> 31));
+}
+
+inline uint64_t CompactBinaryZigZag(int64_t value)
+{
+    return static_cast<uint64_t>((value << 1) ^ (value >> 63));
+}
+
+inline size_t CompactBinaryFieldHeaderSize(uint16_t id)
+{
+    return (id <= 5) ? 1 : ((id <= 0xff) ? 2 : 3);
+}
+
+class CompactBinaryProtocolSizer {
+  protected:
+    size_t m_size;
+
+  public:
+    CompactBinaryProtocolSizer()
+      : m_size(0)
+    {
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    void WriteBlob(void const* data, size_t size)
+    {
+        UNREFERENCED_PARAMETER(data);
+        m_size += size;
+    }
+
+    void WriteBool(bool value)
+    {
+        UNREFERENCED_PARAMETER(value);
+        m_size += 1;
+    }
+
+    void WriteUInt8(uint8_t value)
+    {
+        UNREFERENCED_PARAMETER(value);
+        m_size += 1;
+    }
+
+    void WriteUInt16(uint16_t value)
+    {
+        m_size += CompactBinaryVarintSize(value);
+    }
+
+    void WriteUInt32(uint32_t value)
+    {
+        m_size += CompactBinaryVarintSize(value);
+    }
+
+    void WriteUInt64(uint64_t value)
+    {
+        m_size += CompactBinaryVarintSize(value);
+    }
+
+    void WriteInt8(int8_t value)
+    {
+        UNREFERENCED_PARAMETER(value);
+        m_size += 1;
+    }
+
+    void WriteInt16(int16_t value)
+    {
+        m_size += CompactBinaryVarintSize(CompactBinaryZigZag(value));
+    }
+
+    void WriteInt32(int32_t value)
+    {
+        m_size += CompactBinaryVarintSize(CompactBinaryZigZag(value));
+    }
+
+    void WriteInt64(int64_t value)
+    {
+        m_size += CompactBinaryVarintSize(CompactBinaryZigZag(value));
+    }
+
+    void WriteFloat(float value)
+    {
+        UNREFERENCED_PARAMETER(value);
+        m_size += 4;
+    }
+
+    void WriteDouble(double value)
+    {
+        UNREFERENCED_PARAMETER(value);
+        m_size += 8;
+    }
+
+    void WriteUInt8Array(uint8_t const* values, size_t count)
+    {
+        UNREFERENCED_PARAMETER(values);
+        m_size += count;
+    }
+
+    void WriteInt64Array(int64_t const* values, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) {
+            m_size += CompactBinaryVarintSize(CompactBinaryZigZag(values[i]));
+        }
+    }
+
+    void WriteDoubleArray(double const* values, size_t count)
+    {
+        UNREFERENCED_PARAMETER(values);
+        m_size += count * 8;
+    }
+
+    void WriteString(std::string const& value)
+    {
+        m_size += CompactBinaryVarintSize(static_cast<uint32_t>(value.size())) + value.size();
+    }
+
+    void WriteWString(std::string const& value)
+    {
+        UNREFERENCED_PARAMETER(value);
+        m_size += 1;
+    }
+
+    void WriteContainerBegin(size_t size, uint8_t elementType)
+    {
+        UNREFERENCED_PARAMETER(elementType);
+        m_size += 1 + CompactBinaryVarintSize(static_cast<uint32_t>(size));
+    }
+
+    void WriteMapContainerBegin(size_t size, uint8_t keyType, uint8_t valueType)
+    {
+        UNREFERENCED_PARAMETER(keyType);
+        UNREFERENCED_PARAMETER(valueType);
+        m_size += 2 + CompactBinaryVarintSize(static_cast<uint32_t>(size));
+    }
+
+    void WriteContainerEnd()
+    {
+    }
+
+    void WriteFieldBegin(uint8_t type, uint16_t id, void* metadata)
+    {
+        UNREFERENCED_PARAMETER(type);
+        UNREFERENCED_PARAMETER(metadata);
+        m_size += CompactBinaryFieldHeaderSize(id);
+    }
+
+    void WriteFieldEnd()
+    {
+    }
+
+    void WriteFieldOmitted(uint8_t type, uint16_t id, void* metadata)
+    {
+        UNREFERENCED_PARAMETER(type);
+        UNREFERENCED_PARAMETER(id);
+        UNREFERENCED_PARAMETER(metadata);
+    }
+
+    void WriteStructBegin(void* metadata, bool isBase)
+    {
+        UNREFERENCED_PARAMETER(metadata);
+        UNREFERENCED_PARAMETER(isBase);
+    }
+
+    void WriteStructEnd(bool isBase)
+    {
+        UNREFERENCED_PARAMETER(isBase);
+        m_size += 1;
+    }
+};
+
+class CompactBinaryProtocolFastWriter {
+  protected:
+    uint8_t* m_cursor;
+#ifndef NDEBUG
+    uint8_t* m_end;
+#endif
+
+    void checkSpace(size_t size)
+    {
+#ifndef NDEBUG
+        assert(static_cast<size_t>(m_end - m_cursor) >= size);
+#else
+        UNREFERENCED_PARAMETER(size);
+#endif
+    }
+
+  public:
+    /// The buffer must be at least CompactBinaryProtocolSizer::size() bytes
+    CompactBinaryProtocolFastWriter(uint8_t* buffer, size_t size)
+      : m_cursor(buffer)
+#ifndef NDEBUG
+      , m_end(buffer + size)
+#endif
+    {
+        UNREFERENCED_PARAMETER(size);
+    }
+
+    uint8_t* cursor() const
+    {
+        return m_cursor;
+    }
+
+    void WriteBlob(void const* data, size_t size)
+    {
+        if (size != 0) {
+            checkSpace(size);
+            memcpy(m_cursor, data, size);
+            m_cursor += size;
+        }
+    }
+
+    void WriteBool(bool value)
+    {
+        checkSpace(1);
+        *m_cursor++ = value ? 1 : 0;
+    }
+
+    void WriteUInt8(uint8_t value)
+    {
+        checkSpace(1);
+        *m_cursor++ = value;
+    }
+
+    void WriteUInt16(uint16_t value)
+    {
+        checkSpace(3);
+        m_cursor = CompactBinaryWriteVarint(m_cursor, value);
+    }
+
+    void WriteUInt32(uint32_t value)
+    {
+        checkSpace(CompactBinaryVarintSize(value));
+        m_cursor = CompactBinaryWriteVarint(m_cursor, value);
+    }
+
+    void WriteUInt64(uint64_t value)
+    {
+        checkSpace(CompactBinaryVarintSize(value));
+        m_cursor = CompactBinaryWriteVarint(m_cursor, value);
+    }
+
+    void WriteInt8(int8_t value)
+    {
+        WriteUInt8(static_cast<uint8_t>(value));
+    }
+
+    void WriteInt16(int16_t value)
+    {
+        WriteUInt16(CompactBinaryZigZag(value));
+    }
+
+    void WriteInt32(int32_t value)
+    {
+        WriteUInt32(CompactBinaryZigZag(value));
+    }
+
+    void WriteInt64(int64_t value)
+    {
+        WriteUInt64(CompactBinaryZigZag(value));
+    }
+
+    void WriteFloat(float value)
+    {
+        // FIXME: Not big-endian compatible
+        static_assert(sizeof(value) == 4, "Wrong sizeof(float)");
+        WriteBlob(&value, 4);
+    }
+
+    void WriteDouble(double value)
+    {
+        // FIXME: Not big-endian compatible
+        static_assert(sizeof(value) == 8, "Wrong sizeof(double)");
+        WriteBlob(&value, 8);
+    }
+
+    void WriteUInt8Array(uint8_t const* values, size_t count)
+    {
+        WriteBlob(values, count);
+    }
+
+    void WriteInt64Array(int64_t const* values, size_t count)
+    {
+        uint8_t* cursor = m_cursor;
+        for (size_t i = 0; i < count; i++) {
+            cursor = CompactBinaryWriteVarint(cursor, CompactBinaryZigZag(values[i]));
+        }
+#ifndef NDEBUG
+        assert(cursor <= m_end);
+#endif
+        m_cursor = cursor;
+    }
+
+    void WriteDoubleArray(double const* values, size_t count)
+    {
+        // FIXME: Not big-endian compatible
+        WriteBlob(values, count * sizeof(double));
+    }
+
+    void WriteString(std::string const& value)
+    {
+        assert(value.size() <= UINT32_MAX);
+        WriteUInt32(static_cast<uint32_t>(value.size()));
+        WriteBlob(value.data(), value.size());
+    }
+
+    void WriteWString(std::string const& value)
+    {
+        UNREFERENCED_PARAMETER(value);
+        WriteUInt32(0);
+    }
+
+    void WriteContainerBegin(size_t size, uint8_t elementType)
+    {
+        WriteUInt8(elementType);
+        assert(size <= UINT32_MAX);
+        WriteUInt32(static_cast<uint32_t>(size));
+    }
+
+    void WriteMapContainerBegin(size_t size, uint8_t keyType, uint8_t valueType)
+    {
+        WriteUInt8(keyType);
+        WriteUInt8(valueType);
+        assert(size <= UINT32_MAX);
+        WriteUInt32(static_cast<uint32_t>(size));
+    }
+
+    void WriteContainerEnd()
+    {
+    }
+
+    void WriteFieldBegin(uint8_t type, uint16_t id, void* metadata)
+    {
+        UNREFERENCED_PARAMETER(metadata);
+        checkSpace(3);
+        if (id <= 5) {
+            *m_cursor++ = static_cast<uint8_t>(type | (id << 5));
+        } else if (id <= 0xff) {
+            m_cursor[0] = static_cast<uint8_t>(type | (6 << 5));
+            m_cursor[1] = static_cast<uint8_t>(id);
+            m_cursor += 2;
+        } else {
+            m_cursor[0] = static_cast<uint8_t>(type | (7 << 5));
+            m_cursor[1] = static_cast<uint8_t>(id & 255);
+            m_cursor[2] = static_cast<uint8_t>(id >> 8);
+            m_cursor += 3;
+        }
+    }
+
+    void WriteFieldEnd()
+    {
+    }
+
+    void WriteFieldOmitted(uint8_t type, uint16_t id, void* metadata)
+    {
+        UNREFERENCED_PARAMETER(type);
+        UNREFERENCED_PARAMETER(id);
+        UNREFERENCED_PARAMETER(metadata);
+    }
+
+    void WriteStructBegin(void* metadata, bool isBase)
+    {
+        UNREFERENCED_PARAMETER(metadata);
+        UNREFERENCED_PARAMETER(isBase);
+    }
+
+    void WriteStructEnd(bool isBase)
+    {
+        WriteUInt8(isBase ? 1 /* BT_STOP_BASE */ : 0 /* BT_STOP */);
+    }
+};
+
+/// Serializes a value with the generated Serialize() functions, reserving the output exactly once.
+template<typename TValue>
+void SerializeFast(std::vector<uint8_t>& output, TValue const& value)
+{
+    CompactBinaryProtocolSizer sizer;
+    Serialize(sizer, value);
+    size_t offset = output.size();
+    output.resize(offset + sizer.size());
+    CompactBinaryProtocolFastWriter writer(output.data() + offset, sizer.size());
+    Serialize(writer, value);
+    assert(writer.cursor() == output.data() + output.size());
+}
+
+} // namespace bond_lite
+#endif
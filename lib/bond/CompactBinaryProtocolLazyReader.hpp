@@ -0,0 +1,348 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef COMPACTBINARYPROTOCOLLAZYREADER_HPP
+#define COMPACTBINARYPROTOCOLLAZYREADER_HPP
+
+#include "generated/BondConstTypes.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace bond_lite {
+
+// Zero-copy counterpart of CompactBinaryProtocolReader. Works on a raw
+// buffer without taking ownership, returns strings as pointer/length pairs
+// into that buffer and can skip any value without materializing it, which
+// allows navigating a serialized struct field by field.
+//
+// Reads that run past the end of the buffer fail and set isTruncated(),
+// so a streaming caller can tell "need more data" apart from corruption.
+
+class CompactBinaryProtocolLazyReader {
+  protected:
+    uint8_t const* m_input;
+    size_t m_size;
+    size_t m_ofs;
+    bool m_truncated;
+
+    static const unsigned MaxNestingDepth = 64;
+
+  public:
+    CompactBinaryProtocolLazyReader(uint8_t const* input, size_t size)
+      : m_input(input),
+        m_size(size),
+        m_ofs(0),
+        m_truncated(false)
+    {
+    }
+
+    size_t getSize() const
+    {
+        return m_ofs;
+    }
+
+    bool isTruncated() const
+    {
+        return m_truncated;
+    }
+
+    void Seek(size_t ofs)
+    {
+        m_ofs = (ofs < m_size) ? ofs : m_size;
+    }
+
+  protected:
+    bool require(size_t size)
+    {
+        if (size > m_size - m_ofs) {
+            m_truncated = true;
+            return false;
+        }
+        return true;
+    }
+
+    template<typename T>
+    bool readVarint(T& value)
+    {
+        value = 0;
+        unsigned bits = 0;
+        for (;;) {
+            if (!require(1)) {
+                return false;
+            }
+            uint8_t raw = m_input[m_ofs++];
+            value |= static_cast<T>(raw & 127) << bits;
+            if (!(raw & 128)) {
+                return true;
+            }
+            bits += 7;
+            if (bits >= sizeof(value) * 8) {
+                return false;
+            }
+        }
+    }
+
+  public:
+    bool ReadUInt8(uint8_t& value)
+    {
+        if (!require(1)) {
+            return false;
+        }
+        value = m_input[m_ofs++];
+        return true;
+    }
+
+    bool ReadUInt32(uint32_t& value)
+    {
+        return readVarint(value);
+    }
+
+    bool ReadUInt64(uint64_t& value)
+    {
+        return readVarint(value);
+    }
+
+    bool ReadInt32(int32_t& value)
+    {
+        uint32_t uValue;
+        if (!ReadUInt32(uValue)) {
+            return false;
+        }
+        value = static_cast<int32_t>((uValue >> 1) ^ -static_cast<int32_t>(uValue & 1));
+        return true;
+    }
+
+    bool ReadInt64(int64_t& value)
+    {
+        uint64_t uValue;
+        if (!ReadUInt64(uValue)) {
+            return false;
+        }
+        value = static_cast<int64_t>((uValue >> 1) ^ -static_cast<int64_t>(uValue & 1));
+        return true;
+    }
+
+    bool ReadDouble(double& value)
+    {
+        // FIXME: Not big-endian compatible
+        static_assert(sizeof(value) == 8, "Wrong sizeof(double)");
+        if (!require(8)) {
+            return false;
+        }
+        memcpy(&value, m_input + m_ofs, 8);
+        m_ofs += 8;
+        return true;
+    }
+
+    /// Returns a reference to the string bytes inside the input buffer
+    bool ReadStringRef(char const*& data, size_t& size)
+    {
+        uint32_t length;
+        if (!ReadUInt32(length) || !require(length)) {
+            return false;
+        }
+        data = reinterpret_cast<char const*>(m_input + m_ofs);
+        size = length;
+        m_ofs += length;
+        return true;
+    }
+
+    /// Returns a reference to a list<uint8> payload (e.g. a GUID) inside the input buffer
+    bool ReadBlobRef(uint8_t const*& data, size_t& size)
+    {
+        uint32_t count;
+        uint8_t elementType;
+        if (!ReadContainerBegin(count, elementType)) {
+            return false;
+        }
+        if (elementType != BT_UINT8 && elementType != BT_INT8) {
+            return false;
+        }
+        if (!require(count)) {
+            return false;
+        }
+        data = m_input + m_ofs;
+        size = count;
+        m_ofs += count;
+        return true;
+    }
+
+    bool ReadContainerBegin(uint32_t& size, uint8_t& elementType)
+    {
+        uint8_t raw;
+        if (!ReadUInt8(raw) || raw >> 5 != 0) {
+            return false;
+        }
+        elementType = (raw & 31);
+        return ReadUInt32(size);
+    }
+
+    bool ReadMapContainerBegin(uint32_t& size, uint8_t& keyType, uint8_t& valueType)
+    {
+        return ReadUInt8(keyType) && (keyType >> 5 == 0) &&
+               ReadUInt8(valueType) && (valueType >> 5 == 0) &&
+               ReadUInt32(size);
+    }
+
+    bool ReadFieldBegin(uint8_t& type, uint16_t& id)
+    {
+        uint8_t raw;
+        if (!ReadUInt8(raw)) {
+            return false;
+        }
+
+        type = (raw & 31);
+        raw >>= 5;
+
+        if (raw <= 5) {
+            id = raw;
+        } else if (raw == 6) {
+            if (!ReadUInt8(raw)) {
+                return false;
+            }
+            id = raw;
+        } else {
+            uint8_t raw2;
+            if (!ReadUInt8(raw) || !ReadUInt8(raw2)) {
+                return false;
+            }
+            id = static_cast<uint16_t>(raw | (raw2 << 8));
+        }
+        return true;
+    }
+
+    /// Skips a value of the given type, including nested containers and structs
+    bool Skip(uint8_t type)
+    {
+        return skip(type, 0);
+    }
+
+    /// Skips the remaining fields of the current struct up to and including its BT_STOP
+    bool SkipStruct()
+    {
+        return skip(BT_STRUCT, 0);
+    }
+
+  protected:
+    bool skipItems(uint8_t type, uint32_t count, unsigned depth)
+    {
+        size_t fixed = 0;
+        switch (type) {
+            case BT_BOOL:
+            case BT_UINT8:
+            case BT_INT8:
+                fixed = 1;
+                break;
+            case BT_FLOAT:
+                fixed = 4;
+                break;
+            case BT_DOUBLE:
+                fixed = 8;
+                break;
+            default:
+                break;
+        }
+        if (fixed != 0) {
+            if (count > (m_size - m_ofs) / fixed) {
+                m_truncated = true;
+                return false;
+            }
+            m_ofs += count * fixed;
+            return true;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            if (!skip(type, depth)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool skip(uint8_t type, unsigned depth)
+    {
+        if (depth > MaxNestingDepth) {
+            return false;
+        }
+
+        switch (type) {
+            case BT_BOOL:
+            case BT_UINT8:
+            case BT_INT8:
+            case BT_FLOAT:
+            case BT_DOUBLE:
+                return skipItems(type, 1, depth);
+
+            case BT_UINT16:
+            case BT_UINT32:
+            case BT_UINT64:
+            case BT_INT16:
+            case BT_INT32:
+            case BT_INT64: {
+                uint64_t value;
+                return readVarint(value);
+            }
+
+            case BT_STRING:
+            case BT_WSTRING: {
+                uint32_t length;
+                if (!ReadUInt32(length)) {
+                    return false;
+                }
+                size_t bytes = (type == BT_WSTRING) ? static_cast<size_t>(length) * 2 : length;
+                if (!require(bytes)) {
+                    return false;
+                }
+                m_ofs += bytes;
+                return true;
+            }
+
+            case BT_STRUCT:
+                for (;;) {
+                    uint8_t fieldType;
+                    uint16_t id;
+                    if (!ReadFieldBegin(fieldType, id)) {
+                        return false;
+                    }
+                    if (fieldType == BT_STOP) {
+                        return true;
+                    }
+                    if (fieldType == BT_STOP_BASE) {
+                        continue;
+                    }
+                    if (!skip(fieldType, depth + 1)) {
+                        return false;
+                    }
+                }
+
+            case BT_LIST:
+            case BT_SET: {
+                uint32_t count;
+                uint8_t elementType;
+                return ReadContainerBegin(count, elementType) && skipItems(elementType, count, depth + 1);
+            }
+
+            case BT_MAP: {
+                uint32_t count;
+                uint8_t keyType, valueType;
+                if (!ReadMapContainerBegin(count, keyType, valueType)) {
+                    return false;
+                }
+                for (uint32_t i = 0; i < count; i++) {
+                    if (!skip(keyType, depth + 1) || !skip(valueType, depth + 1)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            default:
+                return false;
+        }
+    }
+};
+
+} // namespace bond_lite
+#endif
@@ -108,6 +108,24 @@ class CompactBinaryProtocolWriter {
         WriteBlob(&value, 8);
     }
 
+    void WriteUInt8Array(uint8_t const* values, size_t count)
+    {
+        WriteBlob(values, count);
+    }
+
+    void WriteInt64Array(int64_t const* values, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) {
+            WriteInt64(values[i]);
+        }
+    }
+
+    void WriteDoubleArray(double const* values, size_t count)
+    {
+        // FIXME: Not big-endian compatible
+        WriteBlob(values, count * sizeof(double));
+    }
+
     void WriteString(std::string const& value)
     {
         if (value.empty()) {
@@ -0,0 +1,278 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "TypedEventEncoder.hpp"
+#include "CorrelationVector.hpp"
+#include "utils/Utils.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
+#include "bond/generated/CsProtocol_readers.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace MAT_NS_BEGIN {
+
+    using bond_lite::CompactBinaryProtocolWriter;
+
+    // Same order as std::less<std::string>, which sorts the properties map
+    static int compareNames(const char* a, size_t aSize, const char* b, size_t bSize)
+    {
+        int result = std::char_traits<char>::compare(a, b, std::min(aSize, bSize));
+        if (result != 0)
+        {
+            return result;
+        }
+        return (aSize < bSize) ? -1 : ((aSize > bSize) ? 1 : 0);
+    }
+
+    TypedEventEncoder::TypedEventEncoder(EncodedPartC& partC) :
+        m_partC(partC),
+        m_valid(true)
+    {
+        m_partC.bytes.clear();
+        m_partC.entries.clear();
+    }
+
+    void TypedEventEncoder::beginEntry(TypedFieldKey const& key)
+    {
+        std::string name(key.name, key.size);
+        if (validatePropertyName(name) != REJECTED_REASON_OK || name == CorrelationVector::PropertyName)
+        {
+            m_valid = false;
+        }
+
+        EncodedPartC::Entry entry;
+        entry.name = key.name;
+        entry.nameSize = key.size;
+        entry.offset = static_cast<uint32_t>(m_partC.bytes.size());
+        entry.size = 0;
+        m_partC.entries.push_back(entry);
+
+        // The pre-encoded length prefix and the name form the Bond string
+        m_partC.bytes.insert(m_partC.bytes.end(), key.prefix, key.prefix + key.prefixSize);
+        m_partC.bytes.insert(m_partC.bytes.end(), key.name, key.name + key.size);
+    }
+
+    void TypedEventEncoder::endEntry()
+    {
+        EncodedPartC::Entry& entry = m_partC.entries.back();
+        entry.size = static_cast<uint32_t>(m_partC.bytes.size()) - entry.offset;
+    }
+
+    void TypedEventEncoder::addValue(TypedFieldKey const& key, ::CsProtocol::Value const& value)
+    {
+        beginEntry(key);
+        CompactBinaryProtocolWriter writer(m_partC.bytes);
+        bond_lite::Serialize(writer, value, false);
+        endEntry();
+    }
+
+    // Direct encoding of bond_lite::Serialize(Value) for a type and a longValue
+    void TypedEventEncoder::addLong(TypedFieldKey const& key, ::CsProtocol::ValueKind kind, int64_t value)
+    {
+        beginEntry(key);
+        CompactBinaryProtocolWriter writer(m_partC.bytes);
+        writer.WriteFieldBegin(bond_lite::BT_INT32, 1, nullptr);
+        writer.WriteInt32(static_cast<int32_t>(kind));
+        if (value != 0)
+        {
+            writer.WriteFieldBegin(bond_lite::BT_INT64, 4, nullptr);
+            writer.WriteInt64(value);
+        }
+        writer.WriteStructEnd(false);
+        endEntry();
+    }
+
+    void TypedEventEncoder::AddString(TypedFieldKey const& key, std::string const& value, PiiKind piiKind)
+    {
+        if (piiKind != PiiKind_None)
+        {
+            ::CsProtocol::Value temp;
+            ::CsProtocol::Attributes attrib;
+            if (piiKind == PiiKind::CustomerContentKind_GenericData)
+            {
+                ::CsProtocol::CustomerContent cc;
+                cc.Kind = ::CsProtocol::CustomerContentKind::GenericContent;
+                attrib.customerContent.push_back(cc);
+            }
+            else
+            {
+                ::CsProtocol::PII pii;
+                pii.Kind = static_cast< ::CsProtocol::PIIKind>(piiKind);
+                attrib.pii.push_back(pii);
+            }
+            temp.attributes.push_back(attrib);
+            temp.stringValue = value;
+            addValue(key, temp);
+            return;
+        }
+
+        // ValueString is the default type, so only the string is written
+        beginEntry(key);
+        CompactBinaryProtocolWriter writer(m_partC.bytes);
+        if (!value.empty())
+        {
+            writer.WriteFieldBegin(bond_lite::BT_STRING, 3, nullptr);
+            writer.WriteString(value);
+        }
+        writer.WriteStructEnd(false);
+        endEntry();
+    }
+
+    void TypedEventEncoder::AddInt64(TypedFieldKey const& key, int64_t value)
+    {
+        addLong(key, ::CsProtocol::ValueKind::ValueInt64, value);
+    }
+
+    void TypedEventEncoder::AddDouble(TypedFieldKey const& key, double value)
+    {
+        beginEntry(key);
+        CompactBinaryProtocolWriter writer(m_partC.bytes);
+        writer.WriteFieldBegin(bond_lite::BT_INT32, 1, nullptr);
+        writer.WriteInt32(static_cast<int32_t>(::CsProtocol::ValueKind::ValueDouble));
+        if (value != 0.0)
+        {
+            writer.WriteFieldBegin(bond_lite::BT_DOUBLE, 5, nullptr);
+            writer.WriteDouble(value);
+        }
+        writer.WriteStructEnd(false);
+        endEntry();
+    }
+
+    void TypedEventEncoder::AddBool(TypedFieldKey const& key, bool value)
+    {
+        addLong(key, ::CsProtocol::ValueKind::ValueBool, value ? 1 : 0);
+    }
+
+    void TypedEventEncoder::AddTime(TypedFieldKey const& key, time_ticks_t value)
+    {
+        addLong(key, ::CsProtocol::ValueKind::ValueDateTime, static_cast<int64_t>(value.ticks));
+    }
+
+    void TypedEventEncoder::AddGuid(TypedFieldKey const& key, GUID_t const& value)
+    {
+        uint8_t guidBytes[16] = { 0 };
+        GUID_t guid = value;
+        guid.to_bytes(guidBytes);
+
+        ::CsProtocol::Value temp;
+        temp.type = ::CsProtocol::ValueKind::ValueGuid;
+        temp.guidValue.push_back(std::vector<uint8_t>(guidBytes, guidBytes + sizeof(guidBytes)));
+        addValue(key, temp);
+    }
+
+    bool TypedEventEncoder::Finish()
+    {
+        auto& entries = m_partC.entries;
+        std::stable_sort(entries.begin(), entries.end(), [](EncodedPartC::Entry const& a, EncodedPartC::Entry const& b) {
+            return compareNames(a.name, a.nameSize, b.name, b.nameSize) < 0;
+        });
+
+        // A name set twice keeps its last value, as EventProperties::SetProperty does
+        auto last = std::unique(entries.rbegin(), entries.rend(), [](EncodedPartC::Entry const& a, EncodedPartC::Entry const& b) {
+            return compareNames(a.name, a.nameSize, b.name, b.nameSize) == 0;
+        });
+        entries.erase(entries.begin(), last.base());
+        return m_valid;
+    }
+
+    void SerializeWithPartC(std::vector<uint8_t>& output, ::CsProtocol::Record& record, EncodedPartC const& partC)
+    {
+        // Data is the last field of Record: serialize the others, then replace the final BT_STOP
+        std::vector< ::CsProtocol::Data> data;
+        data.swap(record.data);
+        bond_lite::SerializeFast(output, record);
+        data.swap(record.data);
+        assert(!output.empty() && output.back() == 0);
+        output.pop_back();
+
+        CompactBinaryProtocolWriter writer(output);
+        if (record.data.empty() && partC.entries.empty())
+        {
+            writer.WriteStructEnd(false);
+            return;
+        }
+
+        static const std::map<std::string, ::CsProtocol::Value> noProperties;
+        auto const& properties = record.data.empty() ? noProperties : record.data[0].properties;
+
+        // Properties overridden by a typed field are not written
+        size_t count = partC.entries.size() + properties.size();
+        auto entry = partC.entries.begin();
+        for (auto const& kv : properties)
+        {
+            while (entry != partC.entries.end() && compareNames(entry->name, entry->nameSize, kv.first.data(), kv.first.size()) < 0)
+            {
+                ++entry;
+            }
+            if (entry != partC.entries.end() && compareNames(entry->name, entry->nameSize, kv.first.data(), kv.first.size()) == 0)
+            {
+                count--;
+            }
+        }
+
+        output.reserve(output.size() + partC.bytes.size() + 16);
+        writer.WriteFieldBegin(bond_lite::BT_LIST, 70, nullptr);
+        writer.WriteContainerBegin(std::max<size_t>(record.data.size(), 1), bond_lite::BT_STRUCT);
+
+        if (count > 0)
+        {
+            writer.WriteFieldBegin(bond_lite::BT_MAP, 1, nullptr);
+            writer.WriteMapContainerBegin(count, bond_lite::BT_STRING, bond_lite::BT_STRUCT);
+            entry = partC.entries.begin();
+            auto property = properties.begin();
+            while (entry != partC.entries.end() || property != properties.end())
+            {
+                int order = (entry == partC.entries.end()) ? 1 :
+                    (property == properties.end()) ? -1 :
+                    compareNames(entry->name, entry->nameSize, property->first.data(), property->first.size());
+                if (order <= 0)
+                {
+                    writer.WriteBlob(partC.bytes.data() + entry->offset, entry->size);
+                    ++entry;
+                    if (order == 0)
+                    {
+                        ++property;
+                    }
+                }
+                else
+                {
+                    writer.WriteString(property->first);
+                    bond_lite::Serialize(writer, property->second, false);
+                    ++property;
+                }
+            }
+        }
+        writer.WriteStructEnd(false);
+
+        for (size_t i = 1; i < record.data.size(); i++)
+        {
+            bond_lite::Serialize(writer, record.data[i], false);
+        }
+        writer.WriteStructEnd(false);
+    }
+
+    bool MaterializePartC(::CsProtocol::Record& record, EncodedPartC const& partC)
+    {
+        if (record.data.empty())
+        {
+            record.data.push_back(::CsProtocol::Data());
+        }
+
+        bond_lite::CompactBinaryProtocolReader reader(partC.bytes);
+        while (reader.getSize() < partC.bytes.size())
+        {
+            std::string name;
+            ::CsProtocol::Value value;
+            if (!reader.ReadString(name) || !bond_lite::Deserialize(reader, value, false))
+            {
+                return false;
+            }
+            record.data[0].properties[name] = std::move(value);
+        }
+        return true;
+    }
+
+} MAT_NS_END
@@ -0,0 +1,87 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef TYPEDEVENTENCODER_HPP
+#define TYPEDEVENTENCODER_HPP
+
+#include "ctmacros.hpp"
+#include "TypedEvent.hpp"
+#include "CsProtocol_types.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Part C properties of a typed event, encoded as Bond compact binary map
+    /// entries (key string, Value struct) ready to be spliced into a record.
+    /// </summary>
+    class EncodedPartC
+    {
+    public:
+        struct Entry
+        {
+            const char* name;
+            uint32_t    nameSize;
+            uint32_t    offset;
+            uint32_t    size;
+        };
+
+        /// Entries in the order the fields were added
+        std::vector<uint8_t> bytes;
+
+        /// Entries sorted by name as in a std::map, the last of duplicate names kept
+        std::vector<Entry>   entries;
+    };
+
+    /// <summary>
+    /// Sink encoding the fields of a typed event into EncodedPartC. Each value is
+    /// written as EventPropertiesDecorator would convert it, so that the map spliced
+    /// by SerializeWithPartC is byte for byte the one of the dynamic path.
+    /// </summary>
+    class TypedEventEncoder : public ITypedEventSink
+    {
+    public:
+        explicit TypedEventEncoder(EncodedPartC& partC);
+
+        virtual void AddString(TypedFieldKey const& key, std::string const& value, PiiKind piiKind) override;
+        virtual void AddInt64(TypedFieldKey const& key, int64_t value) override;
+        virtual void AddDouble(TypedFieldKey const& key, double value) override;
+        virtual void AddBool(TypedFieldKey const& key, bool value) override;
+        virtual void AddTime(TypedFieldKey const& key, time_ticks_t value) override;
+        virtual void AddGuid(TypedFieldKey const& key, GUID_t const& value) override;
+
+        /// <summary>
+        /// Sorts the entries once all fields are added.
+        /// </summary>
+        /// <returns>false if a field name is not a valid property name.</returns>
+        bool Finish();
+
+    protected:
+        void beginEntry(TypedFieldKey const& key);
+        void endEntry();
+        void addValue(TypedFieldKey const& key, ::CsProtocol::Value const& value);
+        void addLong(TypedFieldKey const& key, ::CsProtocol::ValueKind kind, int64_t value);
+
+        EncodedPartC& m_partC;
+        bool          m_valid;
+    };
+
+    /// <summary>
+    /// Serializes the record with the entries of partC merged into the properties of
+    /// its first Data. Typed fields override properties of the same name, as event
+    /// properties override context fields on the dynamic path.
+    /// </summary>
+    void SerializeWithPartC(std::vector<uint8_t>& output, ::CsProtocol::Record& record, EncodedPartC const& partC);
+
+    /// <summary>
+    /// Decodes the entries of partC into the properties of the record, for the
+    /// stages that need to see them: custom decorators and data inspectors.
+    /// </summary>
+    bool MaterializePartC(::CsProtocol::Record& record, EncodedPartC const& partC);
+
+} MAT_NS_END
+
+#endif
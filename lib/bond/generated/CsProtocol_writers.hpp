@@ -1524,9 +1524,7 @@ void Serialize(TWriter& writer, ::CsProtocol::Value const& value, bool isBase)
         writer.WriteContainerBegin(value.guidValue.size(), BT_LIST);
         for (auto const& item2 : value.guidValue) {
             writer.WriteContainerBegin(item2.size(), BT_UINT8);
-            for (auto const& item3 : item2) {
-                writer.WriteUInt8(item3);
-            }
+            writer.WriteUInt8Array(item2.data(), item2.size());
             writer.WriteContainerEnd();
         }
         writer.WriteContainerEnd();
@@ -1556,9 +1554,7 @@ void Serialize(TWriter& writer, ::CsProtocol::Value const& value, bool isBase)
         writer.WriteContainerBegin(value.longArray.size(), BT_LIST);
         for (auto const& item2 : value.longArray) {
             writer.WriteContainerBegin(item2.size(), BT_INT64);
-            for (auto const& item3 : item2) {
-                writer.WriteInt64(item3);
-            }
+            writer.WriteInt64Array(item2.data(), item2.size());
             writer.WriteContainerEnd();
         }
         writer.WriteContainerEnd();
@@ -1572,9 +1568,7 @@ void Serialize(TWriter& writer, ::CsProtocol::Value const& value, bool isBase)
         writer.WriteContainerBegin(value.doubleArray.size(), BT_LIST);
         for (auto const& item2 : value.doubleArray) {
             writer.WriteContainerBegin(item2.size(), BT_DOUBLE);
-            for (auto const& item3 : item2) {
-                writer.WriteDouble(item3);
-            }
+            writer.WriteDoubleArray(item2.data(), item2.size());
             writer.WriteContainerEnd();
         }
         writer.WriteContainerEnd();
@@ -1590,9 +1584,7 @@ void Serialize(TWriter& writer, ::CsProtocol::Value const& value, bool isBase)
             writer.WriteContainerBegin(item2.size(), BT_LIST);
             for (auto const& item3 : item2) {
                 writer.WriteContainerBegin(item3.size(), BT_UINT8);
-                for (auto const& item4 : item3) {
-                    writer.WriteUInt8(item4);
-                }
+                writer.WriteUInt8Array(item3.data(), item3.size());
                 writer.WriteContainerEnd();
             }
             writer.WriteContainerEnd();
@@ -0,0 +1,124 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "TokenBucketBandwidthController.hpp"
+#include "pal/PAL.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace MAT_NS_BEGIN {
+
+    // Weight of the latest sample in the smoothed throughput
+    static const double ThroughputSmoothing = 0.2;
+
+    TokenBucketBandwidthController::TokenBucketBandwidthController(IRuntimeConfig& config) :
+        m_measuredBps(0.0)
+    {
+        m_bytesPerSecond = config[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_BYTES_PER_SEC];
+        m_burstBytes = config[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_BURST_BYTES];
+        m_linkSharePct = std::min<unsigned>(100, config[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_LINK_SHARE_PCT]);
+        bucket(EventLatency_Normal).sharePct = config[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_NORMAL_PCT];
+        bucket(EventLatency_CostDeferred).sharePct = config[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_COST_DEFERRED_PCT];
+        bucket(EventLatency_RealTime).sharePct = config[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_REALTIME_PCT];
+        bucket(EventLatency_Max).sharePct = config[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_MAX_PCT];
+    }
+
+    bool TokenBucketBandwidthController::IsEnabled(IRuntimeConfig& config)
+    {
+        unsigned bytesPerSecond = config[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_BYTES_PER_SEC];
+        unsigned linkSharePct = config[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_LINK_SHARE_PCT];
+        return (bytesPerSecond > 0) || (linkSharePct > 0);
+    }
+
+    uint64_t TokenBucketBandwidthController::now() const
+    {
+        return PAL::getMonotonicTimeMs();
+    }
+
+    TokenBucketBandwidthController::Bucket& TokenBucketBandwidthController::bucket(EventLatency latency)
+    {
+        // Unspecified and Off are not uploaded on their own, account them as Normal
+        int index = std::max<int>(EventLatency_Normal, std::min<int>(EventLatency_Max, latency));
+        return m_buckets[index - EventLatency_Normal];
+    }
+
+    double TokenBucketBandwidthController::budgetBps() const
+    {
+        double budget = (m_bytesPerSecond > 0) ? m_bytesPerSecond : std::numeric_limits<double>::infinity();
+        if (m_linkSharePct > 0 && m_measuredBps > 0.0)
+        {
+            budget = std::min(budget, m_measuredBps * m_linkSharePct / 100.0);
+        }
+        return std::isinf(budget) ? 0.0 : budget;
+    }
+
+    // Returns the refill rate of the bucket in bytes per second, 0 if the class is not paced
+    double TokenBucketBandwidthController::refill(Bucket& bucket, uint64_t nowMs)
+    {
+        double rate = budgetBps() * bucket.sharePct / 100.0;
+        if (rate <= 0.0)
+        {
+            return 0.0;
+        }
+
+        double burst = (m_burstBytes > 0) ? (static_cast<double>(m_burstBytes) * bucket.sharePct / 100.0) : rate;
+        if (!bucket.initialized)
+        {
+            bucket.tokens = burst;
+            bucket.initialized = true;
+        }
+        else if (nowMs > bucket.lastRefillMs)
+        {
+            bucket.tokens = std::min(burst, bucket.tokens + rate * static_cast<double>(nowMs - bucket.lastRefillMs) / 1000.0);
+        }
+        bucket.lastRefillMs = nowMs;
+        return rate;
+    }
+
+    unsigned TokenBucketBandwidthController::GetProposedBandwidthBps()
+    {
+        LOCKGUARD(m_lock);
+        double budget = budgetBps();
+        return (budget > 0.0) ? static_cast<unsigned>(std::min<double>(budget, std::numeric_limits<unsigned>::max())) : std::numeric_limits<unsigned>::max();
+    }
+
+    unsigned TokenBucketBandwidthController::GetUploadDelayMs(EventLatency latency)
+    {
+        LOCKGUARD(m_lock);
+        Bucket& b = bucket(latency);
+        double rate = refill(b, now());
+        if (rate <= 0.0 || b.tokens >= 0.0)
+        {
+            return 0;
+        }
+        // Wait until the debt left by previous uploads has been paid off
+        double delayMs = std::ceil(-b.tokens * 1000.0 / rate);
+        return static_cast<unsigned>(std::min<double>(delayMs, std::numeric_limits<unsigned>::max()));
+    }
+
+    void TokenBucketBandwidthController::OnUploadCompleted(EventLatency latency, size_t bytes, int durationMs)
+    {
+        LOCKGUARD(m_lock);
+        if (durationMs > 0 && bytes > 0)
+        {
+            double sample = static_cast<double>(bytes) * 1000.0 / durationMs;
+            m_measuredBps = (m_measuredBps > 0.0) ? (m_measuredBps + ThroughputSmoothing * (sample - m_measuredBps)) : sample;
+        }
+
+        Bucket& b = bucket(latency);
+        if (refill(b, now()) > 0.0)
+        {
+            b.tokens -= static_cast<double>(bytes);
+        }
+    }
+
+    double TokenBucketBandwidthController::GetMeasuredThroughputBps()
+    {
+        LOCKGUARD(m_lock);
+        return m_measuredBps;
+    }
+
+} MAT_NS_END
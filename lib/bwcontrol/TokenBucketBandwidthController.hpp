@@ -0,0 +1,72 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef TOKENBUCKETBANDWIDTHCONTROLLER_HPP
+#define TOKENBUCKETBANDWIDTHCONTROLLER_HPP
+
+#include "IBandwidthController.hpp"
+#include "api/IRuntimeConfig.hpp"
+
+#include <cstdint>
+#include <mutex>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Portable bandwidth controller that paces uploads with one token bucket
+    /// per latency class. Each class refills at its configured share of the
+    /// upload budget; a completed upload is charged against its bucket and the
+    /// next upload of that class waits until the bucket is out of debt.
+    ///
+    /// The budget is the configured bytesPerSecond and, if linkSharePercent is
+    /// set, at most that share of the throughput measured from completed
+    /// requests (body size / round trip), so telemetry backs off when the link
+    /// gets slower.
+    /// </summary>
+    class TokenBucketBandwidthController : public IBandwidthController
+    {
+    public:
+        TokenBucketBandwidthController(IRuntimeConfig& config);
+        virtual ~TokenBucketBandwidthController() {}
+
+        /// <summary>
+        /// true if the configuration asks for upload pacing.
+        /// </summary>
+        static bool IsEnabled(IRuntimeConfig& config);
+
+        virtual unsigned GetProposedBandwidthBps() override;
+        virtual unsigned GetUploadDelayMs(EventLatency latency) override;
+        virtual void OnUploadCompleted(EventLatency latency, size_t bytes, int durationMs) override;
+
+        /// <summary>
+        /// Smoothed upload throughput of completed requests in bytes per second, 0 if unknown.
+        /// </summary>
+        double GetMeasuredThroughputBps();
+
+    protected:
+        struct Bucket
+        {
+            unsigned sharePct = 0;
+            double   tokens = 0.0;
+            uint64_t lastRefillMs = 0;
+            bool     initialized = false;
+        };
+
+        virtual uint64_t now() const;
+
+        Bucket& bucket(EventLatency latency);
+        double budgetBps() const;
+        double refill(Bucket& bucket, uint64_t nowMs);
+
+        std::mutex m_lock;
+        unsigned   m_bytesPerSecond;
+        unsigned   m_burstBytes;
+        unsigned   m_linkSharePct;
+        double     m_measuredBps;
+        Bucket     m_buckets[EventLatency_Max];
+    };
+
+} MAT_NS_END
+
+#endif
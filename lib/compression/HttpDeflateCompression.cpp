@@ -86,6 +86,7 @@ namespace MAT_NS_BEGIN {
         }
 
         ctx->body.resize(stream.total_out);
+        ctx->bodyMemory.Resize(ctx->body.size());
         ctx->compressed = true;
 #endif
         return true;
@@ -27,6 +27,7 @@ namespace MAT_NS_BEGIN {
     public:
         RouteSource<EventsUploadContextPtr const&>                              compressionFailed;
         RoutePassThrough<HttpDeflateCompression, EventsUploadContextPtr const&> compress{ this, &HttpDeflateCompression::handleCompress };
+        StaticRouteHandler<decltype(&HttpDeflateCompression::handleCompress), &HttpDeflateCompression::handleCompress> compressStatic{ this };
     };
 
 } MAT_NS_END
@@ -16,11 +16,18 @@ namespace MAT_NS_BEGIN
         {CFG_BOOL_ENABLE_ANALYTICS, false},
         {CFG_INT_CACHE_FILE_SIZE, 3145728},
         {CFG_INT_RAM_QUEUE_SIZE, 524288},
+        {CFG_INT_RAM_QUEUE_SHARDS, 1},
+        {CFG_INT_MEMORY_BUDGET, 0},
+        {CFG_INT_BACKPRESSURE_HIGH_PCT, 200},
+        {CFG_INT_BACKPRESSURE_LOW_PCT, 100},
         {CFG_BOOL_ENABLE_MULTITENANT, true},
         {CFG_BOOL_ENABLE_DB_DROP_IF_FULL, false},
         {CFG_INT_MAX_TEARDOWN_TIME, 1},
         {CFG_INT_MAX_PENDING_REQ, 4},
+        {CFG_INT_UPLOAD_PIPELINE_DEPTH, 0},
+        {CFG_BOOL_SHARED_RUNTIME, false},
         {CFG_INT_RAM_QUEUE_BUFFERS, 3},
+        {CFG_BOOL_ASYNC_STORAGE_OPEN, false},
         {CFG_INT_TRACE_LEVEL_MASK, 0},
         {CFG_BOOL_ENABLE_TRACE, true},
         {CFG_STR_COLLECTOR_URL, COLLECTOR_URL_PROD},
@@ -32,6 +39,10 @@ namespace MAT_NS_BEGIN
         {CFG_MAP_METASTATS_CONFIG,
          {/* Parameter that allows to split stats events by tenant */
           {"split", false},
+          /* Parameter that adds pipeline stage latency percentiles to stats events */
+          {"pipeline", false},
+          /* Parameter that adds context pool hit rates to stats events */
+          {"pools", false},
           {"interval", 1800},
           {"tokenProd", STATS_TOKEN_PROD},
           {"tokenInt", STATS_TOKEN_INT}}},
@@ -64,6 +75,23 @@ namespace MAT_NS_BEGIN
              {CFG_INT_TPM_MAX_RETRY, 5},
              {CFG_BOOL_TPM_CLOCK_SKEW_ENABLED, true},
              {CFG_STR_TPM_BACKOFF, "E,3000,300000,2,1"},
+             {CFG_INT_TPM_MAX_LATENCY_WINDOW_MS, 0},
+             {CFG_INT_TPM_MAX_LATENCY_BATCH, 0},
+             {CFG_INT_TPM_UPLOAD_ALIGN_WINDOW_MS, 1000},
+             {CFG_BOOL_TPM_ADAPTIVE_UPLOADS, false},
+             {CFG_INT_TPM_ADAPTIVE_MIN_UPLOAD_BYTES, 32768},
+             {CFG_INT_TPM_ADAPTIVE_TARGET_REQUEST_MS, 2000},
+         }},
+        {CFG_MAP_BANDWIDTH,
+         {
+             /* Pacing is enabled by a fixed budget and/or a share of the measured throughput */
+             {CFG_INT_BANDWIDTH_BYTES_PER_SEC, 0},
+             {CFG_INT_BANDWIDTH_BURST_BYTES, 0},
+             {CFG_INT_BANDWIDTH_LINK_SHARE_PCT, 0},
+             {CFG_INT_BANDWIDTH_NORMAL_PCT, 30},
+             {CFG_INT_BANDWIDTH_COST_DEFERRED_PCT, 10},
+             {CFG_INT_BANDWIDTH_REALTIME_PCT, 30},
+             {CFG_INT_BANDWIDTH_MAX_PCT, 30},
          }},
         {CFG_MAP_COMPAT,
          {
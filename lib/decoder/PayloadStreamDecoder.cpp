@@ -0,0 +1,475 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+
+#include "PayloadStreamDecoder.hpp"
+
+#include "bond/All.hpp"
+#include "bond/CompactBinaryProtocolLazyReader.hpp"
+#include "CsProtocol_types.hpp"
+#include "bond/generated/CsProtocol_readers.hpp"
+
+#include <cstring>
+
+#ifdef HAVE_MAT_ZLIB
+#define ZLIB_CONST
+#include "zlib.h"
+#undef compress
+#endif
+
+using bond_lite::CompactBinaryProtocolLazyReader;
+
+namespace MAT_NS_BEGIN {
+
+    namespace exporters {
+
+        namespace {
+
+            bool readStringField(CompactBinaryProtocolLazyReader& reader, uint8_t type, StringRef& value)
+            {
+                if (type != bond_lite::BT_STRING)
+                {
+                    return reader.Skip(type);
+                }
+                return reader.ReadStringRef(value.data, value.size);
+            }
+
+            bool readInt64Field(CompactBinaryProtocolLazyReader& reader, uint8_t type, int64_t& value)
+            {
+                if (type != bond_lite::BT_INT64)
+                {
+                    return reader.Skip(type);
+                }
+                return reader.ReadInt64(value);
+            }
+
+            bool readDoubleField(CompactBinaryProtocolLazyReader& reader, uint8_t type, double& value)
+            {
+                if (type != bond_lite::BT_DOUBLE)
+                {
+                    return reader.Skip(type);
+                }
+                return reader.ReadDouble(value);
+            }
+
+            /// Reads the fields of a struct, calling handler(type, id) for each of them
+            template<typename THandler>
+            bool readStruct(CompactBinaryProtocolLazyReader& reader, THandler handler)
+            {
+                for (;;)
+                {
+                    uint8_t type;
+                    uint16_t id;
+                    if (!reader.ReadFieldBegin(type, id))
+                    {
+                        return false;
+                    }
+                    if (type == bond_lite::BT_STOP)
+                    {
+                        return true;
+                    }
+                    if (type == bond_lite::BT_STOP_BASE)
+                    {
+                        continue;
+                    }
+                    if (!handler(type, id))
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            /// Reads a list of structs, passing the first element to handler() and skipping the rest
+            template<typename THandler>
+            bool readFirstStruct(CompactBinaryProtocolLazyReader& reader, uint8_t type, THandler handler)
+            {
+                uint32_t count;
+                uint8_t elementType;
+                if (type != bond_lite::BT_LIST)
+                {
+                    return reader.Skip(type);
+                }
+                if (!reader.ReadContainerBegin(count, elementType))
+                {
+                    return false;
+                }
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    bool result = (i == 0 && elementType == bond_lite::BT_STRUCT) ? handler() : reader.Skip(elementType);
+                    if (!result)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            bool readPii(CompactBinaryProtocolLazyReader& reader, PropertyView& value)
+            {
+                return readStruct(reader, [&](uint8_t type, uint16_t id) {
+                    if (id == 1 && type == bond_lite::BT_INT32)
+                    {
+                        return reader.ReadInt32(value.piiKind);
+                    }
+                    return reader.Skip(type);
+                });
+            }
+
+            bool readAttributes(CompactBinaryProtocolLazyReader& reader, PropertyView& value)
+            {
+                return readStruct(reader, [&](uint8_t type, uint16_t id) {
+                    if (id == 1)
+                    {
+                        return readFirstStruct(reader, type, [&]() { return readPii(reader, value); });
+                    }
+                    return reader.Skip(type);
+                });
+            }
+
+            bool readValue(CompactBinaryProtocolLazyReader& reader, PropertyView& value)
+            {
+                value = PropertyView();
+                return readStruct(reader, [&](uint8_t type, uint16_t id) {
+                    switch (id)
+                    {
+                    case 1:
+                        if (type == bond_lite::BT_INT32)
+                        {
+                            return reader.ReadInt32(value.type);
+                        }
+                        break;
+                    case 2:
+                        return readFirstStruct(reader, type, [&]() { return readAttributes(reader, value); });
+                    case 3:
+                        return readStringField(reader, type, value.stringValue);
+                    case 4:
+                        return readInt64Field(reader, type, value.longValue);
+                    case 5:
+                        return readDoubleField(reader, type, value.doubleValue);
+                    case 6:
+                        if (type == bond_lite::BT_LIST)
+                        {
+                            uint32_t count;
+                            uint8_t elementType;
+                            if (!reader.ReadContainerBegin(count, elementType))
+                            {
+                                return false;
+                            }
+                            for (uint32_t i = 0; i < count; i++)
+                            {
+                                if (i == 0 && elementType == bond_lite::BT_LIST)
+                                {
+                                    uint8_t const* guid;
+                                    if (!reader.ReadBlobRef(guid, value.guidValue.size))
+                                    {
+                                        return false;
+                                    }
+                                    value.guidValue.data = reinterpret_cast<const char*>(guid);
+                                }
+                                else if (!reader.Skip(elementType))
+                                {
+                                    return false;
+                                }
+                            }
+                            return true;
+                        }
+                        break;
+                    default:
+                        break;
+                    }
+                    return reader.Skip(type);
+                });
+            }
+
+        }
+
+        bool StringRef::operator==(const char* other) const
+        {
+            size_t length = (other != nullptr) ? strlen(other) : 0;
+            return (length == size) && (size == 0 || memcmp(data, other, size) == 0);
+        }
+
+        RecordView::RecordView()
+        {
+            clear();
+        }
+
+        void RecordView::clear()
+        {
+            m_data = nullptr;
+            m_size = 0;
+            m_truncated = false;
+            m_ver = StringRef();
+            m_name = StringRef();
+            m_time = 0;
+            m_popSample = 100;
+            m_iKey = StringRef();
+            m_flags = 0;
+            m_cV = StringRef();
+            m_baseType = StringRef();
+            m_dataOffset = 0;
+        }
+
+        bool RecordView::parse(const uint8_t* data, size_t size)
+        {
+            clear();
+            CompactBinaryProtocolLazyReader reader(data, size);
+            bool result = readStruct(reader, [&](uint8_t type, uint16_t id) {
+                switch (id)
+                {
+                case 1:
+                    return readStringField(reader, type, m_ver);
+                case 2:
+                    return readStringField(reader, type, m_name);
+                case 3:
+                    return readInt64Field(reader, type, m_time);
+                case 4:
+                    return readDoubleField(reader, type, m_popSample);
+                case 5:
+                    return readStringField(reader, type, m_iKey);
+                case 6:
+                    return readInt64Field(reader, type, m_flags);
+                case 7:
+                    return readStringField(reader, type, m_cV);
+                case 60:
+                    return readStringField(reader, type, m_baseType);
+                case 70:
+                    return readFirstStruct(reader, type, [&]() {
+                        m_dataOffset = reader.getSize();
+                        return reader.SkipStruct();
+                    });
+                default:
+                    return reader.Skip(type);
+                }
+            });
+            if (!result)
+            {
+                m_truncated = reader.isTruncated();
+                m_dataOffset = 0;
+                return false;
+            }
+            m_data = data;
+            m_size = reader.getSize();
+            return true;
+        }
+
+        bool RecordView::forEachProperty(const std::function<bool(const StringRef&, const PropertyView&)>& callback) const
+        {
+            if (m_dataOffset == 0)
+            {
+                return true;
+            }
+            CompactBinaryProtocolLazyReader reader(m_data, m_size);
+            reader.Seek(m_dataOffset);
+            bool stopped = false;
+            bool result = readStruct(reader, [&](uint8_t type, uint16_t id) {
+                if (id != 1 || type != bond_lite::BT_MAP || stopped)
+                {
+                    return reader.Skip(type);
+                }
+                uint32_t count;
+                uint8_t keyType, valueType;
+                if (!reader.ReadMapContainerBegin(count, keyType, valueType) ||
+                    keyType != bond_lite::BT_STRING || valueType != bond_lite::BT_STRUCT)
+                {
+                    return false;
+                }
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    StringRef key;
+                    PropertyView value;
+                    if (!reader.ReadStringRef(key.data, key.size) || !readValue(reader, value))
+                    {
+                        return false;
+                    }
+                    if (!callback(key, value))
+                    {
+                        // Nothing else to look at in this record
+                        stopped = true;
+                        return true;
+                    }
+                }
+                return true;
+            });
+            return result || stopped;
+        }
+
+        bool RecordView::getProperty(const char* name, PropertyView& value) const
+        {
+            bool found = false;
+            forEachProperty([&](const StringRef& key, const PropertyView& property) {
+                if (key == name)
+                {
+                    value = property;
+                    found = true;
+                    return false;
+                }
+                return true;
+            });
+            return found;
+        }
+
+        bool RecordView::toRecord(CsProtocol::Record& record) const
+        {
+            if (m_data == nullptr)
+            {
+                return false;
+            }
+            std::vector<uint8_t> input(m_data, m_data + m_size);
+            bond_lite::CompactBinaryProtocolReader reader(input);
+            return bond_lite::Deserialize(reader, record, false);
+        }
+
+        // Same inflate output chunk as ZlibUtils::InflateVector
+        static const size_t InflateChunkSize = 131072;
+
+        PayloadStreamDecoder::PayloadStreamDecoder(RecordCallback callback, bool compressed, bool isGzip) :
+            m_callback(callback),
+            m_compressed(compressed),
+            m_stream(nullptr),
+            m_streamEnd(false),
+            m_failed(false),
+            m_offset(0),
+            m_records(0)
+        {
+            if (!m_compressed)
+            {
+                return;
+            }
+#ifdef HAVE_MAT_ZLIB
+            z_stream* zs = new z_stream();
+            memset(zs, 0, sizeof(*zs));
+            // "deflate": raw deflate as produced by HttpDeflateCompression, "gzip": add 16 to windowBits
+            if (inflateInit2(zs, isGzip ? (MAX_WBITS | 16) : -MAX_WBITS) != Z_OK)
+            {
+                delete zs;
+                m_failed = true;
+                return;
+            }
+            m_stream = zs;
+#else
+            UNREFERENCED_PARAMETER(isGzip);
+            m_failed = true;
+#endif
+        }
+
+        PayloadStreamDecoder::~PayloadStreamDecoder()
+        {
+#ifdef HAVE_MAT_ZLIB
+            if (m_stream != nullptr)
+            {
+                z_stream* zs = static_cast<z_stream*>(m_stream);
+                inflateEnd(zs);
+                delete zs;
+            }
+#endif
+        }
+
+        bool PayloadStreamDecoder::write(const uint8_t* data, size_t size)
+        {
+            if (m_failed)
+            {
+                return false;
+            }
+
+            if (!m_compressed)
+            {
+                m_buffer.insert(m_buffer.end(), data, data + size);
+                return drain();
+            }
+
+#ifdef HAVE_MAT_ZLIB
+            z_stream* zs = static_cast<z_stream*>(m_stream);
+            zs->next_in = data;
+            zs->avail_in = static_cast<uInt>(size);
+            while (!m_streamEnd)
+            {
+                size_t used = m_buffer.size();
+                m_buffer.resize(used + InflateChunkSize);
+                zs->next_out = m_buffer.data() + used;
+                zs->avail_out = static_cast<uInt>(InflateChunkSize);
+                int ret = inflate(zs, Z_NO_FLUSH);
+                m_buffer.resize(used + InflateChunkSize - zs->avail_out);
+                if (ret == Z_STREAM_END)
+                {
+                    m_streamEnd = true;
+                }
+                else if (ret != Z_OK && ret != Z_BUF_ERROR)
+                {
+                    m_failed = true;
+                    return false;
+                }
+                // Hand complete records out as soon as they are inflated, so that
+                // only the current chunk and a partial record are kept in memory
+                if (!drain())
+                {
+                    return false;
+                }
+                if (zs->avail_in == 0 && zs->avail_out != 0)
+                {
+                    break;
+                }
+            }
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        bool PayloadStreamDecoder::drain()
+        {
+            while (m_offset < m_buffer.size())
+            {
+                RecordView view;
+                if (!view.parse(m_buffer.data() + m_offset, m_buffer.size() - m_offset))
+                {
+                    if (view.isTruncated())
+                    {
+                        break;
+                    }
+                    m_failed = true;
+                    return false;
+                }
+                m_offset += view.size();
+                m_records++;
+                if (!m_callback(view))
+                {
+                    m_failed = true;
+                    return false;
+                }
+            }
+            if (m_offset != 0)
+            {
+                m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_offset);
+                m_offset = 0;
+            }
+            return true;
+        }
+
+        bool PayloadStreamDecoder::finish()
+        {
+            if (m_failed)
+            {
+                return false;
+            }
+            if (m_compressed && !m_streamEnd)
+            {
+                return false;
+            }
+            return m_buffer.empty();
+        }
+
+        /// <summary>
+        /// Decodes the whole request in one go, see PayloadStreamDecoder.
+        /// </summary>
+        bool ForEachRecord(const std::vector<uint8_t>& in, const PayloadStreamDecoder::RecordCallback& callback, bool compressed)
+        {
+            PayloadStreamDecoder decoder(callback, compressed);
+            return decoder.write(in.data(), in.size()) && decoder.finish();
+        }
+
+    }
+
+} MAT_NS_END
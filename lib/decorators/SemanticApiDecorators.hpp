@@ -60,6 +60,10 @@ namespace MAT_NS_BEGIN {
                 setInt64Value(RECORD_EXT, "AggregatedMetric.Buckets." + toString(bucket.first), bucket.second);
             }
 
+            for (auto const& percentile : metricData.percentiles) {
+                setDoubleValue(RECORD_EXT, "AggregatedMetric.Percentiles.P" + toString(percentile.first), percentile.second);
+            }
+
             return true;
         }
 
@@ -0,0 +1,253 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "EventSampler.hpp"
+#include "ILogConfiguration.hpp"
+#include "pal/PAL.hpp"
+#include "utils/Utils.hpp"
+
+#include <algorithm>
+
+namespace MAT_NS_BEGIN
+{
+
+    // Resolution of the sample percentage
+    static const uint64_t SampleBuckets = 10000;
+
+    static double toDouble(VariantMap const& config, const char* key, double defaultValue)
+    {
+        auto it = config.find(key);
+        if (it == config.end())
+        {
+            return defaultValue;
+        }
+        Variant& value = const_cast<Variant&>(it->second);
+        switch (value.type)
+        {
+        case Variant::TYPE_INT:
+            return static_cast<double>(static_cast<int64_t>(value));
+        case Variant::TYPE_DOUBLE:
+            return static_cast<double>(value);
+        default:
+            return defaultValue;
+        }
+    }
+
+    static VariantMap const* toMap(VariantMap const& config, const char* key)
+    {
+        auto it = config.find(key);
+        if (it == config.end() || it->second.type != Variant::TYPE_OBJ)
+        {
+            return nullptr;
+        }
+        return &static_cast<VariantMap&>(it->second);
+    }
+
+    EventSampler::EventSampler() :
+        m_active(false),
+        m_random(PAL::getMonotonicTimeMs()),
+        m_sampledOut(0),
+        m_rateLimited(0)
+    {
+    }
+
+    uint64_t EventSampler::now() const
+    {
+        return PAL::getMonotonicTimeMs();
+    }
+
+    EventSampler::Rule EventSampler::parseRule(VariantMap const& config, Rule const& defaults)
+    {
+        Rule rule;
+        rule.samplePercent = std::max(0.0, std::min(100.0, toDouble(config, CFG_INT_SAMPLING_PERCENT, defaults.samplePercent)));
+        rule.eventsPerSecond = std::max(0.0, toDouble(config, CFG_INT_SAMPLING_EVENTS_PER_SEC, defaults.eventsPerSecond));
+        rule.burst = std::max(0.0, toDouble(config, CFG_INT_SAMPLING_BURST, defaults.burst));
+        return rule;
+    }
+
+    void EventSampler::Configure(VariantMap const& config)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_key.clear();
+        auto key = config.find(CFG_STR_SAMPLING_KEY);
+        if (key != config.end() && (key->second.type == Variant::TYPE_STRING || key->second.type == Variant::TYPE_STRING2))
+        {
+            m_key = static_cast<const char*>(const_cast<Variant&>(key->second));
+        }
+
+        m_defaultRule = parseRule(config, Rule());
+        bool active = (m_defaultRule.samplePercent < 100.0) || (m_defaultRule.eventsPerSecond > 0.0);
+
+        // Per event and per tenant rules inherit the unset values of the default rule
+        m_eventRules.clear();
+        m_tenantRules.clear();
+        VariantMap const* events = toMap(config, CFG_MAP_SAMPLING_EVENTS);
+        if (events != nullptr)
+        {
+            for (auto const& kv : *events)
+            {
+                if (kv.second.type == Variant::TYPE_OBJ)
+                {
+                    m_eventRules[kv.first] = parseRule(static_cast<VariantMap&>(kv.second), m_defaultRule);
+                    active = true;
+                }
+            }
+        }
+        VariantMap const* tenants = toMap(config, CFG_MAP_SAMPLING_TENANTS);
+        if (tenants != nullptr)
+        {
+            for (auto const& kv : *tenants)
+            {
+                if (kv.second.type == Variant::TYPE_OBJ)
+                {
+                    Rule rule;
+                    rule.eventsPerSecond = std::max(0.0, toDouble(static_cast<VariantMap&>(kv.second), CFG_INT_SAMPLING_EVENTS_PER_SEC, 0.0));
+                    rule.burst = std::max(0.0, toDouble(static_cast<VariantMap&>(kv.second), CFG_INT_SAMPLING_BURST, 0.0));
+                    if (rule.eventsPerSecond > 0.0)
+                    {
+                        m_tenantRules[kv.first] = rule;
+                        active = true;
+                    }
+                }
+            }
+        }
+
+        m_eventBuckets.clear();
+        m_tenantBuckets.clear();
+        m_active = active;
+    }
+
+    uint64_t EventSampler::hash(std::string const& value)
+    {
+        // FNV-1a, stable across platforms and processes, then mixed for uniform low bits
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : value)
+        {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    uint64_t EventSampler::random()
+    {
+        // splitmix64 over a shared counter
+        uint64_t z = m_random.fetch_add(0x9e3779b97f4a7c15ULL, std::memory_order_relaxed);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    bool EventSampler::refill(std::map<std::string, Bucket>& buckets, std::string const& name, Rule const& rule, uint64_t nowMs, Bucket*& bucket)
+    {
+        double capacity = (rule.burst > 0.0) ? rule.burst : std::max(1.0, rule.eventsPerSecond);
+        auto it = buckets.find(name);
+        if (it == buckets.end())
+        {
+            if (buckets.size() >= MaxBuckets)
+            {
+                // Evicting a busy bucket would hand its events a full burst again
+                auto stale = std::find_if(buckets.begin(), buckets.end(),
+                    [nowMs](std::pair<const std::string, Bucket> const& kv) { return kv.second.isFull(nowMs); });
+                if (stale == buckets.end())
+                {
+                    bucket = nullptr;
+                    return true;
+                }
+                buckets.erase(stale);
+            }
+            it = buckets.emplace(name, Bucket()).first;
+            it->second.tokens = capacity;
+            it->second.lastRefillMs = nowMs;
+        }
+        else if (nowMs > it->second.lastRefillMs)
+        {
+            it->second.tokens = std::min(capacity, it->second.tokens + (nowMs - it->second.lastRefillMs) * rule.eventsPerSecond / 1000.0);
+            it->second.lastRefillMs = nowMs;
+        }
+        it->second.capacity = capacity;
+        it->second.eventsPerSecond = rule.eventsPerSecond;
+        bucket = &it->second;
+        return it->second.tokens >= 1.0;
+    }
+
+    EventSampler::Decision EventSampler::Admit(EventProperties const& properties, std::string const& tenantToken, ContextFieldsProvider& context, double& popSampleScale)
+    {
+        popSampleScale = 1.0;
+        if (!IsActive())
+        {
+            return Accepted;
+        }
+
+        std::string const& name = properties.GetName();
+        std::lock_guard<std::mutex> lock(m_lock);
+        auto eventRule = m_eventRules.find(name);
+        Rule const& rule = (eventRule != m_eventRules.end()) ? eventRule->second : m_defaultRule;
+
+        if (rule.samplePercent < 100.0)
+        {
+            uint64_t sample;
+            EventProperty keyValue;
+            auto const& props = properties.GetProperties();
+            auto prop = m_key.empty() ? props.end() : props.find(m_key);
+            if (prop != props.end())
+            {
+                sample = hash(prop->second.to_string());
+            }
+            else if (!m_key.empty() && context.GetField(m_key, keyValue))
+            {
+                sample = hash(keyValue.to_string());
+            }
+            else
+            {
+                sample = random();
+            }
+
+            if (static_cast<double>(sample % SampleBuckets) >= rule.samplePercent * (SampleBuckets / 100))
+            {
+                m_sampledOut++;
+                return SampledOut;
+            }
+            popSampleScale = rule.samplePercent / 100.0;
+        }
+
+        // Both buckets must have a token before either is charged
+        uint64_t nowMs = now();
+        Bucket* eventBucket = nullptr;
+        Bucket* tenantBucket = nullptr;
+        if (rule.eventsPerSecond > 0.0 && !refill(m_eventBuckets, name, rule, nowMs, eventBucket))
+        {
+            m_rateLimited++;
+            return RateLimited;
+        }
+
+        if (!m_tenantRules.empty())
+        {
+            auto tenantRule = m_tenantRules.find(tenantToken);
+            if (tenantRule == m_tenantRules.end())
+            {
+                tenantRule = m_tenantRules.find(tenantTokenToId(tenantToken));
+            }
+            if (tenantRule != m_tenantRules.end() && !refill(m_tenantBuckets, tenantRule->first, tenantRule->second, nowMs, tenantBucket))
+            {
+                m_rateLimited++;
+                return RateLimited;
+            }
+        }
+
+        if (eventBucket != nullptr)
+        {
+            eventBucket->tokens -= 1.0;
+        }
+        if (tenantBucket != nullptr)
+        {
+            tenantBucket->tokens -= 1.0;
+        }
+        return Accepted;
+    }
+
+} MAT_NS_END
@@ -0,0 +1,124 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef EVENTSAMPLER_HPP
+#define EVENTSAMPLER_HPP
+
+#include "ctmacros.hpp"
+#include "EventProperties.hpp"
+#include "Variant.hpp"
+#include "api/ContextFieldsProvider.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Ingress stage that sheds events before they are decorated, serialized and
+    /// stored. Events are sampled deterministically on the hash of a key (an event
+    /// property or context field, e.g. the device id), so that a kept device keeps
+    /// all its events, and rate limited by token buckets per event name and per
+    /// tenant, so that one noisy event does not fill the RAM queue for the others.
+    ///
+    /// The stage is configured by the CFG_MAP_SAMPLING map and may be reconfigured
+    /// at runtime. Without configuration every event is accepted without locking.
+    /// </summary>
+    class EventSampler
+    {
+    public:
+        enum Decision
+        {
+            Accepted = 0,
+            SampledOut = 1,
+            RateLimited = 2
+        };
+
+        EventSampler();
+        virtual ~EventSampler() {}
+
+        EventSampler(const EventSampler&) = delete;
+        EventSampler& operator=(const EventSampler&) = delete;
+
+        /// <summary>
+        /// Replaces the configuration. Token buckets restart full.
+        /// </summary>
+        void Configure(VariantMap const& config);
+
+        bool IsActive() const noexcept
+        {
+            return m_active.load(std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// Decides whether the event goes on. The sampling key is looked up in the
+        /// event properties, then in the context; events without it are sampled at random.
+        /// </summary>
+        /// <param name="popSampleScale">Receives the fraction of the population a kept event stands for, 1 if not sampled.</param>
+        Decision Admit(EventProperties const& properties, std::string const& tenantToken, ContextFieldsProvider& context, double& popSampleScale);
+
+        uint64_t GetSampledOutCount() const noexcept
+        {
+            return m_sampledOut.load(std::memory_order_relaxed);
+        }
+
+        uint64_t GetRateLimitedCount() const noexcept
+        {
+            return m_rateLimited.load(std::memory_order_relaxed);
+        }
+
+    protected:
+        struct Rule
+        {
+            double samplePercent = 100.0;
+            double eventsPerSecond = 0.0;
+            double burst = 0.0;
+        };
+
+        struct Bucket
+        {
+            double   tokens = 0.0;
+            double   capacity = 0.0;
+            double   eventsPerSecond = 0.0;
+            uint64_t lastRefillMs = 0;
+
+            /// A bucket idle long enough to be full again may be forgotten without changing any decision
+            bool isFull(uint64_t nowMs) const
+            {
+                uint64_t idleMs = (nowMs > lastRefillMs) ? (nowMs - lastRefillMs) : 0;
+                return tokens + idleMs * eventsPerSecond / 1000.0 >= capacity;
+            }
+        };
+
+        /// Past this, a new event name or tenant takes the bucket of an idle one, or is not rate limited
+        static const size_t MaxBuckets = 4096;
+
+        virtual uint64_t now() const;
+
+        static Rule parseRule(VariantMap const& config, Rule const& defaults);
+        static uint64_t hash(std::string const& value);
+        uint64_t random();
+
+        // Called with m_lock held
+        bool refill(std::map<std::string, Bucket>& buckets, std::string const& name, Rule const& rule, uint64_t nowMs, Bucket*& bucket);
+
+        mutable std::mutex               m_lock;
+        std::atomic<bool>                m_active;
+        std::string                      m_key;
+        Rule                             m_defaultRule;
+        std::map<std::string, Rule>      m_eventRules;
+        std::map<std::string, Rule>      m_tenantRules;
+        std::map<std::string, Bucket>    m_eventBuckets;
+        std::map<std::string, Bucket>    m_tenantBuckets;
+        std::atomic<uint64_t>            m_random;
+        std::atomic<uint64_t>            m_sampledOut;
+        std::atomic<uint64_t>            m_rateLimited;
+    };
+
+} MAT_NS_END
+
+#endif
@@ -9,6 +9,7 @@
 
 #include <assert.h>
 #include <algorithm>
+#include <vector>
 
 #ifdef linux
 #include <unistd.h>
@@ -43,6 +44,10 @@ namespace MAT_NS_BEGIN {
         {
             m_ctx->durationMs = static_cast<int>(PAL::getMonotonicTimeMs() - m_startTime);
             m_ctx->httpResponse = response;
+            if (response != nullptr)
+            {
+                m_ctx->responseMemory.Resize(response->GetBody().size());
+            }
 #ifdef USE_SYNC_HTTPRESPONSE_HANDLER // handle HTTP callback synchronously in context of a callback thread
             // We need to decide on pros and cons of synchronous vs. asynchronous callback
             m_hcm.onHttpResponse(this);
@@ -82,6 +87,8 @@ namespace MAT_NS_BEGIN {
         m_httpClient(httpClient),
         m_taskDispatcher(taskDispatcher)
     {
+        ILogConfiguration& config = logManager.GetLogConfiguration();
+        m_isClientShared = config.HasConfig(CFG_BOOL_SHARED_RUNTIME) && static_cast<bool>(config[CFG_BOOL_SHARED_RUNTIME]);
     }
 
     HttpClientManager::~HttpClientManager() noexcept
@@ -136,21 +143,46 @@ namespace MAT_NS_BEGIN {
             LOG_TRACE("HTTP remove callback=%p", callback);
             m_httpCallbacks.remove(callback);
         }
+        m_httpCallbacksDone.notify_all();
 
+        // The context may be recycled long after the callback is deleted:
+        // drop the request while the callback can still receive its events
+        ctx->releaseHttp();
         delete callback;
     }
 
     bool HttpClientManager::cancelAllRequestsAsync()
     {
-        m_httpClient.CancelAllRequests();
+        if (!m_isClientShared)
+        {
+            m_httpClient.CancelAllRequests();
+            return true;
+        }
+
+        // The client also sends the requests of other LogManagers: only abort ours
+        std::vector<std::string> ids;
+        {
+            LOCKGUARD(m_httpCallbacksMtx);
+            for (HttpCallback* callback : m_httpCallbacks)
+            {
+                if (callback->m_ctx->httpRequest != nullptr)
+                {
+                    ids.push_back(callback->m_ctx->httpRequest->GetId());
+                }
+            }
+        }
+        for (auto const& id : ids)
+        {
+            m_httpClient.CancelRequestAsync(id);
+        }
         return true;
     }
 
     void HttpClientManager::cancelAllRequests()
     {
         cancelAllRequestsAsync();
-        while (!m_httpCallbacks.empty())
-            std::this_thread::yield();
+        std::unique_lock<std::recursive_mutex> lock(m_httpCallbacksMtx);
+        m_httpCallbacksDone.wait(lock, [this]() { return m_httpCallbacks.empty(); });
     }
 
     // start async cancellation
@@ -10,6 +10,7 @@
 #include "system/Route.hpp"
 #include "ILogManager.hpp"
 
+#include <condition_variable>
 #include <list>
 #include <mutex>
 
@@ -30,6 +31,11 @@ class HttpClientManager
 
         void cancelAllRequests();
 
+        /// <summary>
+        /// Starts canceling all requests without waiting for their callbacks.
+        /// </summary>
+        bool cancelAllRequestsAsync();
+
         size_t requestCount() const
         {
             return m_httpCallbacks.size();
@@ -49,13 +55,19 @@ class HttpClientManager
         void handleSendRequest(EventsUploadContextPtr const& ctx);
         virtual void scheduleOnHttpResponse(HttpCallback* callback);
         void onHttpResponse(HttpCallback* callback);
-        bool cancelAllRequestsAsync();
 
         ILogManager&              m_logManager;
         IHttpClient&              m_httpClient;
         ITaskDispatcher&          m_taskDispatcher;
         std::recursive_mutex      m_httpCallbacksMtx;
         std::list<HttpCallback*>  m_httpCallbacks;
+        // Signaled when a callback leaves m_httpCallbacks
+        std::condition_variable_any m_httpCallbacksDone;
+        // The HTTP client is shared with other LogManagers, see CFG_BOOL_SHARED_RUNTIME
+        bool                      m_isClientShared { false };
+
+    public:
+        StaticRouteHandler<decltype(&HttpClientManager::handleSendRequest), &HttpClientManager::handleSendRequest> sendRequestStatic{ this };
 };
 
 } MAT_NS_END
@@ -39,8 +39,20 @@ namespace MAT_NS_BEGIN {
             }
         }
 
+        // Kept apart from m_headers so that the client can reuse its curl_slist
+        virtual void SetSharedHeaders(std::shared_ptr<const HttpHeaders> const& headers) override
+        {
+            m_sharedHeaders = headers;
+        }
+
+        std::shared_ptr<const HttpHeaders> const& GetSharedHeaders() const
+        {
+            return m_sharedHeaders;
+        }
+
     private:
         std::shared_ptr<CurlHttpOperation> m_curlOperation;
+        std::shared_ptr<const HttpHeaders> m_sharedHeaders;
     };
 
     HttpClient_Curl::HttpClient_Curl()
@@ -49,10 +61,14 @@ namespace MAT_NS_BEGIN {
         TRACE("Initializing HttpClient_Curl...\n");
         curl_global_init(CURL_GLOBAL_ALL);
         TRACE("libcurl version = %s\n", curl_version_info(CURLVERSION_NOW)->version);
+
+        m_share = std::make_shared<CurlShare>();
     }
 
     HttpClient_Curl::~HttpClient_Curl()
     {
+        // Requests still in flight hold their own reference to the share
+        m_share.reset();
         curl_global_cleanup();
         TRACE("Destroyed HttpClient_Curl.\n");
     };
@@ -69,12 +85,10 @@ namespace MAT_NS_BEGIN {
         auto curlRequest = static_cast<CurlHttpRequest*>(request);
 
         std::string requestId = curlRequest->GetId();
-        std::map<std::string, std::string> requestHeaders;
-        for (const auto& header : curlRequest->m_headers) {
-            requestHeaders[header.first] = header.second;
-        }
+        std::map<std::string, std::string> requestHeaders(curlRequest->m_headers.begin(), curlRequest->m_headers.end());
 
-        auto curlOperation = std::make_shared<CurlHttpOperation>(curlRequest->m_method, curlRequest->m_url, callback, requestHeaders, curlRequest->m_body);
+        auto curlOperation = std::make_shared<CurlHttpOperation>(curlRequest->m_method, curlRequest->m_url, callback, requestHeaders, curlRequest->m_body,
+            false, HTTP_CONN_TIMEOUT, GetSharedHeaders(curlRequest->GetSharedHeaders()), m_share);
         curlRequest->SetOperation(curlOperation);
         
         // The lifetime of curlOperation is guarnteed by the call to result.wait() in the d'tor.  
@@ -102,6 +116,8 @@ namespace MAT_NS_BEGIN {
             response->m_headers.insert(responseHeaders.begin(), responseHeaders.end());
             response->m_body = operation.GetResponseBody();
             
+            // The operation may outlive the callback once the response is delivered
+            operation.DetachCallback();
             // 'response' is no longer owned by IHttpClient and gets deleted in EventsUploadContext.clear()
             callback->OnHttpResponse(response.release());
         });
@@ -125,6 +141,31 @@ namespace MAT_NS_BEGIN {
         }
     }
 
+    std::shared_ptr<curl_slist> HttpClient_Curl::GetSharedHeaders(std::shared_ptr<const HttpHeaders> const& headers)
+    {
+        if (headers == nullptr) {
+            return nullptr;
+        }
+
+        // The block is immutable: the same block always encodes to the same list
+        std::lock_guard<std::mutex> lock(m_sharedHeadersMtx);
+        if (headers == m_sharedHeaderBlock) {
+            return m_sharedHeaders;
+        }
+
+        // Operations still in flight keep their reference to the previous list
+        m_sharedHeaderBlock = headers;
+        curl_slist* list = nullptr;
+        for (const auto& header : *headers) {
+            std::string line = header.first;
+            line += ": ";
+            line += header.second;
+            list = curl_slist_append(list, line.c_str());
+        }
+        m_sharedHeaders = (list != nullptr) ? std::shared_ptr<curl_slist>(list, curl_slist_free_all) : nullptr;
+        return m_sharedHeaders;
+    }
+
     void HttpClient_Curl::EraseRequest(std::string const& id)
     {
         std::lock_guard<std::mutex> lock(m_requestsMtx);
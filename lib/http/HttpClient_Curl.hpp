@@ -22,6 +22,9 @@
 #include <numeric>
 #include <future>
 #include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include <curl/curl.h>
 
@@ -43,6 +46,55 @@
 
 namespace MAT_NS_BEGIN {
 
+/**
+ * DNS cache and TLS sessions shared between curl handles, with the locks libcurl
+ * calls back into. Every request holds a reference, so the share and its locks
+ * outlive the client while a request is still in flight.
+ */
+class CurlShare {
+public:
+    CurlShare()
+    {
+        m_share = curl_share_init();
+        if (m_share != nullptr) {
+            curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, &CurlShare::Lock);
+            curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, &CurlShare::Unlock);
+            curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        }
+    }
+
+    ~CurlShare()
+    {
+        if (m_share != nullptr) {
+            curl_share_cleanup(m_share);
+        }
+    }
+
+    CurlShare(CurlShare const&) = delete;
+    CurlShare& operator=(CurlShare const&) = delete;
+
+    CURLSH* get() const { return m_share; }
+
+private:
+    static void Lock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr)
+    {
+        (void)handle;
+        (void)access;
+        static_cast<CurlShare*>(userptr)->m_mtx[data].lock();
+    }
+
+    static void Unlock(CURL* handle, curl_lock_data data, void* userptr)
+    {
+        (void)handle;
+        static_cast<CurlShare*>(userptr)->m_mtx[data].unlock();
+    }
+
+    CURLSH* m_share = nullptr;
+    std::mutex m_mtx[CURL_LOCK_DATA_LAST];
+};
+
 /**
  * Curl-based HTTP client
  */
@@ -58,9 +110,20 @@ public:
 private:
     void EraseRequest(std::string const& id);
     void AddRequest(IHttpRequest* request);
+    std::shared_ptr<curl_slist> GetSharedHeaders(std::shared_ptr<const HttpHeaders> const& headers);
+
+    // DNS cache and TLS sessions reused by all requests of this client, and so by all
+    // LogManagers sharing it. Connections themselves are not shared: libcurl does not
+    // support sharing them between requests running on different threads.
+    std::shared_ptr<CurlShare> m_share;
 
     std::mutex m_requestsMtx;
     std::map<std::string, IHttpRequest*> m_requests;
+
+    // curl_slist of the last shared header block, reused while requests carry that same block
+    std::mutex m_sharedHeadersMtx;
+    std::shared_ptr<const HttpHeaders> m_sharedHeaderBlock;
+    std::shared_ptr<curl_slist> m_sharedHeaders;
 };
 
 class CurlHttpOperation {
@@ -81,6 +144,8 @@ public:
      * @param body
      * @param httpConnTimeout   HTTP connection timeout in seconds
      * @param httpReadTimeout   HTTP read timeout in seconds
+     * @param sharedHeaders     Read-only header list appended after requestHeaders
+     * @param share             Optional share for the DNS cache and TLS sessions, kept alive by the operation
      */
     CurlHttpOperation(
             std::string method,
@@ -91,7 +156,9 @@ public:
             const std::vector<uint8_t>& requestBody                  = std::vector<uint8_t>(),
             // Default connectivity and response size options
             bool rawResponse                                         = false,
-            size_t httpConnTimeout                                   = HTTP_CONN_TIMEOUT) :
+            size_t httpConnTimeout                                   = HTTP_CONN_TIMEOUT,
+            std::shared_ptr<curl_slist> sharedHeaders                = nullptr,
+            std::shared_ptr<CurlShare> share                         = nullptr) :
 
             // Optional connection params
             rawResponse(rawResponse),
@@ -103,7 +170,9 @@ public:
 
             // Local vars
             requestHeaders(requestHeaders),
-            requestBody(requestBody)
+            requestBody(requestBody),
+            m_sharedHeaders(sharedHeaders),
+            m_share(share)
     {
         TRACE("--------------------------------------------------------------------------------------------------\n");
         response.memory = nullptr;
@@ -129,6 +198,11 @@ public:
         // Specify target URL
         curl_easy_setopt(curl, CURLOPT_URL, m_url.c_str());
 
+        if(m_share != nullptr && m_share->get() != nullptr)
+        {
+            curl_easy_setopt(curl, CURLOPT_SHARE, m_share->get());
+        }
+
         // TODO: expose SSL cert verification opts via ILogConfiguration
         curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);      // 1L
         curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);      // 2L
@@ -144,6 +218,24 @@ public:
             m_headersChunk = curl_slist_append(m_headersChunk, header.c_str());
         }
 
+        // Link the shared list behind our own nodes instead of copying it. The link is
+        // cut again in the destructor so that only our nodes are freed.
+        if(m_sharedHeaders != nullptr)
+        {
+            if(m_headersChunk == nullptr)
+            {
+                curl_easy_setopt(curl, CURLOPT_HTTPHEADER, m_sharedHeaders.get());
+            } else
+            {
+                m_headersTail = m_headersChunk;
+                while(m_headersTail->next != nullptr)
+                {
+                    m_headersTail = m_headersTail->next;
+                }
+                m_headersTail->next = m_sharedHeaders.get();
+            }
+        }
+
         if(m_headersChunk != nullptr)
         {
             curl_easy_setopt(curl, CURLOPT_HTTPHEADER, m_headersChunk);
@@ -167,6 +259,10 @@ public:
         DispatchEvent(OnDestroy);
         res = CURLE_OK;
         curl_easy_cleanup(curl);
+        if(m_headersTail != nullptr)
+        {
+            m_headersTail->next = nullptr;
+        }
         curl_slist_free_all(m_headersChunk);
         ReleaseResponse();
     }
@@ -390,6 +486,15 @@ cleanup:
         respBody.clear();
     }
 
+    /**
+     * Stop dispatching state events. The response callback may delete its
+     * IHttpResponseCallback before this operation is destroyed.
+     */
+    void DetachCallback()
+    {
+        m_callback = nullptr;
+    }
+
     /**
      * Abort request in connecting or reading state.
      */
@@ -426,6 +531,10 @@ protected:
     const std::map<std::string, std::string>& requestHeaders;
     const std::vector<uint8_t>& requestBody;
     struct curl_slist *m_headersChunk = nullptr;
+    struct curl_slist *m_headersTail = nullptr;
+    std::shared_ptr<curl_slist> m_sharedHeaders;
+    // Released after curl_easy_cleanup() has detached the handle from the share
+    std::shared_ptr<CurlShare> m_share;
 
     // Processed response headers and body
     std::vector<uint8_t>        respHeaders;
@@ -22,7 +22,9 @@ namespace MAT_NS_BEGIN {
         :
         m_system(system),
         m_httpClient(httpClient),
-        m_config(system.getConfig())
+        m_config(system.getConfig()),
+        m_headerBlockOwner(nullptr),
+        m_headerBlockVersion(0)
     {
     }
 
@@ -35,123 +37,129 @@ namespace MAT_NS_BEGIN {
         m_system.getLogManager().GetDataViewerCollection().DispatchDataViewerEvent(dataPacket);
     }
 
-    bool HttpRequestEncoder::handleEncode(EventsUploadContextPtr const& ctx)
+    std::shared_ptr<const HttpHeaders> HttpRequestEncoder::getHeaderBlock()
     {
-        ctx->httpRequest = m_httpClient.CreateRequest();
-        ctx->httpRequestId = ctx->httpRequest->GetId();
-
-        ctx->httpRequest->SetMethod("POST");
-
-        ctx->httpRequest->SetUrl(m_config.GetCollectorUrl());
-
-        ctx->httpRequest->GetHeaders().set("Expect", "100-continue");
-        
-#ifdef HAVE_MAT_EVT_TRACEID 
-        ctx->httpRequest->GetHeaders().set("Trace-Id", ctx->traceId);
-#endif //HAVE_MAT_EVT_TRACEID 
-
-        ctx->httpRequest->GetHeaders().set("SDK-Version", PAL::getSdkVersion());
-        ctx->httpRequest->GetHeaders().set("Client-Id", "NO_AUTH");
-        ctx->httpRequest->GetHeaders().set("Content-Type", "application/bond-compact-binary");
-        ctx->httpRequest->GetHeaders().set("Upload-Time", toString(PAL::getUtcSystemTimeMs()));
+        std::lock_guard<std::mutex> lock(m_headerBlockLock);
+        IAuthTokensController* controller = GetAuthTokensController();
+        uint64_t version = (controller != nullptr) ? controller->GetVersion() : 0;
+        // Version 0 means the controller does not track changes: never trust the cache then
+        if (m_headerBlock != nullptr && controller == m_headerBlockOwner && version == m_headerBlockVersion &&
+            (controller == nullptr || version != 0))
+        {
+            return m_headerBlock;
+        }
 
+        auto block = std::make_shared<HttpHeaders>();
+        block->set("Expect", "100-continue");
+        block->set("SDK-Version", PAL::getSdkVersion());
+        block->set("Client-Id", "NO_AUTH");
+        block->set("Content-Type", "application/bond-compact-binary");
 
-        if (GetAuthTokensController() != nullptr && GetAuthTokensController()->GetDeviceTokens().size() > 0)
+        if (controller != nullptr)
         {
-            std::map<TicketType, std::string>& map = GetAuthTokensController()->GetDeviceTokens();
-            if (map.end() != map.find(TicketType::TicketType_MSA_Device))
+            static const std::pair<TicketType, const char*> deviceHeaders[] =
             {
-                ctx->httpRequest->GetHeaders().set("AuthMsaDeviceTicket", map[TicketType::TicketType_MSA_Device]);
-            }
-
-            if (map.end() != map.find(TicketType::TicketType_XAuth_Device))
-            {
-                ctx->httpRequest->GetHeaders().set("AuthXToken", map[TicketType::TicketType_XAuth_Device]);
-            }
-
-            if (map.end() != map.find(TicketType::TicketType_AAD))
+                { TicketType::TicketType_MSA_Device,   "AuthMsaDeviceTicket" },
+                { TicketType::TicketType_XAuth_Device, "AuthXToken" },
+                { TicketType::TicketType_AAD,          "Aad-Token" },
+                { TicketType::TicketType_AAD_JWT,      "Aad-Jwt-Token" },
+                { TicketType::TicketType_AAD_Device,   "AadDeviceToken" }
+            };
+            std::map<TicketType, std::string> const& deviceTokens = controller->GetDeviceTokens();
+            for (auto const& item : deviceHeaders)
             {
-                ctx->httpRequest->GetHeaders().set("Aad-Token", map[TicketType::TicketType_AAD]);
+                auto it = deviceTokens.find(item.first);
+                if (it != deviceTokens.end())
+                {
+                    block->set(item.second, it->second);
+                }
             }
 
-            if (map.end() != map.find(TicketType::TicketType_AAD_JWT))
+            std::string ticketHeader = buildTicketsHeader(controller->GetUserTokens());
+            if (!ticketHeader.empty())
             {
-                ctx->httpRequest->GetHeaders().set("Aad-Jwt-Token", map[TicketType::TicketType_AAD_JWT]);
+                block->set("Tickets", ticketHeader);
             }
 
-            if (map.end() != map.find(TicketType::TicketType_AAD_Device))
+            //strict mode
+            if (controller->GetStrictMode())
             {
-                ctx->httpRequest->GetHeaders().set("AadDeviceToken", map[TicketType::TicketType_AAD_Device]);
+                block->set("Strict", "true");
             }
         }
 
-        if (GetAuthTokensController() != nullptr && GetAuthTokensController()->GetUserTokens().size() > 0)
-        {  //create Ticket header
-            std::map<TicketType, std::string>& map = GetAuthTokensController()->GetUserTokens();
-
-            std::string ticketHeader;
-            // We know that each ticket is about 1kb in size, so pre-reserve space for the appends
-            ticketHeader.reserve(GetAuthTokensController()->GetUserTokens().size() * 1024);//
+        m_headerBlock = block;
+        m_headerBlockOwner = controller;
+        m_headerBlockVersion = version;
+        return m_headerBlock;
+    }
 
-            if (map.end() != map.find(TicketType::TicketType_MSA_User))
-            {
-                ticketHeader.append("\"");
-                ticketHeader.append(TICKETS_PREPEND_STRING + std::to_string(TicketType::TicketType_MSA_User));
-                ticketHeader.append("\"=\"");
-                ticketHeader.append("p:");
-                ticketHeader.append(map[TicketType::TicketType_MSA_User]);
-                ticketHeader.append("\"");
-            }
-            if (map.end() != map.find(TicketType::TicketType_XAuth_User))
-            {
-                if (!ticketHeader.empty())
-                {
-                    ticketHeader.append(";");
-                }
-                ticketHeader.append("\"");
-                ticketHeader.append(TICKETS_PREPEND_STRING + std::to_string(TicketType::TicketType_XAuth_User));
-                ticketHeader.append("\"=\"");
-                ticketHeader.append("x:XBL3.0 x=");
-                ticketHeader.append(map[TicketType::TicketType_XAuth_User]);
-                ticketHeader.append("\"");
-            }
-            if (map.end() != map.find(TicketType::TicketType_AAD_User))
+    std::string HttpRequestEncoder::buildTicketsHeader(std::map<TicketType, std::string> const& userTokens)
+    {
+        static const std::pair<TicketType, const char*> userTickets[] =
+        {
+            { TicketType::TicketType_MSA_User,   "p:" },
+            { TicketType::TicketType_XAuth_User, "x:XBL3.0 x=" },
+            { TicketType::TicketType_AAD_User,   "at:" }
+        };
+
+        std::string ticketHeader;
+        // We know that each ticket is about 1kb in size, so pre-reserve space for the appends
+        ticketHeader.reserve(userTokens.size() * 1024);
+        for (auto const& item : userTickets)
+        {
+            auto it = userTokens.find(item.first);
+            if (it == userTokens.end())
             {
-                if (!ticketHeader.empty())
-                {
-                    ticketHeader.append(";");
-                }
-                ticketHeader.append("\"");
-                ticketHeader.append(TICKETS_PREPEND_STRING + std::to_string(TicketType::TicketType_AAD_User));
-                ticketHeader.append("\"=\"");
-                ticketHeader.append("at:");
-                ticketHeader.append(map[TicketType::TicketType_AAD_User]);
-                ticketHeader.append("\"");
+                continue;
             }
-
             if (!ticketHeader.empty())
             {
-                ctx->httpRequest->GetHeaders().set("Tickets", ticketHeader);
+                ticketHeader.append(";");
             }
+            ticketHeader.append("\"");
+            ticketHeader.append(TICKETS_PREPEND_STRING + std::to_string(item.first));
+            ticketHeader.append("\"=\"");
+            ticketHeader.append(item.second);
+            ticketHeader.append(it->second);
+            ticketHeader.append("\"");
         }
-        //strict mode
-        if (GetAuthTokensController() != nullptr && true == GetAuthTokensController()->GetStrictMode())
-        {
-            ctx->httpRequest->GetHeaders().set("Strict", "true");
-        }
+        return ticketHeader;
+    }
+
+    bool HttpRequestEncoder::handleEncode(EventsUploadContextPtr const& ctx)
+    {
+        ctx->httpRequest = m_httpClient.CreateRequest();
+        ctx->httpRequestId = ctx->httpRequest->GetId();
+
+        ctx->httpRequest->SetMethod("POST");
+
+        ctx->httpRequest->SetUrl(m_config.GetCollectorUrl());
+
+        ctx->httpRequest->SetSharedHeaders(getHeaderBlock());
+
+        // Headers computed for every upload
+        HttpHeaders& headers = ctx->httpRequest->GetHeaders();
+
+#ifdef HAVE_MAT_EVT_TRACEID 
+        headers.set("Trace-Id", ctx->traceId);
+#endif //HAVE_MAT_EVT_TRACEID 
+
+        headers.set("Upload-Time", toString(PAL::getUtcSystemTimeMs()));
 
+        TenantTable const& tenants = m_system.getTenantTable();
         std::string tenantTokens;
         tenantTokens.reserve(ctx->packageIds.size() * 75); // Tenants tokens are usually 74 chars long.
         for (auto const& item : ctx->packageIds) {
             if (!tenantTokens.empty()) {
                 tenantTokens.push_back(',');
             }
-            tenantTokens.append(item.first);
+            tenantTokens.append(tenants.resolve(item.first));
         }
-        ctx->httpRequest->GetHeaders().set("APIKey", tenantTokens);
+        headers.set("APIKey", tenantTokens);
 
         if (ctx->compressed) {
-            ctx->httpRequest->GetHeaders().add("Content-Encoding", "deflate");
+            headers.add("Content-Encoding", "deflate");
         }
 
 
@@ -162,6 +170,7 @@ namespace MAT_NS_BEGIN {
         bond_lite::Deserialize(reader, result);
 #endif
 
+        ctx->bodySize = ctx->body.size();
         ctx->httpRequest->SetBody(ctx->body);
         // IHttpRequest::SetBody() is free to swap the real body out, but better clear it anyway.
         ctx->body.clear();
@@ -14,6 +14,9 @@
 
 #include "IAuthTokensController.hpp"
 
+#include <memory>
+#include <mutex>
+
 namespace MAT_NS_BEGIN {
 
     class HttpRequestEncoder {
@@ -30,12 +33,32 @@ namespace MAT_NS_BEGIN {
         IHttpClient &           m_httpClient;
         IRuntimeConfig&         m_config;
 
-        IAuthTokensController* GetAuthTokensController()
+        virtual IAuthTokensController* GetAuthTokensController()
         {
             return m_system.getLogManager().GetAuthTokensController();
         }
 
+        /// <summary>
+        /// Returns m_headerBlock, rebuilt first if the auth tokens changed since it was last built.
+        /// </summary>
+        std::shared_ptr<const HttpHeaders> getHeaderBlock();
+
+        /// <summary>
+        /// Builds the Tickets header value from the user tokens.
+        /// </summary>
+        static std::string buildTicketsHeader(std::map<TicketType, std::string> const& userTokens);
+
+        // Headers that are the same for every request until the auth tokens change.
+        // A new block is built on change, requests in flight keep the previous one.
+        std::mutex                          m_headerBlockLock;
+        std::shared_ptr<const HttpHeaders>  m_headerBlock;
+        IAuthTokensController*  m_headerBlockOwner;
+        uint64_t                m_headerBlockVersion;
+
         virtual void DispatchDataViewerEvent(const StorageBlob& dataPacket);
+
+    public:
+        StaticRouteHandler<decltype(&HttpRequestEncoder::handleEncode), &HttpRequestEncoder::handleEncode> encodeStatic{ this };
     };
 
 
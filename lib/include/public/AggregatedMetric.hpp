@@ -56,12 +56,19 @@ namespace MAT_NS_BEGIN
                 ILogger* pLogger = NULL);
 
             /// <summary>
-            /// The AggregatedMetric destructor.
+            /// The AggregatedMetric destructor. Logs the values pushed since the last
+            /// interval, so it must run before the LogManager of the logger tears down.
             /// </summary>
             ~AggregatedMetric();
 
+            AggregatedMetric(AggregatedMetric const&) = delete;
+            AggregatedMetric& operator=(AggregatedMetric const&) = delete;
+
             /// <summary>
-            /// Pushes a single metric value for auto-aggregation.
+            /// Pushes a single metric value for auto-aggregation. The values pushed in
+            /// each interval are logged as one aggregated metric event: count, sum,
+            /// sum of squares, minimum, maximum and estimated percentiles.
+            /// Values pushed without a logger, NaN and infinities are dropped.
             /// </summary>
             /// <param name="value">The metric value to push.</param>
             void PushMetric(double value);
@@ -59,6 +59,11 @@ namespace MAT_NS_BEGIN
             return evt_log(handle, evt);
         }
 
+        evt_status_t logBatch(uint32_t count, evt_prop** evts)
+        {
+            return evt_log_batch(handle, count, evts);
+        }
+
         evt_status_t pause()
         {
             return evt_pause(handle);
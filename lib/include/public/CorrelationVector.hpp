@@ -7,13 +7,16 @@
 
 #include "ctmacros.hpp"
 
-#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace MAT_NS_BEGIN
 {
     // Implementation of the Common Schema standard vector clock type.
-    // Class methods are thread-safe.
+    // Class methods are thread-safe and take no locks: concurrent calls only wait
+    // while Initialize, Uninitialize, SetValue or Extend rewrites the base vector.
     // Boolean-value methods return false to indicate failures.
 
     /*
@@ -56,6 +59,9 @@ namespace MAT_NS_BEGIN
     {
     public:
 
+        // Size of a buffer that holds any CV value and its terminating NUL.
+        static constexpr size_t ValueBufferSize = 128;
+
         // Constructs an uninitialized, not yet ready to use correlation vector
         MATSDK_LIBABI CorrelationVector();
 
@@ -76,9 +82,19 @@ namespace MAT_NS_BEGIN
         // Returns the read value or empty string if CV is not initialized.
         MATSDK_LIBABI std::string GetNextValue();
 
+        // Same as GetNextValue() above, formatting the value into the NUL-terminated buffer
+        // without allocating. Returns the length of the value, or 0 if CV is not initialized
+        // or the buffer is too small, in which case CV is not incremented.
+        MATSDK_LIBABI size_t GetNextValue(char* buffer, size_t size);
+
         // Returns the current CV string representation or empty string if not initialized.
         MATSDK_LIBABI std::string GetValue();
 
+        // Same as GetValue() above, formatting the value into the NUL-terminated buffer
+        // without allocating. Returns the length of the value, or 0 if CV is not initialized
+        // or the buffer is too small.
+        MATSDK_LIBABI size_t GetValue(char* buffer, size_t size);
+
         // Adds .0 to the end of the current correlation vector,
         // or does nothing if the maximum length was reached.
         MATSDK_LIBABI bool Extend();
@@ -112,36 +128,48 @@ namespace MAT_NS_BEGIN
     private:
 
         // Version specific constants.
-        static const size_t c_maxCVLength_v1;
-        static const size_t c_baseCVLength_v1;
+        static constexpr size_t c_maxCVLength_v1 = 63;
+        static constexpr size_t c_baseCVLength_v1 = 16;
 
-        static const size_t c_maxCVLength_v2;
-        static const size_t c_baseCVLength_v2;
+        static constexpr size_t c_maxCVLength_v2 = 127;
+        static constexpr size_t c_baseCVLength_v2 = 22;
 
         // Helper strings used for input validation.
         static const std::string s_base64CharSet;
         static const std::string s_base10CharSet;
         static const std::string s_maxVectorElementValue;
 
-        // Internal state variables.
-        std::mutex m_lock;
-        bool m_isInitialized {};
-        std::string m_baseVector;
-        size_t m_currentVector {};
-        size_t m_maxLength {};
+        // Consistent copy of the internal state, taken without locking.
+        struct Snapshot
+        {
+            uint64_t state;
+            size_t maxLength;
+            size_t baseLength;
+            char baseVector[c_maxCVLength_v2];
+        };
+
+        // Internal state variables. m_state holds the generation of the base vector in its
+        // upper half and the current vector in its lower half. Writers of the base vector
+        // make the generation odd while they write, readers retry if it changed meanwhile.
+        // Incrementing is a compare-and-swap of m_state alone.
+        std::atomic<uint64_t> m_state {};
+        std::atomic<size_t> m_maxLength {};
+        std::atomic<size_t> m_baseLength {};
+        std::atomic<char> m_baseVector[c_maxCVLength_v2];
 
         // Randomly generates a string for the base vector.
         static std::string InitializeInternal(size_t baseLength);
 
-        // Internal, unsynchronized class method implementations.
-        std::string GetValueInternal();
-        bool IncrementInternal();
-        size_t GetLengthInternal(size_t vectorValue);
-        bool CanExtendInternal();
-        bool CanIncrementInternal();
+        // Internal class method implementations on a snapshot of the state.
+        void LoadSnapshot(Snapshot& snapshot, bool copyBaseVector);
+        uint64_t BeginWrite();
+        void EndWrite(uint64_t previousState, size_t maxLength, size_t baseLength, uint32_t currentVector);
+        static size_t FormatValue(Snapshot const& snapshot, char* buffer, size_t size);
+        static bool CanExtendInternal(Snapshot const& snapshot);
+        static bool CanIncrementInternal(Snapshot const& snapshot);
 
         // Calculates the length of the specified integer.
-        size_t GetDigitCount(size_t value);
+        static size_t GetDigitCount(size_t value);
     };
 
 } MAT_NS_END
@@ -123,6 +123,9 @@ namespace MAT_NS_BEGIN
         EVT_STORAGE_FULL        = 0x0E000000,
         /// <summary>Storage failed.</summary>
         EVT_STORAGE_FAILED      = 0x0E000001,
+        /// <summary>Storage backpressure watermark crossed: param1 is 1 when saturated, 0 once
+        /// drained; param2 is the RAM queue fill in percent.</summary>
+        EVT_STORAGE_BACKPRESSURE = 0x0E000002,
 
         /// <summary>Ticket Expired</summary>
         EVT_TICKET_EXPIRED      = 0x0F000000,
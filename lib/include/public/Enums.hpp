@@ -474,6 +474,24 @@ namespace MAT_NS_BEGIN
         EventPersistence_DoNotStoreOnDisk = 3
     };
 
+    /// <summary>
+    /// Outcome of ILogger::TryLogEvent
+    /// </summary>
+    enum LogEventResult
+    {
+        /// Accepted: the event is in the RAM queue
+        LogEventResult_Accepted = 0,
+
+        /// QueuedToDisk: the event went straight to offline storage, there is no RAM queue
+        LogEventResult_QueuedToDisk = 1,
+
+        /// RateLimited: the event was shed by ingress sampling or rate limiting
+        LogEventResult_RateLimited = 2,
+
+        /// Dropped: the event was filtered, invalid, or shed while the pipeline is saturated
+        LogEventResult_Dropped = 3
+    };
+
     typedef struct
     {
         EventPriority priority;
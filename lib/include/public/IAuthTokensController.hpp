@@ -66,6 +66,15 @@ namespace MAT_NS_BEGIN
         /// <param name="ticketValue">Ticketvalue</param>
         virtual std::map<TicketType, std::string>&  GetUserTokens() = 0;
 
+        /// <summary>
+        /// Gets a counter that changes every time a token or the strict mode is set or cleared.
+        /// Consumers may cache data derived from the tokens until the counter changes.
+        /// Modifications made directly through the maps returned by GetDeviceTokens()
+        /// and GetUserTokens() are not tracked.
+        /// </summary>
+        /// <returns>Current version, or 0 if the implementation does not track changes.</returns>
+        virtual uint64_t  GetVersion() { return 0; }
+
     };
 
 } MAT_NS_END
@@ -6,6 +6,9 @@
 #define IBANDWIDTHCONTROLLER_HPP
 
 #include "ctmacros.hpp"
+#include "Enums.hpp"
+
+#include <cstddef>
 
 namespace MAT_NS_BEGIN
 {
@@ -25,6 +28,27 @@ namespace MAT_NS_BEGIN
         /// </summary>
         /// <returns>Proposed bandwidth in bytes per second</returns>
         virtual unsigned GetProposedBandwidthBps() = 0;
+
+        /// <summary>
+        /// Query how long an upload of the given latency class has to wait
+        /// before it may start. Called each time an upload is scheduled.
+        /// </summary>
+        /// <returns>Delay in milliseconds, 0 to upload right away</returns>
+        virtual unsigned GetUploadDelayMs(EventLatency /*latency*/)
+        {
+            return 0;
+        }
+
+        /// <summary>
+        /// Reports a completed upload so that its bytes are charged against
+        /// the budget and the measured throughput can be taken into account.
+        /// </summary>
+        /// <param name="latency">Latency class of the upload</param>
+        /// <param name="bytes">Size of the HTTP request body</param>
+        /// <param name="durationMs">Time from sending the request to receiving the response, negative if unknown</param>
+        virtual void OnUploadCompleted(EventLatency /*latency*/, size_t /*bytes*/, int /*durationMs*/)
+        {
+        }
     };
 } MAT_NS_END
 
@@ -41,7 +41,8 @@ namespace MAT_NS_BEGIN
 
         /// <summary>
         /// Iterate and inspect the given record's Part-B and
-        /// Part-C properties
+        /// Part-C properties. May be called concurrently from
+        /// several logging threads.
         /// </summary>
         /// <param name="record">Record to inspect</param>
         /// <returns>Always returns true.</returns>
@@ -29,6 +29,7 @@ namespace MAT_NS_BEGIN {
 
         /// <summary>
         /// Decorates the specified record with common properties.
+        /// May be called concurrently from several logging threads.
         /// </summary>
         /// <param name="record">Common Schema protocol record.</param>
         /// <returns></returns>
@@ -12,6 +12,7 @@
 
 #include <tuple>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -140,6 +141,21 @@ namespace MAT_NS_BEGIN
         /// <returns>The HTTP headers in an HttpHeaders object.</returns>
         virtual HttpHeaders& GetHeaders() = 0;
 
+        /// <summary>
+        /// Adds headers that many requests share unchanged, next to the ones in GetHeaders().
+        /// The default implementation copies them into GetHeaders(); a client that caches its
+        /// own encoding of the block may keep the reference instead and reuse that encoding
+        /// for as long as it receives the same block.
+        /// </summary>
+        /// <param name="headers">The shared headers, never modified once set.</param>
+        virtual void SetSharedHeaders(std::shared_ptr<const HttpHeaders> const& headers)
+        {
+            if (headers != nullptr)
+            {
+                GetHeaders().insert(headers->begin(), headers->end());
+            }
+        }
+
         /// <summary>
         /// Sets the request body.
         /// </summary>
@@ -139,6 +139,32 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_INT_RAM_QUEUE_SIZE = "cacheMemorySizeLimitInBytes";
 
+    /// <summary>
+    /// Number of RAM queue shards, so that threads logging concurrently
+    /// do not contend on one queue lock. 0 uses one shard per hardware thread.
+    /// </summary>
+    static constexpr const char* const CFG_INT_RAM_QUEUE_SHARDS = "cacheMemoryShards";
+
+    /// <summary>
+    /// Budget in bytes for the memory held by the telemetry pipelines of the process:
+    /// RAM queues, events waiting for storage, packages, upload bodies and responses.
+    /// Past 75% of it packages shrink and the RAM queue spills to disk early.
+    /// 0 disables the accounting.
+    /// </summary>
+    static constexpr const char* const CFG_INT_MEMORY_BUDGET = "memoryBudgetInBytes";
+
+    /// <summary>
+    /// RAM queue fill, in percent of its size limit, from which the pipeline is saturated:
+    /// EVT_STORAGE_BACKPRESSURE is dispatched and ILogger::TryLogEvent sheds events.
+    /// Above 100 the fill measures the backlog the flush to disk has not absorbed yet.
+    /// </summary>
+    static constexpr const char* const CFG_INT_BACKPRESSURE_HIGH_PCT = "backpressureHighWatermark";
+
+    /// <summary>
+    /// RAM queue fill, in percent of its size limit, at which a saturated pipeline is drained.
+    /// </summary>
+    static constexpr const char* const CFG_INT_BACKPRESSURE_LOW_PCT = "backpressureLowWatermark";
+
     /// <summary>
     /// The size of the RAM queue buffers, in bytes.
     /// </summary>
@@ -149,6 +175,13 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_BOOL_CHECKPOINT_DB_ON_FLUSH = "checkpointDBOnFlush";
 
+    /// <summary>
+    /// Open the offline storage on a background thread. Events are kept in the RAM queue
+    /// until the storage is open, then the queue is flushed to it as usual.
+    /// Requires a non-zero CFG_INT_RAM_QUEUE_SIZE.
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_ASYNC_STORAGE_OPEN = "asyncStorageOpen";
+
     /// <summary>
     /// The trace level mask.
     /// </summary>
@@ -209,6 +242,16 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_INT_MAX_PENDING_REQ = "maxPendingHTTPRequests";
 
+    /// <summary>
+    /// The number of packages kept prepared while uploads are in flight, 0 to disable pipelined uploads.
+    /// </summary>
+    static constexpr const char* const CFG_INT_UPLOAD_PIPELINE_DEPTH = "uploadPipelineDepth";
+
+    /// <summary>
+    /// Share one HTTP client and one upload scheduler with the other LogManagers of the process that set it.
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_SHARED_RUNTIME = "sharedRuntime";
+
     /// <summary>
     /// The maximum package drop on full.
     /// </summary>
@@ -326,6 +369,16 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_BOOL_METASTATS_SPLIT = "split";
 
+    /// <summary>
+    /// MetaStats configuration: add per-stage pipeline latency percentiles to stats events
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_METASTATS_PIPELINE = "pipeline";
+
+    /// <summary>
+    /// MetaStats configuration: add upload and event context pool hit rates to stats events
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_METASTATS_POOLS = "pools";
+
     /// <summary>
     /// Compatibility configuration
     /// </summary>
@@ -386,6 +439,111 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_BOOL_TPM_CLOCK_SKEW_ENABLED = "clockSkewEnabled";
 
+    /// <summary>
+    /// TPM configuration: window (ms) during which Max latency events are coalesced into one upload, 0 to upload each event right away
+    /// </summary>
+    static constexpr const char* const CFG_INT_TPM_MAX_LATENCY_WINDOW_MS = "maxLatencyWindowMs";
+
+    /// <summary>
+    /// TPM configuration: number of Max latency events that closes the coalescing window early, 0 for no limit
+    /// </summary>
+    static constexpr const char* const CFG_INT_TPM_MAX_LATENCY_BATCH = "maxLatencyBatchSize";
+
+    /// <summary>
+    /// TPM configuration: with a shared runtime, uploads due within this window (ms) join the upload of another LogManager to the same collector, 0 to disable
+    /// </summary>
+    static constexpr const char* const CFG_INT_TPM_UPLOAD_ALIGN_WINDOW_MS = "uploadAlignWindowMs";
+
+    /// <summary>
+    /// TPM configuration: size packages and pace uploads from the observed request times, failures and backlog
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_TPM_ADAPTIVE_UPLOADS = "adaptiveUploads";
+
+    /// <summary>
+    /// TPM configuration: smallest package size (bytes) of adaptive uploads, the largest is maxBlobSize
+    /// </summary>
+    static constexpr const char* const CFG_INT_TPM_ADAPTIVE_MIN_UPLOAD_BYTES = "adaptiveMinUploadSize";
+
+    /// <summary>
+    /// TPM configuration: request duration (ms) above which adaptive uploads shrink the package
+    /// </summary>
+    static constexpr const char* const CFG_INT_TPM_ADAPTIVE_TARGET_REQUEST_MS = "adaptiveTargetRequestMs";
+
+    /// <summary>
+    /// Upload bandwidth configuration map
+    /// </summary>
+    static constexpr const char* const CFG_MAP_BANDWIDTH = "bandwidth";
+
+    /// <summary>
+    /// Upload bandwidth configuration: upload budget in bytes per second, 0 for no fixed limit
+    /// </summary>
+    static constexpr const char* const CFG_INT_BANDWIDTH_BYTES_PER_SEC = "bytesPerSecond";
+
+    /// <summary>
+    /// Upload bandwidth configuration: bytes that may be sent in a burst, 0 for one second of budget
+    /// </summary>
+    static constexpr const char* const CFG_INT_BANDWIDTH_BURST_BYTES = "burstBytes";
+
+    /// <summary>
+    /// Upload bandwidth configuration: percentage of the measured upload throughput telemetry may use, 0 to ignore the measurement
+    /// </summary>
+    static constexpr const char* const CFG_INT_BANDWIDTH_LINK_SHARE_PCT = "linkSharePercent";
+
+    /// <summary>
+    /// Upload bandwidth configuration: percentage of the budget reserved for Normal latency uploads, 0 to not pace them
+    /// </summary>
+    static constexpr const char* const CFG_INT_BANDWIDTH_NORMAL_PCT = "normalPercent";
+
+    /// <summary>
+    /// Upload bandwidth configuration: percentage of the budget reserved for CostDeferred latency uploads, 0 to not pace them
+    /// </summary>
+    static constexpr const char* const CFG_INT_BANDWIDTH_COST_DEFERRED_PCT = "costDeferredPercent";
+
+    /// <summary>
+    /// Upload bandwidth configuration: percentage of the budget reserved for RealTime latency uploads, 0 to not pace them
+    /// </summary>
+    static constexpr const char* const CFG_INT_BANDWIDTH_REALTIME_PCT = "realTimePercent";
+
+    /// <summary>
+    /// Upload bandwidth configuration: percentage of the budget reserved for Max latency uploads, 0 to not pace them
+    /// </summary>
+    static constexpr const char* const CFG_INT_BANDWIDTH_MAX_PCT = "maxPercent";
+
+    /// <summary>
+    /// Ingress sampling configuration map, applied before events are decorated and stored. May be updated with ILogManager::SetSamplingConfiguration
+    /// </summary>
+    static constexpr const char* const CFG_MAP_SAMPLING = "sampling";
+
+    /// <summary>
+    /// Sampling configuration: event property or context field whose value decides deterministically whether an event is sampled in
+    /// </summary>
+    static constexpr const char* const CFG_STR_SAMPLING_KEY = "key";
+
+    /// <summary>
+    /// Sampling configuration: percentage of events kept, 100 by default. Kept events have their popSample scaled down accordingly
+    /// </summary>
+    static constexpr const char* const CFG_INT_SAMPLING_PERCENT = "samplePercent";
+
+    /// <summary>
+    /// Sampling configuration: events per second allowed for each event name or tenant, 0 for no limit
+    /// </summary>
+    static constexpr const char* const CFG_INT_SAMPLING_EVENTS_PER_SEC = "eventsPerSecond";
+
+    /// <summary>
+    /// Sampling configuration: events allowed in a burst, 0 for one second of eventsPerSecond
+    /// </summary>
+    static constexpr const char* const CFG_INT_SAMPLING_BURST = "burst";
+
+    /// <summary>
+    /// Sampling configuration: map of event names to their own samplePercent, eventsPerSecond and burst
+    /// </summary>
+    static constexpr const char* const CFG_MAP_SAMPLING_EVENTS = "events";
+
+    /// <summary>
+    /// Sampling configuration: map of tenant tokens or tenant ids to the eventsPerSecond and burst of all their events
+    /// </summary>
+    static constexpr const char* const CFG_MAP_SAMPLING_TENANTS = "tenants";
+
     /// <summary>
     /// When enabled, the session timer is reset after session is completed, allowing for several session events in the duration of the SDK lifecycle
     /// </summary>
@@ -21,6 +21,7 @@
 #include "ISemanticContext.hpp"
 #include "LogConfiguration.hpp"
 #include "LogSessionData.hpp"
+#include "PipelineStageStats.hpp"
 
 #include "DebugEvents.hpp"
 #include "TransmitProfiles.hpp"
@@ -154,7 +155,9 @@ namespace MAT_NS_BEGIN
         {
         }
 
-        ///
+        /// <summary>
+        /// Applies the current snapshot of the ILogConfiguration, e.g. an updated CFG_MAP_SAMPLING map.
+        /// </summary>
         virtual void Configure() = 0;
 
         /// Retrieve an ISemanticContext interface through which to specify context information
@@ -429,6 +432,65 @@ namespace MAT_NS_BEGIN
         /// method if StartActivity returned true.
         /// </summary>
         virtual void EndActivity() = 0;
+
+        /// <summary>
+        /// Get the latency distribution of a telemetry pipeline stage, e.g. LogEvent to
+        /// offline storage per event, or upload initiated to acknowledged per batch.
+        /// </summary>
+        /// <param name="stage">Pipeline stage</param>
+        /// <param name="stats">Receives the stage latency snapshot, in microseconds</param>
+        /// <returns>STATUS_SUCCESS if the snapshot is available, STATUS_ENOTSUP otherwise.</returns>
+        virtual status_t GetPipelineStageStats(PipelineStage stage, PipelineStageStats& stats)
+        {
+            UNREFERENCED_PARAMETER(stage);
+            UNREFERENCED_PARAMETER(stats);
+            return STATUS_ENOTSUP;
+        }
+
+        /// <summary>
+        /// Get the duration of each shutdown phase, available once FlushAndTeardown has completed.
+        /// </summary>
+        /// <param name="stats">Receives the phase durations, in milliseconds</param>
+        /// <returns>STATUS_SUCCESS if the telemetry system was shut down, STATUS_ENOTSUP otherwise.</returns>
+        virtual status_t GetShutdownStats(ShutdownStats& stats)
+        {
+            UNREFERENCED_PARAMETER(stats);
+            return STATUS_ENOTSUP;
+        }
+
+        /// <summary>
+        /// Get the memory held by the telemetry pipelines of the process, see CFG_INT_MEMORY_BUDGET.
+        /// </summary>
+        /// <param name="stats">Receives the usage per pipeline stage, in bytes</param>
+        /// <returns>STATUS_SUCCESS, or STATUS_ENOTSUP if not supported by this log manager.</returns>
+        virtual status_t GetMemoryUsage(MemoryUsageStats& stats)
+        {
+            UNREFERENCED_PARAMETER(stats);
+            return STATUS_ENOTSUP;
+        }
+
+        /// <summary>
+        /// Set the callback told when the RAM queue crosses the backpressure watermarks,
+        /// CFG_INT_BACKPRESSURE_HIGH_PCT and CFG_INT_BACKPRESSURE_LOW_PCT. It runs on the thread
+        /// that crossed the watermark, possibly a logging thread, and must not block or log.
+        /// </summary>
+        /// <param name="callback">Receives true once saturated, false once drained, and the
+        /// RAM queue fill in percent. An empty callback unsets it.</param>
+        /// <returns>STATUS_SUCCESS, or STATUS_ENOTSUP if not supported by this log manager.</returns>
+        virtual status_t SetBackpressureCallback(std::function<void(bool saturated, unsigned fillPercent)> callback)
+        {
+            UNREFERENCED_PARAMETER(callback);
+            return STATUS_ENOTSUP;
+        }
+
+        /// <summary>
+        /// Whether the RAM queue has reached the high backpressure watermark and has not
+        /// drained to the low one since.
+        /// </summary>
+        virtual bool IsSaturated() const
+        {
+            return false;
+        }
     };
 
 }
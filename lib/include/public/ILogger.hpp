@@ -8,6 +8,7 @@
 #include "ctmacros.hpp"
 #include "Enums.hpp"
 #include "EventProperties.hpp"
+#include "TypedEvent.hpp"
 #include "ISemanticContext.hpp"
 #include "IEventFilterCollection.hpp"
 
@@ -185,6 +186,11 @@ Refer to https://osgwiki.com/wiki/Common_Schema_Event_Overrides for details on t
         /// </summary>
         std::map<long, long> buckets;
 
+        /// <summary>
+        /// [Optional] Estimated percentiles of the observations, e.g. 99 for the value that 99% of the observations do not exceed.
+        /// </summary>
+        std::map<unsigned, double> percentiles;
+
         /// <summary>
         /// An AggregatedMetricData constructor 
         /// that takes a string that contains the name of the aggregated metric,
@@ -619,6 +625,30 @@ Refer to https://osgwiki.com/wiki/Common_Schema_Event_Overrides for details on t
         /// Get collection of current event filters.
         /// </summary>
         virtual IEventFilterCollection const& GetEventFilters() const noexcept = 0;
+
+        /// <summary>
+        /// Logs an event declared with TypedEvent. Loggers of the SDK encode its fields
+        /// straight into the Bond payload; DebugEventListeners of EVT_LOG_EVENT do not
+        /// see them in the record. Other loggers log ToEventProperties().
+        /// </summary>
+        /// <param name="event">The typed event.</param>
+        virtual void LogTypedEvent(ITypedEvent const& event)
+        {
+            LogEvent(event.ToEventProperties());
+        }
+
+        /// <summary>
+        /// Logs a custom event like LogEvent, and reports what became of it. While the pipeline
+        /// is saturated (see ILogManager::IsSaturated) the event is shed instead of piling up
+        /// behind the flush to disk. Other loggers log the event and report it accepted.
+        /// </summary>
+        /// <param name="properties">Properties of this custom event, specified using an EventProperties object.</param>
+        /// <returns>One of the LogEventResult enumeration values.</returns>
+        virtual LogEventResult TryLogEvent(EventProperties const& properties)
+        {
+            LogEvent(properties);
+            return LogEventResult_Accepted;
+        }
     };
 
 
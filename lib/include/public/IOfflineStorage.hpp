@@ -346,6 +346,22 @@ namespace MAT_NS_BEGIN {
 
         virtual void ReleaseAllRecords() {};
 
+        /// <summary>
+        /// Tells whether the storage is open, so that settings and records on disk
+        /// can be accessed without waiting for it.
+        /// </summary>
+        virtual bool IsOpen() { return true; };
+
+        /// <summary>
+        /// Save pending in-memory records to persistent storage ahead of Shutdown
+        /// </summary>
+        /// <remarks>
+        /// Called once during teardown while the aborted uploads are still being
+        /// completed on the worker thread, so that Shutdown only has to save the
+        /// records those uploads give back.
+        /// </remarks>
+        virtual void FlushForShutdown() {};
+
     };
 
     // IOfflineStorage as Module. External offline storage implementations need to inherit from it.
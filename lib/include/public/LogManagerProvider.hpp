@@ -157,6 +157,17 @@ namespace MAT_NS_BEGIN
     /// </summary>
     typedef int64_t  evt_handle_t;
 
+    /// <summary>
+    /// Logger resolved for a (tenant token, source) pair of C API events.
+    /// Immutable once published, replaced as a whole when the pair changes.
+    /// </summary>
+    typedef struct capi_route_struct
+    {
+        std::string                      token;
+        std::string                      source;
+        ILogger*                         logger = nullptr;
+    } capi_route;
+
     /// <summary>
     /// C API client struct
     /// logmanager     - ILogManager pointer to SDK instance
@@ -164,6 +175,9 @@ namespace MAT_NS_BEGIN
     /// ctx_data       - original JSON configuration or token passed to mat_open
     /// http           - optional IHttpClient override instance
     /// taskDispatcher - optional ITaskDispatcher override instance
+    /// scope          - context scope of the loggers, resolved from config on open
+    /// route          - last logger route used by evt_log / evt_log_batch, accessed
+    ///                  with std::atomic_load / std::atomic_store only
     /// </summary>
     typedef struct capi_client_struct
     {
@@ -172,6 +186,8 @@ namespace MAT_NS_BEGIN
         std::string                      ctx_data;
         std::shared_ptr<IHttpClient>     http;
         std::shared_ptr<ITaskDispatcher> taskDispatcher;
+        std::string                      scope;
+        std::shared_ptr<const capi_route> route;
     } capi_client;
 
     /// <summary>
@@ -0,0 +1,204 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef PAYLOADSTREAMDECODER_HPP
+#define PAYLOADSTREAMDECODER_HPP
+//
+// Advanced functionality for Diagnostic Data Viewer and internal Unit Tests.
+// Lightweight alternative to PayloadDecoder: records are navigated in place
+// inside the Bond buffer instead of being materialized as CsProtocol::Record,
+// and upload bodies are walked record by record while they are being inflated.
+//
+#include "ctmacros.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace CsProtocol
+{
+    struct Record;
+};
+
+namespace MAT_NS_BEGIN {
+
+    namespace exporters {
+
+        /// <summary>
+        /// Non-owning reference to a string inside a serialized buffer.
+        /// Valid only as long as the buffer it points into.
+        /// </summary>
+        struct StringRef
+        {
+            const char* data = nullptr;
+            size_t size = 0;
+
+            std::string str() const
+            {
+                return std::string(data, size);
+            }
+
+            bool empty() const
+            {
+                return size == 0;
+            }
+
+            bool operator==(const char* other) const;
+        };
+
+        /// <summary>
+        /// Scalar view of a CsProtocol::Value. Array kinds are not expanded;
+        /// use RecordView::toRecord when the full value is needed.
+        /// </summary>
+        struct PropertyView
+        {
+            /// CsProtocol::ValueKind
+            int32_t type = 5;
+            StringRef stringValue;
+            int64_t longValue = 0;
+            double doubleValue = 0.0;
+            /// The first GUID of guidValue, 16 bytes
+            StringRef guidValue;
+            /// CsProtocol::PIIKind of the first attribute, 0 if none
+            int32_t piiKind = 0;
+        };
+
+        /// <summary>
+        /// Lazily navigated view of a Bond-serialized CsProtocol::Record.
+        /// parse() validates the record structure once and remembers where the
+        /// commonly inspected fields are, no strings or maps are allocated.
+        /// </summary>
+        class RecordView
+        {
+        public:
+            RecordView();
+
+            /// <summary>
+            /// Parses the record at the start of the buffer.
+            /// </summary>
+            /// <returns>false if the data is malformed or truncated (see isTruncated)</returns>
+            bool parse(const uint8_t* data, size_t size);
+
+            /// <summary>
+            /// true if the last parse() failed only because the buffer ended early.
+            /// </summary>
+            bool isTruncated() const { return m_truncated; }
+
+            /// <summary>
+            /// Serialized size of the record in bytes.
+            /// </summary>
+            size_t size() const { return m_size; }
+            const uint8_t* data() const { return m_data; }
+
+            StringRef ver() const { return m_ver; }
+            StringRef name() const { return m_name; }
+            int64_t time() const { return m_time; }
+            double popSample() const { return m_popSample; }
+            StringRef iKey() const { return m_iKey; }
+            int64_t flags() const { return m_flags; }
+            StringRef cV() const { return m_cV; }
+            StringRef baseType() const { return m_baseType; }
+
+            /// <summary>
+            /// Looks up a custom property in the first data entry of the record.
+            /// </summary>
+            bool getProperty(const char* name, PropertyView& value) const;
+
+            /// <summary>
+            /// Enumerates custom properties of the first data entry until the callback returns false.
+            /// </summary>
+            bool forEachProperty(const std::function<bool(const StringRef&, const PropertyView&)>& callback) const;
+
+            /// <summary>
+            /// Fully deserializes the record, for the few cases that need all of it.
+            /// </summary>
+            bool toRecord(CsProtocol::Record& record) const;
+
+        protected:
+            void clear();
+
+            const uint8_t* m_data;
+            size_t m_size;
+            bool m_truncated;
+
+            StringRef m_ver;
+            StringRef m_name;
+            int64_t m_time;
+            double m_popSample;
+            StringRef m_iKey;
+            int64_t m_flags;
+            StringRef m_cV;
+            StringRef m_baseType;
+
+            /// Offset of the first Data struct of the "data" field, 0 if absent
+            size_t m_dataOffset;
+        };
+
+        /// <summary>
+        /// Walks an upload body record by record. Input can be fed in arbitrary
+        /// chunks; compressed input is inflated incrementally, so neither the full
+        /// uncompressed body nor any CsProtocol::Record is ever built.
+        /// </summary>
+        class PayloadStreamDecoder
+        {
+        public:
+            typedef std::function<bool(const RecordView&)> RecordCallback;
+
+            /// <summary>
+            /// Creates a decoder.
+            /// <param name="callback">Invoked for every complete record; return false to stop decoding</param>
+            /// <param name="compressed">Input is compressed (raw deflate, as sent by the SDK)</param>
+            /// <param name="isGzip">Input is gzip-compressed rather than raw deflate</param>
+            /// </summary>
+            PayloadStreamDecoder(RecordCallback callback, bool compressed = true, bool isGzip = false);
+            ~PayloadStreamDecoder();
+
+            PayloadStreamDecoder(const PayloadStreamDecoder&) = delete;
+            PayloadStreamDecoder& operator=(const PayloadStreamDecoder&) = delete;
+
+            /// <summary>
+            /// Feeds the next chunk of the body.
+            /// </summary>
+            /// <returns>false on malformed input or if the callback stopped decoding</returns>
+            bool write(const uint8_t* data, size_t size);
+
+            /// <summary>
+            /// Completes decoding.
+            /// </summary>
+            /// <returns>true if the body ended at a record boundary</returns>
+            bool finish();
+
+            size_t recordCount() const { return m_records; }
+
+        protected:
+            bool drain();
+
+            RecordCallback m_callback;
+            bool m_compressed;
+            void* m_stream;
+            bool m_streamEnd;
+            bool m_failed;
+            std::vector<uint8_t> m_buffer;
+            size_t m_offset;
+            size_t m_records;
+        };
+
+        /// <summary>
+        /// Invokes the callback for every record of an upload body.
+        /// <param name="in">Payload data, e.g. HTTPS POST request body</param>
+        /// <param name="callback">Invoked for every record; return false to stop</param>
+        /// <param name="compressed">Parameter that specifies that the payload data is compressed (optional, default true)</param>
+        /// </summary>
+        /// <returns>
+        /// Returns true if the whole payload was decoded.
+        /// </returns>
+        bool ForEachRecord(const std::vector<uint8_t>& in, const PayloadStreamDecoder::RecordCallback& callback, bool compressed = true);
+
+    };
+
+} MAT_NS_END
+
+#endif
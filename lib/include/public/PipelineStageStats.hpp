@@ -0,0 +1,106 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef PIPELINESTAGESTATS_HPP
+#define PIPELINESTAGESTATS_HPP
+
+#include "ctmacros.hpp"
+
+#include <cstdint>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Stages of the telemetry pipeline that are timed by the SDK.
+    /// Per-event stages start when the event is handed to the log manager,
+    /// per-batch stages start when the transmission policy initiates an upload.
+    /// </summary>
+    enum PipelineStage
+    {
+        /// <summary>Per event: LogEvent to Bond record serialized.</summary>
+        PipelineStage_Serialize = 0,
+        /// <summary>Per event: serialized record to accepted by offline storage.</summary>
+        PipelineStage_Store,
+        /// <summary>
+        /// Per event: LogEvent to handed off to offline storage (end-to-end). With the RAM queue
+        /// enabled the record is not durable yet, it reaches disk when the queue is flushed.
+        /// </summary>
+        PipelineStage_EventToQueue,
+        /// <summary>Per batch: upload initiated to records retrieved and packaged.</summary>
+        PipelineStage_Retrieve,
+        /// <summary>Per batch: package ready to HTTP request encoded (includes compression).</summary>
+        PipelineStage_Encode,
+        /// <summary>Per batch: HTTP request encoded to HTTP response received.</summary>
+        PipelineStage_Send,
+        /// <summary>Per batch: HTTP response received to response decoded.</summary>
+        PipelineStage_Decode,
+        /// <summary>Per batch: response decoded to records removed from offline storage.</summary>
+        PipelineStage_Ack,
+        /// <summary>Per batch: upload initiated to records acknowledged (end-to-end).</summary>
+        PipelineStage_RetrieveToAck,
+        /// <summary>Number of stages.</summary>
+        PipelineStage_Max
+    };
+
+    /// <summary>
+    /// Latency distribution snapshot of a single pipeline stage, in microseconds.
+    /// Percentiles are accurate to within ~6% of the recorded value.
+    /// </summary>
+    struct PipelineStageStats
+    {
+        uint64_t count = 0;
+        uint64_t minUs = 0;
+        uint64_t maxUs = 0;
+        uint64_t meanUs = 0;
+        uint64_t p50Us = 0;
+        uint64_t p90Us = 0;
+        uint64_t p99Us = 0;
+        uint64_t p999Us = 0;
+    };
+
+    /// <summary>
+    /// Duration of the phases of the last telemetry system shutdown, in milliseconds.
+    /// </summary>
+    struct ShutdownStats
+    {
+        /// <summary>Waiting for the in-flight uploads, bounded by CFG_INT_MAX_TEARDOWN_TIME.</summary>
+        int64_t uploadMs = 0;
+        /// <summary>Canceling the HTTP requests while the in-memory events are saved to disk.</summary>
+        int64_t abortMs = 0;
+        /// <summary>Waiting for the callbacks of the canceled uploads.</summary>
+        int64_t stopMs = 0;
+        /// <summary>Waiting for the queued worker thread callbacks.</summary>
+        int64_t workerMs = 0;
+        /// <summary>Saving the events given back by the canceled uploads and closing offline storage.</summary>
+        int64_t storageMs = 0;
+        /// <summary>Whole shutdown.</summary>
+        int64_t totalMs = 0;
+    };
+
+    /// <summary>
+    /// Memory accounted against the process-wide CFG_INT_MEMORY_BUDGET, in bytes.
+    /// </summary>
+    struct MemoryUsageStats
+    {
+        /// <summary>The budget, 0 if none is set. Nothing is accounted then.</summary>
+        uint64_t limitBytes = 0;
+        uint64_t usedBytes = 0;
+        /// <summary>Highest usedBytes since the budget was set.</summary>
+        uint64_t peakBytes = 0;
+        /// <summary>Records in the RAM queue.</summary>
+        uint64_t ramQueueBytes = 0;
+        /// <summary>Serialized events waiting for the hand-off into storage.</summary>
+        uint64_t incomingEventBytes = 0;
+        /// <summary>Splicer buffers of the packages being built.</summary>
+        uint64_t packagingBytes = 0;
+        /// <summary>Spliced and compressed bodies of the uploads in flight.</summary>
+        uint64_t uploadBodyBytes = 0;
+        /// <summary>HTTP response bodies waiting to be decoded.</summary>
+        uint64_t responseBytes = 0;
+    };
+
+}
+MAT_NS_END
+
+#endif
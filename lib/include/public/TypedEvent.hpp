@@ -0,0 +1,248 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef TYPEDEVENT_HPP
+#define TYPEDEVENT_HPP
+
+#include "ctmacros.hpp"
+#include "EventProperties.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Name of a typed event field, with its Bond compact binary length prefix
+    /// computed at compile time from the string literal.
+    /// </summary>
+    struct TypedFieldKey
+    {
+        const char* name;
+        uint32_t    size;
+        uint8_t     prefix[2];
+        uint8_t     prefixSize;
+
+        template<size_t N>
+        constexpr TypedFieldKey(const char (&literal)[N]) :
+            name(literal),
+            size(N - 1),
+            prefix { static_cast<uint8_t>((N - 1 < 128) ? (N - 1) : (((N - 1) & 127) | 128)), static_cast<uint8_t>((N - 1) >> 7) },
+            prefixSize((N - 1 < 128) ? 1 : 2)
+        {
+            static_assert(N - 1 < 16384, "Field name too long");
+        }
+    };
+
+    /// <summary>
+    /// Receives the fields of a typed event, see TypedEvent::Fields.
+    /// </summary>
+    class ITypedEventSink
+    {
+    public:
+        virtual ~ITypedEventSink() noexcept = default;
+
+        virtual void AddString(TypedFieldKey const& key, std::string const& value, PiiKind piiKind) = 0;
+        virtual void AddInt64(TypedFieldKey const& key, int64_t value) = 0;
+        virtual void AddDouble(TypedFieldKey const& key, double value) = 0;
+        virtual void AddBool(TypedFieldKey const& key, bool value) = 0;
+        virtual void AddTime(TypedFieldKey const& key, time_ticks_t value) = 0;
+        virtual void AddGuid(TypedFieldKey const& key, GUID_t const& value) = 0;
+    };
+
+    /// <summary>
+    /// Front end passed to TypedEvent::Fields, mapping C++ field types to the
+    /// property types of the dynamic EventProperties path.
+    /// </summary>
+    class TypedEventFields
+    {
+    public:
+        explicit TypedEventFields(ITypedEventSink& sink) :
+            m_sink(sink)
+        {
+        }
+
+        template<size_t N>
+        void Add(const char (&name)[N], std::string const& value, PiiKind piiKind = PiiKind_None)
+        {
+            m_sink.AddString(TypedFieldKey(name), value, piiKind);
+        }
+
+        template<size_t N>
+        void Add(const char (&name)[N], const char* value, PiiKind piiKind = PiiKind_None)
+        {
+            m_sink.AddString(TypedFieldKey(name), std::string((value != nullptr) ? value : ""), piiKind);
+        }
+
+        template<size_t N, typename T>
+        typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type
+        Add(const char (&name)[N], T value)
+        {
+            m_sink.AddInt64(TypedFieldKey(name), static_cast<int64_t>(value));
+        }
+
+        template<size_t N, typename T>
+        typename std::enable_if<std::is_floating_point<T>::value>::type
+        Add(const char (&name)[N], T value)
+        {
+            m_sink.AddDouble(TypedFieldKey(name), static_cast<double>(value));
+        }
+
+        template<size_t N>
+        void Add(const char (&name)[N], bool value)
+        {
+            m_sink.AddBool(TypedFieldKey(name), value);
+        }
+
+        template<size_t N>
+        void Add(const char (&name)[N], time_ticks_t value)
+        {
+            m_sink.AddTime(TypedFieldKey(name), value);
+        }
+
+        template<size_t N>
+        void Add(const char (&name)[N], GUID_t const& value)
+        {
+            m_sink.AddGuid(TypedFieldKey(name), value);
+        }
+
+    protected:
+        ITypedEventSink& m_sink;
+    };
+
+    /// <summary>
+    /// An event whose name, latency, persistence and Part C fields are fixed at compile time.
+    /// ILogger::LogTypedEvent encodes its fields straight into Bond, without building
+    /// EventProperties or a CsProtocol properties map; the output on the wire is the same
+    /// as logging ToEventProperties() with ILogger::LogEvent.
+    /// </summary>
+    class ITypedEvent
+    {
+    public:
+        virtual ~ITypedEvent() noexcept = default;
+
+        virtual const char* GetName() const = 0;
+        virtual EventLatency GetLatency() const = 0;
+        virtual EventPersistence GetPersistence() const = 0;
+
+        /// <summary>
+        /// Passes every field to the sink. The fields are Part C properties.
+        /// </summary>
+        virtual void VisitFields(ITypedEventSink& sink) const = 0;
+
+        /// <summary>
+        /// Builds the equivalent EventProperties, for loggers without a direct encoder.
+        /// </summary>
+        EventProperties ToEventProperties() const
+        {
+            EventProperties properties(GetName());
+            properties.SetLatency(GetLatency());
+            properties.SetPersistence(GetPersistence());
+            PropertiesSink sink(properties);
+            VisitFields(sink);
+            return properties;
+        }
+
+    protected:
+        class PropertiesSink : public ITypedEventSink
+        {
+        public:
+            explicit PropertiesSink(EventProperties& properties) :
+                m_properties(properties)
+            {
+            }
+
+            virtual void AddString(TypedFieldKey const& key, std::string const& value, PiiKind piiKind) override
+            {
+                m_properties.SetProperty(std::string(key.name, key.size), value, piiKind);
+            }
+
+            virtual void AddInt64(TypedFieldKey const& key, int64_t value) override
+            {
+                m_properties.SetProperty(std::string(key.name, key.size), value);
+            }
+
+            virtual void AddDouble(TypedFieldKey const& key, double value) override
+            {
+                m_properties.SetProperty(std::string(key.name, key.size), value);
+            }
+
+            virtual void AddBool(TypedFieldKey const& key, bool value) override
+            {
+                m_properties.SetProperty(std::string(key.name, key.size), value);
+            }
+
+            virtual void AddTime(TypedFieldKey const& key, time_ticks_t value) override
+            {
+                m_properties.SetProperty(std::string(key.name, key.size), value);
+            }
+
+            virtual void AddGuid(TypedFieldKey const& key, GUID_t const& value) override
+            {
+                m_properties.SetProperty(std::string(key.name, key.size), value);
+            }
+
+        protected:
+            EventProperties& m_properties;
+        };
+    };
+
+    /// <summary>
+    /// Base of typed event declarations. TEvent provides the name and the fields,
+    /// and may hide Latency() and Persistence():
+    ///
+    ///     struct PageLoadEvent : TypedEvent&lt;PageLoadEvent&gt;
+    ///     {
+    ///         int64_t durationMs = 0;
+    ///         std::string url;
+    ///
+    ///         static const char* Name() { return "PageLoad"; }
+    ///         void Fields(TypedEventFields&amp; fields) const
+    ///         {
+    ///             fields.Add("durationMs", durationMs);
+    ///             fields.Add("url", url, PiiKind_URI);
+    ///         }
+    ///     };
+    /// </summary>
+    template<typename TEvent>
+    class TypedEvent : public ITypedEvent
+    {
+    public:
+        static EventLatency Latency()
+        {
+            return EventLatency_Normal;
+        }
+
+        static EventPersistence Persistence()
+        {
+            return EventPersistence_Normal;
+        }
+
+        virtual const char* GetName() const override
+        {
+            return TEvent::Name();
+        }
+
+        virtual EventLatency GetLatency() const override
+        {
+            return TEvent::Latency();
+        }
+
+        virtual EventPersistence GetPersistence() const override
+        {
+            return TEvent::Persistence();
+        }
+
+        virtual void VisitFields(ITypedEventSink& sink) const override
+        {
+            TypedEventFields fields(sink);
+            static_cast<TEvent const&>(*this).Fields(fields);
+        }
+    };
+
+} MAT_NS_END
+
+#endif // TYPEDEVENT_HPP
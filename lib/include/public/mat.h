@@ -60,7 +60,8 @@ extern "C" {
         EVT_OP_VERSION = 0x0000000B,
         EVT_OP_OPEN_WITH_PARAMS = 0x0000000C,
         EVT_OP_FLUSHANDTEARDOWN = 0x0000000D,
-        EVT_OP_MAX = EVT_OP_FLUSHANDTEARDOWN + 1,
+        EVT_OP_LOG_BATCH = 0x0000000E,
+        EVT_OP_MAX = EVT_OP_LOG_BATCH + 1,
     } evt_call_t;
 
     typedef enum evt_prop_t
@@ -522,6 +523,26 @@ extern "C" {
         return evt_api_call(&ctx);
     }
 
+    /**
+     * <summary>
+     * Logs a batch of telemetry events with one call into the SDK.
+     * Last item in each evt_prop array must be { .name = NULL, .type = TYPE_NULL }
+     * </summary>
+     * <param name="handle">SDK handle.</param>
+     * <param name="count">Number of events in the batch.</param>
+     * <param name="evts">Array of event properties arrays.</param>
+     * <returns>Status code of the first event that failed, or 0. Other events are logged anyway.</returns>
+     */
+    static inline evt_status_t evt_log_batch(evt_handle_t handle, uint32_t count, evt_prop** evts)
+    {
+        evt_context_t ctx;
+        ctx.call = EVT_OP_LOG_BATCH;
+        ctx.handle = handle;
+        ctx.data = (void *)evts;
+        ctx.size = count;
+        return evt_api_call(&ctx);
+    }
+
     /* This macro automagically calculates the array size and passes it down to evt_log_s.
      * Developers don't have to calculate the number of event properties passed down to
      *'Log Event' API call utilizing the concept of Secure Template Overloads:
@@ -6,9 +6,14 @@
 
 #include "utils/StringUtils.hpp"
 #include <climits>
+#include <functional>
+#include <thread>
 
 namespace MAT_NS_BEGIN {
 
+    // Upper bound for the number of RAM queue shards
+    static const unsigned MaxShards = 64;
+
     MATSDK_LOG_INST_COMPONENT_CLASS(MemoryStorage, "EventsSDK.MemoryStorage", "Events telemetry client - MemoryStorage class");
 
     MemoryStorage::MemoryStorage(ILogManager & logManager, IRuntimeConfig & runtimeConfig) :
@@ -18,6 +23,53 @@ namespace MAT_NS_BEGIN {
         m_size(0),
         m_lastReadCount(0)
     {
+        unsigned shards = m_config[CFG_INT_RAM_QUEUE_SHARDS];
+        if (shards == 0)
+        {
+            shards = std::thread::hardware_concurrency();
+        }
+        shards = std::max(1u, std::min(shards, MaxShards));
+        for (unsigned i = 0; i < shards; i++)
+        {
+            m_shards.emplace_back(new Shard());
+        }
+        LOG_TRACE("RAM queue uses %u shard(s)", shards);
+    }
+
+    /// <summary>
+    /// Picks the shard of the calling thread. The same thread always lands
+    /// on the same shard, so its records keep their relative order.
+    /// </summary>
+    MemoryStorage::Shard& MemoryStorage::shardForCurrentThread()
+    {
+        if (m_shards.size() == 1)
+        {
+            return *m_shards[0];
+        }
+        uint64_t hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+        // Thread ids are often aligned addresses: mix the bits before taking the modulo
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return *m_shards[static_cast<size_t>(hash % m_shards.size())];
+    }
+
+    void MemoryStorage::lockAllShards(std::vector<std::unique_lock<std::mutex>>& locks) const
+    {
+        locks.reserve(m_shards.size());
+        for (auto const& shard : m_shards)
+        {
+            locks.emplace_back(shard->lock);
+        }
+    }
+
+    void MemoryStorage::decreaseSize(size_t bytes)
+    {
+        size_t current = m_size.load();
+        while (!m_size.compare_exchange_weak(current, current - std::min(current, bytes)))
+        {
+        }
+        m_budget.Remove(bytes);
     }
     
     /// <summary>
@@ -42,10 +94,16 @@ namespace MAT_NS_BEGIN {
     {
         LOCKGUARD(m_reserved_lock);
         LOCKGUARD(m_records_lock);
+        std::vector<std::unique_lock<std::mutex>> locks;
+        lockAllShards(locks);
 
         for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max); latency++)
         {
-            size_t numRecords = m_records[latency].size();
+            size_t numRecords = 0;
+            for (auto const& shard : m_shards)
+            {
+                numRecords += shard->records[latency].size();
+            }
             if (numRecords)
             {
                 // OfflineStorageHandler high-level wrapper must flush these on graceful shutdown
@@ -96,15 +154,21 @@ namespace MAT_NS_BEGIN {
         if (record.latency == EventLatency_Off)
             return false;
 
-        LOCKGUARD(m_records_lock);
-        m_size += record.blob.size() + sizeof(record); // approximate contents size
+        // Accounted before the record becomes visible to readers, so that
+        // the size never drops below what is actually queued
+        size_t recordSize = record.blob.size() + sizeof(record); // approximate contents size
+        m_size += recordSize;
+        m_budget.Add(recordSize);
+
+        Shard& shard = shardForCurrentThread();
+        LOCKGUARD(shard.lock);
 
 #ifdef DEBUG_DUPLICATE_ROUTES
-        if (contains(m_records[record.latency], record))
+        if (contains(shard.records[record.latency], record))
             LOG_WARN("Vector already contains this element!");
 #endif
 
-        m_records[record.latency].push_back(std::move(record));
+        shard.records[record.latency].push_back(std::move(record));
         return true;
     }
 
@@ -145,13 +209,29 @@ namespace MAT_NS_BEGIN {
 
         LOCKGUARD(m_reserved_lock);
         LOCKGUARD(m_records_lock);
+        std::vector<std::unique_lock<std::mutex>> locks;
+        lockAllShards(locks);
         m_lastReadCount = 0;
         // Start processing events of critical latency first
         for (int latency = static_cast<int>(EventLatency_Max); (latency >= static_cast<int>(minLatency)) && (maxCount); latency--)
         {
-            while (maxCount && (m_records[latency]).size())
+            while (maxCount)
             {
-                StorageRecord & record = m_records[latency].back();
+                // Merge the shards: newest record first, as with a single queue
+                std::vector<StorageRecord>* source = nullptr;
+                for (auto& shard : m_shards)
+                {
+                    auto& records = shard->records[latency];
+                    if (!records.empty() && ((source == nullptr) || (records.back().timestamp > source->back().timestamp)))
+                    {
+                        source = &records;
+                    }
+                }
+                if (source == nullptr)
+                {
+                    break;
+                }
+                StorageRecord & record = source->back();
 
                 size_t recordSize = record.blob.size() + sizeof(record);
                 StorageRecord forConsumer(record);
@@ -168,8 +248,8 @@ namespace MAT_NS_BEGIN {
                 if (leaseTimeMs) {
                     m_reserved_records[record.id] = std::move(record); // move to reserved
                 }
-                m_records[latency].pop_back();
-                m_size -= std::min(m_size, recordSize);
+                source->pop_back();
+                decreaseSize(recordSize);
                 maxCount--;
                 m_lastReadCount++;
             }
@@ -209,14 +289,20 @@ namespace MAT_NS_BEGIN {
         }
         {
             LOCKGUARD(m_records_lock);
-            for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max); latency++)
+            std::vector<std::unique_lock<std::mutex>> locks;
+            lockAllShards(locks);
+            for (auto& shard : m_shards)
             {
-                auto& records = m_records[latency];
-                if (records.size()) {
-                    records.clear();
+                for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max); latency++)
+                {
+                    auto& records = shard->records[latency];
+                    if (records.size()) {
+                        records.clear();
+                    }
                 }
             }
             m_size = 0;
+            m_budget.Reset();
             m_lastReadCount = 0;
         }
 
@@ -262,21 +348,26 @@ namespace MAT_NS_BEGIN {
         // Delete from ram queue, which is a bigger list
         {
             LOCKGUARD(m_records_lock);
-            for (unsigned latency = EventLatency_Off; latency <= EventLatency_Max;  latency++)
+            std::vector<std::unique_lock<std::mutex>> locks;
+            lockAllShards(locks);
+            for (auto& shard : m_shards)
             {
-                auto& records = m_records[latency];
-                auto it = records.begin();
-                // remove from records all ids that were found in the set
-                while (it != records.end()) {
-                    auto &v = *it;
-                    if (matcher(v, whereFilter))
-                    {
-                        size_t recordSize = v.blob.size() + sizeof(v);
-                        m_size -= std::min(m_size, recordSize);
-                        it = records.erase(it);
-                        continue;
+                for (unsigned latency = EventLatency_Off; latency <= EventLatency_Max;  latency++)
+                {
+                    auto& records = shard->records[latency];
+                    auto it = records.begin();
+                    // remove from records all ids that were found in the set
+                    while (it != records.end()) {
+                        auto &v = *it;
+                        if (matcher(v, whereFilter))
+                        {
+                            size_t recordSize = v.blob.size() + sizeof(v);
+                            decreaseSize(recordSize);
+                            it = records.erase(it);
+                            continue;
+                        }
+                        ++it;
                     }
-                    ++it;
                 }
             }
         }
@@ -316,32 +407,37 @@ namespace MAT_NS_BEGIN {
         }
 
         {
-            // Delete from ram queue (m_records[])
+            // Delete from ram queue (all shards)
             LOCKGUARD(m_records_lock);
+            std::vector<std::unique_lock<std::mutex>> locks;
+            lockAllShards(locks);
 
             // convert vector of ids to unordered set
             std::unordered_set<StorageRecordId> idSet(ids.begin(), ids.end());
 
-            // For each latency - delete from current unreserved records
-            for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max); latency++)
+            // For each shard and latency - delete from current unreserved records
+            for (auto& shard : m_shards)
             {
-                auto& records = m_records[latency];
-                if (records.size() && idSet.size())
+                for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max); latency++)
                 {
-                    auto it = records.begin();
-                    // remove from records all ids that were found in the set
-                    while (it != records.end()) {
-                        auto &v = *it;
-                        if (idSet.count(v.id))
-                        {
-                            // record id appears once only, so remove from set
-                            idSet.erase(v.id);
-                            size_t recordSize = v.blob.size() + sizeof(v);
-                            m_size -= std::min(m_size, recordSize);
-                            it = records.erase(it);
-                            continue;
+                    auto& records = shard->records[latency];
+                    if (records.size() && idSet.size())
+                    {
+                        auto it = records.begin();
+                        // remove from records all ids that were found in the set
+                        while (it != records.end()) {
+                            auto &v = *it;
+                            if (idSet.count(v.id))
+                            {
+                                // record id appears once only, so remove from set
+                                idSet.erase(v.id);
+                                size_t recordSize = v.blob.size() + sizeof(v);
+                                decreaseSize(recordSize);
+                                it = records.erase(it);
+                                continue;
+                            }
+                            ++it;
                         }
-                        ++it;
                     }
                 }
             }
@@ -449,12 +545,11 @@ namespace MAT_NS_BEGIN {
     /// Approximate ram queue size
     /// </returns>
     /// <remarks>
-    /// Called from the internal worker thread.
+    /// Lock-free: producers on other shards may be adding records concurrently.
     /// </remarks>
     size_t MemoryStorage::GetSize()
     {
-        LOCKGUARD(m_records_lock);
-        return m_size;
+        return m_size.load();
     }
 
     /// <summary>
@@ -464,16 +559,19 @@ namespace MAT_NS_BEGIN {
     /// <returns></returns>
     size_t MemoryStorage::GetRecordCount(EventLatency latency) const
     {
-        LOCKGUARD(m_records_lock);
         size_t numRecords = 0;
-        if (latency == EventLatency_Unspecified)
-        {
-            for (unsigned lat = EventLatency_Off; lat <= EventLatency_Max; lat++)
-                numRecords += m_records[lat].size();
-        }
-        else
+        for (auto const& shard : m_shards)
         {
-            numRecords = m_records[latency].size();
+            LOCKGUARD(shard->lock);
+            if (latency == EventLatency_Unspecified)
+            {
+                for (unsigned lat = EventLatency_Off; lat <= EventLatency_Max; lat++)
+                    numRecords += shard->records[lat].size();
+            }
+            else
+            {
+                numRecords += shard->records[latency].size();
+            }
         }
         return numRecords;
     }
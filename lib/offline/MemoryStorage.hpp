@@ -14,8 +14,10 @@
 #include "api/IRuntimeConfig.hpp"
 
 #include "ILogManager.hpp"
+#include "system/MemoryBudget.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <map>
@@ -69,6 +71,8 @@ namespace MAT_NS_BEGIN {
 
         virtual size_t GetReservedCount();
 
+        size_t GetShardCount() const { return m_shards.size(); }
+
         virtual std::vector<StorageRecord> GetRecords(bool shutdown = false, EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0) override;
 
         virtual bool ResizeDb() override;
@@ -81,9 +85,27 @@ namespace MAT_NS_BEGIN {
         IRuntimeConfig&             m_config;
         ILogManager&                m_logManager;
 
+        /// <summary>
+        /// One slice of the RAM queue. Producers only lock the shard picked
+        /// for their thread, so concurrent StoreRecord calls rarely contend.
+        /// </summary>
+        struct Shard
+        {
+            mutable std::mutex          lock;
+            std::vector<StorageRecord>  records[EventLatency_Max+1];
+        };
+
+        /// <summary>
+        /// Serializes readers and maintenance operations. When held together
+        /// with shard locks, it is taken first and shards are locked in index order.
+        /// </summary>
         mutable std::mutex          m_records_lock;
-        std::vector<StorageRecord>  m_records[EventLatency_Max+1];
-        
+        std::vector<std::unique_ptr<Shard>> m_shards;
+
+        Shard& shardForCurrentThread();
+        void lockAllShards(std::vector<std::unique_lock<std::mutex>>& locks) const;
+        void decreaseSize(size_t bytes);
+
         /// <summary>
         /// Contains reserved (aka in-flight) records.
         /// Current storage interface API requires deletion and release by StorageRecordId.
@@ -91,7 +113,9 @@ namespace MAT_NS_BEGIN {
         std::mutex                  m_reserved_lock;
         std::map<StorageRecordId, StorageRecord> m_reserved_records;
 
-        size_t                      m_size;
+        std::atomic<size_t>         m_size;
+        // m_size as accounted to the process memory budget
+        MemoryReservation           m_budget { MemoryCategory_RamQueue };
 
         MATSDK_LOG_DECL_COMPONENT_CLASS();
 
@@ -7,6 +7,7 @@
 #include "OfflineStorageFactory.hpp"
 
 #include "offline/MemoryStorage.hpp"
+#include "system/MemoryBudget.hpp"
 
 #include "ILogManager.hpp"
 #include <algorithm>
@@ -28,16 +29,22 @@ namespace MAT_NS_BEGIN {
         m_flushPending(false),
         m_offlineStorageMemory(nullptr),
         m_offlineStorageDisk(nullptr),
+        m_diskReady(false),
+        m_pendingScrubAll(false),
         m_readFromMemory(false),
         m_lastReadCount(0),
         m_shutdownStarted(false),
         m_memoryDbSize(0),
         m_queryDbSize(0),
-        m_isStorageFullNotificationSend(false)
+        m_isStorageFullNotificationSend(false),
+        m_saturated(false)
     {
         // TODO: [MG] - OfflineStorage_SQLite.cpp is performing similar checks
         uint32_t percentage = m_config[CFG_INT_RAMCACHE_FULL_PCT];
         uint32_t cacheMemorySizeLimitInBytes = m_config[CFG_INT_RAM_QUEUE_SIZE];
+        m_memoryDbSize = cacheMemorySizeLimitInBytes;
+        m_backpressureHighPct = m_config[CFG_INT_BACKPRESSURE_HIGH_PCT];
+        m_backpressureLowPct = m_config[CFG_INT_BACKPRESSURE_LOW_PCT];
         if (percentage > 0 && percentage <= 100)
         {
             m_memoryDbSizeNotificationLimit = (percentage * cacheMemorySizeLimitInBytes) / 100;
@@ -69,6 +76,7 @@ namespace MAT_NS_BEGIN {
 
     OfflineStorageHandler::~OfflineStorageHandler()
     {
+        WaitForDiskOpen();
         WaitForFlush();
         if (nullptr != m_offlineStorageMemory)
         {
@@ -85,11 +93,15 @@ namespace MAT_NS_BEGIN {
         m_observer = &observer;
         uint32_t cacheMemorySizeLimitInBytes = m_config[CFG_INT_RAM_QUEUE_SIZE];
 
-        m_offlineStorageDisk = OfflineStorageFactory::Create(m_logManager, m_config);
-        if (m_offlineStorageDisk)
+        WaitForDiskOpen();
+        m_diskReady = false;
+        m_diskOpenedType.clear();
         {
-            m_offlineStorageDisk->Initialize(*this);
+            LOCKGUARD(m_pendingScrubLock);
+            m_pendingScrubs.clear();
+            m_pendingScrubAll = false;
         }
+        m_offlineStorageDisk = CreateDiskStorage();
 
         // TODO: [MG] - consider passing m_offlineStorageDisk to m_offlineStorageMemory,
         // so that the Flush() op on memory storage leads to saving unflushed events to
@@ -101,18 +113,115 @@ namespace MAT_NS_BEGIN {
         }
 
         m_shutdownStarted = false;
+
+        // Opening a large database may take a while. In async mode the events are
+        // accepted into the RAM queue meanwhile, and flushed to disk once it is open.
+        if (m_offlineStorageDisk && m_offlineStorageMemory && m_config[CFG_BOOL_ASYNC_STORAGE_OPEN])
+        {
+            LOCKGUARD(m_diskOpenLock);
+            m_diskOpenThread = std::thread(&OfflineStorageHandler::OpenDisk, this);
+        }
+        else
+        {
+            OpenDisk();
+        }
         LOG_TRACE("Initializing offline storage handler");
     }
 
+    std::shared_ptr<IOfflineStorage> OfflineStorageHandler::CreateDiskStorage()
+    {
+        return OfflineStorageFactory::Create(m_logManager, m_config);
+    }
+
+    void OfflineStorageHandler::OpenDisk()
+    {
+        if (m_offlineStorageDisk)
+        {
+            m_offlineStorageDisk->Initialize(*this);
+        }
+
+        std::vector<std::map<std::string, std::string>> scrubs;
+        bool scrubAll;
+        {
+            LOCKGUARD(m_pendingScrubLock);
+            m_diskReady = true;
+            scrubs.swap(m_pendingScrubs);
+            scrubAll = m_pendingScrubAll;
+            m_pendingScrubAll = false;
+        }
+        if (m_offlineStorageDisk)
+        {
+            if (scrubAll)
+            {
+                m_offlineStorageDisk->DeleteAllRecords();
+            }
+            for (auto const& whereFilter : scrubs)
+            {
+                m_offlineStorageDisk->DeleteRecords(whereFilter);
+            }
+        }
+        if (!m_diskOpenedType.empty())
+        {
+            m_observer->OnStorageOpened(m_diskOpenedType);
+        }
+
+        // Move what has been buffered above the RAM queue limit while opening
+        if ((m_offlineStorageMemory != nullptr) && !m_shutdownStarted)
+        {
+            uint32_t cacheMemorySizeLimitInBytes = m_config[CFG_INT_RAM_QUEUE_SIZE];
+            if (m_offlineStorageMemory->GetSize() > cacheMemorySizeLimitInBytes)
+            {
+                RequestFlush();
+            }
+        }
+    }
+
+    void OfflineStorageHandler::WaitForDiskOpen()
+    {
+        LOCKGUARD(m_diskOpenLock);
+        // The open callbacks may come back here on the opening thread itself
+        if (m_diskOpenThread.joinable() && (m_diskOpenThread.get_id() != std::this_thread::get_id()))
+        {
+            LOG_INFO("Waiting for offline storage to open...");
+            m_diskOpenThread.join();
+        }
+    }
+
+    /// <summary>
+    /// Queues a scrub of the disk storage if it is still opening, so that the
+    /// caller (possibly the worker thread) does not wait for the open.
+    /// </summary>
+    /// <param name="whereFilter">The where filter, or nullptr to delete all records.</param>
+    /// <returns>True if the scrub was queued, false if the disk storage is open.</returns>
+    bool OfflineStorageHandler::DeferDiskScrub(std::map<std::string, std::string> const* whereFilter)
+    {
+        LOCKGUARD(m_pendingScrubLock);
+        if (m_diskReady)
+        {
+            return false;
+        }
+        if (whereFilter == nullptr)
+        {
+            m_pendingScrubAll = true;
+            m_pendingScrubs.clear();
+        }
+        else if (!m_pendingScrubAll)
+        {
+            m_pendingScrubs.push_back(*whereFilter);
+        }
+        return true;
+    }
+
     void OfflineStorageHandler::Shutdown()
     {
         LOG_TRACE("Shutting down offline storage handler");
         m_shutdownStarted = true;
+        WaitForDiskOpen();
         WaitForFlush();
         if (nullptr != m_offlineStorageMemory)
         {
             m_offlineStorageMemory->ReleaseAllRecords();
-            Flush();
+            FlushToDisk();
             m_offlineStorageMemory->Shutdown();
         }
         if (nullptr != m_offlineStorageDisk)
@@ -135,7 +244,7 @@ namespace MAT_NS_BEGIN {
         size_t size = 0;
         if (m_offlineStorageMemory != nullptr)
             size += m_offlineStorageMemory->GetSize();
-        if (m_offlineStorageDisk != nullptr)
+        if (m_offlineStorageDisk != nullptr && m_diskReady)
             size += m_offlineStorageDisk->GetSize();
         return size;
     }
@@ -145,7 +254,7 @@ namespace MAT_NS_BEGIN {
         size_t count = 0;
         if (m_offlineStorageMemory != nullptr)
             count += m_offlineStorageMemory->GetRecordCount(latency);
-        if (m_offlineStorageDisk != nullptr)
+        if (m_offlineStorageDisk != nullptr && m_diskReady)
             count += m_offlineStorageDisk->GetRecordCount(latency);
         return count;
     }
@@ -153,8 +262,28 @@ namespace MAT_NS_BEGIN {
     void OfflineStorageHandler::Flush()
     {
         if (!m_logManager.StartActivity()) {
+            // A flush scheduled from StoreRecord() that can no longer run
+            // must still release WaitForFlush() in Shutdown()
+            LOCKGUARD(m_flushLock);
+            m_flushComplete.post();
+            m_flushPending = false;
             return;
         }
+        FlushToDisk();
+        m_logManager.EndActivity();
+    }
+
+    void OfflineStorageHandler::FlushForShutdown()
+    {
+        // The log manager is paused for teardown, so Flush() would be a no-op here
+        if (m_offlineStorageMemory != nullptr)
+        {
+            FlushToDisk();
+        }
+    }
+
+    void OfflineStorageHandler::FlushToDisk()
+    {
         // Flush could be executed from context of worker thread, as well as from TPM and
         // after HTTP callback. Make sure it is atomic / thread-safe.
         LOCKGUARD(m_flushLock);
@@ -164,24 +293,18 @@ namespace MAT_NS_BEGIN {
         // than the handle gets replaced by nullptr in this DeferredCallbackHandle obj.
         m_flushHandle.Cancel();
 
+        // Until the disk storage is open, the records stay in RAM
         size_t dbSizeBeforeFlush = m_offlineStorageMemory->GetSize();
-        if ((m_offlineStorageMemory) && (dbSizeBeforeFlush > 0) && (m_offlineStorageDisk))
+        if ((m_offlineStorageMemory) && (dbSizeBeforeFlush > 0) && (m_offlineStorageDisk) && m_diskReady)
         {
             // This will block on and then take a lock for the duration of this move, and
             // StoreRecord() will then block until the move completes.
             auto records = m_offlineStorageMemory->GetRecords(false, EventLatency_Unspecified);
             std::vector<StorageRecordId> ids;
 
-            // TODO: [MG] - consider running the batch in transaction
-            //            if (sqlite)
-            //                sqlite->Execute("BEGIN");
-
+            // SQLite storage saves the batch in a single transaction
             size_t totalSaved = m_offlineStorageDisk->StoreRecords(records);
 
-            // TODO: [MG] - consider running the batch in transaction
-            //            if (sqlite)
-            //                sqlite->Execute("END");
-
             // Delete records from reserved on flush
             HttpHeaders dummy;
             bool fromMemory = true;
@@ -197,10 +320,11 @@ namespace MAT_NS_BEGIN {
                 // obviously because the disk is slower than ram.
                 LOG_WARN("Data is arriving too fast!");
             }
+            UpdateBackpressure();
         }
 
         // Checkpoint DB
-        if (m_config.HasConfig(CFG_BOOL_CHECKPOINT_DB_ON_FLUSH) && m_config[CFG_BOOL_CHECKPOINT_DB_ON_FLUSH]) 
+        if (m_offlineStorageDisk && m_diskReady && m_config.HasConfig(CFG_BOOL_CHECKPOINT_DB_ON_FLUSH) && m_config[CFG_BOOL_CHECKPOINT_DB_ON_FLUSH])
         {
             m_offlineStorageDisk->Flush();
         }
@@ -210,7 +334,6 @@ namespace MAT_NS_BEGIN {
         // Flush is done, notify the waiters
         m_flushComplete.post();
         m_flushPending = false;
-        m_logManager.EndActivity();
     }
 
     bool OfflineStorageHandler::StoreRecord(StorageRecord const& record)
@@ -237,21 +360,14 @@ namespace MAT_NS_BEGIN {
                 m_offlineStorageMemory->StoreRecord(record);
             }
 
-            // Perform periodic flush to disk
-            if (memDbSize > cacheMemorySizeLimitInBytes)
+            // Perform periodic flush to disk, earlier when the RAM queue outgrows
+            // what is left of the process memory budget
+            size_t flushLimit = std::min<size_t>(cacheMemorySizeLimitInBytes, MemoryBudget::GetInstance().GetAvailable());
+            if ((memDbSize > flushLimit) && m_diskReady)
             {
-                if (m_flushLock.try_lock())
-                {
-                    if (!m_flushPending)
-                    {
-                        m_flushPending = true;
-                        m_flushComplete.Reset();
-                        m_flushHandle = PAL::scheduleTask(&m_taskDispatcher, 0, this, &OfflineStorageHandler::Flush);
-                        LOG_INFO("Requested Flush (%p)", m_flushHandle.m_task);
-                    }
-                    m_flushLock.unlock();
-                }
+                RequestFlush();
             }
+            UpdateBackpressure();
         }
         else
         {
@@ -267,6 +383,55 @@ namespace MAT_NS_BEGIN {
         return true;
     }
 
+    void OfflineStorageHandler::RequestFlush()
+    {
+        if (m_flushLock.try_lock())
+        {
+            if (!m_flushPending)
+            {
+                m_flushPending = true;
+                m_flushComplete.Reset();
+                m_flushHandle = PAL::scheduleTask(&m_taskDispatcher, 0, this, &OfflineStorageHandler::Flush);
+                LOG_INFO("Requested Flush (%p)", m_flushHandle.m_task);
+            }
+            m_flushLock.unlock();
+        }
+    }
+
+    /// <summary>
+    /// Dispatches EVT_STORAGE_BACKPRESSURE when the RAM queue fill crosses the high watermark
+    /// upwards, or the low watermark downwards once saturated. The fill goes past 100% while
+    /// the flush to disk lags behind the incoming records.
+    /// </summary>
+    void OfflineStorageHandler::UpdateBackpressure()
+    {
+        if ((m_offlineStorageMemory == nullptr) || (m_memoryDbSize == 0) || (m_backpressureHighPct == 0))
+        {
+            return;
+        }
+
+        size_t fillPercent = m_offlineStorageMemory->GetSize() * 100 / m_memoryDbSize;
+        bool saturated = m_saturated;
+        if (saturated ? (fillPercent > m_backpressureLowPct) : (fillPercent < m_backpressureHighPct))
+        {
+            return;
+        }
+
+        // Serialized so that the crossings are dispatched in order
+        LOCKGUARD(m_backpressureLock);
+        if (m_saturated.exchange(!saturated) != saturated)
+        {
+            // Crossed by another thread meanwhile
+            return;
+        }
+        LOG_INFO("RAM queue %s at %u%% full", saturated ? "drained" : "saturated", static_cast<unsigned>(fillPercent));
+        DebugEvent evt;
+        evt.type = DebugEventType::EVT_STORAGE_BACKPRESSURE;
+        evt.param1 = saturated ? 0 : 1;
+        evt.param2 = fillPercent;
+        m_logManager.DispatchEvent(evt);
+    }
+
     size_t OfflineStorageHandler::StoreRecords(std::vector<StorageRecord>& records)
     {
         size_t stored = 0;
@@ -287,7 +452,7 @@ namespace MAT_NS_BEGIN {
             m_offlineStorageMemory->ResizeDb();
         }
 
-        if (nullptr != m_offlineStorageDisk)
+        if (nullptr != m_offlineStorageDisk && m_diskReady)
         {
             m_offlineStorageDisk->ResizeDb();
         }
@@ -326,7 +491,7 @@ namespace MAT_NS_BEGIN {
                 return returnValue;
         }
 
-        if (m_offlineStorageDisk)
+        if (m_offlineStorageDisk && m_diskReady)
         {
             returnValue |= m_offlineStorageDisk->GetAndReserveRecords(consumer, leaseTimeMs, minLatency, maxCount);
             auto lastOfflineReadCount = m_offlineStorageDisk->LastReadRecordCount();
@@ -379,14 +544,15 @@ namespace MAT_NS_BEGIN {
 
     void OfflineStorageHandler::DeleteAllRecords()
     {
-        for (const auto storagePtr : { m_offlineStorageMemory.get() , m_offlineStorageDisk.get() })
+        if (nullptr != m_offlineStorageMemory)
         {
-            if (storagePtr != nullptr)
-            {
-                storagePtr->DeleteAllRecords();
-            }
+            m_offlineStorageMemory->DeleteAllRecords();
         }
-
+        if (nullptr != m_offlineStorageDisk && !DeferDiskScrub(nullptr))
+        {
+            m_offlineStorageDisk->DeleteAllRecords();
+        }
+        UpdateBackpressure();
     }
 
     /**
@@ -402,12 +568,13 @@ namespace MAT_NS_BEGIN {
     /// </remarks>
     void OfflineStorageHandler::DeleteRecords(const std::map<std::string, std::string>& whereFilter)
     {
-        for (const auto storagePtr : {m_offlineStorageMemory.get(), m_offlineStorageDisk.get()})
+        if (nullptr != m_offlineStorageMemory)
         {
-            if (storagePtr != nullptr)
-            {
-                storagePtr->DeleteRecords(whereFilter);
-            }
+            m_offlineStorageMemory->DeleteRecords(whereFilter);
+        }
+        if (nullptr != m_offlineStorageDisk && !DeferDiskScrub(&whereFilter))
+        {
+            m_offlineStorageDisk->DeleteRecords(whereFilter);
         }
     }
 
@@ -442,6 +609,7 @@ namespace MAT_NS_BEGIN {
         if (fromMemory && nullptr != m_offlineStorageMemory)
         {
             m_offlineStorageMemory->DeleteRecords(ids, headers, fromMemory);
+            UpdateBackpressure();
         }
         else
         {
@@ -482,6 +650,7 @@ namespace MAT_NS_BEGIN {
 
     bool OfflineStorageHandler::StoreSetting(std::string const& name, std::string const& value)
     {
+        WaitForDiskOpen();
         if (nullptr != m_offlineStorageDisk)
         {
             m_offlineStorageDisk->StoreSetting(name, value);
@@ -492,6 +661,7 @@ namespace MAT_NS_BEGIN {
 
     std::string OfflineStorageHandler::GetSetting(std::string const& name)
     {
+        WaitForDiskOpen();
         if (nullptr != m_offlineStorageDisk)
         {
             return m_offlineStorageDisk->GetSetting(name);
@@ -501,6 +671,7 @@ namespace MAT_NS_BEGIN {
 
     bool OfflineStorageHandler::DeleteSetting(std::string const& name)
     {
+        WaitForDiskOpen();
         if (nullptr != m_offlineStorageDisk)
         {
             return m_offlineStorageDisk->DeleteSetting(name);
@@ -508,8 +679,19 @@ namespace MAT_NS_BEGIN {
         return false;
     }
 
+    bool OfflineStorageHandler::IsOpen()
+    {
+        return m_diskReady;
+    }
+
     void OfflineStorageHandler::OnStorageOpened(std::string const& type)
     {
+        // Reported from OpenDisk() once the records on disk are visible to readers
+        if (!m_diskReady)
+        {
+            m_diskOpenedType = type;
+            return;
+        }
         m_observer->OnStorageOpened(type);
     }
 
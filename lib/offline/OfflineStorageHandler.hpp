@@ -17,6 +17,8 @@
 #include <atomic>
 #include <list>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "KillSwitchManager.hpp"
 #include "ClockSkewManager.hpp"
@@ -31,6 +33,7 @@ namespace MAT_NS_BEGIN {
         virtual void Initialize(IOfflineStorageObserver& observer) override;
         virtual void Shutdown() override;
         virtual void Flush() override;
+        virtual void FlushForShutdown() override;
         virtual bool StoreRecord(StorageRecord const& record) override;
         virtual size_t StoreRecords(std::vector<StorageRecord> & records) override;
         virtual bool GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0) override;
@@ -52,6 +55,7 @@ namespace MAT_NS_BEGIN {
 
         virtual std::vector<StorageRecord> GetRecords(bool shutdown, EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0) override;
         virtual bool ResizeDb() override;
+        virtual bool IsOpen() override;
 
         virtual void OnStorageOpened(std::string const& type) override;
         virtual void OnStorageFailed(std::string const& reason) override;
@@ -63,6 +67,7 @@ namespace MAT_NS_BEGIN {
 
     protected:
         virtual void DeleteRecordsByKeys(const std::list<std::string> & keys);
+        virtual std::shared_ptr<IOfflineStorage> CreateDiskStorage();
 
         IOfflineStorageObserver   * m_observer;
         ILogManager &               m_logManager;
@@ -83,6 +88,16 @@ namespace MAT_NS_BEGIN {
         std::unique_ptr<IOfflineStorage>       m_offlineStorageMemory;
         std::shared_ptr<IOfflineStorage>       m_offlineStorageDisk;
 
+        std::mutex                             m_diskOpenLock;
+        std::thread                            m_diskOpenThread;
+        std::atomic<bool>                      m_diskReady;
+        std::string                            m_diskOpenedType;
+
+        // Scrubs requested while the disk storage is opening, applied once it is open
+        std::mutex                                          m_pendingScrubLock;
+        std::vector<std::map<std::string, std::string>>     m_pendingScrubs;
+        bool                                                m_pendingScrubAll;
+
         bool                                   m_readFromMemory;
         unsigned                               m_lastReadCount;
 
@@ -92,11 +107,22 @@ namespace MAT_NS_BEGIN {
         unsigned                               m_queryDbSize;
         bool                                   m_isStorageFullNotificationSend;
 
+        unsigned                               m_backpressureHighPct;
+        unsigned                               m_backpressureLowPct;
+        std::atomic<bool>                      m_saturated;
+        std::mutex                             m_backpressureLock;
+
     protected:
         MATSDK_LOG_DECL_COMPONENT_CLASS();
 
     private:
         void WaitForFlush();
+        void FlushToDisk();
+        void RequestFlush();
+        void OpenDisk();
+        void WaitForDiskOpen();
+        bool DeferDiskScrub(std::map<std::string, std::string> const* whereFilter);
+        void UpdateBackpressure();
 
     };
 
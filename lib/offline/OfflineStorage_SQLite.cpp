@@ -44,8 +44,11 @@ namespace MAT_NS_BEGIN {
 
     MATSDK_LOG_INST_COMPONENT_CLASS(OfflineStorage_SQLite, "EventsSDK.Storage", "Events telemetry client - OfflineStorage_SQLite class");
 
-    static int const CURRENT_SCHEMA_VERSION = 1;
+    static int const CURRENT_SCHEMA_VERSION = 2;
+    // Tenant row IDs kept in memory; lookups past this are served by the tenants table
+    static size_t const MAX_CACHED_TENANT_IDS = 1024;
 #define TABLE_NAME_EVENTS   "events"
+#define TABLE_NAME_TENANTS  "tenants"
 #define TABLE_NAME_SETTINGS "settings"
 #define TABLE_NAME_PACKAGES "packages"
 
@@ -146,11 +149,11 @@ namespace MAT_NS_BEGIN {
             m_db->execute(command.c_str());
     }
 
-    bool OfflineStorage_SQLite::StoreRecord(StorageRecord const& record)
+    /// <summary>
+    /// Checks the record can be stored, notifying the observer if it cannot.
+    /// </summary>
+    bool OfflineStorage_SQLite::isValidRecord(StorageRecord const& record)
     {
-        // TODO: [MG] - this works, but may not play nicely with several LogManager instances
-        // static SqliteStatement sql_insert(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data);
-
         if (record.id.empty() || record.tenantToken.empty() || static_cast<int>(record.latency) < 0 || record.timestamp <= 0) {
             LOG_ERROR("Failed to store event %s:%s: Invalid parameters",
                 tenantTokenToId(record.tenantToken).c_str(), record.id.c_str());
@@ -164,10 +167,38 @@ namespace MAT_NS_BEGIN {
             m_observer->OnStorageOpenFailed("Database is not open");
             return false;
         }
+        return true;
+    }
+
+    /// <summary>
+    /// Inserts the record, the caller holds m_lock and the DB transaction.
+    /// </summary>
+    bool OfflineStorage_SQLite::insertRecord(StorageRecord const& record)
+    {
+        int64_t tenantId;
+        if (!getTenantId(record.tenantToken, tenantId))
+        {
+            LOG_ERROR("Failed to store event %s:%s: Database error", tenantTokenToId(record.tenantToken).c_str(), record.id.c_str());
+            m_observer->OnStorageFailed("Database error");
+            return false;
+        }
+        SqliteStatement(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data).execute(record.id, tenantId, static_cast<int>(record.latency), static_cast<int>(record.persistence), record.timestamp, record.blob);
+        m_DbSizeEstimate += record.id.size() + sizeof(tenantId) + record.blob.size();
+        return true;
+    }
+
+    bool OfflineStorage_SQLite::StoreRecord(StorageRecord const& record)
+    {
+        // TODO: [MG] - this works, but may not play nicely with several LogManager instances
+        // static SqliteStatement sql_insert(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data);
+
+        if (!isValidRecord(record)) {
+            return false;
+        }
 
         {
-#ifdef ENABLE_LOCKING
             LOCKGUARD(m_lock);
+#ifdef ENABLE_LOCKING
             DbTransaction transaction(m_db.get());
             if (!transaction.locked)
             {
@@ -176,10 +207,22 @@ namespace MAT_NS_BEGIN {
                 return false;
             }
 #endif
-            SqliteStatement(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data).execute(record.id, record.tenantToken, static_cast<int>(record.latency), static_cast<int>(record.persistence), record.timestamp, record.blob);
-            m_DbSizeEstimate += record.id.size() + record.tenantToken.size() + record.blob.size();
+            if (!insertRecord(record))
+            {
+                return false;
+            }
         }
 
+        checkDbSize();
+        return true;
+    }
+
+    /// <summary>
+    /// Notifies about a DB getting full and trims it once over the limit. Called outside
+    /// of any DB transaction since trimming may VACUUM.
+    /// </summary>
+    void OfflineStorage_SQLite::checkDbSize()
+    {
         if ((m_DbSizeNotificationLimit != 0) && (m_DbSizeEstimate>m_DbSizeNotificationLimit))
         {
             auto now = PAL::getMonotonicTimeMs();
@@ -209,19 +252,82 @@ namespace MAT_NS_BEGIN {
                 m_resizing = false;
             }
         }
+    }
 
+    /// <summary>
+    /// Gets the row ID of a tenant token in the tenants table, adding it on first use.
+    /// </summary>
+    bool OfflineStorage_SQLite::getTenantId(std::string const& tenantToken, int64_t& tenantId)
+    {
+        LOCKGUARD(m_lock);
+        auto it = m_tenantIds.find(tenantToken);
+        if (it != m_tenantIds.end())
+        {
+            tenantId = it->second;
+            return true;
+        }
+        if (m_tenantIds.size() >= MAX_CACHED_TENANT_IDS)
+        {
+            m_tenantIds.clear();
+        }
+
+        if (!SqliteStatement(*m_db, m_stmtInsertTenant_token).execute(tenantToken))
+        {
+            return false;
+        }
+        SqliteStatement selectStmt(*m_db, m_stmtSelectTenant_token);
+        if (!selectStmt.select(tenantToken) || !selectStmt.getRow(tenantId))
+        {
+            return false;
+        }
+        m_tenantIds[tenantToken] = tenantId;
         return true;
+    }
 
+    /// <summary>
+    /// Deletes the tenants no event refers to anymore.
+    /// </summary>
+    void OfflineStorage_SQLite::pruneTenants()
+    {
+        LOCKGUARD(m_lock);
+        Execute("DELETE FROM " TABLE_NAME_TENANTS " WHERE tenant_id NOT IN (SELECT tenant_id FROM " TABLE_NAME_EVENTS ")");
+        m_tenantIds.clear();
     }
 
     size_t OfflineStorage_SQLite::StoreRecords(std::vector<StorageRecord> & records)
     {
+        if (records.empty()) {
+            return 0;
+        }
+        if (!m_db) {
+            LOG_ERROR("Failed to store %zu events: Database is not open", records.size());
+            m_observer->OnStorageOpenFailed("Database is not open");
+            return 0;
+        }
+
+        // One transaction for the whole batch rather than one per record
         size_t stored = 0;
-        for (auto & i : records) {
-            if (StoreRecord(i)) {
-                ++stored;
+        {
+            LOCKGUARD(m_lock);
+#ifdef ENABLE_LOCKING
+            DbTransaction transaction(m_db.get());
+            if (!transaction.locked)
+            {
+                LOG_ERROR("Failed to store %zu events: Database error", records.size());
+                m_observer->OnStorageFailed("Database error");
+                return 0;
+            }
+#endif
+            for (auto const& record : records) {
+                if (isValidRecord(record) && insertRecord(record)) {
+                    ++stored;
+                }
             }
         }
+
+        if (stored > 0) {
+            checkDbSize();
+        }
         return stored;
     }
 
@@ -393,6 +499,7 @@ namespace MAT_NS_BEGIN {
     {
         std::string sql = "DELETE FROM "  TABLE_NAME_EVENTS ;
         Execute(sql);
+        pruneTenants();
 
     }
 
@@ -419,8 +526,17 @@ namespace MAT_NS_BEGIN {
                 for (const auto &kv : whereFilter)
                 {
                     bool quotes = false;
-                    if ((kv.first == "record_id") ||
-                        (kv.first == "tenant_token"))
+                    if (kv.first == "tenant_token")
+                    {
+                        // events refer to the tenants table
+                        if (!clause.empty())
+                        {
+                            clause += " AND ";
+                        }
+                        clause += "tenant_id IN (SELECT tenant_id FROM " TABLE_NAME_TENANTS " WHERE tenant_token=\"" + kv.second + "\")";
+                        continue;
+                    }
+                    if (kv.first == "record_id")
                     {
                         // string types
                         quotes = true;
@@ -691,6 +807,56 @@ namespace MAT_NS_BEGIN {
         return false;
     }
 
+    /// <summary>
+    /// Converts the tables of an older schema version in place.
+    /// </summary>
+    /// <param name="openedDbVersion">The schema version found in the database.</param>
+    /// <returns>false if the database could not be converted and has to be recreated</returns>
+    bool OfflineStorage_SQLite::upgradeDatabase(int openedDbVersion)
+    {
+        if (openedDbVersion >= 2)
+        {
+            return true;
+        }
+
+        // Version 2 moves the tenant token of each event into the tenants table
+        static const char* const upgradeToV2[] = {
+            "BEGIN IMMEDIATE",
+            "CREATE TABLE IF NOT EXISTS " TABLE_NAME_TENANTS " ("
+            "tenant_id"      " INTEGER PRIMARY KEY,"
+            "tenant_token"   " TEXT NOT NULL UNIQUE"
+            ")",
+            "INSERT OR IGNORE INTO " TABLE_NAME_TENANTS " (tenant_token)"
+            " SELECT DISTINCT tenant_token FROM " TABLE_NAME_EVENTS,
+            "CREATE TABLE events_v2 ("
+            "record_id"      " TEXT,"
+            "tenant_id"      " INTEGER NOT NULL,"
+            "latency"        " INTEGER,"
+            "persistence"    " INTEGER,"
+            "timestamp"      " INTEGER,"
+            "retry_count"    " INTEGER DEFAULT 0,"
+            "reserved_until" " INTEGER DEFAULT 0,"
+            "payload"        " BLOB"
+            ")",
+            "INSERT INTO events_v2 (record_id,tenant_id,latency,persistence,timestamp,retry_count,reserved_until,payload)"
+            " SELECT record_id,tenant_id,latency,persistence,timestamp,retry_count,reserved_until,payload"
+            " FROM " TABLE_NAME_EVENTS " JOIN " TABLE_NAME_TENANTS " USING (tenant_token)",
+            "DROP TABLE " TABLE_NAME_EVENTS,
+            "ALTER TABLE events_v2 RENAME TO " TABLE_NAME_EVENTS,
+            "COMMIT"
+        };
+        for (const char* sql : upgradeToV2)
+        {
+            if (!SqliteStatement(*m_db, sql).execute())
+            {
+                LOG_ERROR("Failed to upgrade database to version %d", CURRENT_SCHEMA_VERSION);
+                SqliteStatement(*m_db, "ROLLBACK").execute();
+                return false;
+            }
+        }
+        return true;
+    }
+
     bool OfflineStorage_SQLite::initializeDatabase()
     {
         SqliteStatement(*m_db, "PRAGMA auto_vacuum=FULL").select();
@@ -722,6 +888,9 @@ namespace MAT_NS_BEGIN {
                     openedDbVersion, CURRENT_SCHEMA_VERSION);
                 return false;
             }
+            if ((openedDbVersion > 0) && !upgradeDatabase(openedDbVersion)) {
+                return false;
+            }
             if (!SqliteStatement(*m_db,
                 ("PRAGMA user_version=" + toString(CURRENT_SCHEMA_VERSION)).c_str()
             ).execute()) {
@@ -729,10 +898,19 @@ namespace MAT_NS_BEGIN {
             }
         }
 
+        if (!SqliteStatement(*m_db,
+            "CREATE TABLE IF NOT EXISTS " TABLE_NAME_TENANTS " ("
+            "tenant_id"      " INTEGER PRIMARY KEY,"
+            "tenant_token"   " TEXT NOT NULL UNIQUE"
+            ")"
+        ).execute()) {
+            return false;
+        }
+
         if (!SqliteStatement(*m_db,
             "CREATE TABLE IF NOT EXISTS " TABLE_NAME_EVENTS " ("
             "record_id"      " TEXT,"
-            "tenant_token"   " TEXT NOT NULL,"
+            "tenant_id"      " INTEGER NOT NULL,"
             "latency"        " INTEGER,"
             "persistence"    " INTEGER,"
             "timestamp"      " INTEGER,"
@@ -797,7 +975,8 @@ namespace MAT_NS_BEGIN {
             "SELECT count(*) FROM " TABLE_NAME_EVENTS " WHERE latency=?");
 
         PREPARE_SQL(m_stmtPerTenantTrimCount,
-            "SELECT tenant_token FROM " TABLE_NAME_EVENTS " ORDER BY persistence ASC, timestamp ASC LIMIT MAX(1,"
+            "SELECT tenant_token FROM " TABLE_NAME_EVENTS " CROSS JOIN " TABLE_NAME_TENANTS " USING (tenant_id)"
+            " ORDER BY persistence ASC, timestamp ASC LIMIT MAX(1,"
             "(SELECT COUNT(record_id) FROM " TABLE_NAME_EVENTS ")"
             "* ? / 100)");
         PREPARE_SQL(m_stmtTrimEvents_percent,
@@ -809,7 +988,7 @@ namespace MAT_NS_BEGIN {
 
         PREPARE_SQL(m_stmtDeleteEvents_tenants,
                 SQL_SUPPLY_PACKAGED_IDS
-                "DELETE FROM " TABLE_NAME_EVENTS " WHERE tenant_token IN ids");
+                "DELETE FROM " TABLE_NAME_EVENTS " WHERE tenant_id IN (SELECT tenant_id FROM " TABLE_NAME_TENANTS " WHERE tenant_token IN ids)");
         PREPARE_SQL(m_stmtDeleteEvents_ids,
             SQL_SUPPLY_PACKAGED_IDS
             "DELETE FROM " TABLE_NAME_EVENTS " WHERE record_id IN ids");
@@ -819,17 +998,17 @@ namespace MAT_NS_BEGIN {
             " WHERE reserved_until<>0 AND reserved_until<=?");
         PREPARE_SQL(m_stmtSelectEvents,
             "SELECT record_id,tenant_token,latency,timestamp,retry_count,reserved_until,payload"
-            " FROM " TABLE_NAME_EVENTS
+            " FROM " TABLE_NAME_EVENTS " CROSS JOIN " TABLE_NAME_TENANTS " USING (tenant_id)"
             " WHERE latency>=? AND reserved_until=0"
             " ORDER BY latency DESC,persistence DESC, timestamp ASC LIMIT ?");
         PREPARE_SQL(m_stmtSelectEventAtShutdown,
             "SELECT record_id,tenant_token,latency,timestamp,retry_count,reserved_until,payload"
-            " FROM " TABLE_NAME_EVENTS
+            " FROM " TABLE_NAME_EVENTS " CROSS JOIN " TABLE_NAME_TENANTS " USING (tenant_id)"
             " WHERE latency>=?"
             " ORDER BY latency DESC,persistence DESC, timestamp ASC LIMIT ?");
         PREPARE_SQL(m_stmtSelectEventsMinlatency,
             "SELECT record_id,tenant_token,latency,timestamp,retry_count,reserved_until,payload"
-            " FROM " TABLE_NAME_EVENTS
+            " FROM " TABLE_NAME_EVENTS " CROSS JOIN " TABLE_NAME_TENANTS " USING (tenant_id)"
             " WHERE latency=(SELECT MIN(latency) FROM " TABLE_NAME_EVENTS " WHERE reserved_until=0 AND latency>=?) AND reserved_until=0"
             " ORDER BY timestamp ASC LIMIT ?");
 
@@ -844,13 +1023,17 @@ namespace MAT_NS_BEGIN {
             " SET reserved_until=0, retry_count=retry_count+?"
             " WHERE record_id IN ids AND reserved_until>0");
         PREPARE_SQL(m_stmtSelectEventsRetried_maxRetryCount,
-            "SELECT tenant_token FROM " TABLE_NAME_EVENTS
+            "SELECT tenant_token FROM " TABLE_NAME_EVENTS " CROSS JOIN " TABLE_NAME_TENANTS " USING (tenant_id)"
             " WHERE retry_count>?");
         PREPARE_SQL(m_stmtDeleteEventsRetried_maxRetryCount,
             "DELETE FROM " TABLE_NAME_EVENTS
             " WHERE retry_count>?");
         PREPARE_SQL(m_stmtInsertEvent_id_tenant_prio_ts_data,
-            "REPLACE INTO " TABLE_NAME_EVENTS " (record_id,tenant_token,latency,persistence,timestamp,payload) VALUES (?,?,?,?,?,?)");
+            "REPLACE INTO " TABLE_NAME_EVENTS " (record_id,tenant_id,latency,persistence,timestamp,payload) VALUES (?,?,?,?,?,?)");
+        PREPARE_SQL(m_stmtInsertTenant_token,
+            "INSERT OR IGNORE INTO " TABLE_NAME_TENANTS " (tenant_token) VALUES (?)");
+        PREPARE_SQL(m_stmtSelectTenant_token,
+            "SELECT tenant_id FROM " TABLE_NAME_TENANTS " WHERE tenant_token=?");
         PREPARE_SQL(m_stmtInsertSetting_name_value,
             "REPLACE INTO " TABLE_NAME_SETTINGS " (name,value) VALUES (?,?)");
         PREPARE_SQL(m_stmtDeleteSetting_name,
@@ -860,6 +1043,7 @@ namespace MAT_NS_BEGIN {
 
         /* Delete v1 records */
         Execute("DELETE FROM " TABLE_NAME_PACKAGES);
+        pruneTenants();
 
 #undef PREPARE_SQL
 
@@ -953,6 +1137,7 @@ namespace MAT_NS_BEGIN {
             {
                 LOG_TRACE("DB is too big, deleting...");
                 Execute("DELETE FROM " TABLE_NAME_EVENTS);
+                pruneTenants();
                 Execute("VACUUM");
                 return true;
             }
@@ -964,6 +1149,7 @@ namespace MAT_NS_BEGIN {
                 LOG_TRACE("Evict all non-critical");
                 Execute("DELETE FROM " TABLE_NAME_EVENTS " WHERE persistence=1");
             }
+            pruneTenants();
             eventsDropped = count - GetRecordCountUnsafe(EventLatency::EventLatency_Unspecified);
             LOG_TRACE("Db resized, events dropeed: %d", eventsDropped);
             trimStmt.reset();
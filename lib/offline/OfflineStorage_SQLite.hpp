@@ -16,6 +16,7 @@
 #include <memory>
 #include <atomic>
 #include <mutex>
+#include <unordered_map>
 
 #define ENABLE_LOCKING      // Enable DB locking for flush
 
@@ -63,6 +64,13 @@ namespace MAT_NS_BEGIN {
         // Debug routine to print record count in the DB
         void printRecordCount();
 
+        bool getTenantId(std::string const& tenantToken, int64_t& tenantId);
+        bool isValidRecord(StorageRecord const& record);
+        bool insertRecord(StorageRecord const& record);
+        void checkDbSize();
+        void pruneTenants();
+        bool upgradeDatabase(int openedDbVersion);
+
     protected:
         mutable std::recursive_mutex m_lock {};
         IOfflineStorageObserver*    m_observer {};
@@ -105,6 +113,8 @@ namespace MAT_NS_BEGIN {
         size_t                      m_stmtDeleteEventsRetried_maxRetryCount {};
         size_t                      m_stmtSelectEventsRetried_maxRetryCount {};
         size_t                      m_stmtInsertEvent_id_tenant_prio_ts_data {};
+        size_t                      m_stmtInsertTenant_token {};
+        size_t                      m_stmtSelectTenant_token {};
         size_t                      m_stmtInsertSetting_name_value {};
         size_t                      m_stmtDeleteSetting_name {};
         size_t                      m_stmtSelectSetting_name {};
@@ -116,6 +126,8 @@ namespace MAT_NS_BEGIN {
         size_t                      m_DbSizeLimit {};
         std::atomic<size_t>         m_DbSizeEstimate {};
         uint64_t                    m_isStorageFullNotificationSendTime {};
+        // Row IDs of the tenants table, which events refer to instead of repeating the token
+        std::unordered_map<std::string, int64_t> m_tenantIds {};
 
     protected:
         MATSDK_LOG_DECL_COMPONENT_CLASS();
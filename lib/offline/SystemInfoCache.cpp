@@ -0,0 +1,152 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "SystemInfoCache.hpp"
+#include "utils/StringUtils.hpp"
+
+#include <vector>
+
+namespace MAT_NS_BEGIN
+{
+    static const char* sysInfoStampName = "sysinfostamp";
+    static const char* sysInfoFieldsName = "sysinfofields";
+    static const char* sysInfoFieldPrefix = "sysinfo.";
+
+    // Spawning a process may take a while, but teardown must not leave the task running
+    static const uint64_t collectCancelTimeMs = 10000;
+
+    // How often to look again while the offline storage is opening
+    static const unsigned storageOpenPollMs = 100;
+
+    SystemInfoCache::SystemInfoCache(IOfflineStorage& offlineStorage, ContextFieldsProvider& context, ITaskDispatcher& taskDispatcher) :
+        m_offlineStorage(offlineStorage),
+        m_context(context),
+        m_taskDispatcher(taskDispatcher),
+        m_registeredFields(context.GetCommonFields()),
+        m_stopped(false)
+    {
+    }
+
+    SystemInfoCache::~SystemInfoCache()
+    {
+        Stop();
+    }
+
+    void SystemInfoCache::Start()
+    {
+        m_stamp = GetStamp();
+        if (m_stamp.empty())
+        {
+            // Everything was collected on startup
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_collectLock);
+        m_stopped = false;
+        m_collectTask = PAL::scheduleTask(&m_taskDispatcher, 0, this, &SystemInfoCache::OnCollect);
+    }
+
+    void SystemInfoCache::Stop()
+    {
+        {
+            // A running collection checks this before it schedules itself again
+            std::lock_guard<std::mutex> lock(m_collectLock);
+            m_stopped = true;
+        }
+        if (!m_collectTask.Cancel(collectCancelTimeMs))
+        {
+            LOG_WARN("System information collection is still running");
+        }
+    }
+
+    std::string SystemInfoCache::GetStamp()
+    {
+        return PAL::getDeferredSystemInformationStamp();
+    }
+
+    std::map<std::string, std::string> SystemInfoCache::Collect()
+    {
+        return PAL::collectDeferredSystemInformation();
+    }
+
+    bool SystemInfoCache::ApplyPersisted()
+    {
+        if (m_offlineStorage.GetSetting(sysInfoStampName) == m_stamp)
+        {
+            std::vector<std::string> names;
+            StringUtils::SplitString(m_offlineStorage.GetSetting(sysInfoFieldsName), ',', names);
+
+            std::map<std::string, std::string> fields;
+            for (auto const& name : names)
+            {
+                std::string value = m_offlineStorage.GetSetting(sysInfoFieldPrefix + name);
+                if (name.empty() || value.empty())
+                {
+                    fields.clear();
+                    break;
+                }
+                fields[name] = value;
+            }
+
+            if (fields.size() == names.size())
+            {
+                LOG_TRACE("Using %zu cached system information fields", fields.size());
+                Apply(fields);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void SystemInfoCache::OnCollect()
+    {
+        // Reading settings now would block the worker until the storage is open
+        if (!m_offlineStorage.IsOpen())
+        {
+            std::lock_guard<std::mutex> lock(m_collectLock);
+            if (!m_stopped)
+            {
+                m_collectTask = PAL::scheduleTask(&m_taskDispatcher, storageOpenPollMs, this, &SystemInfoCache::OnCollect);
+            }
+            return;
+        }
+
+        if (ApplyPersisted())
+        {
+            return;
+        }
+
+        auto fields = Collect();
+        Apply(fields);
+
+        std::string names;
+        for (auto const& kv : fields)
+        {
+            if (!m_offlineStorage.StoreSetting(sysInfoFieldPrefix + kv.first, kv.second))
+            {
+                LOG_WARN("Unable to save system information to DB for %s", kv.first.c_str());
+                return;
+            }
+            names += (names.empty() ? "" : ",") + kv.first;
+        }
+
+        // The stamp goes last, it validates the rest
+        m_offlineStorage.StoreSetting(sysInfoFieldsName, names);
+        m_offlineStorage.StoreSetting(sysInfoStampName, m_stamp);
+    }
+
+    void SystemInfoCache::Apply(std::map<std::string, std::string> const& fields)
+    {
+        for (auto const& kv : fields)
+        {
+            auto registered = m_registeredFields.find(kv.first);
+            if (registered == m_registeredFields.end() ||
+                !m_context.ReplaceCommonField(kv.first, registered->second, kv.second))
+            {
+                LOG_INFO("Keeping common field %s set by the application", kv.first.c_str());
+            }
+        }
+    }
+}
+MAT_NS_END
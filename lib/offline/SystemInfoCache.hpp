@@ -0,0 +1,70 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef MAT_SYSTEMINFOCACHE_HPP
+#define MAT_SYSTEMINFOCACHE_HPP
+
+#include "IOfflineStorage.hpp"
+#include "ITaskDispatcher.hpp"
+#include "api/ContextFieldsProvider.hpp"
+#include "pal/PAL.hpp"
+#include "pal/TaskDispatcher.hpp"
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Fills in the common fields that the PAL does not collect on startup because
+    /// they are too slow to obtain, e.g. a device ID hashed from the output of a
+    /// shell command. The values are collected once on the task dispatcher and kept
+    /// in the settings of the offline storage along with a stamp from the PAL, so
+    /// later runs read them back instead while the stamp stays the same. Both
+    /// happen on the task dispatcher once the offline storage is open, so that
+    /// the worker never waits for it. Until then, events carry the PAL defaults.
+    /// </summary>
+    class SystemInfoCache
+    {
+    public:
+        /// <summary>
+        /// Takes note of the fields registered by the PAL in the context, which
+        /// must not be changed by the application yet.
+        /// </summary>
+        SystemInfoCache(IOfflineStorage& offlineStorage, ContextFieldsProvider& context, ITaskDispatcher& taskDispatcher);
+
+        virtual ~SystemInfoCache();
+
+        /// <summary>
+        /// Schedules filling in the context from the settings if they are valid,
+        /// or else from a new collection. Does not access the offline storage.
+        /// </summary>
+        void Start();
+
+        /// <summary>
+        /// Cancels a pending collection, or waits for a running one to finish.
+        /// </summary>
+        void Stop();
+
+    protected:
+        virtual std::string GetStamp();
+        virtual std::map<std::string, std::string> Collect();
+
+        void OnCollect();
+        bool ApplyPersisted();
+        void Apply(std::map<std::string, std::string> const& fields);
+
+        IOfflineStorage&                      m_offlineStorage;
+        ContextFieldsProvider&                m_context;
+        ITaskDispatcher&                      m_taskDispatcher;
+        std::map<std::string, EventProperty>  m_registeredFields;
+        std::string                           m_stamp;
+        std::mutex                            m_collectLock;
+        bool                                  m_stopped;
+        PAL::DeferredCallbackHandle           m_collectTask;
+    };
+}
+MAT_NS_END
+#endif
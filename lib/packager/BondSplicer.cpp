@@ -37,6 +37,14 @@ size_t BondSplicer::getSizeEstimate() const
 std::vector<uint8_t> BondSplicer::splice() const
 {
     std::vector<uint8_t> output;
+    splice(output);
+    return output;
+}
+
+void BondSplicer::splice(std::vector<uint8_t>& output) const
+{
+    output.clear();
+    output.reserve(m_buffer.size());
     bond_lite::CompactBinaryProtocolWriter writer(output);
 
     if (!m_packages.empty()) {
@@ -48,15 +56,18 @@ std::vector<uint8_t> BondSplicer::splice() const
             } 
         }
     } 
-
-    return output;
 }
 
 void BondSplicer::clear()
 {
-    // Swap with empty instead of clear() to release memory
-    std::vector<uint8_t>().swap(m_buffer);
-    std::vector<PackageInfo>().swap(m_packages);
+    // Splicers of pooled upload contexts keep a typically sized buffer for the
+    // next package; release it after an unusually large one.
+    if (m_buffer.capacity() > MaxRetainedBufferSize) {
+        std::vector<uint8_t>().swap(m_buffer);
+    } else {
+        m_buffer.clear();
+    }
+    m_packages.clear();
     m_overheadEstimate = 0;
 }
 
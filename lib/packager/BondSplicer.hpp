@@ -9,7 +9,6 @@
 #include "DataPackage.hpp"
 #include "ISplicer.hpp"
 
-#include <list>
 #include <vector>
 
 namespace MAT_NS_BEGIN {
@@ -22,6 +21,8 @@ class BondSplicer : public ISplicer
     std::vector<PackageInfo> m_packages;
     size_t                   m_overheadEstimate {};
 
+    static const size_t      MaxRetainedBufferSize = 256 * 1024;
+
   public:
     BondSplicer() noexcept = default;
     BondSplicer(BondSplicer const&) = delete;
@@ -32,6 +33,7 @@ class BondSplicer : public ISplicer
 
     size_t getSizeEstimate() const override;
     std::vector<uint8_t> splice() const override;
+    void splice(std::vector<uint8_t>& output) const override;
 
     void clear() override;
 };
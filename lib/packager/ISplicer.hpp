@@ -8,7 +8,6 @@
 #include "pal/PAL.hpp"
 #include "DataPackage.hpp"
 
-#include <list>
 #include <vector>
 
 namespace MAT_NS_BEGIN {
@@ -23,7 +22,7 @@ class ISplicer
     struct PackageInfo {
         std::string     tenantToken;
         Span            header;
-        std::list<Span> records;
+        std::vector<Span> records;
     };
 
   public:
@@ -35,6 +34,14 @@ class ISplicer
     virtual size_t getSizeEstimate() const = 0;
     virtual std::vector<uint8_t> splice() const = 0;
 
+    /// <summary>
+    /// Splices into an existing buffer, reusing its capacity.
+    /// </summary>
+    virtual void splice(std::vector<uint8_t>& output) const
+    {
+        output = splice();
+    }
+
     virtual void clear() = 0;
 };
 
@@ -10,13 +10,19 @@
 
 namespace MAT_NS_BEGIN {
 
-    Packager::Packager(IRuntimeConfig& runtimeConfig)
-        : m_config(runtimeConfig)
+    constexpr size_t Packager::MinUploadSizeUnderPressure;
+
+    Packager::Packager(IRuntimeConfig& runtimeConfig, TenantTable& tenants)
+        : m_config(runtimeConfig),
+          m_tenants(tenants),
+          m_hasForcedTenant(false),
+          m_forcedTenantId(0)
     {
         const char *forcedTenantToken = runtimeConfig["forcedTenantToken"];
-        if (forcedTenantToken != nullptr)
+        if (forcedTenantToken != nullptr && forcedTenantToken[0] != '\0')
         {
-            m_forcedTenantToken = forcedTenantToken;
+            m_hasForcedTenant = true;
+            m_forcedTenantId = m_tenants.intern(forcedTenantToken);
         }
     }
 
@@ -26,9 +32,13 @@ namespace MAT_NS_BEGIN {
             if (ctx->maxUploadSize == 0) {
                 ctx->maxUploadSize = m_config.GetMaximumUploadSizeBytes();
             }
+            if (ctx->recordIdsAndTenantIds.empty()) {
+                limitToMemoryBudget(ctx);
+            }
             if (ctx->splicer->getSizeEstimate() + record.blob.size() > ctx->maxUploadSize) {
                 wantMore = false;
                 if (!ctx->recordIdsAndTenantIds.empty()) {
+                    ctx->packageFull = true;
                     LOG_TRACE("Maximum upload size %u bytes exceeded, not adding the next event (ID %s, size %u bytes)",
                         ctx->maxUploadSize, record.id.c_str(), static_cast<unsigned>(record.blob.size()));
                     return;
@@ -52,16 +62,19 @@ namespace MAT_NS_BEGIN {
                         ctx->traceId = record.traceId;
             #endif // HAVE_MAT_EVT_TRACEID
 
-            std::string const& tenantToken = m_forcedTenantToken.empty() ? record.tenantToken : m_forcedTenantToken;
-            auto it = ctx->packageIds.lower_bound(tenantToken);
-            if (it == ctx->packageIds.end() || it->first != tenantToken)
+            TenantId tenantId = m_tenants.intern(record.tenantToken);
+            TenantId packageTenantId = m_hasForcedTenant ? m_forcedTenantId : tenantId;
+            auto it = ctx->packageIds.lower_bound(packageTenantId);
+            if (it == ctx->packageIds.end() || it->first != packageTenantId)
             {
-                it = ctx->packageIds.insert(it, { tenantToken, ctx->splicer->addTenantToken(tenantToken) });
+                // The token is only written out once per tenant and package
+                it = ctx->packageIds.insert(it, { packageTenantId, ctx->splicer->addTenantToken(m_tenants.resolve(packageTenantId)) });
             }
 
             ctx->splicer->addRecord(it->second, record.blob);
+            ctx->packagingMemory.Resize(ctx->splicer->getSizeEstimate());
 
-            ctx->recordIdsAndTenantIds[record.id] = record.tenantToken;
+            ctx->recordIdsAndTenantIds[record.id] = tenantId;
             ctx->recordTimestamps.push_back(record.timestamp);
             ctx->maxRetryCountSeen = std::max<int>(ctx->maxRetryCountSeen, record.retryCount);
         }
@@ -71,6 +84,20 @@ namespace MAT_NS_BEGIN {
         }
     }
 
+    void Packager::limitToMemoryBudget(EventsUploadContextPtr const& ctx)
+    {
+        MemoryBudget& budget = MemoryBudget::GetInstance();
+        if (!budget.IsUnderPressure()) {
+            return;
+        }
+        // The splicer buffer and the spliced body both hold the whole package
+        size_t limit = std::max<size_t>(budget.GetAvailable() / 2, MinUploadSizeUnderPressure);
+        if (limit < ctx->maxUploadSize) {
+            LOG_TRACE("Memory budget under pressure, package limited to %u bytes", static_cast<unsigned>(limit));
+            ctx->maxUploadSize = static_cast<unsigned>(limit);
+        }
+    }
+
     void Packager::handleFinalizePackage(EventsUploadContextPtr const& ctx)
     {
         if (ctx->packageIds.empty()) {
@@ -78,8 +105,10 @@ namespace MAT_NS_BEGIN {
             return;
         }
 
-        ctx->body = ctx->splicer->splice();
+        ctx->splicer->splice(ctx->body);
         ctx->splicer->clear();
+        ctx->bodyMemory.Resize(ctx->body.size());
+        ctx->packagingMemory.Reset();
 
         packagedEvents(ctx);
     }
@@ -13,15 +13,23 @@ namespace MAT_NS_BEGIN {
 
     class Packager {
     public:
-        Packager(IRuntimeConfig& runtimeConfig);
+        Packager(IRuntimeConfig& runtimeConfig, TenantTable& tenants);
+
+        /// <summary>
+        /// Smallest package limit applied when the memory budget is under pressure.
+        /// </summary>
+        static constexpr size_t MinUploadSizeUnderPressure = 64 * 1024;
 
     protected:
         void handleAddEventToPackage(EventsUploadContextPtr const& ctx, StorageRecord const& record, bool& wantMore);
         void handleFinalizePackage(EventsUploadContextPtr const& ctx);
+        void limitToMemoryBudget(EventsUploadContextPtr const& ctx);
 
     protected:
         IRuntimeConfig & m_config;
-        std::string      m_forcedTenantToken;
+        TenantTable &    m_tenants;
+        bool             m_hasForcedTenant;
+        TenantId         m_forcedTenantId;
 
     public:
         RouteSink<Packager, EventsUploadContextPtr const&, StorageRecord const&, bool&> addEventToPackage{ this, &Packager::handleAddEventToPackage };
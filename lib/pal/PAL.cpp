@@ -39,6 +39,9 @@
 #ifdef __linux__
 #include <sys/syscall.h>   /* For SYS_xxx definitions */
 #endif
+#if defined(__linux__) && !defined(ANDROID) && !defined(__ANDROID__)
+#include "posix/sysinfo_sources_impl.hpp"
+#endif
 
 #endif
 
@@ -524,6 +527,30 @@ namespace PAL_NS_BEGIN {
         }
     }
 
+    std::string PlatformAbstractionLayer::getDeferredSystemInformationStamp() const
+    {
+#if defined(__linux__) && !defined(ANDROID) && !defined(__ANDROID__)
+        return sysinfo_sources_impl::GetSysInfo().deferred_stamp();
+#else
+        return std::string();
+#endif
+    }
+
+    std::map<std::string, std::string> PlatformAbstractionLayer::collectDeferredSystemInformation()
+    {
+        std::map<std::string, std::string> fields;
+#if defined(__linux__) && !defined(ANDROID) && !defined(__ANDROID__)
+        for (auto const& kv : sysinfo_sources_impl::GetSysInfo().collect_deferred())
+        {
+            if (kv.first == "devId")
+            {
+                fields[COMMONFIELDS_DEVICE_ID] = kv.second;
+            }
+        }
+#endif
+        return fields;
+    }
+
 #undef OS_NAME
 #if defined(_WIN32)
     #define OS_NAME     "Windows"
@@ -94,6 +94,10 @@ namespace PAL_NS_BEGIN
 
         void registerSemanticContext(MAT::ISemanticContext* context);
 
+        std::string getDeferredSystemInformationStamp() const;
+
+        std::map<std::string, std::string> collectDeferredSystemInformation();
+
         std::shared_ptr<MAT::ITaskDispatcher> getDefaultTaskDispatcher();
 
         void initialize(MAT::IRuntimeConfig& configuration);
@@ -195,6 +199,24 @@ namespace PAL_NS_BEGIN
         GetPAL().registerSemanticContext(context);
     }
 
+    /**
+     * Return a value that changes whenever collectDeferredSystemInformation() may
+     * return something else, or an empty string if there is nothing to collect.
+     */
+    inline std::string getDeferredSystemInformationStamp()
+    {
+        return GetPAL().getDeferredSystemInformationStamp();
+    }
+
+    /**
+     * Collect the per-platform common fields too expensive to obtain on startup and
+     * left with defaults by registerSemanticContext(). Blocks, call in background.
+     */
+    inline std::map<std::string, std::string> collectDeferredSystemInformation()
+    {
+        return GetPAL().collectDeferredSystemInformation();
+    }
+
     /**
      * Get default PAL-owned worker thread
      */
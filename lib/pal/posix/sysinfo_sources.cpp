@@ -25,8 +25,6 @@
 #include <unistd.h>
 #include <sys/utsname.h>
 
-#include <regex>
-
 #include <iostream>
 #include <iomanip>
 
@@ -142,37 +140,68 @@ static std::string Exec(const char* cmd)
 #endif
 
 /**
- * Read node value, preprocess it using regexp and store result in cache
+ * Extract a value from file contents, see sysinfo_source_t for the selectors.
+ *
+ * @param contents
+ * @param selector
+ * @return          true if the selector matched
+ */
+bool sysinfo_sources::select(const std::string& contents, const std::string& selector, std::string& value)
+{
+    if (selector.empty() || selector == "*")
+    {
+        value = contents;
+        return true;
+    }
+
+    if (selector == "^")
+    {
+        value = contents.substr(0, contents.find_first_of(std::string("\n\0", 2)));
+        return true;
+    }
+
+    // KEY= selector: only match at the start of a line, so that ID= does not match VERSION_ID=
+    for (size_t pos = 0; pos < contents.length(); )
+    {
+        size_t eol = contents.find('\n', pos);
+        if (eol == std::string::npos)
+        {
+            eol = contents.length();
+        }
+        if (contents.compare(pos, selector.length(), selector) == 0)
+        {
+            value = contents.substr(pos + selector.length(), eol - pos - selector.length());
+            // Values may be quoted, e.g. ID="opensuse-leap"
+            if (value.length() >= 2 && (value[0] == '"' || value[0] == '\'') && value[value.length() - 1] == value[0])
+            {
+                value = value.substr(1, value.length() - 2);
+            }
+            return true;
+        }
+        pos = eol + 1;
+    }
+    return false;
+}
+
+/**
+ * Read node value, extract it using the selector and store result in cache
  *
  * @param key       Field name
  * @return          true if field value is found and saved in cache
  */
 bool sysinfo_sources::fetch(std::string key)
 {
-	for(auto &kv : (*this))
-	{
-		if(kv.first == key)
-		{
-			const std::string star("*");
-			const std::string empty("");
-
-			std::string contents = ReadFile(kv.second.path);
-			if((kv.second.selector == star) || (kv.second.selector == empty))
-			{
-				cache[key] = contents;
-				return true;
-			}
-			// Run regexp
-			std::regex selector_regex(kv.second.selector);
-			std::smatch match;
-			if(std::regex_search(contents, match, selector_regex))
-			{
-				cache[key] = match[1];
-				return true;
-			}
-		}
-	}
-	return false;
+    auto range = equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        std::string value;
+        if (select(ReadFile(it->second.path), it->second.selector, value))
+        {
+            cache[key] = value;
+            return true;
+        }
+    }
+    return false;
 }
 
 /**
@@ -186,6 +215,43 @@ void sysinfo_sources::add(const std::string& key, const sysinfo_source_t& val)
     (*this).insert(std::pair<std::string, sysinfo_source_t>(key, val));
 }
 
+/**
+ * Add a source too expensive to run on startup, e.g. one that spawns
+ * processes. get() does not return its value, collect_deferred() does.
+ *
+ * @param key
+ * @param source
+ */
+void sysinfo_sources::add_deferred(const std::string& key, std::function<std::string()> source)
+{
+    std::lock_guard<std::mutex> lock(deferred_lock);
+    deferred[key] = source;
+}
+
+/**
+ * Run the deferred sources once, on the calling thread, and return
+ * their non-empty values.
+ *
+ * @return
+ */
+std::map<std::string, std::string> sysinfo_sources::collect_deferred()
+{
+    std::lock_guard<std::mutex> lock(deferred_lock);
+    for (auto& kv : deferred)
+    {
+        if (kv.second)
+        {
+            std::string value = kv.second();
+            if (!value.empty())
+            {
+                deferred_cache[kv.first] = value;
+            }
+            kv.second = nullptr;
+        }
+    }
+    return deferred_cache;
+}
+
 /**
  * Static configuration provisioning for where to fetch the props from
  */
@@ -218,23 +284,12 @@ sysinfo_sources_impl::sysinfo_sources_impl() : sysinfo_sources()
 #if defined(__linux__)
     // Obtain Linux system information from filesystem
     add("devId", { "/etc/machine-id", "*"});
-    add("osName", {"/etc/os-release", ".*ID=(.*)[\n]+"});
-    add("osVer", {"/etc/os-release", ".*VERSION_ID=\"(.*)\".*"});
-    add("osRel", {"/etc/os-release", ".*VERSION=\"(.*)\".*"});
-    add("osBuild", {"/proc/version", "(.*)[\n]+"});
-    // add("proc_loadavg", {"/proc/loadavg", "(.*)[\n]*"});
-    // add("proc_uptime", {"/proc/uptime", "(.*)[\n]*"});
-
-    // osName may contain quotes on openSUSE
-    if (get("osName").find('"') == 0)
-    {
-        std::string contents = get("osName");
-        size_t pos_end_quote = contents.rfind('"');
-        if (pos_end_quote != std::string::npos && pos_end_quote > 0)
-        {
-            cache["osName"] = contents.substr(1, pos_end_quote - 1);
-        }
-    }
+    add("osName", {"/etc/os-release", "ID="});
+    add("osVer", {"/etc/os-release", "VERSION_ID="});
+    add("osRel", {"/etc/os-release", "VERSION="});
+    add("osBuild", {"/proc/version", "^"});
+    // add("proc_loadavg", {"/proc/loadavg", "^"});
+    // add("proc_uptime", {"/proc/uptime", "^"});
 
     time_t t = time(NULL);
 
@@ -315,7 +370,7 @@ sysinfo_sources_impl::sysinfo_sources_impl() : sysinfo_sources()
     }
 
 #ifndef __APPLE__
-    add("appId", {"/proc/self/cmdline", "(.*)[ ]*.*[\n]*"});
+    add("appId", {"/proc/self/cmdline", "^"});
 #else
     cache["appId"] = get_app_name();
 #endif
@@ -334,17 +389,24 @@ sysinfo_sources_impl::sysinfo_sources_impl() : sysinfo_sources()
         // We were unable to obtain Device Id using standard means.
         // Try to use hash of blkid + hostname instead. Both blkid
         // and hostname would rarely change, as well as guarantee
-        // at least some protection from cloned VM images.
-        std::string contents = Exec("echo `blkid; hostname`");
-        if (!contents.empty())
+        // at least some protection from cloned VM images. Spawning
+        // a shell is too slow for startup, so the value is collected
+        // in background and persisted by the SDK, see SystemInfoCache.
+        add_deferred("devId", []()
         {
+            std::string contents = Exec("echo `blkid; hostname`");
+            if (contents.empty())
+            {
+                return contents;
+            }
             uint8_t guid_bytes[16] = { 0 };
             for(size_t i=0; i<contents.length(); i++)
             {   // Simple XOR of contents to generate a UUID
                 guid_bytes[i % 16] ^= contents.at(i);
             }
-            cache["devId"] = MAT::GUID_t(guid_bytes).to_string();
-        }
+            return MAT::GUID_t(guid_bytes).to_string();
+        });
+        stamp = std::string(buf.nodename) + "/" + buf.release;
 #endif
     }
 
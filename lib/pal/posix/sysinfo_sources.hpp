@@ -5,11 +5,16 @@
 // SPDX-License-Identifier: Apache-2.0
 //
 
+#include <functional>
 #include <map>
+#include <mutex>
 #include <string>
 
 /**
- * System information source path and selector
+ * System information source path and selector. The selector is one of:
+ *  - "*" or "" for the whole file,
+ *  - "KEY=" for the value of the first line starting with KEY=, unquoted,
+ *  - "^" for the first line, or the first NUL-terminated string.
  */
 typedef struct {
     const char * path;
@@ -28,8 +33,13 @@ class sysinfo_sources : public std::multimap<std::string, sysinfo_source_t> {
 protected:
     std::map<std::string, std::string> cache;
 
+    std::map<std::string, std::function<std::string()>> deferred;
+    std::map<std::string, std::string> deferred_cache;
+    std::mutex deferred_lock;
+    std::string stamp;
+
     /**
-     * Read node value, preprocess it using regexp and store result in cache
+     * Read node value, extract it using the selector and store result in cache
      *
      * @param key       Field name
      * @return          true if field value is found and saved in cache
@@ -57,6 +67,42 @@ public:
      */
     const std::string& get(std::string key);
 
+    /**
+     * Extract a value from file contents, see sysinfo_source_t for the selectors.
+     *
+     * @param contents
+     * @param selector
+     * @return          true if the selector matched
+     */
+    static bool select(const std::string& contents, const std::string& selector, std::string& value);
+
+    /**
+     * Add a source too expensive to run on startup, e.g. one that spawns
+     * processes. get() does not return its value, collect_deferred() does.
+     *
+     * @param key
+     * @param source
+     */
+    void add_deferred(const std::string& key, std::function<std::string()> source);
+
+    /**
+     * Value that changes whenever the deferred sources may return something
+     * else, so that their values can be persisted across runs. Empty if
+     * there are no deferred sources.
+     */
+    const std::string& deferred_stamp() const
+    {
+        return stamp;
+    }
+
+    /**
+     * Run the deferred sources once, on the calling thread, and return
+     * their non-empty values.
+     *
+     * @return
+     */
+    std::map<std::string, std::string> collect_deferred();
+
 };
 
 #endif /* LIB_PAL_POSIX_SYSINFO_SOURCES_HPP_ */
@@ -0,0 +1,212 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include "ctmacros.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Lock-free log-linear (HDR-style) histogram of durations in microseconds.
+    /// Values below 32 are recorded exactly; above that each power-of-two range
+    /// is split into 16 linear sub-buckets, which bounds the relative error to ~6%.
+    /// Values above 2^36 us (~19 hours) are clamped to the last bucket.
+    /// Recording is a handful of relaxed atomic operations and safe from any thread.
+    /// </summary>
+    class LatencyHistogram
+    {
+    public:
+        static constexpr unsigned SubBucketBits  = 4;
+        static constexpr unsigned SubBucketCount = 1u << SubBucketBits;
+        static constexpr unsigned LinearCount    = 2 * SubBucketCount;
+        static constexpr unsigned MaxValueBits   = 36;
+        static constexpr uint64_t MaxValue       = (uint64_t(1) << MaxValueBits) - 1;
+        static constexpr unsigned BucketCount    = LinearCount + (MaxValueBits - SubBucketBits - 1) * SubBucketCount;
+
+        LatencyHistogram()
+        {
+            reset();
+        }
+
+        LatencyHistogram(LatencyHistogram const&) = delete;
+        LatencyHistogram& operator=(LatencyHistogram const&) = delete;
+
+        /// <summary>
+        /// Records a single duration.
+        /// </summary>
+        void record(uint64_t valueUs)
+        {
+            if (valueUs > MaxValue)
+            {
+                valueUs = MaxValue;
+            }
+            m_buckets[bucketIndex(valueUs)].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            m_sum.fetch_add(valueUs, std::memory_order_relaxed);
+
+            uint64_t current = m_min.load(std::memory_order_relaxed);
+            while (valueUs < current && !m_min.compare_exchange_weak(current, valueUs, std::memory_order_relaxed))
+            {
+            }
+            current = m_max.load(std::memory_order_relaxed);
+            while (valueUs > current && !m_max.compare_exchange_weak(current, valueUs, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        uint64_t count() const
+        {
+            return m_count.load(std::memory_order_relaxed);
+        }
+
+        uint64_t sum() const
+        {
+            return m_sum.load(std::memory_order_relaxed);
+        }
+
+        uint64_t min() const
+        {
+            return (count() != 0) ? m_min.load(std::memory_order_relaxed) : 0;
+        }
+
+        uint64_t max() const
+        {
+            return m_max.load(std::memory_order_relaxed);
+        }
+
+        uint64_t mean() const
+        {
+            uint64_t n = count();
+            return (n != 0) ? (sum() / n) : 0;
+        }
+
+        /// <summary>
+        /// Returns the value at the given percentile (0..100). The result is the
+        /// midpoint of the bucket holding that rank, clamped to the observed min/max.
+        /// </summary>
+        uint64_t percentile(double pct) const
+        {
+            uint64_t total = 0;
+            uint64_t counts[BucketCount];
+            for (unsigned i = 0; i < BucketCount; i++)
+            {
+                counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+                total += counts[i];
+            }
+            if (total == 0)
+            {
+                return 0;
+            }
+
+            if (pct < 0.0)
+            {
+                pct = 0.0;
+            }
+            if (pct > 100.0)
+            {
+                pct = 100.0;
+            }
+            uint64_t rank = static_cast<uint64_t>(pct / 100.0 * static_cast<double>(total) + 0.5);
+            if (rank == 0)
+            {
+                rank = 1;
+            }
+
+            uint64_t seen = 0;
+            for (unsigned i = 0; i < BucketCount; i++)
+            {
+                seen += counts[i];
+                if (seen >= rank)
+                {
+                    uint64_t value = (bucketLowerBound(i) + bucketUpperBound(i)) / 2;
+                    uint64_t lo = min();
+                    uint64_t hi = max();
+                    if (value < lo)
+                    {
+                        value = lo;
+                    }
+                    if (value > hi)
+                    {
+                        value = hi;
+                    }
+                    return value;
+                }
+            }
+            return max();
+        }
+
+        void reset()
+        {
+            for (auto& bucket : m_buckets)
+            {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            m_count.store(0, std::memory_order_relaxed);
+            m_sum.store(0, std::memory_order_relaxed);
+            m_min.store(UINT64_MAX, std::memory_order_relaxed);
+            m_max.store(0, std::memory_order_relaxed);
+        }
+
+        static unsigned bucketIndex(uint64_t value)
+        {
+            if (value < LinearCount)
+            {
+                return static_cast<unsigned>(value);
+            }
+            unsigned shift = highestBit(value) - SubBucketBits;
+            unsigned mantissa = static_cast<unsigned>(value >> shift) - SubBucketCount;
+            return LinearCount + (shift - 1) * SubBucketCount + mantissa;
+        }
+
+        static uint64_t bucketLowerBound(unsigned index)
+        {
+            if (index < LinearCount)
+            {
+                return index;
+            }
+            unsigned shift = (index - LinearCount) / SubBucketCount + 1;
+            uint64_t mantissa = (index - LinearCount) % SubBucketCount + SubBucketCount;
+            return mantissa << shift;
+        }
+
+        static uint64_t bucketUpperBound(unsigned index)
+        {
+            if (index < LinearCount)
+            {
+                return index;
+            }
+            unsigned shift = (index - LinearCount) / SubBucketCount + 1;
+            uint64_t mantissa = (index - LinearCount) % SubBucketCount + SubBucketCount;
+            return ((mantissa + 1) << shift) - 1;
+        }
+
+    protected:
+        static unsigned highestBit(uint64_t value)
+        {
+            unsigned bit = 0;
+            if (value >> 32) { value >>= 32; bit += 32; }
+            if (value >> 16) { value >>= 16; bit += 16; }
+            if (value >> 8)  { value >>= 8;  bit += 8;  }
+            if (value >> 4)  { value >>= 4;  bit += 4;  }
+            if (value >> 2)  { value >>= 2;  bit += 2;  }
+            if (value >> 1)  { bit += 1; }
+            return bit;
+        }
+
+        std::atomic<uint64_t> m_buckets[BucketCount];
+        std::atomic<uint64_t> m_count;
+        std::atomic<uint64_t> m_sum;
+        std::atomic<uint64_t> m_min;
+        std::atomic<uint64_t> m_max;
+    };
+
+} MAT_NS_END
+
+#endif
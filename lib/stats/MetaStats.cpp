@@ -466,7 +466,7 @@ namespace MAT_NS_BEGIN {
     /// <param name="durationMs">The duration ms.</param>
     /// <param name="latencyToSendMs">The latency to send ms.</param>
     /// <param name="metastatsOnly">if set to <c>true</c> [metastats only].</param>
-    void MetaStats::updateOnPackageSentSucceeded(std::map<std::string, std::string> const& recordIdsAndTenantids, EventLatency eventLatency, unsigned retryFailedTimes, unsigned durationMs, std::vector<unsigned> const& /*latencyToSendMs*/, bool metastatsOnly)
+    void MetaStats::updateOnPackageSentSucceeded(std::map<std::string, size_t> const& countOnTenant, EventLatency eventLatency, unsigned retryFailedTimes, unsigned durationMs, std::vector<unsigned> const& /*latencyToSendMs*/, bool metastatsOnly)
     {
         // Package summary stats
         PackageStats& packageStats = m_telemetryStats.packageStats;
@@ -483,26 +483,26 @@ namespace MAT_NS_BEGIN {
         rttStats.maxOfLatencyInMilliSecs = std::max<unsigned>(rttStats.maxOfLatencyInMilliSecs, durationMs);
         rttStats.minOfLatencyInMilliSecs = std::min<unsigned>(rttStats.minOfLatencyInMilliSecs, durationMs);
 
-        auto updatePackageSent = [&](TelemetryStats& stats)
+        auto updatePackageSent = [&](TelemetryStats& stats, size_t count)
         {
             RecordStats& recordStats = stats.recordStats;
-            recordStats.sent++;
+            recordStats.sent += static_cast<unsigned>(count);
             // Update per-priority record stats
             if (eventLatency >= 0) {
                 RecordStats& recordStatsPerPriority = stats.recordStatsPerLatency[eventLatency];
-                recordStatsPerPriority.sent++;
+                recordStatsPerPriority.sent += static_cast<unsigned>(count);
             }
         };
 
         // Cumulative
-        updatePackageSent(m_telemetryStats);
+        updatePackageSent(m_telemetryStats, 1);
 
         // Per-tenant
         if (m_enableTenantStats)
         {
-            for (const auto& entry : recordIdsAndTenantids)
+            for (const auto& entry : countOnTenant)
             {
-                updatePackageSent(m_telemetryTenantStats[entry.second]);
+                updatePackageSent(m_telemetryTenantStats[entry.first], entry.second);
             }
         }
 
@@ -0,0 +1,153 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "PipelineStats.hpp"
+#include "utils/Utils.hpp"
+
+#include <algorithm>
+
+namespace MAT_NS_BEGIN {
+
+    PipelineStats::PipelineStats()
+    {
+    }
+
+    PipelineStats::~PipelineStats()
+    {
+    }
+
+    void PipelineStats::record(PipelineStage stage, int64_t startUs, int64_t endUs)
+    {
+        if (stage >= PipelineStage_Max || startUs <= 0)
+        {
+            return;
+        }
+        m_histograms[stage].record(static_cast<uint64_t>(std::max<int64_t>(0, endUs - startUs)));
+    }
+
+    /// <summary>
+    /// Takes a snapshot of the latency distribution of a pipeline stage.
+    /// </summary>
+    /// <param name="stage">The stage.</param>
+    /// <param name="stats">Receives the snapshot.</param>
+    /// <returns>false if the stage is invalid</returns>
+    bool PipelineStats::getStageStats(PipelineStage stage, PipelineStageStats& stats) const
+    {
+        if (stage >= PipelineStage_Max)
+        {
+            return false;
+        }
+        LatencyHistogram const& histogram = m_histograms[stage];
+        stats.count = histogram.count();
+        stats.minUs = histogram.min();
+        stats.maxUs = histogram.max();
+        stats.meanUs = histogram.mean();
+        stats.p50Us = histogram.percentile(50.0);
+        stats.p90Us = histogram.percentile(90.0);
+        stats.p99Us = histogram.percentile(99.0);
+        stats.p999Us = histogram.percentile(99.9);
+        return true;
+    }
+
+    void PipelineStats::reset()
+    {
+        for (auto& histogram : m_histograms)
+        {
+            histogram.reset();
+        }
+    }
+
+    /// <summary>
+    /// Short stage name used as a prefix of stats event fields.
+    /// </summary>
+    const char* PipelineStats::stageName(PipelineStage stage)
+    {
+        switch (stage)
+        {
+        case PipelineStage_Serialize:
+            return "ser";
+        case PipelineStage_Store:
+            return "sto";
+        case PipelineStage_EventToQueue:
+            return "e2q";
+        case PipelineStage_Retrieve:
+            return "ret";
+        case PipelineStage_Encode:
+            return "enc";
+        case PipelineStage_Send:
+            return "snd";
+        case PipelineStage_Decode:
+            return "dec";
+        case PipelineStage_Ack:
+            return "ack";
+        case PipelineStage_RetrieveToAck:
+            return "r2a";
+        default:
+            return "unk";
+        }
+    }
+
+    bool PipelineStats::handleOnEventSerialized(IncomingEventContextPtr const& ctx)
+    {
+        int64_t now = GetSteadyTimeUs();
+        record(PipelineStage_Serialize, ctx->createdUs, now);
+        ctx->stageStartUs = now;
+        return true;
+    }
+
+    bool PipelineStats::handleOnEventStored(IncomingEventContextPtr const& ctx)
+    {
+        int64_t now = GetSteadyTimeUs();
+        record(PipelineStage_Store, ctx->stageStartUs, now);
+        record(PipelineStage_EventToQueue, ctx->createdUs, now);
+        ctx->stageStartUs = now;
+        return true;
+    }
+
+    bool PipelineStats::handleOnUploadInitiated(EventsUploadContextPtr const& ctx)
+    {
+        ctx->startUs = GetSteadyTimeUs();
+        ctx->stageStartUs = ctx->startUs;
+        return true;
+    }
+
+    bool PipelineStats::closeStage(PipelineStage stage, EventsUploadContextPtr const& ctx)
+    {
+        int64_t now = GetSteadyTimeUs();
+        record(stage, ctx->stageStartUs, now);
+        ctx->stageStartUs = now;
+        return true;
+    }
+
+    bool PipelineStats::handleOnPackaged(EventsUploadContextPtr const& ctx)
+    {
+        return closeStage(PipelineStage_Retrieve, ctx);
+    }
+
+    bool PipelineStats::handleOnEncoded(EventsUploadContextPtr const& ctx)
+    {
+        return closeStage(PipelineStage_Encode, ctx);
+    }
+
+    bool PipelineStats::handleOnResponse(EventsUploadContextPtr const& ctx)
+    {
+        return closeStage(PipelineStage_Send, ctx);
+    }
+
+    bool PipelineStats::handleOnDecoded(EventsUploadContextPtr const& ctx)
+    {
+        return closeStage(PipelineStage_Decode, ctx);
+    }
+
+    bool PipelineStats::handleOnAcked(EventsUploadContextPtr const& ctx)
+    {
+        int64_t now = GetSteadyTimeUs();
+        record(PipelineStage_Ack, ctx->stageStartUs, now);
+        record(PipelineStage_RetrieveToAck, ctx->startUs, now);
+        ctx->stageStartUs = now;
+        return true;
+    }
+
+} MAT_NS_END
@@ -0,0 +1,69 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef PIPELINESTATS_HPP
+#define PIPELINESTATS_HPP
+
+#include "pal/PAL.hpp"
+
+#include "PipelineStageStats.hpp"
+#include "LatencyHistogram.hpp"
+
+#include "system/Route.hpp"
+#include "system/Contexts.hpp"
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Per-stage latency histograms of the telemetry pipeline.
+    /// The pass-through handlers are spliced into the route graph of the
+    /// TelemetrySystem; each one closes the stage that ends at its position
+    /// and starts the next one by stamping the context.
+    /// </summary>
+    class PipelineStats
+    {
+    public:
+        PipelineStats();
+        ~PipelineStats();
+
+        void record(PipelineStage stage, int64_t startUs, int64_t endUs);
+        bool getStageStats(PipelineStage stage, PipelineStageStats& stats) const;
+        void reset();
+
+        static const char* stageName(PipelineStage stage);
+
+    protected:
+        bool handleOnEventSerialized(IncomingEventContextPtr const& ctx);
+        bool handleOnEventStored(IncomingEventContextPtr const& ctx);
+
+        bool handleOnUploadInitiated(EventsUploadContextPtr const& ctx);
+        bool handleOnPackaged(EventsUploadContextPtr const& ctx);
+        bool handleOnEncoded(EventsUploadContextPtr const& ctx);
+        bool handleOnResponse(EventsUploadContextPtr const& ctx);
+        bool handleOnDecoded(EventsUploadContextPtr const& ctx);
+        bool handleOnAcked(EventsUploadContextPtr const& ctx);
+
+        bool closeStage(PipelineStage stage, EventsUploadContextPtr const& ctx);
+
+        LatencyHistogram m_histograms[PipelineStage_Max];
+
+    public:
+        RoutePassThrough<PipelineStats, IncomingEventContextPtr const&> onEventSerialized{ this, &PipelineStats::handleOnEventSerialized };
+        RoutePassThrough<PipelineStats, IncomingEventContextPtr const&> onEventStored{ this, &PipelineStats::handleOnEventStored };
+
+        RoutePassThrough<PipelineStats, EventsUploadContextPtr const&>  onUploadInitiated{ this, &PipelineStats::handleOnUploadInitiated };
+        RoutePassThrough<PipelineStats, EventsUploadContextPtr const&>  onPackaged{ this, &PipelineStats::handleOnPackaged };
+        RoutePassThrough<PipelineStats, EventsUploadContextPtr const&>  onEncoded{ this, &PipelineStats::handleOnEncoded };
+        RoutePassThrough<PipelineStats, EventsUploadContextPtr const&>  onResponse{ this, &PipelineStats::handleOnResponse };
+        RoutePassThrough<PipelineStats, EventsUploadContextPtr const&>  onDecoded{ this, &PipelineStats::handleOnDecoded };
+        RoutePassThrough<PipelineStats, EventsUploadContextPtr const&>  onAcked{ this, &PipelineStats::handleOnAcked };
+
+        StaticRouteHandler<decltype(&PipelineStats::handleOnEventSerialized), &PipelineStats::handleOnEventSerialized> onEventSerializedStatic{ this };
+        StaticRouteHandler<decltype(&PipelineStats::handleOnPackaged), &PipelineStats::handleOnPackaged>               onPackagedStatic{ this };
+        StaticRouteHandler<decltype(&PipelineStats::handleOnEncoded), &PipelineStats::handleOnEncoded>                 onEncodedStatic{ this };
+    };
+
+} MAT_NS_END
+
+#endif
@@ -8,6 +8,7 @@
 #include "Statistics.hpp"
 #include "ILogManager.hpp"
 #include "utils/Utils.hpp"
+#include "utils/StringUtils.hpp"
 #include <oacr.h>
 
 namespace MAT_NS_BEGIN {
@@ -65,6 +66,15 @@ namespace MAT_NS_BEGIN {
             LOCKGUARD(m_metaStats_mtx);
             records = m_metaStats.generateStatsEvent(rollupKind);
         }
+        if (!records.empty() && static_cast<bool>(m_config[CFG_MAP_METASTATS_CONFIG][CFG_BOOL_METASTATS_PIPELINE]))
+        {
+            // Cumulative stats record is always the first one
+            addPipelineStats(records[0]);
+        }
+        if (!records.empty() && static_cast<bool>(m_config[CFG_MAP_METASTATS_CONFIG][CFG_BOOL_METASTATS_POOLS]))
+        {
+            addContextPoolStats(records[0]);
+        }
         std::string tenantToken = m_config.GetMetaStatsTenantToken();
 
         for (auto& record : records)
@@ -75,8 +85,9 @@ namespace MAT_NS_BEGIN {
             result &= m_semanticContextDecorator.decorate(record, true);
             if (result)
             {
-                IncomingEventContext evt(PAL::generateUuidString(), tenantToken, EventLatency_Normal, EventPersistence_Normal, &record);
-                m_iTelemetrySystem.sendEvent(&evt);
+                auto evt = m_iTelemetrySystem.createIncomingEventContext();
+                evt->reset(PAL::generateUuidString(), tenantToken, EventLatency_Normal, EventPersistence_Normal, &record);
+                m_iTelemetrySystem.sendEvent(evt.get());
             }
             else
             {
@@ -86,6 +97,73 @@ namespace MAT_NS_BEGIN {
         m_statEventSentTime = PAL::getUtcSystemTimeMs();
     }
 
+    /// <summary>
+    /// Adds per-stage pipeline latency percentiles (in microseconds) to a stats record.
+    /// </summary>
+    /// <param name="record">The stats record.</param>
+    void Statistics::addPipelineStats(::CsProtocol::Record& record)
+    {
+        if (record.data.empty())
+        {
+            return;
+        }
+        std::map<std::string, ::CsProtocol::Value>& ext = record.data[0].properties;
+        for (int i = 0; i < PipelineStage_Max; i++)
+        {
+            PipelineStage stage = static_cast<PipelineStage>(i);
+            PipelineStageStats stageStats;
+            if (!m_iTelemetrySystem.getPipelineStageStats(stage, stageStats) || (stageStats.count == 0))
+            {
+                continue;
+            }
+            std::string prefix = std::string("pl_") + PipelineStats::stageName(stage) + "_";
+            std::pair<const char*, uint64_t> values[] = {
+                { "cnt", stageStats.count },
+                { "p50", stageStats.p50Us },
+                { "p90", stageStats.p90Us },
+                { "p99", stageStats.p99Us },
+                { "max", stageStats.maxUs }
+            };
+            for (auto const& value : values)
+            {
+                ::CsProtocol::Value temp;
+                temp.stringValue = toString(value.second);
+                ext[prefix + value.first] = temp;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Adds hit rates of the upload and incoming event context pools to a stats record.
+    /// </summary>
+    /// <param name="record">The stats record.</param>
+    void Statistics::addContextPoolStats(::CsProtocol::Record& record)
+    {
+        ObjectPoolStats pools[2];
+        if (record.data.empty() || !m_iTelemetrySystem.getContextPoolStats(pools[0], pools[1]))
+        {
+            return;
+        }
+        std::map<std::string, ::CsProtocol::Value>& ext = record.data[0].properties;
+        const char* prefixes[2] = { "pool_upload_", "pool_event_" };
+        for (size_t i = 0; i < 2; i++)
+        {
+            uint64_t requests = pools[i].hits + pools[i].misses;
+            std::pair<const char*, uint64_t> values[] = {
+                { "hits", pools[i].hits },
+                { "misses", pools[i].misses },
+                { "size", pools[i].size },
+                { "hit_pct", (requests > 0) ? (pools[i].hits * 100 / requests) : 0 }
+            };
+            for (auto const& value : values)
+            {
+                ::CsProtocol::Value temp;
+                temp.stringValue = toString(value.second);
+                ext[prefixes[i] + std::string(value.first)] = temp;
+            }
+        }
+    }
+
     bool Statistics::handleOnStart()
     {
         // synchronously send stats event on SDK start, but only if stats are enabled
@@ -155,9 +233,32 @@ namespace MAT_NS_BEGIN {
         return true;
     }
 
+    bool Statistics::isMetaStatsOnly(EventsUploadContextPtr const& ctx)
+    {
+        TenantId metaStatsTenant = m_iTelemetrySystem.getTenantTable().intern(m_config.GetMetaStatsTenantToken());
+        return ctx->packageIds.count(metaStatsTenant) == ctx->packageIds.size();
+    }
+
+    std::map<std::string, size_t> Statistics::countRecordsOnTenant(EventsUploadContextPtr const& ctx)
+    {
+        // Count by ID first, so that each token is resolved once per package
+        std::map<TenantId, size_t> countOnTenantId;
+        for (const auto& recordAndTenant : ctx->recordIdsAndTenantIds)
+        {
+            countOnTenantId[recordAndTenant.second]++;
+        }
+        TenantTable const& tenants = m_iTelemetrySystem.getTenantTable();
+        std::map<std::string, size_t> countOnTenant;
+        for (const auto& tenantAndCount : countOnTenantId)
+        {
+            countOnTenant[tenants.resolve(tenantAndCount.first)] += tenantAndCount.second;
+        }
+        return countOnTenant;
+    }
+
     bool Statistics::handleOnUploadStarted(EventsUploadContextPtr const& ctx)
     {
-        bool metastatsOnly = (ctx->packageIds.count(m_config.GetMetaStatsTenantToken()) == ctx->packageIds.size());
+        bool metastatsOnly = isMetaStatsOnly(ctx);
         {
             LOCKGUARD(m_metaStats_mtx);
             m_metaStats.updateOnPostData(static_cast<unsigned>(ctx->httpRequest->GetSizeEstimate()), metastatsOnly);
@@ -189,10 +290,10 @@ namespace MAT_NS_BEGIN {
             latencyToSendMs.push_back(static_cast<unsigned>(std::max<int64_t>(0, std::min<int64_t>(0xFFFFFFFFu, now - ts))));
         }
 
-        bool metastatsOnly = (ctx->packageIds.count(m_config.GetMetaStatsTenantToken()) == ctx->packageIds.size());
+        bool metastatsOnly = isMetaStatsOnly(ctx);
         {
             LOCKGUARD(m_metaStats_mtx);
-            m_metaStats.updateOnPackageSentSucceeded(ctx->recordIdsAndTenantIds, ctx->latency, ctx->maxRetryCountSeen, ctx->durationMs, latencyToSendMs, metastatsOnly);
+            m_metaStats.updateOnPackageSentSucceeded(countRecordsOnTenant(ctx), ctx->latency, ctx->maxRetryCountSeen, ctx->durationMs, latencyToSendMs, metastatsOnly);
         }
         scheduleSend();
         return true;
@@ -204,12 +305,7 @@ namespace MAT_NS_BEGIN {
         {
             LOCKGUARD(m_metaStats_mtx);
             m_metaStats.updateOnPackageFailed(status);
-            std::map<std::string, size_t> countOnTenant;
-            for (const auto& recordAndTenant : ctx->recordIdsAndTenantIds)
-            {
-                countOnTenant[recordAndTenant.second]++;
-            }
-            m_metaStats.updateOnRecordsRejected(REJECTED_REASON_SERVER_DECLINED, countOnTenant);
+            m_metaStats.updateOnRecordsRejected(REJECTED_REASON_SERVER_DECLINED, countRecordsOnTenant(ctx));
         }
         scheduleSend();
         return true;
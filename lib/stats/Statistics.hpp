@@ -13,6 +13,7 @@
 #include "decorators/SemanticContextDecorator.hpp"
 
 #include "MetaStats.hpp"
+#include "PipelineStats.hpp"
 #include "DebugEvents.hpp"
 #include "pal/TaskDispatcher.hpp"
 
@@ -36,6 +37,10 @@ namespace MAT_NS_BEGIN {
     protected:
         virtual void scheduleSend();
         void send(RollUpKind rollupKind);
+        void addPipelineStats(::CsProtocol::Record& record);
+        void addContextPoolStats(::CsProtocol::Record& record);
+        bool isMetaStatsOnly(EventsUploadContextPtr const& ctx);
+        std::map<std::string, size_t> countRecordsOnTenant(EventsUploadContextPtr const& ctx);
 
         bool handleOnStart();
         bool handleOnStop();
@@ -115,6 +120,8 @@ namespace MAT_NS_BEGIN {
         RoutePassThrough<Statistics, EventsUploadContextPtr const&>     onUploadFailed{ this, &Statistics::dummy_EventsUploadContextPtr };
 #endif
 
+        StaticRouteHandler<decltype(&Statistics::handleOnUploadStarted), &Statistics::handleOnUploadStarted> onUploadStartedStatic{ this };
+
         RoutePassThrough<Statistics, StorageNotificationContext const*> onStorageOpened{ this, &Statistics::handleOnStorageOpened };
         RoutePassThrough<Statistics, StorageNotificationContext const*> onStorageFailed{ this, &Statistics::handleOnStorageFailed };
         RoutePassThrough<Statistics, StorageNotificationContext const*> onStorageTrimmed{ this, &Statistics::handleOnStorageTrimmed };
@@ -91,6 +91,9 @@ namespace MAT_NS_BEGIN {
 			}
 			return true;
 		}
+
+	public:
+		StaticRouteHandler<decltype(&ClockSkewDelta::handleEncode), &ClockSkewDelta::handleEncode> encodeStatic{ this };
 	};
 
 } MAT_NS_END
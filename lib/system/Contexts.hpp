@@ -9,6 +9,8 @@
 #include "packager/ISplicer.hpp"
 #include "packager/BondSplicer.hpp"
 #include "pal/PAL.hpp"
+#include "system/MemoryBudget.hpp"
+#include "system/TenantTable.hpp"
 #include "utils/Utils.hpp"
 
 #include <map>
@@ -18,32 +20,48 @@
 
 namespace MAT_NS_BEGIN {
 
+    class EncodedPartC;
 
     class IncomingEventContext {
     public:
         ::CsProtocol::Record*  source;
+        // Pre-encoded Part C of a typed event, owned by the caller like source
+        EncodedPartC const*    partC;
         StorageRecord          record;
         std::uint64_t          policyBitFlags;
 
+        // Pipeline timing (GetSteadyTimeUs): creation and start of the current stage
+        int64_t                createdUs;
+        int64_t                stageStartUs;
+
     public:
         IncomingEventContext() :
             source(nullptr),
-            policyBitFlags(0)
+            partC(nullptr),
+            policyBitFlags(0),
+            createdUs(GetSteadyTimeUs()),
+            stageStartUs(createdUs)
         {
         }
 
 #ifdef HAVE_MAT_EVT_TRACEID   
         IncomingEventContext(std::string const& id, std::string const& tenantToken, EventLatency latency, EventPersistence persistence, ::CsProtocol::Record* source)
             : source(source),
+            partC(nullptr),
             record{ id, tenantToken, latency, persistence, (source != nullptr) ? source->cV : "" },
-	    policyBitFlags(0)
+	    policyBitFlags(0),
+            createdUs(GetSteadyTimeUs()),
+            stageStartUs(createdUs)
         {
         }
 #else
         IncomingEventContext(std::string const& id, std::string const& tenantToken, EventLatency latency, EventPersistence persistence, ::CsProtocol::Record* source)
             : source(source),
+            partC(nullptr),
             record{ id, tenantToken, latency, persistence },
-	    policyBitFlags(0)
+	    policyBitFlags(0),
+            createdUs(GetSteadyTimeUs()),
+            stageStartUs(createdUs)
         {
         }
 #endif
@@ -51,6 +69,47 @@ namespace MAT_NS_BEGIN {
         virtual ~IncomingEventContext()
         {
         }
+
+        /// <summary>
+        /// Re-initializes a pooled context, reusing the capacity of its strings and blob.
+        /// </summary>
+        void reset(std::string const& id, std::string const& tenantToken, EventLatency latency, EventPersistence persistence, ::CsProtocol::Record* source)
+        {
+            this->source = source;
+            partC = nullptr;
+            record.id.assign(id);
+            record.tenantToken.assign(tenantToken);
+            record.latency = latency;
+            record.persistence = persistence;
+#ifdef HAVE_MAT_EVT_TRACEID
+            record.traceId.assign((source != nullptr) ? source->cV : "");
+#endif
+            createdUs = GetSteadyTimeUs();
+            stageStartUs = createdUs;
+        }
+
+        /// <summary>
+        /// Returns the context to its default state without releasing memory.
+        /// </summary>
+        void clear()
+        {
+            source = nullptr;
+            partC = nullptr;
+            record.id.clear();
+            record.tenantToken.clear();
+            record.latency = EventLatency_Unspecified;
+            record.persistence = EventPersistence_Normal;
+            record.timestamp = 0;
+            record.blob.clear();
+            record.retryCount = 0;
+            record.reservedUntil = 0;
+#ifdef HAVE_MAT_EVT_TRACEID
+            record.traceId.clear();
+#endif
+            policyBitFlags = 0;
+            createdUs = 0;
+            stageStartUs = 0;
+        }
     };
 
     typedef IncomingEventContext* IncomingEventContextPtr;
@@ -74,9 +133,11 @@ namespace MAT_NS_BEGIN {
     public:
 
         /**
-        * Release unmanaged pointers associated with EventsUploadContext
+        * Delete the HTTP request and response. HTTP clients may notify the
+        * IHttpResponseCallback of the request while it is destroyed, so this
+        * must run before that callback goes away.
         */
-        void clear() noexcept
+        void releaseHttp() noexcept
         {
             if (httpRequest != nullptr) {
                 delete httpRequest;
@@ -86,6 +147,52 @@ namespace MAT_NS_BEGIN {
                 delete httpResponse;
                 httpResponse = nullptr;
             }
+            bodyMemory.Reset();
+            responseMemory.Reset();
+        }
+
+        /**
+        * Give the memory accounted to this upload back to the memory budget
+        * once the upload is over, pooled contexts keep their buffers
+        */
+        void releaseMemory() noexcept
+        {
+            packagingMemory.Reset();
+            bodyMemory.Reset();
+            responseMemory.Reset();
+        }
+
+        /**
+        * Release unmanaged pointers associated with EventsUploadContext and
+        * reset all fields, keeping the capacity of containers for reuse
+        */
+        void clear() noexcept
+        {
+            releaseHttp();
+            releaseMemory();
+            requestedMinLatency = EventLatency_Unspecified;
+            requestedMaxCount = 0;
+            if (splicer) {
+                splicer->clear();
+            }
+            maxUploadSize = 0;
+            packageFull = false;
+            latency = EventLatency_Unspecified;
+            packageIds.clear();
+#ifdef HAVE_MAT_EVT_TRACEID
+            traceId.clear();
+#endif
+            recordIdsAndTenantIds.clear();
+            recordTimestamps.clear();
+            maxRetryCountSeen = 0;
+            body.clear();
+            bodySize = 0;
+            compressed = false;
+            httpRequestId.clear();
+            durationMs = -1;
+            fromMemory = false;
+            startUs = 0;
+            stageStartUs = 0;
         }
 
         // Retrieving
@@ -95,17 +202,22 @@ namespace MAT_NS_BEGIN {
         // Packaging
         std::unique_ptr<ISplicer>            splicer;
         unsigned                             maxUploadSize = 0;
+        // Packaging stopped at maxUploadSize with events left over
+        bool                                 packageFull = false;
         EventLatency                         latency = EventLatency_Unspecified;
-        std::map<std::string, size_t>        packageIds;
+        // Splicer data package of each tenant, see TenantTable
+        std::map<TenantId, size_t>           packageIds;
 #ifdef HAVE_MAT_EVT_TRACEID  
         std::string                          traceId;
 #endif
-        std::map<std::string, std::string>   recordIdsAndTenantIds;
+        std::map<std::string, TenantId>      recordIdsAndTenantIds;
         std::vector<int64_t>                 recordTimestamps;
         unsigned                             maxRetryCountSeen = 0;
 
         // Encoding
         std::vector<uint8_t>                 body;
+        // Size of the encoded body handed to the HTTP request, kept after body is cleared
+        size_t                               bodySize = 0;
         bool                                 compressed = false;
 
         // Sending
@@ -118,6 +230,15 @@ namespace MAT_NS_BEGIN {
         int                                  durationMs = -1;
         bool                                 fromMemory = false;
 
+        // Pipeline timing (GetSteadyTimeUs): upload initiated and start of the current stage
+        int64_t                              startUs = 0;
+        int64_t                              stageStartUs = 0;
+
+        // Accounted to the process memory budget: splicer buffer, body, response body
+        MemoryReservation                    packagingMemory { MemoryCategory_Packaging };
+        MemoryReservation                    bodyMemory { MemoryCategory_UploadBodies };
+        MemoryReservation                    responseMemory { MemoryCategory_Responses };
+
         EventsUploadContext() noexcept : 
             EventsUploadContext(std::unique_ptr<ISplicer>(new BondSplicer()))
         {
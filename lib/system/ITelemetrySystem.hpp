@@ -10,6 +10,9 @@
 #include "bond/BondSerializer.hpp"
 
 #include "ILogManager.hpp"
+#include "PipelineStageStats.hpp"
+#include "utils/ObjectPool.hpp"
+#include "system/TenantTable.hpp"
 
 #include "api/IRuntimeConfig.hpp"
 
@@ -38,15 +41,64 @@ namespace MAT_NS_BEGIN {
         virtual ILogManager& getLogManager() = 0;
         virtual IRuntimeConfig& getConfig() = 0;
         virtual ISemanticContext& getContext() = 0;
+        virtual TenantTable& getTenantTable() = 0;
 
         virtual EventsUploadContextPtr createEventsUploadContext() = 0;
 
+        /// <summary>
+        /// Context for an event being logged. The caller keeps the reference
+        /// until sendEvent() returns; pooling implementations recycle it afterwards.
+        /// </summary>
+        virtual std::shared_ptr<IncomingEventContext> createIncomingEventContext()
+        {
+            return std::make_shared<IncomingEventContext>();
+        }
+
+        // Context pool hit/miss counters
+        virtual bool getContextPoolStats(ObjectPoolStats& uploadContexts, ObjectPoolStats& incomingEvents) const
+        {
+            UNREFERENCED_PARAMETER(uploadContexts);
+            UNREFERENCED_PARAMETER(incomingEvents);
+            return false;
+        }
+
         // Debug functionality
         virtual bool DispatchEvent(DebugEvent evt) override = 0;
 
         // Core sendEvent
         virtual void sendEvent(IncomingEventContextPtr const& event) = 0;
 
+        /// <summary>
+        /// Whether sendEvent() serializes IncomingEventContext::partC itself; otherwise
+        /// typed event fields are materialized into the record before sendEvent().
+        /// </summary>
+        virtual bool supportsEncodedPartC() const
+        {
+            return false;
+        }
+
+        // Number of events waiting in storage, false if unknown
+        virtual bool getPendingRecordCount(size_t& count) const
+        {
+            UNREFERENCED_PARAMETER(count);
+            return false;
+        }
+
+        // Pipeline stage latency snapshot
+        virtual bool getPipelineStageStats(PipelineStage stage, PipelineStageStats& stats) const
+        {
+            UNREFERENCED_PARAMETER(stage);
+            UNREFERENCED_PARAMETER(stats);
+            return false;
+        }
+
+        // Shutdown phase durations, false until stop() has completed
+        virtual bool getShutdownStats(ShutdownStats& stats) const
+        {
+            UNREFERENCED_PARAMETER(stats);
+            return false;
+        }
+
     protected:
         virtual void handleFlushTaskDispatcher() = 0;
         virtual void signalDone() = 0;
@@ -0,0 +1,92 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+
+#include "MemoryBudget.hpp"
+
+#include <cstdint>
+
+namespace MAT_NS_BEGIN {
+
+    constexpr size_t MemoryBudget::PressurePercent;
+
+    MemoryBudget& MemoryBudget::GetInstance()
+    {
+        // Function static: LogManagers may be created during static initialization
+        static MemoryBudget budget;
+        return budget;
+    }
+
+    MemoryBudget::MemoryBudget() :
+        m_limit(0),
+        m_used(0),
+        m_peak(0)
+    {
+        for (auto& category : m_categories)
+        {
+            category = 0;
+        }
+    }
+
+    void MemoryBudget::SetLimit(size_t bytes)
+    {
+        m_limit = bytes;
+    }
+
+    size_t MemoryBudget::Reserve(MemoryCategory category, size_t bytes)
+    {
+        if ((bytes == 0) || (GetLimit() == 0))
+        {
+            return 0;
+        }
+        m_categories[category].fetch_add(bytes, std::memory_order_relaxed);
+        size_t used = m_used.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = m_peak.load(std::memory_order_relaxed);
+        while ((used > peak) && !m_peak.compare_exchange_weak(peak, used, std::memory_order_relaxed))
+        {
+        }
+        return bytes;
+    }
+
+    void MemoryBudget::Release(MemoryCategory category, size_t bytes)
+    {
+        if (bytes == 0)
+        {
+            return;
+        }
+        m_categories[category].fetch_sub(bytes, std::memory_order_relaxed);
+        m_used.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    size_t MemoryBudget::GetAvailable() const
+    {
+        size_t limit = GetLimit();
+        if (limit == 0)
+        {
+            return SIZE_MAX;
+        }
+        size_t used = GetUsage();
+        return (used < limit) ? (limit - used) : 0;
+    }
+
+    bool MemoryBudget::IsUnderPressure() const
+    {
+        size_t limit = GetLimit();
+        return (limit != 0) && (GetUsage() >= limit / 100 * PressurePercent);
+    }
+
+    void MemoryBudget::GetStats(MemoryUsageStats& stats) const
+    {
+        stats.limitBytes = GetLimit();
+        stats.usedBytes = GetUsage();
+        stats.peakBytes = m_peak.load(std::memory_order_relaxed);
+        stats.ramQueueBytes = m_categories[MemoryCategory_RamQueue].load(std::memory_order_relaxed);
+        stats.incomingEventBytes = m_categories[MemoryCategory_IncomingEvents].load(std::memory_order_relaxed);
+        stats.packagingBytes = m_categories[MemoryCategory_Packaging].load(std::memory_order_relaxed);
+        stats.uploadBodyBytes = m_categories[MemoryCategory_UploadBodies].load(std::memory_order_relaxed);
+        stats.responseBytes = m_categories[MemoryCategory_Responses].load(std::memory_order_relaxed);
+    }
+
+} MAT_NS_END
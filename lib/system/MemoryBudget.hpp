@@ -0,0 +1,173 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef MEMORYBUDGET_HPP
+#define MEMORYBUDGET_HPP
+
+#include "ctmacros.hpp"
+#include "PipelineStageStats.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Owners of the memory accounted by MemoryBudget.
+    /// </summary>
+    enum MemoryCategory
+    {
+        /// <summary>Records in the RAM queue.</summary>
+        MemoryCategory_RamQueue,
+        /// <summary>Serialized events waiting for the hand-off into storage.</summary>
+        MemoryCategory_IncomingEvents,
+        /// <summary>Splicer buffers of the packages being built.</summary>
+        MemoryCategory_Packaging,
+        /// <summary>Spliced and compressed bodies of the uploads in flight.</summary>
+        MemoryCategory_UploadBodies,
+        /// <summary>HTTP response bodies waiting to be decoded.</summary>
+        MemoryCategory_Responses,
+        MemoryCategory_Count
+    };
+
+    /// <summary>
+    /// Process-wide accountant of the memory held by the telemetry pipelines, against the
+    /// single budget set with CFG_INT_MEMORY_BUDGET. Nothing is accounted while no budget is set.
+    ///
+    /// The budget is a soft limit: reservations always succeed, and the pipeline reacts to
+    /// the fill level instead. At IsUnderPressure() packages shrink and no extra package is
+    /// prepared ahead of the HTTP requests; the RAM queue spills to disk once it outgrows
+    /// what is left of the budget.
+    /// </summary>
+    class MemoryBudget
+    {
+    public:
+        /// <summary>
+        /// Fill level, in percent of the limit, from which IsUnderPressure() is true.
+        /// </summary>
+        static constexpr size_t PressurePercent = 75;
+
+        /// <summary>
+        /// Returns the budget of the process.
+        /// </summary>
+        static MemoryBudget& GetInstance();
+
+        MemoryBudget();
+
+        MemoryBudget(const MemoryBudget&) = delete;
+        MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+        /// <summary>
+        /// Sets the budget in bytes, 0 stops accounting. With several LogManagers
+        /// the last one configured sets the budget of the process.
+        /// </summary>
+        void SetLimit(size_t bytes);
+
+        size_t GetLimit() const
+        {
+            return m_limit.load(std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// Accounts bytes to the category.
+        /// </summary>
+        /// <returns>The bytes accounted, 0 while no budget is set. Release exactly these.</returns>
+        size_t Reserve(MemoryCategory category, size_t bytes);
+
+        void Release(MemoryCategory category, size_t bytes);
+
+        size_t GetUsage() const
+        {
+            return m_used.load(std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// Returns what is left of the budget, or SIZE_MAX while no budget is set.
+        /// </summary>
+        size_t GetAvailable() const;
+
+        bool IsUnderPressure() const;
+
+        void GetStats(MemoryUsageStats& stats) const;
+
+    protected:
+        std::atomic<size_t> m_limit;
+        std::atomic<size_t> m_used;
+        std::atomic<size_t> m_peak;
+        std::atomic<size_t> m_categories[MemoryCategory_Count];
+    };
+
+    /// <summary>
+    /// Bytes of one owner accounted to a MemoryBudget, released on destruction.
+    /// Add() and Remove() may be called concurrently, Resize() by a single owner.
+    /// </summary>
+    class MemoryReservation
+    {
+    public:
+        explicit MemoryReservation(MemoryCategory category, MemoryBudget& budget = MemoryBudget::GetInstance()) noexcept :
+            m_budget(budget),
+            m_category(category),
+            m_bytes(0)
+        {
+        }
+
+        ~MemoryReservation() noexcept
+        {
+            Reset();
+        }
+
+        MemoryReservation(const MemoryReservation&) = delete;
+        MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+        void Add(size_t bytes) noexcept
+        {
+            m_bytes += m_budget.Reserve(m_category, bytes);
+        }
+
+        /// <summary>
+        /// Releases up to bytes, never more than what is held.
+        /// </summary>
+        void Remove(size_t bytes) noexcept
+        {
+            size_t current = m_bytes.load();
+            size_t removed;
+            do
+            {
+                removed = (bytes < current) ? bytes : current;
+            } while (!m_bytes.compare_exchange_weak(current, current - removed));
+            m_budget.Release(m_category, removed);
+        }
+
+        void Resize(size_t bytes) noexcept
+        {
+            size_t current = m_bytes.load();
+            if (bytes > current)
+            {
+                Add(bytes - current);
+            }
+            else
+            {
+                Remove(current - bytes);
+            }
+        }
+
+        void Reset() noexcept
+        {
+            m_budget.Release(m_category, m_bytes.exchange(0));
+        }
+
+        size_t GetBytes() const noexcept
+        {
+            return m_bytes.load();
+        }
+
+    protected:
+        MemoryBudget&       m_budget;
+        MemoryCategory      m_category;
+        std::atomic<size_t> m_bytes;
+    };
+
+} MAT_NS_END
+
+#endif
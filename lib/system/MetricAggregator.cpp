@@ -0,0 +1,229 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "MetricAggregator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <thread>
+
+namespace MAT_NS_BEGIN {
+
+    // Magnitudes below this are counted as zero, which bounds the bucket indexes
+    static const double MinIndexableValue = 1e-9;
+
+    // Percentiles reported with each aggregate
+    static const unsigned ReportedPercentiles[] = { 50, 90, 95, 99 };
+
+    // Checked on the bits: with -ffast-math the compiler may assume std::isfinite() is always true
+    static bool isFinite(double value)
+    {
+        static const uint64_t ExponentMask = 0x7ff0000000000000ULL;
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits & ExponentMask) != ExponentMask;
+    }
+
+    QuantileSketch::QuantileSketch(double relativeAccuracy) :
+        m_gamma((1 + relativeAccuracy) / (1 - relativeAccuracy)),
+        m_logGamma(std::log(m_gamma)),
+        m_zeros(0),
+        m_count(0)
+    {
+    }
+
+    int QuantileSketch::index(double magnitude) const
+    {
+        return static_cast<int>(std::ceil(std::log(magnitude) / m_logGamma));
+    }
+
+    double QuantileSketch::value(int index) const
+    {
+        // Middle of the bucket (gamma^(i-1), gamma^i] in relative terms
+        return 2 * std::pow(m_gamma, index) / (m_gamma + 1);
+    }
+
+    void QuantileSketch::collapse(std::map<int, uint64_t>& buckets)
+    {
+        while (buckets.size() > MaxBuckets)
+        {
+            auto lowest = buckets.begin();
+            auto next = std::next(lowest);
+            next->second += lowest->second;
+            buckets.erase(lowest);
+        }
+    }
+
+    void QuantileSketch::add(double value)
+    {
+        // Infinities have no bucket: converting their index to int is undefined
+        if (!isFinite(value))
+        {
+            return;
+        }
+        if (value > MinIndexableValue)
+        {
+            m_positive[index(value)]++;
+            collapse(m_positive);
+        }
+        else if (value < -MinIndexableValue)
+        {
+            m_negative[index(-value)]++;
+            collapse(m_negative);
+        }
+        else
+        {
+            m_zeros++;
+        }
+        m_count++;
+    }
+
+    void QuantileSketch::merge(QuantileSketch const& other)
+    {
+        for (auto const& kv : other.m_positive)
+        {
+            m_positive[kv.first] += kv.second;
+        }
+        for (auto const& kv : other.m_negative)
+        {
+            m_negative[kv.first] += kv.second;
+        }
+        collapse(m_positive);
+        collapse(m_negative);
+        m_zeros += other.m_zeros;
+        m_count += other.m_count;
+    }
+
+    void QuantileSketch::clear()
+    {
+        m_positive.clear();
+        m_negative.clear();
+        m_zeros = 0;
+        m_count = 0;
+    }
+
+    double QuantileSketch::quantile(double q) const
+    {
+        if (m_count == 0)
+        {
+            return 0;
+        }
+
+        q = std::min(std::max(q, 0.0), 1.0);
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(m_count - 1));
+
+        // Ascending order: negative values by decreasing magnitude, zeros, positive values
+        uint64_t seen = 0;
+        for (auto it = m_negative.rbegin(); it != m_negative.rend(); ++it)
+        {
+            seen += it->second;
+            if (seen > rank)
+            {
+                return -value(it->first);
+            }
+        }
+        seen += m_zeros;
+        if (seen > rank)
+        {
+            return 0;
+        }
+        for (auto const& kv : m_positive)
+        {
+            seen += kv.second;
+            if (seen > rank)
+            {
+                return value(kv.first);
+            }
+        }
+        return m_positive.empty() ? 0 : value(m_positive.rbegin()->first);
+    }
+
+    MetricAggregator::MetricAggregator()
+    {
+        for (auto& shard : m_shards)
+        {
+            shard.reset(new Shard());
+        }
+    }
+
+    MetricAggregator::Shard& MetricAggregator::shardOfThisThread()
+    {
+        size_t hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+        return *m_shards[hash % ShardCount];
+    }
+
+    void MetricAggregator::push(double value)
+    {
+        // Non-finite values would also turn the sum, minimum and maximum into NaN or infinity
+        if (!isFinite(value))
+        {
+            return;
+        }
+
+        Shard& shard = shardOfThisThread();
+        std::lock_guard<std::mutex> lock(shard.lock);
+        if (shard.count == 0)
+        {
+            shard.min = shard.max = value;
+        }
+        else
+        {
+            shard.min = std::min(shard.min, value);
+            shard.max = std::max(shard.max, value);
+        }
+        shard.count++;
+        shard.sum += value;
+        shard.sumOfSquares += value * value;
+        shard.sketch.add(value);
+    }
+
+    bool MetricAggregator::collect(AggregatedMetricData& metricData)
+    {
+        uint64_t count = 0;
+        double sum = 0, sumOfSquares = 0, min = 0, max = 0;
+        QuantileSketch sketch;
+
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard<std::mutex> lock(shard->lock);
+            if (shard->count == 0)
+            {
+                continue;
+            }
+            min = (count == 0) ? shard->min : std::min(min, shard->min);
+            max = (count == 0) ? shard->max : std::max(max, shard->max);
+            count += shard->count;
+            sum += shard->sum;
+            sumOfSquares += shard->sumOfSquares;
+            sketch.merge(shard->sketch);
+
+            shard->count = 0;
+            shard->sum = 0;
+            shard->sumOfSquares = 0;
+            shard->sketch.clear();
+        }
+
+        if (count == 0)
+        {
+            return false;
+        }
+
+        metricData.count = static_cast<long>(count);
+        metricData.aggregates[AggregateType_Sum] = sum;
+        metricData.aggregates[AggregateType_SumOfSquares] = sumOfSquares;
+        metricData.aggregates[AggregateType_Minimum] = min;
+        metricData.aggregates[AggregateType_Maximum] = max;
+        for (unsigned percentile : ReportedPercentiles)
+        {
+            // The estimate is off by the relative accuracy, keep it within the observed range
+            double estimate = sketch.quantile(percentile / 100.0);
+            metricData.percentiles[percentile] = std::min(std::max(estimate, min), max);
+        }
+        return true;
+    }
+
+} MAT_NS_END
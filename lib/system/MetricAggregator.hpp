@@ -0,0 +1,108 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef METRICAGGREGATOR_HPP
+#define METRICAGGREGATOR_HPP
+
+#include "ctmacros.hpp"
+#include "ILogger.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Compact quantile sketch: values are counted in logarithmic buckets, so that
+    /// any quantile is estimated within a relative error of relativeAccuracy while
+    /// the size only grows with the log of the range of the values.
+    /// </summary>
+    class QuantileSketch
+    {
+    public:
+        /// Buckets kept per sign. Past this, the buckets closest to zero are merged.
+        static const size_t MaxBuckets = 1024;
+
+        explicit QuantileSketch(double relativeAccuracy = 0.01);
+
+        void add(double value);
+        void merge(QuantileSketch const& other);
+        void clear();
+
+        /// <summary>
+        /// Estimates the value at quantile q, between 0 and 1.
+        /// </summary>
+        double quantile(double q) const;
+
+        uint64_t count() const
+        {
+            return m_count;
+        }
+
+        size_t bucketCount() const
+        {
+            return m_positive.size() + m_negative.size();
+        }
+
+    protected:
+        int index(double magnitude) const;
+        double value(int index) const;
+        static void collapse(std::map<int, uint64_t>& buckets);
+
+        double                    m_gamma;
+        double                    m_logGamma;
+        std::map<int, uint64_t>   m_positive;
+        std::map<int, uint64_t>   m_negative;
+        uint64_t                  m_zeros;
+        uint64_t                  m_count;
+    };
+
+    /// <summary>
+    /// Accumulates the values of one metric series: count, sum, sum of squares,
+    /// min, max and a QuantileSketch. Values are pushed into per-thread shards,
+    /// so that threads pushing at high rates do not contend on one lock, and
+    /// merged when collected.
+    /// </summary>
+    class MetricAggregator
+    {
+    public:
+        static const size_t ShardCount = 8;
+
+        MetricAggregator();
+
+        MetricAggregator(const MetricAggregator&) = delete;
+        MetricAggregator& operator=(const MetricAggregator&) = delete;
+
+        void push(double value);
+
+        /// <summary>
+        /// Moves the values pushed since the last call into the count, aggregates
+        /// and percentiles of metricData.
+        /// </summary>
+        /// <returns>false if no value was pushed.</returns>
+        bool collect(AggregatedMetricData& metricData);
+
+    protected:
+        struct Shard
+        {
+            std::mutex     lock;
+            uint64_t       count = 0;
+            double         sum = 0;
+            double         sumOfSquares = 0;
+            double         min = 0;
+            double         max = 0;
+            QuantileSketch sketch;
+        };
+
+        Shard& shardOfThisThread();
+
+        std::unique_ptr<Shard> m_shards[ShardCount];
+    };
+
+} MAT_NS_END
+
+#endif
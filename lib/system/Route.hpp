@@ -8,6 +8,9 @@
 #include "pal/PAL.hpp"
 
 #include <assert.h>
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace MAT_NS_BEGIN {
@@ -63,9 +66,102 @@ namespace MAT_NS_BEGIN {
     using RoutePassThrough = RouteHandlerT<IRoutePassThrough<TArgs...>, TOwner, TArgs...>;
 
 
+    //! Tag base of route stages that are bound at compile time (see StaticRouteHandler)
+    class StaticRouteStage {
+    };
+
+
+    //! Compile-time route stage - calls a handler fixed at compile time, without virtual dispatch
+    template<typename THandlerType, THandlerType THandler>
+    class StaticRouteHandler;
+
+    template<typename TOwner, typename TReturn, typename... TArgs, TReturn(TOwner::* THandler)(TArgs...)>
+    class StaticRouteHandler<TReturn(TOwner::*)(TArgs...), THandler> : public StaticRouteStage {
+    public:
+        using ReturnType = TReturn;
+
+        explicit StaticRouteHandler(TOwner* owner)
+            : m_owner(owner)
+        {
+        }
+
+        template<typename... TRealArgs>
+        TReturn operator()(TRealArgs&& ... args) const
+        {
+            return (m_owner->*THandler)(std::forward<TRealArgs>(args) ...);
+        }
+
+    protected:
+        TOwner* m_owner;
+    };
+
+
+    //! Compile-time composition of two route stages - the second one runs only if the first one passes
+    template<typename TFirst, typename TSecond>
+    class StaticRouteChain : public StaticRouteStage {
+        static_assert(std::is_same<typename TFirst::ReturnType, bool>::value, "Route sink must be the last stage of a route");
+
+    public:
+        using ReturnType = typename TSecond::ReturnType;
+
+        StaticRouteChain(TFirst const& first, TSecond const& second)
+            : m_first(first),
+            m_second(second)
+        {
+        }
+
+        template<typename... TRealArgs>
+        ReturnType operator()(TRealArgs&& ... args) const
+        {
+            return invoke(std::is_same<ReturnType, bool>(), std::forward<TRealArgs>(args) ...);
+        }
+
+    protected:
+        // Only the last stage may consume (move from) the arguments
+        template<typename... TRealArgs>
+        bool invoke(std::true_type, TRealArgs&& ... args) const
+        {
+            return m_first(args ...) && m_second(std::forward<TRealArgs>(args) ...);
+        }
+
+        template<typename... TRealArgs>
+        void invoke(std::false_type, TRealArgs&& ... args) const
+        {
+            if (m_first(args ...)) {
+                m_second(std::forward<TRealArgs>(args) ...);
+            }
+        }
+
+        TFirst  m_first;
+        TSecond m_second;
+    };
+
+
+    //! Route sink over a compile-time composed route - one virtual call for the whole route
+    template<typename TChain, typename... TArgs>
+    class StaticRouteSink : public IRouteSink<TArgs...> {
+    public:
+        explicit StaticRouteSink(TChain const& chain)
+            : m_chain(chain)
+        {
+        }
+
+        virtual void operator()(TArgs... args) override
+        {
+            m_chain(std::forward<TArgs>(args) ...);
+        }
+
+    protected:
+        TChain m_chain;
+    };
+
+
     template<typename... TArgs>
     class RouteBuilder;
 
+    template<typename TChain, typename... TArgs>
+    class StaticRouteBuilder;
+
 
     //! Route source - call like a function to send data downstream
     template<typename... TArgs>
@@ -92,10 +188,27 @@ namespace MAT_NS_BEGIN {
             return RouteBuilder<TArgs...>(*this, target);
         }
 
+        template<typename TStage, typename = typename std::enable_if<std::is_base_of<StaticRouteStage, TStage>::value>::type>
+        StaticRouteBuilder<TStage, TArgs...> operator>>(TStage const& target)
+        {
+            if (m_target != nullptr || !m_passthroughs.empty()) {
+                assert(!"Source already bound");
+            }
+            return StaticRouteBuilder<TStage, TArgs...>(this, target);
+        }
+
         void connect(std::vector<IRoutePassThrough<TArgs...>*>&& passthroughs, IRouteSink<TArgs...>* sink)
         {
             m_passthroughs = std::move(passthroughs);
             m_target = sink;
+            m_ownedTarget.reset();
+        }
+
+        void connect(std::unique_ptr<IRouteSink<TArgs...>>&& route)
+        {
+            m_passthroughs.clear();
+            m_ownedTarget = std::move(route);
+            m_target = m_ownedTarget.get();
         }
 
         template<typename... TRealArgs>
@@ -114,6 +227,7 @@ namespace MAT_NS_BEGIN {
     protected:
         std::vector<IRoutePassThrough<TArgs...>*> m_passthroughs;
         IRouteSink<TArgs...>*                     m_target;
+        std::unique_ptr<IRouteSink<TArgs...>>     m_ownedTarget;
     };
 
 
@@ -186,6 +300,51 @@ namespace MAT_NS_BEGIN {
         std::vector<IRoutePassThrough<TArgs...>*> m_passthroughs;
     };
 
+
+    //! Helper - composes compile-time route stages with operator >>, binds the source when done
+    template<typename TChain, typename... TArgs>
+    class StaticRouteBuilder {
+    public:
+        StaticRouteBuilder(RouteSource<TArgs...>* source, TChain const& chain)
+            : m_source(source),
+            m_chain(chain)
+        {
+        }
+
+        StaticRouteBuilder(StaticRouteBuilder const&) = delete;
+        StaticRouteBuilder& operator=(StaticRouteBuilder const&) = delete;
+
+        StaticRouteBuilder(StaticRouteBuilder&& other)
+            : m_source(other.m_source),
+            m_chain(other.m_chain)
+        {
+            other.m_source = nullptr;
+        }
+
+        template<typename TStage>
+        StaticRouteBuilder<StaticRouteChain<TChain, TStage>, TArgs...> operator>>(TStage const& target)
+        {
+            static_assert(std::is_base_of<StaticRouteStage, TStage>::value, "Static routes can only be composed of static route stages");
+            if (m_source == nullptr) {
+                assert(!"Builder instance inactive (wrong temporary)");
+            }
+            RouteSource<TArgs...>* source = m_source;
+            m_source = nullptr;
+            return StaticRouteBuilder<StaticRouteChain<TChain, TStage>, TArgs...>(source, StaticRouteChain<TChain, TStage>(m_chain, target));
+        }
+
+        ~StaticRouteBuilder()
+        {
+            if (m_source != nullptr) {
+                m_source->connect(std::unique_ptr<IRouteSink<TArgs...>>(new StaticRouteSink<TChain, TArgs...>(m_chain)));
+            }
+        }
+
+    protected:
+        RouteSource<TArgs...>* m_source;
+        TChain                 m_chain;
+    };
+
 } MAT_NS_END
 #endif
 
@@ -0,0 +1,40 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+
+#include "SharedRuntime.hpp"
+#include "http/HttpClientFactory.hpp"
+
+namespace MAT_NS_BEGIN {
+
+    std::shared_ptr<SharedRuntime> SharedRuntime::acquire()
+    {
+        // Function statics: LogManagers may be created during static initialization
+        static std::mutex lock;
+        static std::weak_ptr<SharedRuntime> current;
+
+        std::lock_guard<std::mutex> guard(lock);
+        std::shared_ptr<SharedRuntime> runtime = current.lock();
+        if (!runtime)
+        {
+            runtime = std::make_shared<SharedRuntime>();
+            current = runtime;
+        }
+        return runtime;
+    }
+
+    std::shared_ptr<IHttpClient> SharedRuntime::getHttpClient()
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+#ifdef HAVE_MAT_DEFAULT_HTTP_CLIENT
+        if (!m_httpClient)
+        {
+            m_httpClient = HttpClientFactory::Create();
+        }
+#endif
+        return m_httpClient;
+    }
+
+} MAT_NS_END
@@ -0,0 +1,57 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef SHAREDRUNTIME_HPP
+#define SHAREDRUNTIME_HPP
+
+#include "ctmacros.hpp"
+#include "IHttpClient.hpp"
+#include "tpm/UploadCoordinator.hpp"
+
+#include <memory>
+#include <mutex>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Parts of the upload path shared by the LogManagers of a process that enable
+    /// CFG_BOOL_SHARED_RUNTIME: one HTTP client and one UploadCoordinator. Storage,
+    /// packaging and retries stay per LogManager. The task dispatcher needs no
+    /// sharing here, PAL::getDefaultTaskDispatcher() is already process-wide.
+    ///
+    /// The runtime lives as long as one of the LogManagers holds it.
+    /// </summary>
+    class SharedRuntime
+    {
+    public:
+        /// <summary>
+        /// Returns the runtime of the process, creating it for the first holder.
+        /// </summary>
+        static std::shared_ptr<SharedRuntime> acquire();
+
+        SharedRuntime() = default;
+
+        SharedRuntime(const SharedRuntime&) = delete;
+        SharedRuntime& operator=(const SharedRuntime&) = delete;
+
+        /// <summary>
+        /// Returns the default HTTP client, created on first use, or nullptr if the
+        /// SDK is built without one.
+        /// </summary>
+        std::shared_ptr<IHttpClient> getHttpClient();
+
+        UploadCoordinator& getUploadCoordinator()
+        {
+            return m_uploadCoordinator;
+        }
+
+    protected:
+        std::mutex                    m_lock;
+        std::shared_ptr<IHttpClient>  m_httpClient;
+        UploadCoordinator             m_uploadCoordinator;
+    };
+
+} MAT_NS_END
+
+#endif
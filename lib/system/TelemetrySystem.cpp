@@ -35,7 +35,7 @@ namespace MAT_NS_BEGIN {
         httpEncoder(*this, httpClient),
         httpDecoder(*this),
         storage(*this, offlineStorage),
-        packager(runtimeConfig),
+        packager(runtimeConfig, m_tenants),
         tpm(*this, taskDispatcher, bandwidthController)
     {
 
@@ -58,67 +58,82 @@ namespace MAT_NS_BEGIN {
             uint32_t timeoutInSec = m_config.GetTeardownTime();
 
             bool result = true;
-            int64_t stopTimes[5] = { 0, 0, 0, 0, 0 };
+            ShutdownStats stopTimes;
+            int64_t stopStarted = GetUptimeMs();
 
             // Perform upload only if not paused
             if ((timeoutInSec > 0) && (!tpm.isPaused()))
             {
                 // perform uploads if required
-                stopTimes[0] = GetUptimeMs();
+                stopTimes.uploadMs = GetUptimeMs();
                 LOG_TRACE("Shutdown timer started...");
                 upload();
-                // Try to push thru as much data as possible.
-                // If either data is available for upload or
-                // If there's outstanding request (some records marked in-flight),
-                // then try to wait for up to config[CFG_INT_MAX_TEARDOWN_TIME]
-                while (storage.GetRecordCount() || tpm.isUploadInProgress() )
+                // Try to push thru the uploads in progress. The log manager is paused for
+                // teardown, so no new upload starts: wake up on every upload completion
+                // rather than polling, for up to config[CFG_INT_MAX_TEARDOWN_TIME]
+                int64_t deadline = stopTimes.uploadMs + 1000L * timeoutInSec;
+                for (;;)
                 {
-                    auto uploadTime = GetUptimeMs() - stopTimes[0];
-                    if (uploadTime >= (1000L * timeoutInSec))
+                    uint64_t progress = tpm.getUploadProgress();
+                    if (!tpm.isUploadInProgress())
+                    {
+                        break;
+                    }
+                    int64_t now = GetUptimeMs();
+                    if (now >= deadline)
                     {
                         // Hard-stop if it takes longer than planned
                         LOG_TRACE("Shutdown timer expired, exiting...");
                         break;
                     }
-                    MAT::sleep(100);
+                    tpm.waitForUploadProgress(progress, std::chrono::milliseconds { deadline - now });
                     LOG_INFO("offline records=%zu, pending uploads=%zu", storage.GetRecordCount(), hcm.requestCount());
                 }
-                stopTimes[0] = GetUptimeMs() - stopTimes[0];
+                stopTimes.uploadMs = GetUptimeMs() - stopTimes.uploadMs;
             }
 
             // cancel all pending and force-finish all uploads
-            stopTimes[1] = GetUptimeMs();
+            stopTimes.abortMs = GetUptimeMs();
             // TODO: Should this still pause, since the TPM now has abort logic in addition to pause logic?
             // hcm.cancelAllRequests is also part of pause, so the logic is definitely redundant. Issue 387
-            onPause();
+            tpm.pause();
+            hcm.cancelAllRequestsAsync();
+            // Save the in-memory events to disk while the worker thread completes the canceled requests
+            storage.FlushForShutdown();
             hcm.cancelAllRequests();
             tpm.finishAllUploads();
-            stopTimes[1] = GetUptimeMs() - stopTimes[1];
+            stopTimes.abortMs = GetUptimeMs() - stopTimes.abortMs;
 
             // initiate the stop sequence
-            stopTimes[2] = GetUptimeMs();
+            stopTimes.stopMs = GetUptimeMs();
             result &= tpm.stop();
-            stopTimes[2] = GetUptimeMs() - stopTimes[2];
+            stopTimes.stopMs = GetUptimeMs() - stopTimes.stopMs;
 
             // cancel all pending tasks
-            stopTimes[3] = GetUptimeMs();
+            stopTimes.workerMs = GetUptimeMs();
             LOG_TRACE("Waiting for all queued callbacks...");
             m_done.wait();
             LOG_TRACE("Stopped.");
-            stopTimes[3] = GetUptimeMs() - stopTimes[3];
+            stopTimes.workerMs = GetUptimeMs() - stopTimes.workerMs;
 
             // stop storage
-            stopTimes[4] = GetUptimeMs();
+            stopTimes.storageMs = GetUptimeMs();
             storage.stop();
-            stopTimes[4] = GetUptimeMs() - stopTimes[4];
+            stopTimes.storageMs = GetUptimeMs() - stopTimes.storageMs;
+            stopTimes.totalMs = GetUptimeMs() - stopStarted;
 
 #if 1       // Shutdown performance printout
-            LOG_WARN("upload  = %lld ms", stopTimes[0]);
-            LOG_WARN("abort   = %lld ms", stopTimes[1]);
-            LOG_WARN("stop    = %lld ms", stopTimes[2]);
-            LOG_WARN("worker  = %lld ms", stopTimes[3]);
-            LOG_WARN("storage = %lld ms", stopTimes[4]);
+            LOG_WARN("upload  = %lld ms", stopTimes.uploadMs);
+            LOG_WARN("abort   = %lld ms", stopTimes.abortMs);
+            LOG_WARN("stop    = %lld ms", stopTimes.stopMs);
+            LOG_WARN("worker  = %lld ms", stopTimes.workerMs);
+            LOG_WARN("storage = %lld ms", stopTimes.storageMs);
 #endif
+            {
+                LOCKGUARD(m_shutdownStatsLock);
+                m_shutdownStats = stopTimes;
+                m_isShutdownComplete = true;
+            }
 
             return result;
         };
@@ -148,16 +163,17 @@ namespace MAT_NS_BEGIN {
 
         tpm.allUploadsFinished >> stats.onStop >> this->flushTaskDispatcher;
 
-        // On an arbitrary user thread
-        this->sending >> bondSerializer.serialize >> this->incomingEventPrepared;
-
-        // On the inner worker thread
-        this->preparedIncomingEvent >> storage.storeRecord >> stats.onIncomingEventAccepted >> tpm.eventArrived;
+        // On an arbitrary user thread. The hot routes are composed at compile time, see StaticRouteHandler
+        this->sending >> bondSerializer.serializeStatic >> pipelineStats.onEventSerializedStatic >> this->incomingEventPreparedStatic;
 
+        // On the logging thread: storage takes its own locks, the notifications behind it run under m_storeLock
+        this->preparedIncomingEvent >> storage.storeRecord >> this->incomingEventStored;
+        this->storedIncomingEvent >> pipelineStats.onEventStored >> stats.onIncomingEventAccepted >> tpm.eventArrived;
 
-        storage.storeRecordFailed >> stats.onIncomingEventFailed;
+        storage.storeRecordFailed >> this->incomingEventFailed;
+        this->failedIncomingEvent >> stats.onIncomingEventFailed;
 
-        tpm.initiateUpload >> storage.retrieveEvents;
+        tpm.initiateUpload >> pipelineStats.onUploadInitiated >> storage.retrieveEvents;
 
         storage.retrievedEvent >> packager.addEventToPackage;
         storage.retrievalFinished >> packager.finalizePackage;
@@ -165,30 +181,34 @@ namespace MAT_NS_BEGIN {
         storage.retrievalFailed >> tpm.nothingToUpload;
         packager.emptyPackage >> tpm.nothingToUpload;
 
-        packager.packagedEvents >>
+        packager.packagedEvents >> pipelineStats.onPackagedStatic >>
 #ifdef HAVE_MAT_ZLIB
-        compression.compress >>
+        compression.compressStatic >>
 #endif
-        httpEncoder.encode >> clockSkewDelta.encode >> stats.onUploadStarted >> hcm.sendRequest;
+        httpEncoder.encodeStatic >> clockSkewDelta.encodeStatic >> pipelineStats.onEncodedStatic >> tpm.uploadPreparedStatic >> stats.onUploadStartedStatic >> hcm.sendRequestStatic;
+
+        // Pipelined uploads: prepared packages held by TPM until an HTTP request completes
+        tpm.sendPreparedUpload >> stats.onUploadStarted >> hcm.sendRequest;
+        tpm.preparedUploadDropped >> storage.releaseRecords >> tpm.eventsUploadAborted;
 
 #ifdef HAVE_MAT_ZLIB
         compression.compressionFailed >> storage.releaseRecords >> stats.onPackagingFailed >> tpm.packagingFailed;
 #endif
 
-        hcm.requestDone >> clockSkewDelta.decode >> httpDecoder.decode;
+        hcm.requestDone >> pipelineStats.onResponse >> clockSkewDelta.decode >> httpDecoder.decode;
 
-        httpDecoder.eventsAccepted >> storage.deleteRecords >> stats.onUploadSuccessful >> tpm.eventsUploadSuccessful;
-        httpDecoder.eventsRejected >> storage.deleteRecords >> stats.onUploadRejected >> tpm.eventsUploadRejected;
-        httpDecoder.temporaryNetworkFailure >> storage.releaseRecords >> stats.onUploadFailed >> tpm.eventsUploadFailed;
-        httpDecoder.temporaryServerFailure >> storage.releaseRecordsIncRetryCount >> stats.onUploadFailed >> tpm.eventsUploadFailed;
-        httpDecoder.requestAborted >> storage.releaseRecords >> stats.onUploadFailed >> tpm.eventsUploadAborted;
+        httpDecoder.eventsAccepted >> pipelineStats.onDecoded >> storage.deleteRecords >> pipelineStats.onAcked >> stats.onUploadSuccessful >> tpm.eventsUploadSuccessful;
+        httpDecoder.eventsRejected >> pipelineStats.onDecoded >> storage.deleteRecords >> pipelineStats.onAcked >> stats.onUploadRejected >> tpm.eventsUploadRejected;
+        httpDecoder.temporaryNetworkFailure >> pipelineStats.onDecoded >> storage.releaseRecords >> stats.onUploadFailed >> tpm.eventsUploadFailed;
+        httpDecoder.temporaryServerFailure >> pipelineStats.onDecoded >> storage.releaseRecordsIncRetryCount >> stats.onUploadFailed >> tpm.eventsUploadFailed;
+        httpDecoder.requestAborted >> pipelineStats.onDecoded >> storage.releaseRecords >> stats.onUploadFailed >> tpm.eventsUploadAborted;
 
 
         //
         // Storage notifications
         //
 
-        storage.opened >> stats.onStorageOpened;
+        storage.opened >> stats.onStorageOpened >> this->storageOpened;
         storage.failed >> stats.onStorageFailed;
         storage.trimmed >> stats.onStorageTrimmed;
         storage.recordsDropped >> stats.onStorageRecordsDropped;
@@ -226,9 +246,21 @@ namespace MAT_NS_BEGIN {
         }
 
         event->source = nullptr;
+        event->partC = nullptr;
         preparedIncomingEventAsync(event);
     }
 
+    void TelemetrySystem::handleStorageOpened(StorageNotificationContext const* ctx)
+    {
+        UNREFERENCED_PARAMETER(ctx);
+        // The storage opened in the background after the start-up upload,
+        // send the records recovered from disk without waiting for the timer
+        if (m_config[CFG_BOOL_ASYNC_STORAGE_OPEN])
+        {
+            upload();
+        }
+    }
+
     void TelemetrySystem::handleFlushTaskDispatcher()
     {
         signalDone();
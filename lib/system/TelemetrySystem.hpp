@@ -55,12 +55,29 @@ namespace MAT_NS_BEGIN {
         ~TelemetrySystem();
 
         virtual bool upload() override;
+        virtual bool supportsEncodedPartC() const override
+        {
+            return true;
+        }
+        virtual bool getPendingRecordCount(size_t& count) const override
+        {
+            count = storage.GetRecordCount();
+            return true;
+        }
+        virtual bool getShutdownStats(ShutdownStats& stats) const override
+        {
+            LOCKGUARD(m_shutdownStatsLock);
+            stats = m_shutdownStats;
+            return m_isShutdownComplete;
+        }
         virtual void handleIncomingEventPrepared(IncomingEventContextPtr const& event) override;
 
     protected:
 
         virtual void handleFlushTaskDispatcher() override;
 
+        void handleStorageOpened(StorageNotificationContext const* ctx);
+
 #ifdef HAVE_MAT_ZLIB
         HttpDeflateCompression    compression;
 #else
@@ -75,9 +92,15 @@ namespace MAT_NS_BEGIN {
         TransmissionPolicyManager tpm;
         ClockSkewDelta            clockSkewDelta;
 
+        mutable std::mutex        m_shutdownStatsLock;
+        ShutdownStats             m_shutdownStats;
+        bool                      m_isShutdownComplete { false };
+
     public:
         RouteSink<TelemetrySystem>                                 flushTaskDispatcher{ this, &TelemetrySystem::handleFlushTaskDispatcher };
+        RouteSink<TelemetrySystem, StorageNotificationContext const*> storageOpened{ this, &TelemetrySystem::handleStorageOpened };
         RouteSink<TelemetrySystem, IncomingEventContextPtr const&> incomingEventPrepared{ this, &TelemetrySystem::handleIncomingEventPrepared };
+        StaticRouteHandler<decltype(&TelemetrySystem::handleIncomingEventPrepared), &TelemetrySystem::handleIncomingEventPrepared> incomingEventPreparedStatic{ this };
     };
 
 } MAT_NS_END
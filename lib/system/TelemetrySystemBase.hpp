@@ -8,6 +8,7 @@
 #include "system/ITelemetrySystem.hpp"
 #include "ITaskDispatcher.hpp"
 #include "stats/Statistics.hpp"
+#include "stats/PipelineStats.hpp"
 #include <functional>
 
 namespace MAT_NS_BEGIN {
@@ -131,9 +132,31 @@ namespace MAT_NS_BEGIN {
 
         virtual void preparedIncomingEventAsync(IncomingEventContextPtr const& event) override
         {
+            // Decoration, serialization and storage run in parallel on the logging threads,
+            // only the stats and upload scheduler notifications are serialized.
+            MemoryReservation pending(MemoryCategory_IncomingEvents);
+            pending.Add(event->record.blob.size());
             preparedIncomingEvent(event);
         };
 
+        /// <summary>
+        /// Forwards an event accepted by storage to stats and the upload scheduler.
+        /// </summary>
+        void handleIncomingEventStored(IncomingEventContextPtr const& event)
+        {
+            LOCKGUARD(m_storeLock);
+            storedIncomingEvent(event);
+        }
+
+        /// <summary>
+        /// Forwards an event rejected by storage to stats.
+        /// </summary>
+        void handleIncomingEventFailed(IncomingEventContextPtr const& event)
+        {
+            LOCKGUARD(m_storeLock);
+            failedIncomingEvent(event);
+        }
+
         void sendEvent(IncomingEventContextPtr const& event) override
         {
             sending(event);
@@ -162,9 +185,29 @@ namespace MAT_NS_BEGIN {
             return m_logManager.GetSemanticContext();
         }
 
+        /// <summary>
+        /// Gets the tenant tokens interned by the upload pipeline.
+        /// </summary>
+        TenantTable& getTenantTable() override
+        {
+            return m_tenants;
+        }
+
         EventsUploadContextPtr createEventsUploadContext() override
         {
-            return std::make_shared<EventsUploadContext>();
+            return m_uploadContextPool.acquire();
+        }
+
+        std::shared_ptr<IncomingEventContext> createIncomingEventContext() override
+        {
+            return m_incomingEventContextPool.acquire();
+        }
+
+        virtual bool getContextPoolStats(ObjectPoolStats& uploadContexts, ObjectPoolStats& incomingEvents) const override
+        {
+            uploadContexts = m_uploadContextPool.getStats();
+            incomingEvents = m_incomingEventContextPool.getStats();
+            return true;
         }
 
         virtual bool DispatchEvent(DebugEvent evt) override
@@ -172,16 +215,28 @@ namespace MAT_NS_BEGIN {
             return m_logManager.DispatchEvent(std::move(evt));
         }
 
+        virtual bool getPipelineStageStats(PipelineStage stage, PipelineStageStats& stats) const override
+        {
+            return pipelineStats.getStageStats(stage, stats);
+        }
+
     protected:
         std::mutex              m_lock;
+        std::recursive_mutex    m_storeLock;
         ILogManager &           m_logManager;
         IRuntimeConfig &        m_config;
         std::atomic<bool>       m_isStarted;
         std::atomic<bool>       m_isPaused;
         PAL::Event              m_done;
+        TenantTable             m_tenants;
         BondSerializer          bondSerializer;
+        PipelineStats           pipelineStats;
         Statistics              stats;
 
+        // Enough for every in-flight and prepared upload, and for concurrently logging threads
+        ObjectPool<EventsUploadContext>  m_uploadContextPool { 16 };
+        ObjectPool<IncomingEventContext> m_incomingEventContextPool { 64 };
+
         std::function<bool(void)>                                  onStart;
         std::function<bool(void)>                                  onStop;
         std::function<bool(void)>                                  onPause;
@@ -192,6 +247,10 @@ namespace MAT_NS_BEGIN {
     public:
         RouteSource<IncomingEventContextPtr const&>                sending;
         RouteSource<IncomingEventContextPtr const&>                preparedIncomingEvent;
+        RouteSource<IncomingEventContextPtr const&>                storedIncomingEvent;
+        RouteSource<IncomingEventContextPtr const&>                failedIncomingEvent;
+        RouteSink<TelemetrySystemBase, IncomingEventContextPtr const&> incomingEventStored{ this, &TelemetrySystemBase::handleIncomingEventStored };
+        RouteSink<TelemetrySystemBase, IncomingEventContextPtr const&> incomingEventFailed{ this, &TelemetrySystemBase::handleIncomingEventFailed };
 
     };
 
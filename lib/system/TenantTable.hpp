@@ -0,0 +1,80 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef TENANTTABLE_HPP
+#define TENANTTABLE_HPP
+
+#include "ctmacros.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Small integer standing for a tenant token within one TenantTable.
+    /// </summary>
+    typedef uint32_t TenantId;
+
+    /// <summary>
+    /// Interns the tenant tokens seen by one LogManager, so that the upload
+    /// pipeline keeps a TenantId per record instead of another copy of a
+    /// 70+ character token. IDs are assigned in order of first use and are
+    /// never reused; resolved tokens stay valid for the life of the table.
+    /// </summary>
+    class TenantTable
+    {
+    public:
+        TenantTable() = default;
+
+        TenantTable(const TenantTable&) = delete;
+        TenantTable& operator=(const TenantTable&) = delete;
+
+        /// <summary>
+        /// Returns the ID of the token, assigning the next one on first use.
+        /// </summary>
+        TenantId intern(const std::string& tenantToken)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto it = m_ids.find(tenantToken);
+            if (it != m_ids.end())
+            {
+                return it->second;
+            }
+            TenantId id = static_cast<TenantId>(m_tokens.size());
+            m_tokens.push_back(tenantToken);
+            m_ids.emplace(tenantToken, id);
+            return id;
+        }
+
+        /// <summary>
+        /// Returns the token of an interned ID, or an empty string for an unknown one.
+        /// </summary>
+        const std::string& resolve(TenantId id) const
+        {
+            static const std::string empty;
+            std::lock_guard<std::mutex> lock(m_lock);
+            return (id < m_tokens.size()) ? m_tokens[id] : empty;
+        }
+
+        size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_tokens.size();
+        }
+
+    protected:
+        mutable std::mutex                         m_lock;
+        // A deque keeps references returned by resolve() valid as it grows
+        std::deque<std::string>                    m_tokens;
+        std::unordered_map<std::string, TenantId>  m_ids;
+    };
+
+} MAT_NS_END
+
+#endif
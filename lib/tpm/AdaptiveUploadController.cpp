@@ -0,0 +1,106 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "AdaptiveUploadController.hpp"
+
+#include <algorithm>
+
+namespace MAT_NS_BEGIN {
+
+    // Additive increase: the range between the bounds is crossed in this many full packages
+    static constexpr unsigned AdditiveSteps = 16;
+
+    AdaptiveUploadController::AdaptiveUploadController() :
+        m_minPackageBytes(0),
+        m_maxPackageBytes(0),
+        m_targetRequestMs(0),
+        m_packageBytes(0),
+        m_threshold(0),
+        m_recovering(false),
+        m_configured(false)
+    {
+    }
+
+    void AdaptiveUploadController::Configure(unsigned minPackageBytes, unsigned maxPackageBytes, unsigned targetRequestMs)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_maxPackageBytes = std::max(1u, maxPackageBytes);
+        m_minPackageBytes = std::max(1u, std::min(minPackageBytes, m_maxPackageBytes));
+        m_targetRequestMs = targetRequestMs;
+        if (!m_configured)
+        {
+            // Start small and slow-start towards the maximum
+            m_configured = true;
+            m_packageBytes = m_minPackageBytes;
+            m_threshold = m_maxPackageBytes;
+        }
+        m_packageBytes = clamp(m_packageBytes);
+        m_threshold = clamp(m_threshold);
+    }
+
+    unsigned AdaptiveUploadController::GetPackageSize() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_packageBytes;
+    }
+
+    unsigned AdaptiveUploadController::GetSlowStartThreshold() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_threshold;
+    }
+
+    void AdaptiveUploadController::OnUploadSucceeded(unsigned bodyBytes, bool packageFull, int durationMs)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (!m_configured)
+        {
+            return;
+        }
+
+        if (m_targetRequestMs > 0 && durationMs > 0 && static_cast<unsigned>(durationMs) > m_targetRequestMs)
+        {
+            // The throughput of this request carries this many bytes in the target time
+            uint64_t carried = static_cast<uint64_t>(bodyBytes) * m_targetRequestMs / static_cast<unsigned>(durationMs);
+            m_packageBytes = clamp(std::min<uint64_t>(m_packageBytes / 2, carried));
+            m_threshold = m_packageBytes;
+        }
+        else if (packageFull)
+        {
+            if (m_recovering)
+            {
+                // Reconnected with a backlog: drain it with packages growing as fast as the link allows
+                m_threshold = m_maxPackageBytes;
+            }
+            if (m_packageBytes < m_threshold)
+            {
+                m_packageBytes = std::min(m_threshold, clamp(static_cast<uint64_t>(m_packageBytes) * 2));
+            }
+            else
+            {
+                unsigned step = std::max(1u, (m_maxPackageBytes - m_minPackageBytes) / AdditiveSteps);
+                m_packageBytes = clamp(static_cast<uint64_t>(m_packageBytes) + step);
+            }
+        }
+        m_recovering = false;
+    }
+
+    void AdaptiveUploadController::OnUploadFailed()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (!m_configured)
+        {
+            return;
+        }
+        m_packageBytes = clamp(m_packageBytes / 2);
+        m_threshold = m_packageBytes;
+        m_recovering = true;
+    }
+
+    unsigned AdaptiveUploadController::clamp(uint64_t bytes) const
+    {
+        return static_cast<unsigned>(std::max<uint64_t>(m_minPackageBytes, std::min<uint64_t>(m_maxPackageBytes, bytes)));
+    }
+
+} MAT_NS_END
@@ -0,0 +1,73 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef ADAPTIVEUPLOADCONTROLLER_HPP
+#define ADAPTIVEUPLOADCONTROLLER_HPP
+
+#include "ctmacros.hpp"
+
+#include <cstdint>
+#include <mutex>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Sizes upload packages from the outcome of the previous requests (AIMD):
+    /// a full package that went out within the target request time grows the
+    /// next one, a slow request shrinks it to what the measured throughput
+    /// carries in the target time and at least halves it, a failed request
+    /// halves it. After a failure the size doubles per full package again
+    /// (slow start), so a backlog drains quickly once the network is back.
+    /// Light traffic never fills a package and keeps the size where it is.
+    /// </summary>
+    class AdaptiveUploadController
+    {
+    public:
+        AdaptiveUploadController();
+
+        /// <summary>
+        /// Sets the bounds of the package size and the target duration of a request.
+        /// The current size is clamped to the new bounds.
+        /// </summary>
+        void Configure(unsigned minPackageBytes, unsigned maxPackageBytes, unsigned targetRequestMs);
+
+        /// <summary>
+        /// Maximum size of the next package in bytes.
+        /// </summary>
+        unsigned GetPackageSize() const;
+
+        /// <summary>
+        /// Size up to which the package doubles per full package before growing linearly.
+        /// </summary>
+        unsigned GetSlowStartThreshold() const;
+
+        /// <summary>
+        /// Accounts a request accepted by the collector.
+        /// </summary>
+        /// <param name="bodyBytes">Size of the encoded body the request carried.</param>
+        /// <param name="packageFull">Whether the package stopped at the limit with events left over.</param>
+        /// <param name="durationMs">Round trip of the request, negative if unknown.</param>
+        void OnUploadSucceeded(unsigned bodyBytes, bool packageFull, int durationMs);
+
+        /// <summary>
+        /// Accounts a request that failed for a retriable reason or was too large.
+        /// </summary>
+        void OnUploadFailed();
+
+    protected:
+        unsigned clamp(uint64_t bytes) const;
+
+        mutable std::mutex m_lock;
+        unsigned           m_minPackageBytes;
+        unsigned           m_maxPackageBytes;
+        unsigned           m_targetRequestMs;
+        unsigned           m_packageBytes;
+        unsigned           m_threshold;
+        bool               m_recovering;
+        bool               m_configured;
+    };
+
+} MAT_NS_END
+
+#endif // ADAPTIVEUPLOADCONTROLLER_HPP
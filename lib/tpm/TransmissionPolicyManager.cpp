@@ -7,6 +7,7 @@
 #include "TransmitProfiles.hpp"
 #include "utils/Utils.hpp"
 
+#include <algorithm>
 #include <limits>
 
 namespace MAT_NS_BEGIN {
@@ -52,10 +53,15 @@ namespace MAT_NS_BEGIN {
         m_backoff = IBackoff::createFromConfig(m_backoffConfig);
         assert(m_backoff);
         m_deviceStateHandler.Start();
+        if (m_config[CFG_BOOL_SHARED_RUNTIME])
+        {
+            m_sharedRuntime = SharedRuntime::acquire();
+        }
     }
 
     TransmissionPolicyManager::~TransmissionPolicyManager()
     {
+        leaveUploadCoordinator();
         m_deviceStateHandler.Stop();
     }
 
@@ -122,7 +128,10 @@ namespace MAT_NS_BEGIN {
             LOG_TRACE("Scheduled upload aborted, no upload.");
             return;
         }
-        if (uploadCount() >= static_cast<uint32_t>(m_config[CFG_INT_MAX_PENDING_REQ]) )
+        // In pipelined mode up to pipelineDepth() more packages are prepared while the requests are in flight,
+        // unless their bodies would add to a memory budget under pressure
+        size_t depth = MemoryBudget::GetInstance().IsUnderPressure() ? 0 : pipelineDepth();
+        if (uploadCount() >= maxInFlightUploads() + depth)
         {
             LOG_TRACE("Maximum number of HTTP requests reached");
             return;
@@ -178,28 +187,73 @@ namespace MAT_NS_BEGIN {
         }
     }
 
+    bool TransmissionPolicyManager::joinUpload(uint64_t windowMs)
+    {
+        LOCKGUARD(m_scheduledUploadMutex);
+        if (m_isPaused || m_scheduledUploadAborted || !m_isUploadScheduled)
+        {
+            return false;
+        }
+        auto now = PAL::getMonotonicTimeMs();
+        if (m_scheduledUploadTime <= now || m_scheduledUploadTime - now > windowMs)
+        {
+            // Running anyway, or not due soon enough to be worth an early request
+            return false;
+        }
+        // Do not wait for a task that already started, it is about to upload
+        if (!m_scheduledUpload.Cancel(0))
+        {
+            return false;
+        }
+        LOG_TRACE("JOIN  upload %llu ms early for lat=%d", static_cast<unsigned long long>(m_scheduledUploadTime - now), m_runningLatency);
+        m_uploadJoined = true;
+        m_scheduledUploadTime = now;
+        m_scheduledUpload = PAL::scheduleTask(&m_taskDispatcher, 0, this, &TransmissionPolicyManager::uploadAsync, m_runningLatency);
+        return true;
+    }
+
+    void TransmissionPolicyManager::leaveUploadCoordinator()
+    {
+        if (m_sharedRuntime)
+        {
+            m_sharedRuntime->getUploadCoordinator().remove(this);
+        }
+    }
+
     void TransmissionPolicyManager::uploadAsync(EventLatency latency)
     {
         PauseGuard guard(m_system.getLogManager());
         if (guard.isPaused()) {
+            // Nothing uploads anymore while the log manager is paused for teardown
+            m_isUploadScheduled = false;
+            notifyUploadProgress();
             return;
         }
         m_runningLatency = latency;
         m_scheduledUploadTime = std::numeric_limits<uint64_t>::max();
 
+        bool joined;
         {
             LOCKGUARD(m_scheduledUploadMutex);
             m_isUploadScheduled = false;  // Allow to schedule another uploadAsync
+            joined = m_uploadJoined.exchange(false);
             if ((m_isPaused) || (m_scheduledUploadAborted))
             {
                 LOG_TRACE("Paused or upload aborted: cancel pending upload task.");
                 cancelUploadTask();  // If there is a pending upload task, kill it
+                notifyUploadProgress();
                 return;
             }
         }
 
-#ifdef ENABLE_BW_CONTROLLER   /* Bandwidth controller is not currently supported */
         if (m_bandwidthController) {
+            unsigned delayMs = m_bandwidthController->GetUploadDelayMs(latency);
+            if (delayMs > 0) {
+                LOG_TRACE("Bandwidth controller paces lat=%d uploads, will retry %u ms later", latency, delayMs);
+                scheduleUpload(std::chrono::milliseconds { delayMs }, latency);
+                return;
+            }
+#ifdef ENABLE_BW_CONTROLLER   /* Minimum bandwidth gate of the legacy bandwidth controllers is not currently supported */
             unsigned proposedBandwidthBps = m_bandwidthController->GetProposedBandwidthBps();
             unsigned minimumBandwidthBps = m_config.GetMinimumUploadBandwidthBps();
             if (proposedBandwidthBps >= minimumBandwidthBps) {
@@ -207,17 +261,28 @@ namespace MAT_NS_BEGIN {
                     proposedBandwidthBps, minimumBandwidthBps);
             }
             else {
-                unsigned delayMs = 1000;
+                delayMs = 1000;
                 LOG_INFO("Bandwidth controller proposed bandwidth %u bytes/sec but minimum accepted is %u, will retry %u ms later",
                     proposedBandwidthBps, minimumBandwidthBps, delayMs);
-                scheduleUpload(delayMs, latency); // reschedule uploadAsync to run again 1000 ms later
+                scheduleUpload(std::chrono::milliseconds { delayMs }, latency); // reschedule uploadAsync to run again 1000 ms later
                 return;
             }
-        }
 #endif
+        }
+
+        // A joined upload does not pull the others again, they just ran
+        if (m_sharedRuntime && !joined)
+        {
+            unsigned windowMs = m_config[CFG_MAP_TPM][CFG_INT_TPM_UPLOAD_ALIGN_WINDOW_MS];
+            m_sharedRuntime->getUploadCoordinator().onUploadStarting(this, windowMs);
+        }
 
         auto ctx = m_system.createEventsUploadContext();
         ctx->requestedMinLatency = m_runningLatency;
+        if (adaptiveUploads())
+        {
+            ctx->maxUploadSize = m_adaptiveUploads.GetPackageSize();
+        }
         addUpload(ctx);
         initiateUpload(ctx);
     }
@@ -231,6 +296,23 @@ namespace MAT_NS_BEGIN {
             LOG_WARN("HTTP NOT removing non-existing ctx from active uploads ctx=%p", ctx.get());
         }
 
+        // A finished HTTP request hands its slot to the oldest prepared package. After a
+        // failure the prepared packages are returned to storage and retried after backoff.
+        EventsUploadContextPtr next;
+        bool promote = (nextUpload.count() == 0) && !m_isPaused;
+        if (completeSentUpload(ctx, promote, next))
+        {
+            if (next)
+            {
+                LOG_TRACE("Sending prepared upload ctx=%p", next.get());
+                sendPreparedUpload(next);
+            }
+            else if (!promote)
+            {
+                dropPreparedUploads();
+            }
+        }
+
         PauseGuard guard(m_system.getLogManager());
         if (guard.isPaused()) {
             return;
@@ -256,6 +338,10 @@ namespace MAT_NS_BEGIN {
 
     bool TransmissionPolicyManager::handleStart()
     {
+        if (m_sharedRuntime)
+        {
+            m_sharedRuntime->getUploadCoordinator().add(this, m_config.GetCollectorUrl());
+        }
         m_isPaused = false;
         scheduleUpload(std::chrono::seconds{1}, calculateNewPriority());
         return true;
@@ -280,6 +366,8 @@ namespace MAT_NS_BEGIN {
      */
     bool TransmissionPolicyManager::handleStop()
     {
+        // Before taking our locks: the coordinator holds its own while calling joinUpload
+        leaveUploadCoordinator();
         {
             LOCKGUARD(m_scheduledUploadMutex);
             // Prevent execution of all upload tasks
@@ -287,12 +375,11 @@ namespace MAT_NS_BEGIN {
             // Make sure we wait for completion of the upload scheduling task that may be running
             cancelUploadTask();
         }
+        cancelMaxLatencyFlush();
+        dropPreparedUploads();
 
         // Make sure we wait for all active upload callbacks to finish
-        while (uploadCount() > 0)
-        {
-            std::this_thread::yield();
-        }
+        waitForActiveUploads();
         allUploadsFinished();
         return true;
     }
@@ -306,11 +393,10 @@ namespace MAT_NS_BEGIN {
      bool TransmissionPolicyManager::handleCleanup()
      {
         cancelUploadTask();
+        cancelMaxLatencyFlush();
+        dropPreparedUploads();
         // Make sure ongoing uploads are finished.
-        while (uploadCount() > 0)
-        {
-            std::this_thread::yield();
-        }
+        waitForActiveUploads();
 
         allUploadsFinished();
         return true;
@@ -331,13 +417,40 @@ namespace MAT_NS_BEGIN {
         }
         bool forceTimerRestart = false;
 
-        /* This logic needs to be revised: one event in a dedicated HTTP post is wasteful! */
-        // Initiate upload right away
         if (event->record.latency > EventLatency_RealTime) {
-            auto ctx = m_system.createEventsUploadContext();
-            ctx->requestedMinLatency = event->record.latency;
-            addUpload(ctx);
-            initiateUpload(ctx);
+            unsigned windowMs = m_config[CFG_MAP_TPM][CFG_INT_TPM_MAX_LATENCY_WINDOW_MS];
+            if (windowMs == 0)
+            {
+                // Initiate upload right away, one event per HTTP post
+                auto ctx = m_system.createEventsUploadContext();
+                ctx->requestedMinLatency = event->record.latency;
+                addUpload(ctx);
+                initiateUpload(ctx);
+                return;
+            }
+
+            // The first event opens the window: it is uploaded together with everything
+            // that arrives in the next windowMs, or earlier once the batch size is reached.
+            size_t batchSize = static_cast<uint32_t>(m_config[CFG_MAP_TPM][CFG_INT_TPM_MAX_LATENCY_BATCH]);
+            bool flushNow = false;
+            {
+                LOCKGUARD(m_maxLatencyMutex);
+                m_maxLatencyPending++;
+                if (batchSize > 0 && m_maxLatencyPending >= batchSize)
+                {
+                    m_maxLatencyPending = 0;
+                    flushNow = true;
+                }
+                else if (!m_maxLatencyFlushScheduled)
+                {
+                    m_maxLatencyFlushScheduled = true;
+                    m_maxLatencyFlush = PAL::scheduleTask(&m_taskDispatcher, windowMs, this, &TransmissionPolicyManager::flushMaxLatencyEvents);
+                }
+            }
+            if (flushNow)
+            {
+                uploadMaxLatencyEvents();
+            }
             return;
         }
 
@@ -357,6 +470,42 @@ namespace MAT_NS_BEGIN {
         }
     }
 
+    void TransmissionPolicyManager::flushMaxLatencyEvents()
+    {
+        {
+            LOCKGUARD(m_maxLatencyMutex);
+            m_maxLatencyFlushScheduled = false;
+            if (m_maxLatencyPending == 0)
+            {
+                // Already uploaded when the batch filled up
+                return;
+            }
+            m_maxLatencyPending = 0;
+        }
+        uploadMaxLatencyEvents();
+    }
+
+    void TransmissionPolicyManager::uploadMaxLatencyEvents()
+    {
+        if (m_isPaused)
+        {
+            return;
+        }
+        LOG_TRACE("Uploading coalesced Max latency events");
+        auto ctx = m_system.createEventsUploadContext();
+        ctx->requestedMinLatency = EventLatency_Max;
+        addUpload(ctx);
+        initiateUpload(ctx);
+    }
+
+    void TransmissionPolicyManager::cancelMaxLatencyFlush()
+    {
+        m_maxLatencyFlush.Cancel(getCancelWaitTime().count());
+        LOCKGUARD(m_maxLatencyMutex);
+        m_maxLatencyPending = 0;
+        m_maxLatencyFlushScheduled = false;
+    }
+
     // We do only Normal if too few values or timers[0] == timers[2]
     // We do only RealTime if timers[0] < 0 (do not transmit)
     // We alternate RealTime and Normal otherwise (timers differ)
@@ -401,19 +550,84 @@ namespace MAT_NS_BEGIN {
         finishUpload(ctx, m_timerdelay);
     }
 
+    void TransmissionPolicyManager::reportUploadToBandwidthController(EventsUploadContextPtr const& ctx)
+    {
+        if (m_bandwidthController && ctx->bodySize > 0)
+        {
+            m_bandwidthController->OnUploadCompleted(ctx->requestedMinLatency, ctx->bodySize, ctx->durationMs);
+        }
+    }
+
+    bool TransmissionPolicyManager::adaptiveUploads()
+    {
+        if (!static_cast<bool>(m_config[CFG_MAP_TPM][CFG_BOOL_TPM_ADAPTIVE_UPLOADS]))
+        {
+            return false;
+        }
+        unsigned minUploadSize = m_config[CFG_MAP_TPM][CFG_INT_TPM_ADAPTIVE_MIN_UPLOAD_BYTES];
+        unsigned targetMs = m_config[CFG_MAP_TPM][CFG_INT_TPM_ADAPTIVE_TARGET_REQUEST_MS];
+        m_adaptiveUploads.Configure(minUploadSize, m_config.GetMaximumUploadSizeBytes(), targetMs);
+        return true;
+    }
+
+    std::chrono::milliseconds TransmissionPolicyManager::nextAdaptiveUpload(EventsUploadContextPtr const& ctx)
+    {
+        // Prepared packages of a pipeline only keep their slot on a zero delay
+        if (pipelineDepth() > 0)
+        {
+            return std::chrono::milliseconds {};
+        }
+
+        size_t pending = 0;
+        bool backlog = ctx->packageFull || !m_system.getPendingRecordCount(pending) || (pending > 0);
+        if (!backlog)
+        {
+            // Skip the round trip to storage that would find nothing to upload
+            LOG_TRACE("Storage drained, next upload on the profile timer");
+            return (ctx->requestedMinLatency == EventLatency_Normal) ? std::chrono::milliseconds { -1 } : m_timerdelay;
+        }
+
+        unsigned targetMs = m_config[CFG_MAP_TPM][CFG_INT_TPM_ADAPTIVE_TARGET_REQUEST_MS];
+        if (targetMs > 0 && ctx->durationMs > static_cast<int>(targetMs) && m_timerdelay.count() > 0)
+        {
+            return std::min(std::chrono::milliseconds { ctx->durationMs }, m_timerdelay);
+        }
+        return std::chrono::milliseconds {};
+    }
+
     void TransmissionPolicyManager::handleEventsUploadSuccessful(EventsUploadContextPtr const& ctx)
     {
+        reportUploadToBandwidthController(ctx);
         resetBackoff();
-        finishUpload(ctx, std::chrono::milliseconds{});
+        std::chrono::milliseconds nextUpload {};
+        if (adaptiveUploads())
+        {
+            m_adaptiveUploads.OnUploadSucceeded(static_cast<unsigned>(ctx->bodySize), ctx->packageFull, ctx->durationMs);
+            nextUpload = nextAdaptiveUpload(ctx);
+            LOG_TRACE("Adaptive upload: package size %u bytes, next upload in %d ms",
+                m_adaptiveUploads.GetPackageSize(), static_cast<int>(nextUpload.count()));
+        }
+        finishUpload(ctx, nextUpload);
     }
 
     void TransmissionPolicyManager::handleEventsUploadRejected(EventsUploadContextPtr const& ctx)
     {
+        reportUploadToBandwidthController(ctx);
+        // Payload Too Large
+        if (ctx->httpResponse != nullptr && ctx->httpResponse->GetStatusCode() == 413 && adaptiveUploads())
+        {
+            m_adaptiveUploads.OnUploadFailed();
+        }
         finishUpload(ctx, increaseBackoff());
     }
 
     void TransmissionPolicyManager::handleEventsUploadFailed(EventsUploadContextPtr const& ctx)
     {
+        reportUploadToBandwidthController(ctx);
+        if (adaptiveUploads())
+        {
+            m_adaptiveUploads.OnUploadFailed();
+        }
         finishUpload(ctx, increaseBackoff());
     }
 
@@ -422,6 +636,78 @@ namespace MAT_NS_BEGIN {
         finishUpload(ctx, std::chrono::milliseconds{ -1 });
     }
 
+    bool TransmissionPolicyManager::handleUploadPrepared(EventsUploadContextPtr const& ctx)
+    {
+        size_t depth = pipelineDepth();
+        if (depth == 0 || m_isPaused)
+        {
+            return true;
+        }
+
+        bool send;
+        {
+            LOCKGUARD(m_activeUploads_lock);
+            send = (m_sentUploads.size() < maxInFlightUploads());
+            if (send)
+            {
+                m_sentUploads.insert(ctx);
+            }
+            else
+            {
+                m_preparedUploads.push_back(ctx);
+            }
+        }
+        if (!send)
+        {
+            LOG_TRACE("Holding prepared upload ctx=%p until an HTTP request completes", ctx.get());
+        }
+
+        // Prepare the next package while this one is on the wire or waiting for a slot.
+        // scheduleUpload stops once maxInFlightUploads() + depth uploads are active.
+        scheduleUpload(std::chrono::milliseconds {}, ctx->requestedMinLatency);
+        return send;
+    }
+
+    size_t TransmissionPolicyManager::pipelineDepth() const
+    {
+        return static_cast<uint32_t>(m_config[CFG_INT_UPLOAD_PIPELINE_DEPTH]);
+    }
+
+    size_t TransmissionPolicyManager::maxInFlightUploads() const
+    {
+        return std::max<size_t>(1, static_cast<uint32_t>(m_config[CFG_INT_MAX_PENDING_REQ]));
+    }
+
+    bool TransmissionPolicyManager::completeSentUpload(EventsUploadContextPtr const& ctx, bool promote, EventsUploadContextPtr& next)
+    {
+        LOCKGUARD(m_activeUploads_lock);
+        if (m_sentUploads.erase(ctx) == 0)
+        {
+            return false;
+        }
+        if (promote && !m_preparedUploads.empty())
+        {
+            next = m_preparedUploads.front();
+            m_preparedUploads.pop_front();
+            m_sentUploads.insert(next);
+        }
+        return true;
+    }
+
+    void TransmissionPolicyManager::dropPreparedUploads()
+    {
+        std::deque<EventsUploadContextPtr> prepared;
+        {
+            LOCKGUARD(m_activeUploads_lock);
+            prepared.swap(m_preparedUploads);
+        }
+        for (auto const& ctx : prepared)
+        {
+            LOG_TRACE("Dropping prepared upload ctx=%p", ctx.get());
+            preparedUploadDropped(ctx);
+        }
+    }
+
     void TransmissionPolicyManager::addUpload(EventsUploadContextPtr const& ctx)
     {
         LOCKGUARD(m_activeUploads_lock);
@@ -430,15 +716,47 @@ namespace MAT_NS_BEGIN {
 
     bool TransmissionPolicyManager::removeUpload(EventsUploadContextPtr const& ctx)
     {
-        LOCKGUARD(m_activeUploads_lock);
-        auto it = m_activeUploads.find(ctx);
-        if (it != m_activeUploads.cend())
         {
+            LOCKGUARD(m_activeUploads_lock);
+            auto it = m_activeUploads.find(ctx);
+            if (it == m_activeUploads.cend())
+            {
+                return false;
+            }
             LOG_TRACE("HTTP removing from active uploads ctx=%p", ctx.get());
             m_activeUploads.erase(it);
-            return true;
+            ++m_uploadProgress;
+        }
+        ctx->releaseMemory();
+        m_uploadsChanged.notify_all();
+        return true;
+    }
+
+    void TransmissionPolicyManager::notifyUploadProgress()
+    {
+        {
+            LOCKGUARD(m_activeUploads_lock);
+            ++m_uploadProgress;
         }
-        return false;
+        m_uploadsChanged.notify_all();
+    }
+
+    void TransmissionPolicyManager::waitForActiveUploads()
+    {
+        std::unique_lock<std::mutex> lock(m_activeUploads_lock);
+        m_uploadsChanged.wait(lock, [this]() { return m_activeUploads.empty(); });
+    }
+
+    uint64_t TransmissionPolicyManager::getUploadProgress() const noexcept
+    {
+        LOCKGUARD(m_activeUploads_lock);
+        return m_uploadProgress;
+    }
+
+    bool TransmissionPolicyManager::waitForUploadProgress(uint64_t progress, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_activeUploads_lock);
+        return m_uploadsChanged.wait_for(lock, timeout, [this, progress]() { return m_uploadProgress != progress; });
     }
 
     void TransmissionPolicyManager::pauseAllUploads()
@@ -446,6 +764,8 @@ namespace MAT_NS_BEGIN {
         PauseGuard guard(m_system.getLogManager());
         m_isPaused = true;
         cancelUploadTask();
+        cancelMaxLatencyFlush();
+        dropPreparedUploads();
     }
 
     std::chrono::milliseconds TransmissionPolicyManager::getCancelWaitTime() const noexcept
@@ -14,15 +14,20 @@
 #include "system/Contexts.hpp"
 #include "system/Route.hpp"
 #include "system/ITelemetrySystem.hpp"
+#include "system/SharedRuntime.hpp"
 
 #include "DeviceStateHandler.hpp"
 #include "pal/TaskDispatcher.hpp"
 
 #include "TransmitProfiles.hpp"
+#include "AdaptiveUploadController.hpp"
+#include "UploadCoordinator.hpp"
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <limits>
 #include <set>
 
@@ -42,13 +47,14 @@ constexpr std::chrono::milliseconds DefaultTaskCancelTime { 500 };
 
 constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
 
-    class TransmissionPolicyManager
+    class TransmissionPolicyManager : public ICoordinatedUploader
     {
 
     public:
         TransmissionPolicyManager(ITelemetrySystem& system, ITaskDispatcher& taskDispatcher, IBandwidthController* bandwidthController);
         virtual ~TransmissionPolicyManager();
         virtual void scheduleUpload(const std::chrono::milliseconds& delay, EventLatency latency, bool force = false);
+        virtual bool joinUpload(uint64_t windowMs) override;
 
     protected:
         MATSDK_LOG_DECL_COMPONENT_CLASS();
@@ -68,12 +74,36 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
 
         void handleEventArrived(IncomingEventContextPtr const& event);
 
+        /// <summary>
+        /// Uploads the Max latency events coalesced so far in a single request.
+        /// </summary>
+        void flushMaxLatencyEvents();
+        void uploadMaxLatencyEvents();
+
         void handleNothingToUpload(EventsUploadContextPtr const& ctx);
         void handlePackagingFailed(EventsUploadContextPtr const& ctx);
         void handleEventsUploadSuccessful(EventsUploadContextPtr const& ctx);
         void handleEventsUploadRejected(EventsUploadContextPtr const& ctx);
         void handleEventsUploadFailed(EventsUploadContextPtr const& ctx);
         void handleEventsUploadAborted(EventsUploadContextPtr const& ctx);
+        bool handleUploadPrepared(EventsUploadContextPtr const& ctx);
+
+        /// <summary>
+        /// Charges the bytes of a completed HTTP request to the bandwidth controller.
+        /// </summary>
+        void reportUploadToBandwidthController(EventsUploadContextPtr const& ctx);
+
+        /// <summary>
+        /// Whether adaptive uploads are enabled, updating the bounds of the package size from the configuration.
+        /// </summary>
+        bool adaptiveUploads();
+
+        /// <summary>
+        /// Delay of the next upload after an adaptive upload succeeded: right away while a backlog
+        /// is left, no sooner than the last request took on a slow link, and like an empty upload
+        /// once storage is drained.
+        /// </summary>
+        std::chrono::milliseconds nextAdaptiveUpload(EventsUploadContextPtr const& ctx);
 
         EventLatency calculateNewPriority();
 
@@ -96,8 +126,70 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
         PAL::DeferredCallbackHandle      m_scheduledUpload;
         bool                             m_scheduledUploadAborted { false };
 
+        // Shared runtime only: the upload that runs next was moved forward by another LogManager
+        std::shared_ptr<SharedRuntime>   m_sharedRuntime;
+        std::atomic<bool>                m_uploadJoined { false };
+
+        /// <summary>
+        /// Stops taking part in the uploads of the other LogManagers.
+        /// </summary>
+        void leaveUploadCoordinator();
+
+        // Coalescing window of Max latency events
+        std::mutex                       m_maxLatencyMutex;
+        size_t                           m_maxLatencyPending { 0 };
+        bool                             m_maxLatencyFlushScheduled { false };
+        PAL::DeferredCallbackHandle      m_maxLatencyFlush;
+
+        /// <summary>
+        /// Cancels the pending Max latency flush and forgets coalesced events, they stay in storage.
+        /// </summary>
+        void cancelMaxLatencyFlush();
+
         mutable std::mutex               m_activeUploads_lock;
         std::set<EventsUploadContextPtr> m_activeUploads;
+
+        // Upload state changes, guarded by m_activeUploads_lock
+        std::condition_variable          m_uploadsChanged;
+        uint64_t                         m_uploadProgress { 0 };
+
+        /// <summary>
+        /// Records an upload state change and wakes up the waiters.
+        /// </summary>
+        void notifyUploadProgress();
+
+        /// <summary>
+        /// Blocks until no upload is active.
+        /// </summary>
+        void waitForActiveUploads();
+
+        // Pipelined uploads only, guarded by m_activeUploads_lock
+        std::set<EventsUploadContextPtr>   m_sentUploads;
+        std::deque<EventsUploadContextPtr> m_preparedUploads;
+
+        /// <summary>
+        /// Number of packages kept prepared while uploads are in flight, 0 if pipelining is disabled.
+        /// </summary>
+        size_t pipelineDepth() const;
+
+        /// <summary>
+        /// Maximum number of HTTP requests in flight.
+        /// </summary>
+        size_t maxInFlightUploads() const;
+
+        /// <summary>
+        /// Thread-safe method to forget a sent upload and pick the next prepared one to send.
+        /// </summary>
+        /// <param name="ctx">The finished upload.</param>
+        /// <param name="promote">Whether a prepared upload may take the freed slot.</param>
+        /// <param name="next">The prepared upload to send next, if any.</param>
+        /// <returns>true if the finished upload was a pipelined HTTP request.</returns>
+        bool completeSentUpload(EventsUploadContextPtr const& ctx, bool promote, EventsUploadContextPtr& next);
+
+        /// <summary>
+        /// Return all prepared packages that have not been sent yet back to storage.
+        /// </summary>
+        void dropPreparedUploads();
         
         /// <summary>
         /// Thread-safe method to add the upload to active uploads.
@@ -130,6 +222,8 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
         /// <returns></returns>
         size_t uploadCount() const noexcept;
 
+        AdaptiveUploadController         m_adaptiveUploads;
+
         std::chrono::milliseconds        m_timerdelay { std::chrono::seconds { 2 } };
         EventLatency                     m_runningLatency { EventLatency_RealTime };
         TimerArray                       m_timers;
@@ -152,8 +246,26 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
         RouteSink<TransmissionPolicyManager, EventsUploadContextPtr const&>  eventsUploadFailed{ this, &TransmissionPolicyManager::handleEventsUploadFailed };
         RouteSink<TransmissionPolicyManager, EventsUploadContextPtr const&>  eventsUploadAborted{ this, &TransmissionPolicyManager::handleEventsUploadAborted };
 
+        // Pipelined uploads: holds encoded packages until an HTTP slot frees up
+        StaticRouteHandler<decltype(&TransmissionPolicyManager::handleUploadPrepared), &TransmissionPolicyManager::handleUploadPrepared> uploadPreparedStatic{ this };
+        RouteSource<EventsUploadContextPtr const&>                           sendPreparedUpload;
+        RouteSource<EventsUploadContextPtr const&>                           preparedUploadDropped;
+
         virtual bool isUploadInProgress() const noexcept;
 
+        /// <summary>
+        /// Number of upload state changes so far: finished uploads and scheduled uploads that ran.
+        /// </summary>
+        uint64_t getUploadProgress() const noexcept;
+
+        /// <summary>
+        /// Waits until the upload state changes after getUploadProgress() returned progress.
+        /// </summary>
+        /// <param name="progress">Value returned by getUploadProgress().</param>
+        /// <param name="timeout">Maximum time to wait.</param>
+        /// <returns>false if nothing changed before the timeout.</returns>
+        bool waitForUploadProgress(uint64_t progress, std::chrono::milliseconds timeout);
+
         virtual bool isPaused() const noexcept;
     };
 
@@ -0,0 +1,53 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "UploadCoordinator.hpp"
+
+namespace MAT_NS_BEGIN {
+
+    void UploadCoordinator::add(ICoordinatedUploader* uploader, std::string const& endpoint)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_uploaders[uploader] = endpoint;
+    }
+
+    void UploadCoordinator::remove(ICoordinatedUploader* uploader)
+    {
+        // Waits for a running onUploadStarting, which may be calling this uploader
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_uploaders.erase(uploader);
+    }
+
+    size_t UploadCoordinator::onUploadStarting(ICoordinatedUploader* uploader, uint64_t windowMs)
+    {
+        if (windowMs == 0)
+        {
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        auto self = m_uploaders.find(uploader);
+        if (self == m_uploaders.end())
+        {
+            return 0;
+        }
+
+        size_t joined = 0;
+        for (auto const& kv : m_uploaders)
+        {
+            if (kv.first != uploader && kv.second == self->second && kv.first->joinUpload(windowMs))
+            {
+                joined++;
+            }
+        }
+        return joined;
+    }
+
+    size_t UploadCoordinator::size() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_uploaders.size();
+    }
+
+} MAT_NS_END
@@ -0,0 +1,74 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef UPLOADCOORDINATOR_HPP
+#define UPLOADCOORDINATOR_HPP
+
+#include "ctmacros.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Upload scheduler of one LogManager, as seen by the UploadCoordinator.
+    /// </summary>
+    class ICoordinatedUploader
+    {
+    public:
+        virtual ~ICoordinatedUploader() noexcept = default;
+
+        /// <summary>
+        /// Moves a scheduled upload that is due within windowMs forward to now.
+        /// Must not call back into the coordinator.
+        /// </summary>
+        /// <returns>true if an upload was moved.</returns>
+        virtual bool joinUpload(uint64_t windowMs) = 0;
+    };
+
+    /// <summary>
+    /// Aligns the uploads of the LogManagers of a process that post to the same
+    /// collector: when one of them starts an upload, the others whose next upload
+    /// is due soon upload right away, so that the requests go out together over
+    /// the connections of the shared HTTP client instead of waking it up one by one.
+    /// </summary>
+    class UploadCoordinator
+    {
+    public:
+        UploadCoordinator() = default;
+
+        UploadCoordinator(const UploadCoordinator&) = delete;
+        UploadCoordinator& operator=(const UploadCoordinator&) = delete;
+
+        /// <summary>
+        /// Registers the uploader for the endpoint, or moves it to a new endpoint.
+        /// </summary>
+        void add(ICoordinatedUploader* uploader, std::string const& endpoint);
+
+        /// <summary>
+        /// Unregisters the uploader. Once this returns the coordinator does not call it anymore.
+        /// </summary>
+        void remove(ICoordinatedUploader* uploader);
+
+        /// <summary>
+        /// Called by an uploader about to upload: asks the other uploaders of its
+        /// endpoint to join if their upload is due within windowMs.
+        /// </summary>
+        /// <returns>Number of uploaders that joined.</returns>
+        size_t onUploadStarting(ICoordinatedUploader* uploader, uint64_t windowMs);
+
+        size_t size() const;
+
+    protected:
+        mutable std::mutex                             m_lock;
+        std::map<ICoordinatedUploader*, std::string>   m_uploaders;
+    };
+
+} MAT_NS_END
+
+#endif
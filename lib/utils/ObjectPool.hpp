@@ -0,0 +1,122 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef OBJECTPOOL_HPP
+#define OBJECTPOOL_HPP
+
+#include "ctmacros.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Cumulative counters of an ObjectPool.
+    /// </summary>
+    struct ObjectPoolStats
+    {
+        /// Requests served with a recycled object
+        uint64_t hits = 0;
+        /// Requests that had to allocate a new object
+        uint64_t misses = 0;
+        /// Objects currently owned by the pool, in use or idle
+        size_t   size = 0;
+    };
+
+    /// <summary>
+    /// Recycles objects handed out as std::shared_ptr. The pool keeps one
+    /// reference to every object it created; an object whose only owner
+    /// left is the pool is idle and gets reused by the next acquire(),
+    /// so neither the object nor its control block are reallocated.
+    ///
+    /// T::clear() is called before an object is reused. It must reset the
+    /// object to its default state without releasing container capacity.
+    /// </summary>
+    template <typename T>
+    class ObjectPool
+    {
+    public:
+        explicit ObjectPool(size_t capacity) :
+            m_capacity(capacity),
+            m_next(0),
+            m_hits(0),
+            m_misses(0)
+        {
+        }
+
+        ObjectPool(const ObjectPool&) = delete;
+        ObjectPool& operator=(const ObjectPool&) = delete;
+
+        /// <summary>
+        /// Returns an idle object, or a new one if all pooled objects are in use.
+        /// Objects allocated past the capacity are not pooled.
+        /// </summary>
+        std::shared_ptr<T> acquire()
+        {
+            std::shared_ptr<T> result;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                size_t count = m_objects.size();
+                for (size_t i = 0; i < count; i++)
+                {
+                    size_t index = (m_next + i) % count;
+                    if (m_objects[index].use_count() == 1)
+                    {
+                        // Taking a reference marks the object as busy for other callers
+                        result = m_objects[index];
+                        m_next = index + 1;
+                        break;
+                    }
+                }
+                if (!result && count < m_capacity)
+                {
+                    m_objects.push_back(std::make_shared<T>());
+                    m_misses++;
+                    return m_objects.back();
+                }
+            }
+
+            if (!result)
+            {
+                m_misses++;
+                return std::make_shared<T>();
+            }
+
+            // The previous owner released its reference with release semantics:
+            // make its writes to the object visible before recycling it
+            std::atomic_thread_fence(std::memory_order_acquire);
+            result->clear();
+            m_hits++;
+            return result;
+        }
+
+        ObjectPoolStats getStats() const
+        {
+            ObjectPoolStats stats;
+            stats.hits = m_hits.load();
+            stats.misses = m_misses.load();
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                stats.size = m_objects.size();
+            }
+            return stats;
+        }
+
+    protected:
+        mutable std::mutex               m_lock;
+        std::vector<std::shared_ptr<T>>  m_objects;
+        size_t                           m_capacity;
+        size_t                           m_next;
+        std::atomic<uint64_t>            m_hits;
+        std::atomic<uint64_t>            m_misses;
+    };
+
+} MAT_NS_END
+
+#endif
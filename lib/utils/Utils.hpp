@@ -86,6 +86,12 @@ namespace MAT_NS_BEGIN {
         return std::chrono::system_clock::now().time_since_epoch() / std::chrono::milliseconds(1);
     }
 
+    /* Monotonic timestamp in microseconds, for measuring short intervals */
+    inline int64_t GetSteadyTimeUs()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
 #ifdef _WINRT
 
     Platform::String ^to_platform_string(const std::string& s);
@@ -14,6 +14,8 @@ class MockIBandwidthController : public MAT::IBandwidthController
 {
   public:
     MOCK_METHOD0(GetProposedBandwidthBps, unsigned());
+    MOCK_METHOD1(GetUploadDelayMs, unsigned(MAT::EventLatency));
+    MOCK_METHOD3(OnUploadCompleted, void(MAT::EventLatency, size_t, int));
 };
 
 
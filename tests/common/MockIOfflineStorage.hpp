@@ -39,6 +39,7 @@ class MockIOfflineStorage : public MAT::IOfflineStorage {
     MOCK_CONST_METHOD1(GetRecordCount, size_t(MAT::EventLatency));
     MOCK_METHOD3(GetRecords, std::vector<MAT::StorageRecord>(bool, MAT::EventLatency, unsigned));
     MOCK_METHOD0(ResizeDb, bool());
+    MOCK_METHOD0(IsOpen, bool());
 };
 
 #if defined(__clang__)
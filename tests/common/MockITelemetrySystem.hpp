@@ -44,11 +44,22 @@ namespace testing {
             return testConfig;
         }
         
+        TenantTable& getTenantTable() override
+        {
+            return tenantTable;
+        }
+
         EventsUploadContextPtr createEventsUploadContext() override
         {
             return std::make_shared<EventsUploadContext>();
         }
 
+        bool getPendingRecordCount(size_t& count) const override
+        {
+            count = pendingRecordCount;
+            return pendingRecordCountKnown;
+        }
+
         MOCK_METHOD0(getContext, ISemanticContext&());
         MOCK_METHOD1(DispatchEvent, bool(DebugEvent evt));
         MOCK_METHOD1(sendEvent, void(IncomingEventContextPtr const& event));
@@ -60,6 +71,12 @@ namespace testing {
         MOCK_METHOD0(resumeAsync, void());
         MOCK_METHOD1(handleIncomingEventPrepared, void(IncomingEventContextPtr const& event));
         MOCK_METHOD1(preparedIncomingEventAsync, void(IncomingEventContextPtr const& event));
+
+        TenantTable tenantTable;
+
+        // Storage backlog reported by getPendingRecordCount, unknown unless a test sets it
+        bool pendingRecordCountKnown = false;
+        size_t pendingRecordCount = 0;
     };
 
 #if defined( __clang__ )
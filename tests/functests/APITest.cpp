@@ -716,6 +716,20 @@ TEST(APITest, C_API_Test)
     }
     EXPECT_EQ(totalEvents, 5u);
 
+    // The logger is resolved once and its route cached on the client
+    auto route = std::atomic_load(&client->route);
+    ASSERT_NE(route, nullptr);
+    EXPECT_EQ(route->token, TEST_TOKEN);
+
+    // Ingest 3 more in one call, a missing event does not stop the others
+    evt_prop* batch[] = { event, nullptr, event, event };
+    EXPECT_EQ(evt_log_batch(handle, 4, batch), EFAULT);
+    EXPECT_EQ(totalEvents, 8u);
+    EXPECT_EQ(std::atomic_load(&client->route), route);
+    evt_log(handle, event);
+    EXPECT_EQ(totalEvents, 9u);
+    EXPECT_EQ(std::atomic_load(&client->route), route);
+
     evt_flush(handle);
     evt_upload(handle);
 
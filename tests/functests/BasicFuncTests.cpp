@@ -630,6 +630,49 @@ TEST_F(BasicFuncTests, sendSamePriorityNormalEvents)
     FlushAndTeardown();
 }
 
+namespace
+{
+    struct TypedTestEvent : TypedEvent<TypedTestEvent>
+    {
+        std::string property;
+        int64_t count = 0;
+        double ratio = 0.0;
+        std::string pii;
+
+        static const char* Name() { return "typed_event"; }
+
+        void Fields(TypedEventFields& fields) const
+        {
+            fields.Add("property", property);
+            fields.Add("count", count);
+            fields.Add("ratio", ratio);
+            fields.Add("pii_property", pii, PiiKind_Identity);
+        }
+    };
+}
+
+TEST_F(BasicFuncTests, sendTypedEvent)
+{
+    CleanStorage();
+    Initialize();
+
+    TypedTestEvent event;
+    event.property = "value";
+    event.count = 12345;
+    event.ratio = 0.5;
+    event.pii = "pii_value";
+    logger->LogTypedEvent(event);
+
+    waitForEvents(3, 2);
+    auto record = find(event.GetName());
+    ASSERT_THAT(record.data.size(), Eq(1u));
+    EXPECT_THAT(record.data[0].properties["property"].stringValue, Eq("value"));
+    EXPECT_THAT(record.data[0].properties["count"].longValue, Eq(12345));
+    verifyEvent(event.ToEventProperties(), record);
+
+    FlushAndTeardown();
+}
+
 TEST_F(BasicFuncTests, sendDifferentPriorityEvents)
 {
     CleanStorage();
@@ -788,8 +831,8 @@ TEST_F(BasicFuncTests, restartRecoversEventsFromStorage)
         LogManager::UploadNow();
 
         // 1st request for realtime event
-        waitForEvents(3, 5); // start, first_event, second_event, ongoing, stop, start, fooEvent
-        // we drop two of the events during pause, though.
+        // Teardown saved the in-memory events of the first run to disk
+        waitForEvents(3, 7); // start, first_event, second_event, ongoing, stop, start, fooEvent
         EXPECT_GE(receivedRequests.size(), (size_t)1);
         if (receivedRequests.size() != 0)
         {
@@ -3,7 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 //
 #include "EventDecoderListener.hpp"
-#include "PayloadDecoder.hpp"
+#include "PayloadStreamDecoder.hpp"
 
 unsigned   latency[MAX_LATENCY_SAMPLES] = { 0 };
 
@@ -14,6 +14,7 @@ std::atomic<size_t>   numSent(0);
 std::atomic<size_t>   numDropped(0);
 std::atomic<size_t>   numReject(0);
 std::atomic<size_t>   numCached(0);
+std::atomic<size_t>   numDecoded(0);
 std::atomic<size_t>   logLatMin(100);
 std::atomic<size_t>   logLatMax(0);
 unsigned long         testStartMs;
@@ -41,6 +42,7 @@ void EventDecoderListener::reset()
     numDropped = 0;
     numReject = 0;
     numCached = 0;
+    numDecoded = 0;
     logLatMin = 100;
     logLatMax = 0;
 }
@@ -51,9 +53,14 @@ void EventDecoderListener::DecodeBuffer(void *data, size_t size)
     {
         std::vector<uint8_t> in;
         in.assign((uint8_t*)data, (uint8_t*)data + size);
-        std::string s;
-        exporters::DecodeRequest(in, s, true);
-        // printf("%s\n", s.c_str());
+        // Walk the records in place instead of building the JSON for the whole request
+        exporters::ForEachRecord(in, [](const exporters::RecordView& record)
+        {
+            // printf("%s\n", record.name().str().c_str());
+            UNREFERENCED_PARAMETER(record);
+            numDecoded++;
+            return true;
+        }, true);
     }
 }
 
@@ -203,6 +203,38 @@ TEST_F(MultipleLogManagersTests, ThreeInstancesCoexist)
     lm3.reset();
 }
 
+TEST_F(MultipleLogManagersTests, SharedRuntimeInstancesCoexist)
+{
+    // Instances #1 and #2 post to the same collector
+    config2[CFG_STR_COLLECTOR_URL] = serverAddress + "/1/";
+    config1[CFG_BOOL_SHARED_RUNTIME] = true;
+    config2[CFG_BOOL_SHARED_RUNTIME] = true;
+    config3[CFG_BOOL_SHARED_RUNTIME] = true;
+
+    std::unique_ptr<ILogManager> lm1(LogManagerFactory::Create(config1));
+    std::unique_ptr<ILogManager> lm2(LogManagerFactory::Create(config2));
+    std::unique_ptr<ILogManager> lm3(LogManagerFactory::Create(config3));
+
+    lm1->GetLogger("lm1_token1", "aaa-source")->LogEvent("l1a1");
+    lm2->GetLogger("lm2_token1", "bbb-source")->LogEvent("l2a1");
+    lm3->GetLogger("lm3_token1", "ccc-source")->LogEvent("l3a1");
+
+    lm1->GetLogController()->UploadNow();
+    lm3->GetLogController()->UploadNow();
+
+    waitForRequestsMultipleLogManager(10000, 2, 0, 1);
+
+    // Tearing down one instance leaves the shared HTTP client to the others
+    lm1.reset();
+    auto sent = callback1.GetRequestCount();
+    lm2->GetLogger("lm2_token1", "bbb-source")->LogEvent("l2a2");
+    lm2->GetLogController()->UploadNow();
+    waitForRequestsMultipleLogManager(10000, static_cast<unsigned>(sent) + 1, 0, 1);
+
+    lm2.reset();
+    lm3.reset();
+}
+
 constexpr static unsigned max_iterations = 2000;
 
 TEST_F(MultipleLogManagersTests, MultiProcessesLogManager)
@@ -0,0 +1,120 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "tpm/AdaptiveUploadController.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    constexpr unsigned MinSize = 32 * 1024;
+    constexpr unsigned MaxSize = 1024 * 1024;
+    constexpr unsigned TargetMs = 2000;
+
+    class AdaptiveUploadControllerTests : public ::testing::Test
+    {
+    protected:
+        AdaptiveUploadController controller;
+
+        virtual void SetUp() override
+        {
+            controller.Configure(MinSize, MaxSize, TargetMs);
+        }
+
+        void uploadFull(int durationMs = 100)
+        {
+            controller.OnUploadSucceeded(controller.GetPackageSize(), true, durationMs);
+        }
+    };
+
+} // namespace
+
+TEST_F(AdaptiveUploadControllerTests, StartsAtMinimumSize)
+{
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MinSize));
+    EXPECT_THAT(controller.GetSlowStartThreshold(), Eq(MaxSize));
+}
+
+TEST_F(AdaptiveUploadControllerTests, LightTrafficKeepsPackagesSmall)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        controller.OnUploadSucceeded(controller.GetPackageSize(), false, 100);
+    }
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MinSize));
+}
+
+TEST_F(AdaptiveUploadControllerTests, FullPackagesSlowStartThenGrowLinearly)
+{
+    uploadFull();
+    EXPECT_THAT(controller.GetPackageSize(), Eq(2 * MinSize));
+    uploadFull();
+    uploadFull();
+    uploadFull();
+    uploadFull();
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MaxSize));
+    uploadFull();
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MaxSize));
+}
+
+TEST_F(AdaptiveUploadControllerTests, SlowRequestShrinksToMeasuredThroughput)
+{
+    for (int i = 0; i < 5; i++)
+    {
+        uploadFull();
+    }
+    ASSERT_THAT(controller.GetPackageSize(), Eq(MaxSize));
+
+    // Half of the package would have made the target time
+    controller.OnUploadSucceeded(MaxSize, true, 2 * TargetMs);
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MaxSize / 2));
+
+    // A quarter of it would have
+    controller.OnUploadSucceeded(MaxSize / 2, true, 4 * TargetMs);
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MaxSize / 8));
+    EXPECT_THAT(controller.GetSlowStartThreshold(), Eq(MaxSize / 8));
+
+    // Additive increase above the threshold
+    uploadFull();
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MaxSize / 8 + (MaxSize - MinSize) / 16));
+}
+
+TEST_F(AdaptiveUploadControllerTests, FailureHalvesAndReconnectDrainsFast)
+{
+    for (int i = 0; i < 5; i++)
+    {
+        uploadFull();
+    }
+    controller.OnUploadFailed();
+    controller.OnUploadFailed();
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MaxSize / 4));
+
+    // Back online with a backlog: doubles again up to the maximum
+    uploadFull();
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MaxSize / 2));
+    uploadFull();
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MaxSize));
+}
+
+TEST_F(AdaptiveUploadControllerTests, StaysWithinConfiguredBounds)
+{
+    for (int i = 0; i < 20; i++)
+    {
+        controller.OnUploadFailed();
+    }
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MinSize));
+
+    for (int i = 0; i < 40; i++)
+    {
+        uploadFull();
+    }
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MaxSize));
+
+    // Lowering the maximum clamps the current size
+    controller.Configure(MinSize, MaxSize / 4, TargetMs);
+    EXPECT_THAT(controller.GetPackageSize(), Eq(MaxSize / 4));
+}
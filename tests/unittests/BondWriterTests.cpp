@@ -0,0 +1,342 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
+#include "bond/generated/CsProtocol_readers.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace testing;
+
+class BondWriterTests : public Test
+{
+  protected:
+    std::mt19937_64 rng{ 20190731 };
+
+    size_t randomSize(size_t max)
+    {
+        return static_cast<size_t>(rng() % (max + 1));
+    }
+
+    int64_t randomInt64()
+    {
+        // Mix of small, negative and extreme values to hit every varint length
+        switch (rng() % 6)
+        {
+        case 0:
+            return 0;
+        case 1:
+            return static_cast<int64_t>(rng() % 128) - 64;
+        case 2:
+            return INT64_MIN;
+        case 3:
+            return INT64_MAX;
+        default:
+            return static_cast<int64_t>(rng() >> (rng() % 64));
+        }
+    }
+
+    double randomDouble()
+    {
+        return static_cast<double>(randomInt64()) / 3.0;
+    }
+
+    std::string randomString(size_t max = 40)
+    {
+        // Occasionally long enough to need a multi-byte length prefix
+        size_t size = (rng() % 16 == 0) ? (200 + randomSize(20000)) : randomSize(max);
+        std::string result(size, ' ');
+        for (auto& c : result)
+        {
+            c = static_cast<char>(rng() & 0xff);
+        }
+        return result;
+    }
+
+    std::vector<uint8_t> randomGuid()
+    {
+        std::vector<uint8_t> guid(16);
+        for (auto& b : guid)
+        {
+            b = static_cast<uint8_t>(rng());
+        }
+        return guid;
+    }
+
+    ::CsProtocol::Value randomValue()
+    {
+        ::CsProtocol::Value value;
+        value.type = static_cast<::CsProtocol::ValueKind>(rng() % 14);
+        switch (rng() % 6)
+        {
+        case 0:
+            value.stringValue = randomString();
+            break;
+        case 1:
+            value.longValue = randomInt64();
+            break;
+        case 2:
+            value.doubleValue = randomDouble();
+            break;
+        case 3:
+            value.guidValue.push_back(randomGuid());
+            break;
+        case 4:
+            value.longArray.resize(1);
+            for (size_t i = randomSize(50); i > 0; i--)
+            {
+                value.longArray[0].push_back(randomInt64());
+            }
+            value.doubleArray.resize(1);
+            for (size_t i = randomSize(50); i > 0; i--)
+            {
+                value.doubleArray[0].push_back(randomDouble());
+            }
+            break;
+        default:
+            value.stringArray.resize(1);
+            for (size_t i = randomSize(10); i > 0; i--)
+            {
+                value.stringArray[0].push_back(randomString());
+            }
+            value.guidArray.resize(1);
+            for (size_t i = randomSize(10); i > 0; i--)
+            {
+                value.guidArray[0].push_back(randomGuid());
+            }
+            break;
+        }
+        if (rng() % 4 == 0)
+        {
+            ::CsProtocol::Attributes attributes;
+            ::CsProtocol::PII pii;
+            pii.Kind = static_cast<::CsProtocol::PIIKind>(rng() % 14);
+            attributes.pii.push_back(pii);
+            value.attributes.push_back(attributes);
+        }
+        return value;
+    }
+
+    ::CsProtocol::Record randomRecord()
+    {
+        ::CsProtocol::Record record;
+        record.ver = "3.0";
+        record.name = randomString();
+        record.time = randomInt64();
+        record.popSample = randomDouble();
+        record.iKey = randomString();
+        record.flags = randomInt64();
+        record.cV = randomString();
+
+        if (rng() % 2)
+        {
+            record.extProtocol.resize(1);
+            record.extProtocol[0].metadataCrc = static_cast<int32_t>(rng());
+            record.extProtocol[0].ticketKeys.resize(1);
+            record.extProtocol[0].ticketKeys[0].push_back(randomString());
+            record.extProtocol[0].devMake = randomString();
+        }
+        if (rng() % 2)
+        {
+            record.extUser.resize(1);
+            record.extUser[0].localId = randomString();
+        }
+        if (rng() % 2)
+        {
+            record.extOs.resize(1);
+            record.extOs[0].bootId = static_cast<int32_t>(rng());
+            record.extOs[0].name = randomString();
+        }
+        if (rng() % 2)
+        {
+            record.extApp.resize(1);
+            record.extApp[0].asId = static_cast<int32_t>(rng());
+            record.extApp[0].id = randomString();
+        }
+        if (rng() % 2)
+        {
+            record.extUtc.resize(1);
+            record.extUtc[0].popSample = randomDouble();
+            record.extUtc[0].eventFlags = randomInt64();
+            record.extUtc[0].seq = randomInt64();
+        }
+        if (rng() % 2)
+        {
+            record.extM365a.resize(1);
+            record.extM365a[0].enrolledTenantId = randomString();
+        }
+        for (size_t i = randomSize(3); i > 0; i--)
+        {
+            record.tags[randomString()] = randomString();
+        }
+        record.baseType = randomString();
+
+        record.data.resize(1);
+        for (size_t i = randomSize(30); i > 0; i--)
+        {
+            record.data[0].properties[randomString(12)] = randomValue();
+        }
+        if (rng() % 4 == 0)
+        {
+            record.baseData.push_back(record.data[0]);
+        }
+        return record;
+    }
+
+    static std::vector<uint8_t> serializeReference(::CsProtocol::Record const& record)
+    {
+        std::vector<uint8_t> output;
+        bond_lite::CompactBinaryProtocolWriter writer(output);
+        bond_lite::Serialize(writer, record);
+        return output;
+    }
+};
+
+TEST_F(BondWriterTests, VarintSizeMatchesEncoding)
+{
+    uint8_t buffer[16];
+    for (unsigned bit = 0; bit < 64; bit++)
+    {
+        for (uint64_t value : { (uint64_t(1) << bit) - 1, uint64_t(1) << bit, (uint64_t(1) << bit) + 1 })
+        {
+            size_t written = static_cast<size_t>(bond_lite::CompactBinaryWriteVarint(buffer, value) - buffer);
+            EXPECT_THAT(bond_lite::CompactBinaryVarintSize(value), Eq(written)) << value;
+        }
+    }
+    EXPECT_THAT(bond_lite::CompactBinaryVarintSize(UINT64_MAX), Eq(10u));
+}
+
+TEST_F(BondWriterTests, ArrayWritesMatchPerElementWrites)
+{
+    std::vector<int64_t> longs = { 0, -1, 1, 63, -64, 64, INT64_MIN, INT64_MAX, 123456789 };
+    std::vector<double> doubles = { 0.0, -1.5, 3.25, 1e300 };
+    std::vector<uint8_t> bytes = randomGuid();
+
+    std::vector<uint8_t> expected;
+    {
+        bond_lite::CompactBinaryProtocolWriter writer(expected);
+        for (auto v : longs)
+        {
+            writer.WriteInt64(v);
+        }
+        for (auto v : doubles)
+        {
+            writer.WriteDouble(v);
+        }
+        for (auto v : bytes)
+        {
+            writer.WriteUInt8(v);
+        }
+    }
+
+    std::vector<uint8_t> bulk;
+    {
+        bond_lite::CompactBinaryProtocolWriter writer(bulk);
+        writer.WriteInt64Array(longs.data(), longs.size());
+        writer.WriteDoubleArray(doubles.data(), doubles.size());
+        writer.WriteUInt8Array(bytes.data(), bytes.size());
+    }
+    EXPECT_THAT(bulk, Eq(expected));
+
+    bond_lite::CompactBinaryProtocolSizer sizer;
+    sizer.WriteInt64Array(longs.data(), longs.size());
+    sizer.WriteDoubleArray(doubles.data(), doubles.size());
+    sizer.WriteUInt8Array(bytes.data(), bytes.size());
+    ASSERT_THAT(sizer.size(), Eq(expected.size()));
+
+    std::vector<uint8_t> fast(sizer.size());
+    bond_lite::CompactBinaryProtocolFastWriter writer(fast.data(), fast.size());
+    writer.WriteInt64Array(longs.data(), longs.size());
+    writer.WriteDoubleArray(doubles.data(), doubles.size());
+    writer.WriteUInt8Array(bytes.data(), bytes.size());
+    EXPECT_THAT(writer.cursor(), Eq(fast.data() + fast.size()));
+    EXPECT_THAT(fast, Eq(expected));
+}
+
+TEST_F(BondWriterTests, EmptyRecordIsBitIdentical)
+{
+    ::CsProtocol::Record record;
+    std::vector<uint8_t> fast;
+    bond_lite::SerializeFast(fast, record);
+    EXPECT_THAT(fast, Eq(serializeReference(record)));
+}
+
+TEST_F(BondWriterTests, RandomRecordsAreBitIdentical)
+{
+    for (int i = 0; i < 500; i++)
+    {
+        ::CsProtocol::Record record = randomRecord();
+        std::vector<uint8_t> expected = serializeReference(record);
+
+        bond_lite::CompactBinaryProtocolSizer sizer;
+        bond_lite::Serialize(sizer, record);
+        ASSERT_THAT(sizer.size(), Eq(expected.size())) << "iteration " << i;
+
+        std::vector<uint8_t> fast;
+        bond_lite::SerializeFast(fast, record);
+        ASSERT_THAT(fast, Eq(expected)) << "iteration " << i;
+
+        ::CsProtocol::Record decoded;
+        bond_lite::CompactBinaryProtocolReader reader(fast);
+        ASSERT_TRUE(bond_lite::Deserialize(reader, decoded)) << "iteration " << i;
+        EXPECT_THAT(decoded == record, true) << "iteration " << i;
+    }
+}
+
+TEST_F(BondWriterTests, SerializeFastAppendsToExistingOutput)
+{
+    ::CsProtocol::Record record = randomRecord();
+    std::vector<uint8_t> expected = { 0xAA, 0xBB };
+    std::vector<uint8_t> serialized = serializeReference(record);
+    expected.insert(expected.end(), serialized.begin(), serialized.end());
+
+    std::vector<uint8_t> fast = { 0xAA, 0xBB };
+    bond_lite::SerializeFast(fast, record);
+    EXPECT_THAT(fast, Eq(expected));
+}
+
+TEST_F(BondWriterTests, FastWriterThroughput)
+{
+    std::vector<::CsProtocol::Record> records;
+    for (int i = 0; i < 200; i++)
+    {
+        records.push_back(randomRecord());
+    }
+
+    const int rounds = 20;
+    size_t checksum[2] = {};
+    double elapsedNs[2] = {};
+    for (int variant = 0; variant < 2; variant++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; round++)
+        {
+            for (auto const& record : records)
+            {
+                std::vector<uint8_t> output;
+                if (variant == 0)
+                {
+                    bond_lite::CompactBinaryProtocolWriter writer(output);
+                    bond_lite::Serialize(writer, record);
+                }
+                else
+                {
+                    bond_lite::SerializeFast(output, record);
+                }
+                checksum[variant] += output.size();
+            }
+        }
+        elapsedNs[variant] = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    double recordCount = static_cast<double>(rounds * records.size());
+    std::cout << "Bond record serialization: vector writer " << elapsedNs[0] / recordCount
+              << " ns/record, sized raw cursor writer " << elapsedNs[1] / recordCount << " ns/record" << std::endl;
+    EXPECT_THAT(checksum[1], Eq(checksum[0]));
+}
@@ -6,6 +6,13 @@
 #include "common/Common.hpp"
 #include "CorrelationVector.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
+
 using namespace testing;
 using namespace MAT;
 
@@ -111,3 +118,112 @@ TEST(CorrelationVectorTests, TestCorrelationVector_Version2)
 {
    TestCorrelationVectorVersion(2, 22, 127, "01234567890123456789ab.4294967295.4294967294");
 }
+
+TEST(CorrelationVectorTests, GetValue_Buffer_FormatsWithoutAllocating)
+{
+    CorrelationVector cv;
+    char buffer[CorrelationVector::ValueBufferSize];
+    EXPECT_EQ(cv.GetValue(buffer, sizeof(buffer)), 0u);
+    EXPECT_STREQ(buffer, "");
+
+    ASSERT_TRUE(cv.SetValue("0123456789abcdef.42"));
+    EXPECT_EQ(cv.GetValue(buffer, sizeof(buffer)), 19u);
+    EXPECT_STREQ(buffer, "0123456789abcdef.42");
+
+    // Too small for the value and its NUL: nothing is read nor incremented
+    EXPECT_EQ(cv.GetNextValue(buffer, 19), 0u);
+    EXPECT_EQ(cv.GetNextValue(buffer, 20), 19u);
+    EXPECT_STREQ(buffer, "0123456789abcdef.42");
+    EXPECT_EQ(cv.GetValue(), "0123456789abcdef.43");
+
+    EXPECT_TRUE(cv.Extend());
+    EXPECT_EQ(cv.GetValue(buffer, sizeof(buffer)), 21u);
+    EXPECT_STREQ(buffer, "0123456789abcdef.43.0");
+
+    cv.Uninitialize();
+    EXPECT_FALSE(cv.IsInitialized());
+    EXPECT_EQ(cv.GetNextValue(buffer, sizeof(buffer)), 0u);
+}
+
+TEST(CorrelationVectorTests, ConcurrentExtendAndIncrement_ProduceValidValues)
+{
+    CorrelationVector cv;
+    ASSERT_TRUE(cv.Initialize(2));
+    std::atomic<bool> done(false);
+    std::atomic<unsigned> invalid(0);
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++)
+    {
+        readers.emplace_back([&cv, &done, &invalid]() {
+            CorrelationVector parsed;
+            char buffer[CorrelationVector::ValueBufferSize];
+            while (!done)
+            {
+                size_t length = cv.GetNextValue(buffer, sizeof(buffer));
+                if ((length == 0) || !parsed.SetValue(std::string(buffer, length)))
+                {
+                    invalid++;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 20000; i++)
+    {
+        if (!cv.Extend())
+        {
+            ASSERT_TRUE(cv.SetValue("01234567890123456789ab"));
+        }
+    }
+    done = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_EQ(invalid, 0u);
+}
+
+TEST(CorrelationVectorTests, GetNextValue_ScalesWithThreads)
+{
+    const unsigned totalValues = 64000;
+    for (unsigned threads : { 1u, 2u, 4u, 8u, 16u })
+    {
+        CorrelationVector cv;
+        ASSERT_TRUE(cv.SetValue("01234567890123456789ab.1"));
+        ASSERT_TRUE(cv.Extend());
+
+        const unsigned perThread = totalValues / threads;
+        std::vector<std::vector<string>> values(threads);
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < threads; t++)
+        {
+            workers.emplace_back([&cv, &values, t, perThread]() {
+                char buffer[CorrelationVector::ValueBufferSize];
+                values[t].reserve(perThread);
+                for (unsigned i = 0; i < perThread; i++)
+                {
+                    size_t length = cv.GetNextValue(buffer, sizeof(buffer));
+                    values[t].emplace_back(buffer, length);
+                }
+            });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "CorrelationVector::GetNextValue with " << threads << " threads: "
+                  << (static_cast<double>(perThread * threads) * 1000000.0 / static_cast<double>(std::max<int64_t>(1, elapsedUs)))
+                  << " values/s" << std::endl;
+
+        // Every value was handed out exactly once
+        std::set<string> unique;
+        for (auto const& perThreadValues : values)
+        {
+            unique.insert(perThreadValues.begin(), perThreadValues.end());
+        }
+        EXPECT_EQ(unique.size(), static_cast<size_t>(perThread * threads));
+        EXPECT_EQ(cv.GetValue(), "01234567890123456789ab.1." + std::to_string(perThread * threads));
+    }
+}
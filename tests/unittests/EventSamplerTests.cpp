@@ -0,0 +1,193 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "filter/EventSampler.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    class EventSampler4Test : public EventSampler
+    {
+    public:
+        uint64_t nowMs = 1000;
+
+        using EventSampler::MaxBuckets;
+
+        virtual uint64_t now() const override
+        {
+            return nowMs;
+        }
+
+        size_t GetEventBucketCount()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_eventBuckets.size();
+        }
+    };
+
+    class EventSamplerTests : public ::testing::Test
+    {
+    public:
+        EventSampler4Test sampler;
+        ContextFieldsProvider context;
+        ILogConfiguration config;
+
+        EventSampler::Decision admit(std::string const& name, std::string const& tenantToken = "tenant-token")
+        {
+            double scale;
+            return sampler.Admit(EventProperties(name), tenantToken, context, scale);
+        }
+
+        void configure()
+        {
+            sampler.Configure(config[CFG_MAP_SAMPLING]);
+        }
+    };
+
+} // namespace
+
+TEST_F(EventSamplerTests, InactiveWithoutConfiguration)
+{
+    configure();
+    EXPECT_FALSE(sampler.IsActive());
+    double scale = 0;
+    EXPECT_THAT(sampler.Admit(EventProperties("event"), "tenant-token", context, scale), Eq(EventSampler::Accepted));
+    EXPECT_THAT(scale, Eq(1.0));
+}
+
+TEST_F(EventSamplerTests, SamplesDeterministicallyOnKey)
+{
+    config[CFG_MAP_SAMPLING][CFG_STR_SAMPLING_KEY] = "deviceId";
+    config[CFG_MAP_SAMPLING][CFG_INT_SAMPLING_PERCENT] = 25;
+    configure();
+    ASSERT_TRUE(sampler.IsActive());
+
+    size_t kept = 0;
+    for (int device = 0; device < 1000; device++)
+    {
+        EventProperties event("event");
+        event.SetProperty("deviceId", "device" + std::to_string(device));
+        double scale = 0;
+        EventSampler::Decision first = sampler.Admit(event, "tenant-token", context, scale);
+        // The same key always gets the same decision
+        EXPECT_THAT(sampler.Admit(event, "tenant-token", context, scale), Eq(first));
+        if (first == EventSampler::Accepted)
+        {
+            EXPECT_THAT(scale, DoubleEq(0.25));
+            kept++;
+        }
+    }
+    EXPECT_THAT(kept, AllOf(Gt(200u), Lt(300u)));
+    EXPECT_THAT(sampler.GetSampledOutCount(), Eq(2 * (1000 - kept)));
+}
+
+TEST_F(EventSamplerTests, FallsBackToContextForKey)
+{
+    config[CFG_MAP_SAMPLING][CFG_STR_SAMPLING_KEY] = "deviceId";
+    config[CFG_MAP_SAMPLING][CFG_INT_SAMPLING_PERCENT] = 50;
+    configure();
+
+    // All events of a device share its decision
+    ContextFieldsProvider parent;
+    context.SetParentContext(&parent);
+    for (int device = 0; device < 20; device++)
+    {
+        parent.SetCommonField("deviceId", EventProperty("device" + std::to_string(device)));
+        EventSampler::Decision first = admit("first");
+        for (int i = 0; i < 10; i++)
+        {
+            EXPECT_THAT(admit("event" + std::to_string(i)), Eq(first));
+        }
+    }
+}
+
+TEST_F(EventSamplerTests, PerEventRulesOverrideDefault)
+{
+    config[CFG_MAP_SAMPLING][CFG_INT_SAMPLING_PERCENT] = 0;
+    config[CFG_MAP_SAMPLING][CFG_MAP_SAMPLING_EVENTS]["important"][CFG_INT_SAMPLING_PERCENT] = 100;
+    configure();
+
+    EXPECT_THAT(admit("other"), Eq(EventSampler::SampledOut));
+    double scale = 0;
+    EXPECT_THAT(sampler.Admit(EventProperties("important"), "tenant-token", context, scale), Eq(EventSampler::Accepted));
+    EXPECT_THAT(scale, Eq(1.0));
+}
+
+TEST_F(EventSamplerTests, RateLimitsEachEventName)
+{
+    config[CFG_MAP_SAMPLING][CFG_INT_SAMPLING_EVENTS_PER_SEC] = 10;
+    config[CFG_MAP_SAMPLING][CFG_MAP_SAMPLING_EVENTS]["noisy"][CFG_INT_SAMPLING_BURST] = 2;
+    configure();
+
+    // The noisy event only has a burst of 2, the quiet one still gets through
+    EXPECT_THAT(admit("noisy"), Eq(EventSampler::Accepted));
+    EXPECT_THAT(admit("noisy"), Eq(EventSampler::Accepted));
+    EXPECT_THAT(admit("noisy"), Eq(EventSampler::RateLimited));
+    EXPECT_THAT(admit("quiet"), Eq(EventSampler::Accepted));
+
+    for (int i = 1; i < 10; i++)
+    {
+        EXPECT_THAT(admit("quiet"), Eq(EventSampler::Accepted));
+    }
+    EXPECT_THAT(admit("quiet"), Eq(EventSampler::RateLimited));
+    EXPECT_THAT(sampler.GetRateLimitedCount(), Eq(2u));
+
+    // Refills at 10 per second
+    sampler.nowMs += 100;
+    EXPECT_THAT(admit("noisy"), Eq(EventSampler::Accepted));
+    EXPECT_THAT(admit("noisy"), Eq(EventSampler::RateLimited));
+}
+
+TEST_F(EventSamplerTests, FullBucketMapKeepsBusyRateLimits)
+{
+    config[CFG_MAP_SAMPLING][CFG_INT_SAMPLING_EVENTS_PER_SEC] = 1;
+    configure();
+
+    for (size_t i = 0; i < EventSampler4Test::MaxBuckets; i++)
+    {
+        EXPECT_THAT(admit("event" + std::to_string(i)), Eq(EventSampler::Accepted));
+    }
+    EXPECT_THAT(sampler.GetEventBucketCount(), Eq(EventSampler4Test::MaxBuckets));
+
+    // Every bucket is empty: a new name is not tracked and the others stay limited
+    EXPECT_THAT(admit("new"), Eq(EventSampler::Accepted));
+    EXPECT_THAT(admit("event0"), Eq(EventSampler::RateLimited));
+    EXPECT_THAT(sampler.GetEventBucketCount(), Eq(EventSampler4Test::MaxBuckets));
+
+    // Once the buckets refill, a new name takes the place of one idle bucket only
+    sampler.nowMs += 1000;
+    EXPECT_THAT(admit("event1"), Eq(EventSampler::Accepted));
+    EXPECT_THAT(admit("new"), Eq(EventSampler::Accepted));
+    EXPECT_THAT(admit("new"), Eq(EventSampler::RateLimited));
+    EXPECT_THAT(admit("event1"), Eq(EventSampler::RateLimited));
+    EXPECT_THAT(sampler.GetEventBucketCount(), Eq(EventSampler4Test::MaxBuckets));
+}
+
+TEST_F(EventSamplerTests, RateLimitsTenants)
+{
+    config[CFG_MAP_SAMPLING][CFG_MAP_SAMPLING_TENANTS]["tenant"][CFG_INT_SAMPLING_EVENTS_PER_SEC] = 1;
+    configure();
+
+    // Matched by tenant id, other tenants are not limited
+    EXPECT_THAT(admit("first", "tenant-token"), Eq(EventSampler::Accepted));
+    EXPECT_THAT(admit("second", "tenant-token"), Eq(EventSampler::RateLimited));
+    EXPECT_THAT(admit("second", "other-token"), Eq(EventSampler::Accepted));
+}
+
+TEST_F(EventSamplerTests, ReconfiguresAtRuntime)
+{
+    config[CFG_MAP_SAMPLING][CFG_INT_SAMPLING_EVENTS_PER_SEC] = 1;
+    configure();
+    EXPECT_THAT(admit("event"), Eq(EventSampler::Accepted));
+    EXPECT_THAT(admit("event"), Eq(EventSampler::RateLimited));
+
+    config[CFG_MAP_SAMPLING][CFG_INT_SAMPLING_EVENTS_PER_SEC] = 0;
+    configure();
+    EXPECT_FALSE(sampler.IsActive());
+    EXPECT_THAT(admit("event"), Eq(EventSampler::Accepted));
+}
@@ -50,9 +50,9 @@ TEST_F(HttpClientManagerTests, HandlesRequestFlow)
     auto ctx = std::make_shared<EventsUploadContext>();
     ctx->httpRequestId = req->GetId();
     ctx->httpRequest = req;
-    ctx->recordIdsAndTenantIds["r1"] = "t1"; ctx->recordIdsAndTenantIds["r2"] = "t1";
+    ctx->recordIdsAndTenantIds["r1"] = 0; ctx->recordIdsAndTenantIds["r2"] = 0;
     ctx->latency = EventLatency_Normal;
-    ctx->packageIds["tenant1-token"] = 0;
+    ctx->packageIds[0] = 0;
 
     IHttpResponseCallback* callback = nullptr;
     EXPECT_CALL(httpClientMock, SendRequestAsync(ctx->httpRequest, _))
@@ -66,11 +66,15 @@ TEST_F(HttpClientManagerTests, HandlesRequestFlow)
     rsp->m_result = HttpResult_OK;
     rsp->m_statusCode = 200;
 
-    EXPECT_CALL(*this, resultRequestDone(ctx))
-        .WillOnce(Return());
     IHttpResponse* rspRef = rsp.get();
+    EXPECT_CALL(*this, resultRequestDone(ctx))
+        .WillOnce(Invoke([rspRef](EventsUploadContextPtr const& done) {
+            EXPECT_THAT(done->httpResponse, rspRef);
+        }));
     callback->OnHttpResponse(rsp.release());
 
-    EXPECT_THAT(ctx->httpResponse, rspRef);
+    // Request and response are released before the callback, so that a pooled context does not outlive them
+    EXPECT_THAT(ctx->httpRequest, IsNull());
+    EXPECT_THAT(ctx->httpResponse, IsNull());
     EXPECT_THAT(ctx->durationMs, Gt(199));
 }
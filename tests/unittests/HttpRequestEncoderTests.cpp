@@ -4,6 +4,7 @@
 #include "common/MockIHttpClient.hpp"
 #include "http/HttpRequestEncoder.hpp"
 #include "config/RuntimeConfig_Default.hpp"
+#include "api/AuthTokensController.hpp"
 
 using namespace testing;
 using namespace MAT;
@@ -22,7 +23,38 @@ public:
         dataPacket = packet;
     }
 
+    IAuthTokensController* GetAuthTokensController() override
+    {
+        return tokens;
+    }
+
     StorageBlob dataPacket;
+    IAuthTokensController* tokens = nullptr;
+};
+
+class CountingAuthTokensController : public AuthTokensController
+{
+public:
+    std::map<TicketType, std::string>& GetUserTokens() override
+    {
+        reads++;
+        return AuthTokensController::GetUserTokens();
+    }
+
+    int reads = 0;
+};
+
+class SharedHeadersHttpRequest : public SimpleHttpRequest
+{
+public:
+    SharedHeadersHttpRequest() : SimpleHttpRequest("SharedHeadersHttpRequest") {}
+
+    virtual void SetSharedHeaders(std::shared_ptr<const HttpHeaders> const& headers) override
+    {
+        shared = headers;
+    }
+
+    std::shared_ptr<const HttpHeaders> shared;
 };
 
 class HttpRequestEncoderTests : public Test {
@@ -55,7 +87,7 @@ TEST_F(HttpRequestEncoderTests, SetsAllParameters)
     EventsUploadContextPtr ctx = std::make_shared<EventsUploadContext>();
     ctx->compressed = false;
     ctx->body = { 1, 127, 255 };
-    ctx->packageIds["tenant1-token"] = 0;
+    ctx->packageIds[system.getTenantTable().intern("tenant1-token")] = 0;
     ctx->latency = EventLatency_RealTime;
 
     encoder.encode(ctx);
@@ -101,14 +133,14 @@ TEST_F(HttpRequestEncoderTests, BuildsApiKeyCorrectly)
     SimpleHttpRequest const* req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
     EXPECT_THAT(req->m_headers, Contains(Pair("APIKey", "")));
 
-    ctx->packageIds["tenant1-token"] = 0;
+    ctx->packageIds[system.getTenantTable().intern("tenant1-token")] = 0;
     encoder.encode(ctx);
     ASSERT_THAT(ctx->httpRequestId, Eq("HttpRequestEncoderTests"));
     req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
     EXPECT_THAT(req->m_headers, Contains(Pair("APIKey", "tenant1-token")));
 
-    ctx->packageIds["tenant2-token"] = 1;
-    ctx->packageIds["tenant3-token"] = 2;
+    ctx->packageIds[system.getTenantTable().intern("tenant2-token")] = 1;
+    ctx->packageIds[system.getTenantTable().intern("tenant3-token")] = 2;
     encoder.encode(ctx);
     ASSERT_THAT(ctx->httpRequestId, Eq("HttpRequestEncoderTests"));
     req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
@@ -126,3 +158,118 @@ TEST_F(HttpRequestEncoderTests, DispatchDataViewerEventCorrectly)
 
     EXPECT_THAT(mockEncoder.dataPacket, Eq(std::vector<uint8_t>{1, 127, 255}));
 }
+
+TEST_F(HttpRequestEncoderTests, AuthTokensVersionChangesOnUpdate)
+{
+    AuthTokensController tokens;
+    uint64_t version = tokens.GetVersion();
+    EXPECT_THAT(version, Ne(0u));
+
+    tokens.SetTicketToken(TicketType_MSA_User, "user");
+    EXPECT_THAT(tokens.GetVersion(), Gt(version));
+    version = tokens.GetVersion();
+
+    EXPECT_THAT(tokens.SetTicketToken(TicketType_MSA_User, nullptr), Eq(STATUS_EFAIL));
+    EXPECT_THAT(tokens.GetVersion(), Eq(version));
+
+    tokens.SetStrictMode(true);
+    EXPECT_THAT(tokens.GetVersion(), Gt(version));
+    version = tokens.GetVersion();
+
+    tokens.Clear();
+    EXPECT_THAT(tokens.GetVersion(), Gt(version));
+}
+
+TEST_F(HttpRequestEncoderTests, SetsAuthHeaders)
+{
+    AuthTokensController tokens;
+    tokens.SetTicketToken(TicketType_MSA_Device, "msa-device");
+    tokens.SetTicketToken(TicketType_XAuth_Device, "xauth-device");
+    tokens.SetTicketToken(TicketType_AAD, "aad");
+    tokens.SetTicketToken(TicketType_AAD_Device, "aad-device");
+    tokens.SetTicketToken(TicketType_MSA_User, "msa-user");
+    tokens.SetTicketToken(TicketType_XAuth_User, "xauth-user");
+    tokens.SetTicketToken(TicketType_AAD_User, "aad-user");
+    tokens.SetStrictMode(true);
+
+    MockHttpRequestEncoder mockEncoder(system, mockHttpClient);
+    mockEncoder.tokens = &tokens;
+    EventsUploadContextPtr ctx = std::make_shared<EventsUploadContext>();
+    mockEncoder.encode(ctx);
+    auto const& headers = static_cast<SimpleHttpRequest*>(ctx->httpRequest)->m_headers;
+
+    EXPECT_THAT(headers, Contains(Pair("AuthMsaDeviceTicket", "msa-device")));
+    EXPECT_THAT(headers, Contains(Pair("AuthXToken", "xauth-device")));
+    EXPECT_THAT(headers, Contains(Pair("Aad-Token", "aad")));
+    EXPECT_THAT(headers, Contains(Pair("AadDeviceToken", "aad-device")));
+    EXPECT_THAT(headers, Contains(Pair("Strict", "true")));
+    EXPECT_THAT(headers, Contains(Pair("Tickets",
+        "\"1000" + std::to_string(TicketType_MSA_User) + "\"=\"p:msa-user\";"
+        "\"1000" + std::to_string(TicketType_XAuth_User) + "\"=\"x:XBL3.0 x=xauth-user\";"
+        "\"1000" + std::to_string(TicketType_AAD_User) + "\"=\"at:aad-user\"")));
+    EXPECT_THAT(headers, Contains(Pair("SDK-Version", PAL::getSdkVersion())));
+    EXPECT_THAT(headers.count("Upload-Time"), Eq(1u));
+}
+
+TEST_F(HttpRequestEncoderTests, CachesHeadersUntilTokensChange)
+{
+    CountingAuthTokensController tokens;
+    tokens.SetTicketToken(TicketType_MSA_User, "first");
+
+    MockHttpRequestEncoder mockEncoder(system, mockHttpClient);
+    mockEncoder.tokens = &tokens;
+
+    for (int i = 0; i < 3; i++)
+    {
+        EventsUploadContextPtr ctx = std::make_shared<EventsUploadContext>();
+        mockEncoder.encode(ctx);
+        EXPECT_THAT(static_cast<SimpleHttpRequest*>(ctx->httpRequest)->m_headers.get("Tickets"), HasSubstr("p:first"));
+    }
+    EXPECT_THAT(tokens.reads, Eq(1));
+
+    tokens.SetTicketToken(TicketType_MSA_User, "second");
+    EventsUploadContextPtr ctx = std::make_shared<EventsUploadContext>();
+    mockEncoder.encode(ctx);
+    auto const& headers = static_cast<SimpleHttpRequest*>(ctx->httpRequest)->m_headers;
+    EXPECT_THAT(tokens.reads, Eq(2));
+    EXPECT_THAT(headers.get("Tickets"), HasSubstr("p:second"));
+    EXPECT_THAT(headers.count("Tickets"), Eq(1u));
+
+    tokens.Clear();
+    EventsUploadContextPtr cleared = std::make_shared<EventsUploadContext>();
+    mockEncoder.encode(cleared);
+    EXPECT_THAT(static_cast<SimpleHttpRequest*>(cleared->httpRequest)->m_headers.count("Tickets"), Eq(0u));
+}
+
+TEST_F(HttpRequestEncoderTests, KeepsPerRequestHeadersOutOfSharedBlock)
+{
+    EXPECT_CALL(mockHttpClient, CreateRequest())
+        .WillRepeatedly(Invoke([]() { return new SharedHeadersHttpRequest(); }));
+
+    std::shared_ptr<const HttpHeaders> first;
+    for (int i = 0; i < 2; i++)
+    {
+        EventsUploadContextPtr ctx = std::make_shared<EventsUploadContext>();
+        ctx->compressed = true;
+        encoder.encode(ctx);
+        auto request = static_cast<SharedHeadersHttpRequest*>(ctx->httpRequest);
+        ASSERT_THAT(request->shared, NotNull());
+        EXPECT_THAT(*request->shared, Contains(Pair("Client-Id", "NO_AUTH")));
+        EXPECT_THAT(request->shared->count("Upload-Time"), Eq(0u));
+        EXPECT_THAT(request->shared->count("APIKey"), Eq(0u));
+        EXPECT_THAT(request->shared->count("Content-Encoding"), Eq(0u));
+        EXPECT_THAT(request->m_headers.count("Upload-Time"), Eq(1u));
+        EXPECT_THAT(request->m_headers.count("APIKey"), Eq(1u));
+        EXPECT_THAT(request->m_headers, Contains(Pair("Content-Encoding", "deflate")));
+        EXPECT_THAT(request->m_headers.count("Client-Id"), Eq(0u));
+        if (i == 0)
+        {
+            first = request->shared;
+        }
+        else
+        {
+            // Clients may cache their encoding of the block on its identity
+            EXPECT_THAT(request->shared, Eq(first));
+        }
+    }
+}
@@ -3,8 +3,13 @@
 // SPDX-License-Identifier: Apache-2.0
 //
 #include "api/LogManagerImpl.hpp"
+#include "system/MemoryBudget.hpp"
 #include "common/Common.hpp"
+#include <chrono>
+#include <condition_variable>
 #include <future>
+#include <iostream>
+#include <thread>
 
 using namespace testing;
 using namespace MAT;
@@ -214,3 +219,332 @@ TEST(LogManagerImplTests, Constructor_DataViewerCollectionIsNotNullptr_DataViewe
     TestLogManagerImpl logManager{configuration, true};
     ASSERT_NO_THROW(logManager.GetDataViewerCollection());
 }
+
+class ConcurrencyProbeDecorator : public IDecoratorModule
+{
+   public:
+    std::mutex lock;
+    std::condition_variable cv;
+    unsigned inside = 0;
+    unsigned maxInside = 0;
+    unsigned waitFor = 0;
+    std::atomic<unsigned> calls{0};
+
+    virtual bool decorate(::CsProtocol::Record& record) override
+    {
+        calls++;
+        record.extApp.resize(1);
+        record.extApp[0].id = "probe";
+        if (waitFor == 0)
+        {
+            return true;
+        }
+        // Blocks until waitFor events are being decorated at once, or a timeout
+        std::unique_lock<std::mutex> guard(lock);
+        inside++;
+        maxInside = std::max(maxInside, inside);
+        cv.notify_all();
+        cv.wait_for(guard, std::chrono::seconds(5), [this]() { return maxInside >= waitFor; });
+        inside--;
+        return true;
+    }
+};
+
+class CountingDataInspector : public IDataInspector
+{
+   public:
+    std::atomic<unsigned> records{0};
+
+    virtual void SetEnabled(bool) noexcept override {}
+    virtual bool IsEnabled() const noexcept override { return true; }
+    virtual bool InspectRecord(::CsProtocol::Record&) noexcept override
+    {
+        records++;
+        return true;
+    }
+    virtual void InspectSemanticContext(const std::string&, const std::string&, bool, const std::string&) noexcept override {}
+    virtual void InspectSemanticContext(const std::string&, GUID_t, bool, const std::string&) noexcept override {}
+    virtual const char* GetName() const noexcept override { return "CountingDataInspector"; }
+};
+
+class LogManagerIngestionTests : public ::testing::Test
+{
+   public:
+    ILogConfiguration configuration;
+    std::shared_ptr<TestHttpClient> httpClient = std::make_shared<TestHttpClient>();
+    std::shared_ptr<ConcurrencyProbeDecorator> decorator = std::make_shared<ConcurrencyProbeDecorator>();
+    std::shared_ptr<CountingDataInspector> inspector = std::make_shared<CountingDataInspector>();
+
+    LogManagerIngestionTests()
+    {
+        configuration.AddModule(CFG_MODULE_HTTP_CLIENT, httpClient);
+        configuration.AddModule(CFG_MODULE_DECORATOR, decorator);
+    }
+};
+
+TEST_F(LogManagerIngestionTests, SendEvent_DecoratesEventsInParallel)
+{
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+    logManager.SetDataInspector(inspector);
+    auto logger = logManager.GetLogger("fred");
+
+    decorator->waitFor = 2;
+    std::thread first([logger]() { logger->LogEvent("ParallelEvent1"); });
+    std::thread second([logger]() { logger->LogEvent("ParallelEvent2"); });
+    first.join();
+    second.join();
+
+    EXPECT_EQ(decorator->maxInside, 2u);
+    EXPECT_EQ(inspector->records, 2u);
+    logManager.FlushAndTeardown();
+}
+
+TEST_F(LogManagerIngestionTests, FlushAndTeardown_ReportsShutdownStats)
+{
+    configuration[CFG_INT_MAX_TEARDOWN_TIME] = 10;
+    TestLogManagerImpl logManager{configuration};
+    ShutdownStats stats;
+    EXPECT_EQ(logManager.GetShutdownStats(stats), STATUS_ENOTSUP);
+    logManager.GetLogger("fred")->LogEvent("PendingEvent");
+
+    logManager.FlushAndTeardown();
+
+    ASSERT_EQ(logManager.GetShutdownStats(stats), STATUS_SUCCESS);
+    // Nothing was in flight: teardown does not wait out the timeout for the stored event
+    EXPECT_LT(stats.uploadMs, 5000);
+    EXPECT_GE(stats.totalMs, stats.uploadMs + stats.abortMs + stats.stopMs + stats.workerMs + stats.storageMs);
+}
+
+TEST_F(LogManagerIngestionTests, GetMemoryUsage_ReportsRamQueue)
+{
+    configuration[CFG_INT_MEMORY_BUDGET] = 1024 * 1024;
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+    logManager.GetLogger("fred")->LogEvent("QueuedEvent");
+
+    MemoryUsageStats stats;
+    ASSERT_EQ(logManager.GetMemoryUsage(stats), STATUS_SUCCESS);
+    EXPECT_EQ(stats.limitBytes, 1024u * 1024u);
+    EXPECT_GT(stats.ramQueueBytes, 0u);
+    EXPECT_GE(stats.usedBytes, stats.ramQueueBytes);
+    EXPECT_GE(stats.peakBytes, stats.usedBytes);
+
+    logManager.FlushAndTeardown();
+    MemoryBudget::GetInstance().SetLimit(0);
+}
+
+TEST_F(LogManagerIngestionTests, TryLogEvent_ShedsWhileSaturated)
+{
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+    std::vector<std::pair<bool, unsigned>> crossings;
+    EXPECT_EQ(logManager.SetBackpressureCallback([&crossings](bool saturated, unsigned fillPercent) {
+        crossings.emplace_back(saturated, fillPercent);
+    }), STATUS_SUCCESS);
+    auto logger = logManager.GetLogger("fred");
+    EXPECT_EQ(logger->TryLogEvent(EventProperties("Accepted")), LogEventResult_Accepted);
+
+    // As dispatched by the offline storage when the RAM queue crosses the watermarks
+    logManager.DispatchEvent(DebugEvent(DebugEventType::EVT_STORAGE_BACKPRESSURE, 1, 250));
+    EXPECT_TRUE(logManager.IsSaturated());
+    EXPECT_EQ(logger->TryLogEvent(EventProperties("Shed")), LogEventResult_Dropped);
+
+    logManager.DispatchEvent(DebugEvent(DebugEventType::EVT_STORAGE_BACKPRESSURE, 0, 90));
+    EXPECT_FALSE(logManager.IsSaturated());
+    EXPECT_EQ(logger->TryLogEvent(EventProperties("AcceptedAgain")), LogEventResult_Accepted);
+
+    // The shed event was not decorated
+    EXPECT_EQ(decorator->calls, 2u);
+    ASSERT_EQ(crossings.size(), 2u);
+    EXPECT_TRUE(crossings[0].first);
+    EXPECT_EQ(crossings[0].second, 250u);
+    EXPECT_FALSE(crossings[1].first);
+    EXPECT_EQ(crossings[1].second, 90u);
+
+    logManager.SetBackpressureCallback(nullptr);
+    logManager.FlushAndTeardown();
+}
+
+TEST_F(LogManagerIngestionTests, TryLogEvent_WithoutRamQueue_ReportsQueuedToDisk)
+{
+    configuration[CFG_INT_RAM_QUEUE_SIZE] = 0;
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+    EXPECT_EQ(logManager.GetLogger("fred")->TryLogEvent(EventProperties("Stored")), LogEventResult_QueuedToDisk);
+    logManager.FlushAndTeardown();
+}
+
+TEST_F(LogManagerIngestionTests, SendEvent_RemovedDataInspectorIsNotCalled)
+{
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+    auto logger = logManager.GetLogger("fred");
+
+    logManager.SetDataInspector(inspector);
+    logger->LogEvent("Inspected");
+    logManager.RemoveDataInspector(inspector->GetName());
+    logger->LogEvent("NotInspected");
+
+    EXPECT_EQ(decorator->calls, 2u);
+    EXPECT_EQ(inspector->records, 1u);
+    logManager.FlushAndTeardown();
+}
+
+static unsigned MeasureIngestion(ILogger* logger, char const* label)
+{
+    const unsigned totalEvents = 12800;
+    unsigned expected = 0;
+    for (unsigned threads : { 1u, 2u, 4u, 8u, 16u, 32u, 64u })
+    {
+        const unsigned perThread = totalEvents / threads;
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < threads; t++)
+        {
+            workers.emplace_back([logger, perThread]() {
+                EventProperties props("ScalingEvent");
+                for (int i = 0; i < 10; i++)
+                {
+                    props.SetProperty("strKey" + std::to_string(i), "value value value value value");
+                }
+                for (unsigned i = 0; i < perThread; i++)
+                {
+                    props.SetProperty("seq", static_cast<int64_t>(i));
+                    logger->LogEvent(props);
+                }
+            });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        expected += perThread * threads;
+        std::cout << "Ingestion (" << label << ") with " << threads << " logging threads: "
+                  << (static_cast<double>(perThread * threads) * 1000000.0 / static_cast<double>(std::max<int64_t>(1, elapsedUs)))
+                  << " events/s" << std::endl;
+    }
+    return expected;
+}
+
+TEST_F(LogManagerIngestionTests, IngestionScalesWithLoggingThreads)
+{
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+    logManager.SetDataInspector(inspector);
+    auto logger = logManager.GetLogger("fred");
+
+    unsigned expected = MeasureIngestion(logger, "single RAM queue");
+
+    EXPECT_EQ(decorator->calls, expected);
+    EXPECT_EQ(inspector->records, expected);
+    logManager.FlushAndTeardown();
+}
+
+TEST_F(LogManagerIngestionTests, IngestionScalesWithShardedRamQueue)
+{
+    // Storing into separate RAM queue shards does not serialize the logging threads
+    configuration[CFG_INT_RAM_QUEUE_SHARDS] = 8;
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+    logManager.SetDataInspector(inspector);
+    auto logger = logManager.GetLogger("fred");
+
+    unsigned expected = MeasureIngestion(logger, "sharded RAM queue");
+
+    EXPECT_EQ(decorator->calls, expected);
+    EXPECT_EQ(inspector->records, expected);
+    logManager.FlushAndTeardown();
+}
+
+TEST(LogManagerImplTests, LoggerLookupCacheFindsExactPairs)
+{
+    LoggerLookupCache cache;
+    Logger* first = reinterpret_cast<Logger*>(0x1000);
+    Logger* second = reinterpret_cast<Logger*>(0x2000);
+    size_t key = LoggerLookupCache::hash("token", "source");
+
+    EXPECT_EQ(cache.find(key, "token", "source"), nullptr);
+    EXPECT_TRUE(cache.insert(key, "token", "source", first));
+    EXPECT_TRUE(cache.insert(LoggerLookupCache::hash("token", "Source"), "token", "Source", second));
+    EXPECT_EQ(cache.find(key, "token", "source"), first);
+    EXPECT_EQ(cache.find(LoggerLookupCache::hash("token", "Source"), "token", "Source"), second);
+    // A colliding key must still compare the strings
+    EXPECT_EQ(cache.find(key, "token", "other"), nullptr);
+    EXPECT_EQ(cache.size(), 2u);
+
+    cache.clear();
+    EXPECT_EQ(cache.find(key, "token", "source"), nullptr);
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(LogManagerImplTests, LoggerLookupCacheRefusesInsertsWhenFull)
+{
+    LoggerLookupCache cache;
+    Logger* logger = reinterpret_cast<Logger*>(0x1000);
+    for (size_t i = 0; i < LoggerLookupCache::MaxEntries; i++)
+    {
+        std::string source = "source" + std::to_string(i);
+        EXPECT_TRUE(cache.insert(LoggerLookupCache::hash("token", source), "token", source, logger));
+    }
+    EXPECT_FALSE(cache.insert(LoggerLookupCache::hash("token", "extra"), "token", "extra", logger));
+    EXPECT_EQ(cache.find(LoggerLookupCache::hash("token", "extra"), "token", "extra"), nullptr);
+    EXPECT_EQ(cache.find(LoggerLookupCache::hash("token", "source0"), "token", "source0"), logger);
+}
+
+TEST(LogManagerImplTests, GetLogger_CachedLookupReturnsSameLogger)
+{
+    ILogConfiguration configuration;
+    auto httpClient = std::make_shared<TestHttpClient>();
+    configuration.AddModule(CFG_MODULE_HTTP_CLIENT, httpClient);
+    TestLogManagerImpl logManager{configuration, true};
+
+    ILogger* logger = logManager.GetLogger("Token-1", "Source");
+    ASSERT_NE(logger, nullptr);
+    EXPECT_EQ(logManager.GetLogger("Token-1", "Source"), logger);
+    // Spellings that normalize to the same pair share the Logger
+    EXPECT_EQ(logManager.GetLogger("token-1", "source"), logger);
+    EXPECT_EQ(logManager.GetLogger("TOKEN-1", "SOURCE"), logger);
+    EXPECT_NE(logManager.GetLogger("Token-1", "Other"), logger);
+    EXPECT_NE(logManager.GetLogger("Token-2", "Source"), logger);
+
+    logManager.FlushAndTeardown();
+    EXPECT_EQ(logManager.GetLogger("Token-1", "Source"), nullptr);
+}
+
+TEST(LogManagerImplTests, GetLogger_ConcurrentLookups)
+{
+    ILogConfiguration configuration;
+    auto httpClient = std::make_shared<TestHttpClient>();
+    configuration.AddModule(CFG_MODULE_HTTP_CLIENT, httpClient);
+    TestLogManagerImpl logManager{configuration, true};
+
+    const std::string token = "6d084bbf6a9644ef83f40a77c9e34580-0c0d561e-e3c6-4a4c-a4c5-fbd26c3ad8a7-7373";
+    ILogger* expected = logManager.GetLogger(token, "Source");
+    const unsigned threads = 8;
+    const unsigned lookups = 100000;
+    std::atomic<unsigned> mismatches{0};
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&]() {
+            for (unsigned i = 0; i < lookups; i++)
+            {
+                if (logManager.GetLogger(token, "Source") != expected)
+                {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "GetLogger " << threads << " threads: " << elapsedNs / (threads * lookups) << " ns/lookup" << std::endl;
+    EXPECT_EQ(mismatches, 0u);
+    logManager.FlushAndTeardown();
+}
@@ -21,9 +21,12 @@ public:
     using Logger::CanEventPropertiesBeSent;
 
     bool SubmitCalled = {};
-    void submit(::CsProtocol::Record&, const EventProperties&) override
+    double SubmittedPopSample = {};
+    bool submit(::CsProtocol::Record& record, const EventProperties&) override
     {
         SubmitCalled = true;
+        SubmittedPopSample = record.popSample;
+        return true;
     }
 };
 
@@ -325,3 +328,51 @@ TEST_F(LoggerTests, LogSession_CanEventPropertiesBeSentReturnsTrue_CallsSubmit)
 }
 
 
+
+TEST_F(LoggerTests, LogEvent_SampledOutByLogManager_DoesNotCallSubmit)
+{
+    configuration[CFG_MAP_SAMPLING][CFG_MAP_SAMPLING_EVENTS]["noisy"][CFG_INT_SAMPLING_PERCENT] = 0;
+    logManager.Configure();
+    logger.LogEvent("noisy");
+    EXPECT_FALSE(logger.SubmitCalled);
+
+    logger.LogEvent("quiet");
+    EXPECT_TRUE(logger.SubmitCalled);
+    EXPECT_THAT(logger.SubmittedPopSample, Eq(100.0));
+}
+
+TEST_F(LoggerTests, LogEvent_SampledInByLogManager_ScalesPopSample)
+{
+    configuration[CFG_MAP_SAMPLING][CFG_INT_SAMPLING_PERCENT] = 100;
+    configuration[CFG_MAP_SAMPLING][CFG_MAP_SAMPLING_EVENTS]["sampled"][CFG_INT_SAMPLING_PERCENT] = 50;
+    logManager.Configure();
+
+    // Random sampling without a key: some event is kept within a few tries
+    EventProperties properties("sampled");
+    properties.SetPopsample(40);
+    for (int i = 0; i < 100 && !logger.SubmitCalled; i++)
+    {
+        logger.LogEvent(properties);
+    }
+    EXPECT_TRUE(logger.SubmitCalled);
+    EXPECT_THAT(logger.SubmittedPopSample, DoubleEq(20.0));
+}
+
+TEST_F(LoggerTests, TryLogEvent_CanEventPropertiesBeSentReturnsFalse_ReturnsDropped)
+{
+    logger.GetEventFilters().RegisterEventFilter(MakeTestEventFilter(false));
+    EXPECT_THAT(logger.TryLogEvent(EventProperties("filtered")), Eq(LogEventResult_Dropped));
+}
+
+TEST_F(LoggerTests, TryLogEvent_SampledOutByLogManager_ReturnsRateLimited)
+{
+    configuration[CFG_MAP_SAMPLING][CFG_MAP_SAMPLING_EVENTS]["noisy"][CFG_INT_SAMPLING_PERCENT] = 0;
+    logManager.Configure();
+    EXPECT_THAT(logger.TryLogEvent(EventProperties("noisy")), Eq(LogEventResult_RateLimited));
+}
+
+TEST_F(LoggerTests, TryLogEvent_LogManagerSaturated_ReturnsDropped)
+{
+    logManager.DispatchEvent(DebugEvent(DebugEventType::EVT_STORAGE_BACKPRESSURE, 1, 300));
+    EXPECT_THAT(logger.TryLogEvent(EventProperties("shed")), Eq(LogEventResult_Dropped));
+}
@@ -0,0 +1,81 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "system/MemoryBudget.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+TEST(MemoryBudgetTests, AccountsNothingWithoutLimit)
+{
+    MemoryBudget budget;
+    EXPECT_THAT(budget.Reserve(MemoryCategory_RamQueue, 100), Eq(0u));
+    EXPECT_THAT(budget.GetUsage(), Eq(0u));
+    EXPECT_THAT(budget.GetAvailable(), Eq(SIZE_MAX));
+    EXPECT_FALSE(budget.IsUnderPressure());
+}
+
+TEST(MemoryBudgetTests, ReportsUsagePerCategoryAndPeak)
+{
+    MemoryBudget budget;
+    budget.SetLimit(1000);
+    EXPECT_THAT(budget.Reserve(MemoryCategory_RamQueue, 300), Eq(300u));
+    EXPECT_THAT(budget.Reserve(MemoryCategory_UploadBodies, 200), Eq(200u));
+    budget.Release(MemoryCategory_RamQueue, 100);
+
+    MemoryUsageStats stats;
+    budget.GetStats(stats);
+    EXPECT_THAT(stats.limitBytes, Eq(1000u));
+    EXPECT_THAT(stats.usedBytes, Eq(400u));
+    EXPECT_THAT(stats.peakBytes, Eq(500u));
+    EXPECT_THAT(stats.ramQueueBytes, Eq(200u));
+    EXPECT_THAT(stats.uploadBodyBytes, Eq(200u));
+    EXPECT_THAT(stats.incomingEventBytes, Eq(0u));
+    EXPECT_THAT(budget.GetAvailable(), Eq(600u));
+}
+
+TEST(MemoryBudgetTests, UnderPressureFromWatermark)
+{
+    MemoryBudget budget;
+    budget.SetLimit(1000);
+    budget.Reserve(MemoryCategory_Packaging, 749);
+    EXPECT_FALSE(budget.IsUnderPressure());
+    budget.Reserve(MemoryCategory_Packaging, 1);
+    EXPECT_TRUE(budget.IsUnderPressure());
+    budget.Reserve(MemoryCategory_Packaging, 500);
+    EXPECT_THAT(budget.GetAvailable(), Eq(0u));
+}
+
+TEST(MemoryBudgetTests, ReservationReleasesWhatItHolds)
+{
+    MemoryBudget budget;
+    budget.SetLimit(1000);
+    {
+        MemoryReservation reservation(MemoryCategory_Responses, budget);
+        reservation.Resize(300);
+        reservation.Add(50);
+        reservation.Resize(100);
+        EXPECT_THAT(reservation.GetBytes(), Eq(100u));
+        reservation.Remove(500);
+        EXPECT_THAT(reservation.GetBytes(), Eq(0u));
+        EXPECT_THAT(budget.GetUsage(), Eq(0u));
+        reservation.Add(70);
+        EXPECT_THAT(budget.GetUsage(), Eq(70u));
+    }
+    EXPECT_THAT(budget.GetUsage(), Eq(0u));
+}
+
+TEST(MemoryBudgetTests, ReservationSurvivesLimitChanges)
+{
+    MemoryBudget budget;
+    MemoryReservation reservation(MemoryCategory_RamQueue, budget);
+    reservation.Add(100);
+    budget.SetLimit(1000);
+    reservation.Add(100);
+    budget.SetLimit(0);
+    reservation.Reset();
+    EXPECT_THAT(budget.GetUsage(), Eq(0u));
+}
@@ -17,6 +17,8 @@
 #include "pal/PAL.hpp"
 
 #include <set>
+#include <chrono>
+#include <iostream>
 #include <memory>
 #include <thread>
 #include <atomic>
@@ -378,3 +380,141 @@ TEST_F(MemoryStorageTests, MultiThreadPerfTest)
 
 }
 
+
+class ShardedMemoryStorageTests : public MemoryStorageTests
+{
+public:
+    void setShards(unsigned shards)
+    {
+        (*testConfig)[CFG_INT_RAM_QUEUE_SHARDS] = shards;
+    }
+
+    virtual void TearDown() override
+    {
+        setShards(1);
+    }
+
+    static StorageRecord makeRecord(EventLatency latency, int64_t timestamp)
+    {
+        return StorageRecord{ PAL::generateUuidString(), "token", latency, EventPersistence_Normal, timestamp, { 1, 2, 3 } };
+    }
+};
+
+TEST_F(ShardedMemoryStorageTests, ShardCountFromConfig)
+{
+    EXPECT_THAT(MemoryStorage(testLogManager, *testConfig).GetShardCount(), 1u);
+    setShards(8);
+    EXPECT_THAT(MemoryStorage(testLogManager, *testConfig).GetShardCount(), 8u);
+    setShards(0);
+    EXPECT_THAT(MemoryStorage(testLogManager, *testConfig).GetShardCount(), Ge(1u));
+}
+
+TEST_F(ShardedMemoryStorageTests, RetrievalMergesShardsByLatencyAndAge)
+{
+    setShards(4);
+    MemoryStorage storage(testLogManager, *testConfig);
+
+    // Each thread lands on its own shard (or shares one), timestamps interleave across them
+    const int threads = 6;
+    const int perThread = 200;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+    {
+        workers.push_back(std::thread([&storage, t]()
+        {
+            for (int i = 0; i < perThread; i++)
+            {
+                EventLatency latency = (i % 2) ? EventLatency_RealTime : EventLatency_Normal;
+                storage.StoreRecord(makeRecord(latency, static_cast<int64_t>(i) * threads + t));
+            }
+        }));
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    size_t total = threads * perThread;
+    EXPECT_THAT(storage.GetRecordCount(), total);
+    EXPECT_THAT(storage.GetRecordCount(EventLatency_RealTime), total / 2);
+
+    auto records = storage.GetRecords(false, EventLatency_Normal, 0);
+    ASSERT_THAT(records.size(), total);
+    EXPECT_THAT(storage.GetSize(), 0u);
+    // Highest latency first, then newest first for every producer, as with a single queue
+    std::map<int64_t, int64_t> lastSeen;
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (i > 0 && records[i].latency != records[i - 1].latency)
+        {
+            EXPECT_THAT(records[i].latency, Lt(records[i - 1].latency)) << i;
+            lastSeen.clear();
+        }
+        int64_t producer = records[i].timestamp % threads;
+        if (lastSeen.count(producer))
+        {
+            EXPECT_THAT(records[i].timestamp, Lt(lastSeen[producer])) << i;
+        }
+        lastSeen[producer] = records[i].timestamp;
+    }
+}
+
+TEST_F(ShardedMemoryStorageTests, ReleaseAndDeleteAcrossShards)
+{
+    setShards(4);
+    MemoryStorage storage(testLogManager, *testConfig);
+    auto total_db_size = addEvents(storage);
+    auto total_records = storage.GetRecordCount();
+
+    std::vector<StorageRecordId> ids;
+    storage.GetAndReserveRecords([&ids](StorageRecord&& record) {
+        ids.push_back(record.id);
+        return ids.size() < 100;
+    }, 1000);
+    EXPECT_THAT(storage.GetReservedCount(), 99u);
+
+    HttpHeaders headers;
+    bool fromMemory = true;
+    storage.ReleaseRecords(ids, false, headers, fromMemory);
+    EXPECT_THAT(storage.GetSize(), total_db_size);
+    EXPECT_THAT(storage.GetRecordCount(), total_records);
+
+    storage.DeleteRecords({ { "latency", std::to_string(EventLatency_Max) } });
+    EXPECT_THAT(storage.GetRecordCount(EventLatency_Max), 0u);
+    EXPECT_THAT(storage.GetRecordCount(), total_records - num_iterations);
+
+    storage.DeleteAllRecords();
+    EXPECT_THAT(storage.GetRecordCount(), 0u);
+    EXPECT_THAT(storage.GetSize(), 0u);
+}
+
+TEST_F(ShardedMemoryStorageTests, ConcurrentStoreThroughput)
+{
+    const size_t threads = 16;
+    const size_t perThread = 5000;
+    for (unsigned shards : { 1u, 16u })
+    {
+        setShards(shards);
+        MemoryStorage storage(testLogManager, *testConfig);
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < threads; t++)
+        {
+            workers.push_back(std::thread([&storage]()
+            {
+                for (size_t i = 0; i < perThread; i++)
+                {
+                    storage.StoreRecord(makeRecord(EventLatency_Normal, static_cast<int64_t>(i)));
+                }
+            }));
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "MemoryStorage " << threads << " threads, " << shards << " shard(s): "
+                  << elapsedUs * 1000 / static_cast<long long>(threads * perThread) << " ns/record" << std::endl;
+        EXPECT_THAT(storage.GetRecordCount(), threads * perThread);
+    }
+}
@@ -0,0 +1,184 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "AggregatedMetric.hpp"
+#include "NullObjects.hpp"
+#include "system/MetricAggregator.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    class AggregatedMetricLogger : public NullLogger
+    {
+    public:
+        std::vector<AggregatedMetricData> logged;
+        std::atomic<size_t> calls { 0 };
+
+        virtual void LogAggregatedMetric(AggregatedMetricData const& metricData, EventProperties const& properties) override
+        {
+            EXPECT_THAT(properties.GetName(), Eq("metricevent"));
+            logged.push_back(metricData);
+            calls++;
+        }
+    };
+
+} // namespace
+
+TEST(MetricAggregatorTests, SketchIsWithinRelativeAccuracy)
+{
+    QuantileSketch sketch;
+    for (int i = 1; i <= 10000; i++)
+    {
+        sketch.add(i);
+    }
+    EXPECT_THAT(sketch.count(), Eq(10000u));
+
+    for (double q : { 0.5, 0.9, 0.95, 0.99 })
+    {
+        double expected = q * 10000;
+        EXPECT_THAT(std::fabs(sketch.quantile(q) - expected), Le(expected * 0.01 + 1)) << q;
+    }
+    EXPECT_THAT(sketch.bucketCount(), Lt(1000u));
+}
+
+TEST(MetricAggregatorTests, SketchHandlesSignsAndMerge)
+{
+    QuantileSketch negative, zeros;
+    for (int i = 1; i <= 100; i++)
+    {
+        negative.add(-i);
+        zeros.add(0);
+    }
+
+    QuantileSketch merged;
+    merged.merge(negative);
+    merged.merge(zeros);
+    EXPECT_THAT(merged.count(), Eq(200u));
+    EXPECT_THAT(merged.quantile(0), DoubleNear(-100, 1));
+    EXPECT_THAT(merged.quantile(0.25), DoubleNear(-50, 1));
+    EXPECT_THAT(merged.quantile(0.75), Eq(0));
+
+    merged.clear();
+    EXPECT_THAT(merged.count(), Eq(0u));
+    EXPECT_THAT(merged.bucketCount(), Eq(0u));
+}
+
+TEST(MetricAggregatorTests, CollectsValuesOfAllThreads)
+{
+    MetricAggregator aggregator;
+    AggregatedMetricData metricData("metric", 0, 0);
+    EXPECT_FALSE(aggregator.collect(metricData));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&aggregator]() {
+            for (int i = 1; i <= 1000; i++)
+            {
+                aggregator.push(i);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    ASSERT_TRUE(aggregator.collect(metricData));
+    EXPECT_THAT(metricData.count, Eq(4000));
+    EXPECT_THAT(metricData.aggregates[AggregateType_Sum], DoubleEq(4 * 500500.0));
+    EXPECT_THAT(metricData.aggregates[AggregateType_Minimum], Eq(1));
+    EXPECT_THAT(metricData.aggregates[AggregateType_Maximum], Eq(1000));
+    ASSERT_THAT(metricData.percentiles.size(), Eq(4u));
+    EXPECT_THAT(metricData.percentiles[50], DoubleNear(500, 10));
+    EXPECT_THAT(metricData.percentiles[99], DoubleNear(990, 20));
+
+    // Collecting resets
+    AggregatedMetricData next("metric", 0, 0);
+    EXPECT_FALSE(aggregator.collect(next));
+    aggregator.push(-3);
+    ASSERT_TRUE(aggregator.collect(next));
+    EXPECT_THAT(next.count, Eq(1));
+    EXPECT_THAT(next.aggregates[AggregateType_Minimum], Eq(-3));
+    EXPECT_THAT(next.percentiles[50], Eq(-3));
+}
+
+TEST(MetricAggregatorTests, AggregatedMetricLogsOnDestruction)
+{
+    AggregatedMetricLogger logger;
+    {
+        Models::AggregatedMetric metric("latency", "ms", 0, "instance", "class", "id", EventProperties("metricevent"), &logger);
+        metric.PushMetric(10);
+        metric.PushMetric(30);
+        EXPECT_THAT(logger.logged.size(), Eq(0u));
+    }
+    ASSERT_THAT(logger.logged.size(), Eq(1u));
+    AggregatedMetricData& metricData = logger.logged[0];
+    EXPECT_THAT(metricData.name, Eq("latency"));
+    EXPECT_THAT(metricData.units, Eq("ms"));
+    EXPECT_THAT(metricData.objectId, Eq("id"));
+    EXPECT_THAT(metricData.count, Eq(2));
+    EXPECT_THAT(metricData.aggregates[AggregateType_Sum], Eq(40));
+
+    // Nothing pushed, nothing logged; no logger, values dropped
+    {
+        Models::AggregatedMetric metric("latency", "ms", 0, EventProperties("metricevent"), &logger);
+    }
+    {
+        Models::AggregatedMetric metric("latency", "ms", 1, EventProperties("metricevent"), nullptr);
+        metric.PushMetric(1);
+    }
+    EXPECT_THAT(logger.logged.size(), Eq(1u));
+}
+
+TEST(MetricAggregatorTests, AggregatedMetricDropsNonFiniteValues)
+{
+    AggregatedMetricLogger logger;
+    {
+        Models::AggregatedMetric metric("latency", "ms", 0, EventProperties("metricevent"), &logger);
+        metric.PushMetric(std::numeric_limits<double>::infinity());
+        metric.PushMetric(-std::numeric_limits<double>::infinity());
+        metric.PushMetric(std::numeric_limits<double>::quiet_NaN());
+        for (int i = 1; i <= 100; i++)
+        {
+            metric.PushMetric(i);
+        }
+    }
+    ASSERT_THAT(logger.logged.size(), Eq(1u));
+    AggregatedMetricData& metricData = logger.logged[0];
+    EXPECT_THAT(metricData.count, Eq(100));
+    EXPECT_THAT(metricData.aggregates[AggregateType_Sum], Eq(5050));
+    EXPECT_THAT(metricData.aggregates[AggregateType_Minimum], Eq(1));
+    EXPECT_THAT(metricData.aggregates[AggregateType_Maximum], Eq(100));
+    ASSERT_THAT(metricData.percentiles.size(), Eq(4u));
+    for (auto const& kv : metricData.percentiles)
+    {
+        EXPECT_TRUE(std::isfinite(kv.second)) << kv.first;
+        EXPECT_THAT(kv.second, DoubleNear(kv.first, 2)) << kv.first;
+    }
+}
+
+TEST(MetricAggregatorTests, AggregatedMetricLogsEveryInterval)
+{
+    AggregatedMetricLogger logger;
+    Models::AggregatedMetric metric("latency", "ms", 1, EventProperties("metricevent"), &logger);
+    metric.PushMetric(5);
+    for (int i = 0; (i < 300) && (logger.calls == 0); i++)
+    {
+        PAL::sleep(10);
+    }
+    ASSERT_THAT(logger.logged.size(), Eq(1u));
+    EXPECT_THAT(logger.logged[0].count, Eq(1));
+    EXPECT_THAT(logger.logged[0].duration, Ge(900000));
+}
@@ -0,0 +1,207 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "utils/ObjectPool.hpp"
+#include "system/Contexts.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    struct PooledItem
+    {
+        std::vector<int> data;
+        int clears = 0;
+
+        void clear()
+        {
+            data.clear();
+            clears++;
+        }
+    };
+
+    std::vector<uint8_t> makeRecordBlob()
+    {
+        ::CsProtocol::Record record;
+        record.name = "PoolTest";
+        std::vector<uint8_t> blob;
+        bond_lite::CompactBinaryProtocolWriter writer(blob);
+        bond_lite::Serialize(writer, record);
+        return blob;
+    }
+
+} // namespace
+
+TEST(ObjectPoolTests, ReleasedObjectIsRecycled)
+{
+    ObjectPool<PooledItem> pool(4);
+    PooledItem* first;
+    {
+        auto item = pool.acquire();
+        first = item.get();
+        item->data.resize(1000);
+    }
+
+    auto item = pool.acquire();
+    EXPECT_THAT(item.get(), Eq(first));
+    EXPECT_THAT(item->clears, Eq(1));
+    EXPECT_THAT(item->data.size(), Eq(0u));
+    EXPECT_THAT(item->data.capacity(), Ge(1000u));
+
+    auto stats = pool.getStats();
+    EXPECT_THAT(stats.hits, Eq(1u));
+    EXPECT_THAT(stats.misses, Eq(1u));
+    EXPECT_THAT(stats.size, Eq(1u));
+}
+
+TEST(ObjectPoolTests, ObjectsInUseAreNotShared)
+{
+    ObjectPool<PooledItem> pool(2);
+    auto a = pool.acquire();
+    auto b = pool.acquire();
+    EXPECT_THAT(a.get(), Ne(b.get()));
+
+    // Past the capacity objects are still handed out, but not pooled
+    auto c = pool.acquire();
+    EXPECT_THAT(c.get(), Ne(a.get()));
+    EXPECT_THAT(c.get(), Ne(b.get()));
+    EXPECT_THAT(pool.getStats().size, Eq(2u));
+    EXPECT_THAT(pool.getStats().misses, Eq(3u));
+
+    // A copy held elsewhere keeps the object busy
+    std::shared_ptr<PooledItem> copy = b;
+    b.reset();
+    a.reset();
+    auto d = pool.acquire();
+    EXPECT_THAT(d.get(), Ne(copy.get()));
+    EXPECT_THAT(pool.getStats().hits, Eq(1u));
+}
+
+TEST(ObjectPoolTests, PooledObjectOutlivesPool)
+{
+    std::shared_ptr<PooledItem> item;
+    {
+        ObjectPool<PooledItem> pool(1);
+        item = pool.acquire();
+    }
+    item->data.push_back(1);
+    EXPECT_THAT(item.use_count(), Eq(1));
+}
+
+TEST(ObjectPoolTests, UploadContextClearKeepsCapacity)
+{
+    ObjectPool<EventsUploadContext> pool(1);
+    auto blob = makeRecordBlob();
+    {
+        auto ctx = pool.acquire();
+        ctx->requestedMinLatency = EventLatency_RealTime;
+        ctx->latency = EventLatency_RealTime;
+        ctx->packageIds[0] = ctx->splicer->addTenantToken("tenant");
+        for (int i = 0; i < 100; i++)
+        {
+            ctx->splicer->addRecord(0, blob);
+            ctx->recordIdsAndTenantIds["id" + std::to_string(i)] = 0;
+            ctx->recordTimestamps.push_back(i);
+        }
+        ctx->splicer->splice(ctx->body);
+        ctx->compressed = true;
+        ctx->durationMs = 100;
+        ctx->httpRequestId = "request";
+    }
+
+    auto ctx = pool.acquire();
+    EXPECT_THAT(pool.getStats().hits, Eq(1u));
+    EXPECT_THAT(ctx->requestedMinLatency, Eq(EventLatency_Unspecified));
+    EXPECT_THAT(ctx->latency, Eq(EventLatency_Unspecified));
+    EXPECT_THAT(ctx->packageIds.empty(), true);
+    EXPECT_THAT(ctx->recordIdsAndTenantIds.empty(), true);
+    EXPECT_THAT(ctx->recordTimestamps.empty(), true);
+    EXPECT_THAT(ctx->recordTimestamps.capacity(), Ge(100u));
+    EXPECT_THAT(ctx->body.empty(), true);
+    EXPECT_THAT(ctx->body.capacity(), Ge(100 * blob.size()));
+    EXPECT_THAT(ctx->splicer->getSizeEstimate(), Eq(8u));
+    EXPECT_THAT(ctx->compressed, false);
+    EXPECT_THAT(ctx->durationMs, Eq(-1));
+    EXPECT_THAT(ctx->httpRequestId.empty(), true);
+}
+
+TEST(ObjectPoolTests, SpliceIntoExistingBuffer)
+{
+    BondSplicer splicer;
+    auto blob = makeRecordBlob();
+    splicer.addRecord(splicer.addTenantToken("tenant"), blob);
+    splicer.addRecord(0, blob);
+
+    std::vector<uint8_t> output = { 1, 2, 3 };
+    splicer.splice(output);
+    EXPECT_THAT(output, Eq(splicer.splice()));
+}
+
+TEST(ObjectPoolTests, IncomingEventContextReset)
+{
+    ::CsProtocol::Record source;
+    IncomingEventContext ctx;
+    ctx.reset("id", "token", EventLatency_RealTime, EventPersistence_Critical, &source);
+    ctx.record.blob.resize(500);
+    ctx.policyBitFlags = 7;
+    EXPECT_THAT(ctx.source, Eq(&source));
+    EXPECT_THAT(ctx.record.tenantToken, Eq("token"));
+    EXPECT_THAT(ctx.createdUs, Gt(0));
+
+    ctx.clear();
+    EXPECT_THAT(ctx.source, IsNull());
+    EXPECT_THAT(ctx.record.id.empty(), true);
+    EXPECT_THAT(ctx.record.latency, Eq(EventLatency_Unspecified));
+    EXPECT_THAT(ctx.record.persistence, Eq(EventPersistence_Normal));
+    EXPECT_THAT(ctx.record.blob.empty(), true);
+    EXPECT_THAT(ctx.record.blob.capacity(), Ge(500u));
+    EXPECT_THAT(ctx.policyBitFlags, Eq(0u));
+}
+
+TEST(ObjectPoolTests, ConcurrentAcquireHitRate)
+{
+    ObjectPool<PooledItem> pool(16);
+    const int threads = 8;
+    const int rounds = 20000;
+    std::vector<std::thread> workers;
+    std::atomic<int> conflicts(0);
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++)
+    {
+        workers.push_back(std::thread([&pool, &conflicts, t]()
+        {
+            for (int i = 0; i < rounds; i++)
+            {
+                auto item = pool.acquire();
+                if (!item->data.empty())
+                {
+                    conflicts++;
+                }
+                item->data.push_back(t);
+            }
+        }));
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    auto stats = pool.getStats();
+    std::cout << "ObjectPool " << threads << " threads: " << elapsedNs / (threads * rounds)
+              << " ns/acquire, " << stats.hits << " hits, " << stats.misses << " misses" << std::endl;
+    EXPECT_THAT(conflicts.load(), Eq(0));
+    EXPECT_THAT(stats.hits + stats.misses, Eq(static_cast<uint64_t>(threads * rounds)));
+    EXPECT_THAT(stats.size, Le(16u));
+    EXPECT_THAT(stats.hits, Gt(stats.misses));
+}
@@ -0,0 +1,239 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+#ifdef HAVE_MAT_STORAGE
+
+#include "common/Common.hpp"
+#include "common/MockIOfflineStorage.hpp"
+#include "common/MockIOfflineStorageObserver.hpp"
+#include "common/MockIRuntimeConfig.hpp"
+#include "offline/OfflineStorageHandler.hpp"
+#include "NullObjects.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <mutex>
+#include <vector>
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    class QueuedTaskDispatcher : public ITaskDispatcher
+    {
+    public:
+        std::mutex lock;
+        std::vector<Task*> tasks;
+
+        void RunAll()
+        {
+            std::vector<Task*> pending;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                pending.swap(tasks);
+            }
+            for (Task* task : pending)
+            {
+                (*task)();
+                delete task;
+            }
+        }
+
+        virtual void Join() override {}
+
+        virtual void Queue(Task* task) override
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            tasks.push_back(task);
+        }
+
+        virtual bool Cancel(Task* task, uint64_t waitTime = 0) override
+        {
+            UNREFERENCED_PARAMETER(waitTime);
+            std::lock_guard<std::mutex> guard(lock);
+            auto it = std::find(tasks.begin(), tasks.end(), task);
+            if (it != tasks.end())
+            {
+                delete *it;
+                tasks.erase(it);
+            }
+            return true;
+        }
+    };
+
+    class BackpressureLogManager : public NullLogManager
+    {
+    public:
+        std::vector<DebugEvent> crossings;
+
+        virtual bool DispatchEvent(DebugEvent evt) override
+        {
+            if (evt.type == DebugEventType::EVT_STORAGE_BACKPRESSURE)
+            {
+                crossings.push_back(evt);
+            }
+            return true;
+        }
+    };
+
+    class OfflineStorageHandler4Test : public OfflineStorageHandler
+    {
+    public:
+        using OfflineStorageHandler::OfflineStorageHandler;
+
+        std::shared_ptr<IOfflineStorage> disk;
+
+        size_t GetMemoryRecordCount() const
+        {
+            return m_offlineStorageMemory->GetRecordCount();
+        }
+
+        virtual std::shared_ptr<IOfflineStorage> CreateDiskStorage() override
+        {
+            return (disk != nullptr) ? disk : OfflineStorageHandler::CreateDiskStorage();
+        }
+    };
+
+    class OfflineStorageHandlerTests : public Test
+    {
+    protected:
+        BackpressureLogManager logManager;
+        QueuedTaskDispatcher taskDispatcher;
+        NiceMock<MockIOfflineStorageObserver> observerMock;
+        NiceMock<MockIRuntimeConfig> configMock;
+        std::string fileName;
+
+        virtual void SetUp() override
+        {
+            ON_CALL(configMock, GetOfflineStorageMaximumSizeBytes()).WillByDefault(Return(1024 * 1024));
+            ON_CALL(configMock, GetMaximumRetryCount()).WillByDefault(Return(5));
+            fileName = GetTempDirectory() + "OfflineStorageHandlerTests.db";
+            configMock[CFG_STR_CACHE_FILE_PATH] = fileName;
+            configMock[CFG_INT_RAM_QUEUE_SIZE] = 100;
+            std::remove(fileName.c_str());
+        }
+
+        virtual void TearDown() override
+        {
+            std::remove(fileName.c_str());
+        }
+
+        static StorageRecord MakeRecord(int i)
+        {
+            return StorageRecord("r" + std::to_string(i), "tenant", EventLatency_Normal, EventPersistence_Normal,
+                PAL::getUtcSystemTimeMs(), std::vector<uint8_t>(16, static_cast<uint8_t>(i)));
+        }
+    };
+
+} // namespace
+
+TEST_F(OfflineStorageHandlerTests, AsyncOpenBuffersInRamAndFlushesOnceOpen)
+{
+    configMock[CFG_BOOL_ASYNC_STORAGE_OPEN] = true;
+    OfflineStorageHandler4Test storage(logManager, configMock, taskDispatcher);
+    storage.Initialize(observerMock);
+
+    // Accepted whether or not the disk storage is open yet
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_TRUE(storage.StoreRecord(MakeRecord(i)));
+    }
+
+    // Settings access waits for the open
+    EXPECT_TRUE(storage.StoreSetting("key", "value"));
+    EXPECT_THAT(storage.GetSetting("key"), Eq("value"));
+
+    // Over the RAM queue limit: either the open or a later store has requested a flush
+    taskDispatcher.RunAll();
+    EXPECT_THAT(storage.GetMemoryRecordCount(), Eq(0u));
+    EXPECT_THAT(storage.GetRecordCount(), Eq(10u));
+
+    storage.Shutdown();
+}
+
+TEST_F(OfflineStorageHandlerTests, AsyncOpenShutdownPersistsBufferedRecords)
+{
+    // Stays below the RAM queue limit, so nothing is flushed before the shutdown
+    configMock[CFG_INT_RAM_QUEUE_SIZE] = 1024 * 1024;
+    configMock[CFG_BOOL_ASYNC_STORAGE_OPEN] = true;
+    {
+        OfflineStorageHandler4Test storage(logManager, configMock, taskDispatcher);
+        storage.Initialize(observerMock);
+        EXPECT_TRUE(storage.StoreRecord(MakeRecord(0)));
+        storage.Shutdown();
+        taskDispatcher.RunAll();
+    }
+
+    configMock[CFG_BOOL_ASYNC_STORAGE_OPEN] = false;
+    OfflineStorageHandler4Test storage(logManager, configMock, taskDispatcher);
+    storage.Initialize(observerMock);
+    EXPECT_THAT(storage.GetRecordCount(), Eq(1u));
+    storage.Shutdown();
+}
+
+TEST_F(OfflineStorageHandlerTests, AsyncOpenDefersScrubsInsteadOfWaiting)
+{
+    configMock[CFG_BOOL_ASYNC_STORAGE_OPEN] = true;
+    auto disk = std::make_shared<NiceMock<MockIOfflineStorage>>();
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    ON_CALL(*disk, Initialize(_)).WillByDefault(Invoke([released](IOfflineStorageObserver&) { released.wait(); }));
+
+    OfflineStorageHandler4Test storage(logManager, configMock, taskDispatcher);
+    storage.disk = disk;
+    storage.Initialize(observerMock);
+    EXPECT_FALSE(storage.IsOpen());
+
+    // The kill switch scrubs on the worker thread, which must not wait for the open
+    std::map<std::string, std::string> const filter { { "tenant_token", "killed" } };
+    EXPECT_CALL(*disk, DeleteRecords(filter)).Times(0);
+    auto scrub = std::async(std::launch::async, [&storage, &filter]() { storage.DeleteRecords(filter); });
+    auto status = scrub.wait_for(std::chrono::seconds(5));
+    Mock::VerifyAndClearExpectations(disk.get());
+
+    EXPECT_CALL(*disk, DeleteRecords(filter)).Times(1);
+    release.set_value();
+    scrub.wait();
+    storage.Shutdown();
+    EXPECT_THAT(status, Eq(std::future_status::ready));
+    EXPECT_TRUE(storage.IsOpen());
+}
+
+TEST_F(OfflineStorageHandlerTests, BackpressureFollowsRamQueueWatermarks)
+{
+    configMock[CFG_INT_RAM_QUEUE_SIZE] = 1000;
+    configMock[CFG_INT_BACKPRESSURE_HIGH_PCT] = 300;
+    configMock[CFG_INT_BACKPRESSURE_LOW_PCT] = 100;
+    OfflineStorageHandler4Test storage(logManager, configMock, taskDispatcher);
+    storage.Initialize(observerMock);
+
+    // No flush runs until the task dispatcher does, as if the disk lagged behind
+    int i = 0;
+    while ((i < 100) && logManager.crossings.empty())
+    {
+        EXPECT_TRUE(storage.StoreRecord(MakeRecord(i++)));
+    }
+    ASSERT_THAT(logManager.crossings.size(), Eq(1u));
+    EXPECT_THAT(logManager.crossings[0].param1, Eq(1u));
+    EXPECT_THAT(logManager.crossings[0].param2, Ge(300u));
+
+    // Still saturated between the watermarks
+    EXPECT_TRUE(storage.StoreRecord(MakeRecord(i++)));
+    EXPECT_THAT(logManager.crossings.size(), Eq(1u));
+
+    storage.Flush();
+    ASSERT_THAT(logManager.crossings.size(), Eq(2u));
+    EXPECT_THAT(logManager.crossings[1].param1, Eq(0u));
+    EXPECT_THAT(logManager.crossings[1].param2, Eq(0u));
+    EXPECT_THAT(storage.GetRecordCount(), Eq(static_cast<size_t>(i)));
+
+    taskDispatcher.RunAll();
+    storage.Shutdown();
+}
+
+#endif // HAVE_MAT_STORAGE
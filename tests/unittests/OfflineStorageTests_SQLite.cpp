@@ -153,6 +153,54 @@ TEST_F(OfflineStorageTests_SQLite, GetAndReservedReturnsStoredRecord)
     EXPECT_THAT(consumer.records[0].reservedUntil, 0);
 }
 
+TEST_F(OfflineStorageTests_SQLite, TenantTokensAreResolvedAndFiltered)
+{
+    initializeStorage();
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid1", "token1", EventLatency_Normal, EventPersistence_Normal, 1, { 1 } }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid2", "token2", EventLatency_Normal, EventPersistence_Normal, 2, { 2 } }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid3", "token1", EventLatency_Normal, EventPersistence_Normal, 3, { 3 } }), true);
+
+    offlineStorage->DeleteRecords({ { "tenant_token", "token2" } });
+
+    TestRecordConsumer consumer;
+    EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000), true);
+    ASSERT_THAT(consumer.records, SizeIs(2));
+    EXPECT_THAT(consumer.records[0].id, Eq("guid1"));
+    EXPECT_THAT(consumer.records[0].tenantToken, Eq("token1"));
+    EXPECT_THAT(consumer.records[1].id, Eq("guid3"));
+    EXPECT_THAT(consumer.records[1].tenantToken, Eq("token1"));
+}
+
+TEST_F(OfflineStorageTests_SQLite, Version1DatabaseIsUpgraded)
+{
+    // Replace the fresh tables with the version 1 layout, which kept the token on each event
+    initializeStorage();
+    offlineStorage->Execute("DROP TABLE events");
+    offlineStorage->Execute("DROP TABLE tenants");
+    offlineStorage->Execute("CREATE TABLE events (record_id TEXT, tenant_token TEXT NOT NULL, latency INTEGER, persistence INTEGER,"
+                            " timestamp INTEGER, retry_count INTEGER DEFAULT 0, reserved_until INTEGER DEFAULT 0, payload BLOB)");
+    offlineStorage->Execute("INSERT INTO events (record_id,tenant_token,latency,persistence,timestamp,retry_count,payload)"
+                            " VALUES ('guid1','token1',1,1,1,2,x'0102'), ('guid2','token2',1,1,2,0,x'03')");
+    offlineStorage->Execute("PRAGMA user_version=1");
+    offlineStorage->Shutdown();
+    EXPECT_CALL(observerMock, OnStorageOpened("SQLite/Default"));
+    offlineStorage->Initialize(observerMock);
+
+    TestRecordConsumer consumer;
+    EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000), true);
+    ASSERT_THAT(consumer.records, SizeIs(2));
+    EXPECT_THAT(consumer.records[0].id, Eq("guid1"));
+    EXPECT_THAT(consumer.records[0].tenantToken, Eq("token1"));
+    EXPECT_THAT(consumer.records[0].retryCount, Eq(2));
+    EXPECT_THAT(consumer.records[0].blob, Eq(std::vector<uint8_t>{ 1, 2 }));
+    EXPECT_THAT(consumer.records[1].tenantToken, Eq("token2"));
+
+    // New records share the tenant rows of the upgraded ones
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid3", "token2", EventLatency_Normal, EventPersistence_Normal, 3, { 4 } }), true);
+    offlineStorage->DeleteRecords({ { "tenant_token", "token2" } });
+    EXPECT_THAT(offlineStorage->GetRecordCount(EventLatency_Unspecified), Eq(1u));
+}
+
 TEST_F(OfflineStorageTests_SQLite, ReservedRecordIsNotReturned)
 {
     initializeStorage();
@@ -448,6 +496,26 @@ TEST_F(OfflineStorageTests_SQLite, StoreThousandEventsTakesLessThanASecond)
 
 #endif  // NDEBUG
 
+TEST_F(OfflineStorageTests_SQLite, StoreRecordsSavesBatchAndSkipsBadRecords)
+{
+    initializeStorage();
+    std::vector<StorageRecord> records;
+    for (int i = 0; i < 100; ++i) {
+        records.push_back({std::to_string(i), "token", EventLatency_Normal, EventPersistence_Normal, 1 + i, {1, 2, 3}});
+    }
+    records.push_back({"", "token", EventLatency_Normal, EventPersistence_Normal, 1, {}});
+
+    EXPECT_CALL(observerMock, OnStorageFailed("Invalid parameters"));
+    EXPECT_THAT(offlineStorage->StoreRecords(records), 100u);
+    EXPECT_THAT(offlineStorage->GetRecordCount(EventLatency_Unspecified), 100u);
+
+    // The batch transaction is committed: a plain insert still works afterwards
+    EXPECT_THAT(offlineStorage->StoreRecord({"100", "token", EventLatency_Normal, EventPersistence_Normal, 200, {}}), true);
+    TestRecordConsumer consumer;
+    EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 10000, EventLatency_Normal), true);
+    EXPECT_THAT(consumer.records.size(), 101u);
+}
+
 TEST_F(OfflineStorageTests_SQLite, OnInvalidFilename)
 {
     initializeStorage();
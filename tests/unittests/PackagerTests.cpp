@@ -15,6 +15,7 @@ using namespace MAT;
 class PackagerTests : public StrictMock<Test> {
   protected:
     StrictMock<MockIRuntimeConfig> runtimeConfigMock;
+    TenantTable                    tenants;
     Packager                       packager;
 
     RouteSink<PackagerTests, EventsUploadContextPtr const&> emptyPackage{this, &PackagerTests::resultEmptyPackage};
@@ -22,7 +23,7 @@ class PackagerTests : public StrictMock<Test> {
 
   protected:
     PackagerTests()
-      : packager(runtimeConfigMock)
+      : packager(runtimeConfigMock, tenants)
     {
         packager.emptyPackage   >> emptyPackage;
         packager.packagedEvents >> packagedEvents;
@@ -65,7 +66,7 @@ TEST_F(PackagerTests, PackagesEventsByTenant)
     }
     EXPECT_THAT(recordIds, Contains("r1"));
     EXPECT_THAT(ctx->packageIds, SizeIs(1));
-    EXPECT_THAT(ctx->packageIds, Contains(Key("tenant1-token")));
+    EXPECT_THAT(ctx->packageIds, Contains(Key(tenants.intern("tenant1-token"))));
 
 
     ctx = std::make_shared<EventsUploadContext>();
@@ -92,9 +93,11 @@ TEST_F(PackagerTests, PackagesEventsByTenant)
     }
     EXPECT_THAT(recordIds, Contains("r1"));
     EXPECT_THAT(recordIds, Contains("r2"));
+    EXPECT_THAT(tenants.resolve(ctx->recordIdsAndTenantIds["r1"]), Eq("tenant1-token"));
+    EXPECT_THAT(tenants.resolve(ctx->recordIdsAndTenantIds["r2"]), Eq("tenant2-token"));
     EXPECT_THAT(ctx->packageIds, SizeIs(2));
-    EXPECT_THAT(ctx->packageIds, Contains(Key("tenant1-token")));
-    EXPECT_THAT(ctx->packageIds, Contains(Key("tenant2-token")));
+    EXPECT_THAT(ctx->packageIds, Contains(Key(tenants.intern("tenant1-token"))));
+    EXPECT_THAT(ctx->packageIds, Contains(Key(tenants.intern("tenant2-token"))));
 }
 
 TEST_F(PackagerTests, UsesPriorityOfTheFirstEvent)
@@ -130,6 +133,7 @@ TEST_F(PackagerTests, HonorsMaximumPackageSize)
     }
     EXPECT_THAT(i, 4);
     EXPECT_THAT(wantMore, false);
+    EXPECT_THAT(ctx->packageFull, true);
 
     EXPECT_CALL(*this, resultPackagedEvents(ctx))
         .WillOnce(Return());
@@ -139,6 +143,46 @@ TEST_F(PackagerTests, HonorsMaximumPackageSize)
     EXPECT_THAT(ctx->body, SizeIs(Lt(MaxSize)));
 }
 
+TEST_F(PackagerTests, ShrinksPackagesWhenMemoryBudgetIsUnderPressure)
+{
+    unsigned const MaxSize  = 1000000;
+    unsigned const PartSize = 40000;
+
+    MemoryBudget& budget = MemoryBudget::GetInstance();
+    budget.SetLimit(200000);
+    MemoryReservation held(MemoryCategory_RamQueue);
+    held.Add(180000);
+
+    auto ctx = std::make_shared<EventsUploadContext>();
+    EXPECT_CALL(runtimeConfigMock, GetMaximumUploadSizeBytes())
+        .WillOnce(Return(MaxSize))
+        .RetiresOnSaturation();
+
+    bool wantMore = true;
+    int i = 0;
+    while (i < 4 && wantMore) {
+        StorageRecord record("r" + toString(i), "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890 + i, std::vector<uint8_t>(PartSize, 0));
+        packager.addEventToPackage(ctx, record, wantMore);
+        i++;
+    }
+    // Limited to Packager::MinUploadSizeUnderPressure
+    EXPECT_THAT(i, 2);
+    EXPECT_THAT(ctx->packageFull, true);
+    EXPECT_THAT(ctx->maxUploadSize, Eq(Packager::MinUploadSizeUnderPressure));
+    EXPECT_THAT(ctx->packagingMemory.GetBytes(), Gt(PartSize));
+
+    EXPECT_CALL(*this, resultPackagedEvents(ctx))
+        .WillOnce(Return());
+    packager.finalizePackage(ctx);
+
+    EXPECT_THAT(ctx->packagingMemory.GetBytes(), Eq(0u));
+    EXPECT_THAT(ctx->bodyMemory.GetBytes(), Eq(ctx->body.size()));
+    ctx->releaseMemory();
+    held.Reset();
+    EXPECT_THAT(budget.GetUsage(), Eq(0u));
+    budget.SetLimit(0);
+}
+
 TEST_F(PackagerTests, PackagesAtLeastOneEventEvenIfOverSizeLimit)
 {
     unsigned const MaxSize = 10000;
@@ -152,6 +196,7 @@ TEST_F(PackagerTests, PackagesAtLeastOneEventEvenIfOverSizeLimit)
     StorageRecord record("r", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>(MaxSize, 0));
     packager.addEventToPackage(ctx, record, wantMore);
     EXPECT_THAT(wantMore, false);
+    EXPECT_THAT(ctx->packageFull, false);
 
     EXPECT_CALL(*this, resultPackagedEvents(ctx))
         .WillOnce(Return());
@@ -185,11 +230,11 @@ TEST_F(PackagerTests, SetsRequestBondFieldsCorrectly)
 
     EXPECT_THAT(r.DataPackages, IsEmpty());
 
-    ASSERT_THAT(r.TokenToDataPackagesMap, Contains(Key("tenant1-token")));
+    ASSERT_THAT(r.TokenToDataPackagesMap, Contains(Key(tenants.intern("tenant1-token"))));
     ASSERT_THAT(r.TokenToDataPackagesMap["tenant1-token"], SizeIs(1));
     ASSERT_THAT(r.TokenToDataPackagesMap["tenant1-token"][0].Records, SizeIs(2));
 
-    ASSERT_THAT(r.TokenToDataPackagesMap, Contains(Key("tenant2-token")));
+    ASSERT_THAT(r.TokenToDataPackagesMap, Contains(Key(tenants.intern("tenant2-token"))));
     ASSERT_THAT(r.TokenToDataPackagesMap["tenant2-token"], SizeIs(1));
     ASSERT_THAT(r.TokenToDataPackagesMap["tenant2-token"][0].Records, SizeIs(1));
 
@@ -205,7 +250,7 @@ TEST_F(PackagerTests, SetsRequestBondFieldsCorrectly)
 TEST_F(PackagerTests, ForcedTenantIsForced)
 {
     runtimeConfigMock["forcedTenantToken"] = "forced-Tenant-Token";
-    Packager packagerF(runtimeConfigMock);
+    Packager packagerF(runtimeConfigMock, tenants);
     packagerF.packagedEvents >> packagedEvents;
 
     auto ctx = std::make_shared<EventsUploadContext>();
@@ -226,7 +271,7 @@ TEST_F(PackagerTests, ForcedTenantIsForced)
     packagerF.finalizePackage(ctx);
 
     EXPECT_THAT(ctx->packageIds, SizeIs(1));
-    EXPECT_THAT(ctx->packageIds, Contains(Key("forced-Tenant-Token")));
+    EXPECT_THAT(ctx->packageIds, Contains(Key(tenants.intern("forced-Tenant-Token"))));
 /*
     AriaProtocol::ClientToCollectorRequest r;
     bond_lite::CompactBinaryProtocolReader reader(ctx->body);
@@ -7,6 +7,10 @@
 #include "pal/PseudoRandomGenerator.hpp"
 #include "Version.hpp"
 
+#if defined(__linux__) && !defined(ANDROID) && !defined(__ANDROID__)
+#include "pal/posix/sysinfo_sources.hpp"
+#endif
+
 using namespace testing;
 
 class PalTests : public Test {};
@@ -113,6 +117,35 @@ TEST_F(PalTests, SemanticContextPopulation)
     */
 }
 
+#if defined(__linux__) && !defined(ANDROID) && !defined(__ANDROID__)
+TEST_F(PalTests, SysInfoSelectors)
+{
+    const std::string osRelease =
+        "PRETTY_NAME=\"Debian GNU/Linux 12 (bookworm)\"\n"
+        "VERSION_ID=\"12\"\n"
+        "VERSION=\"12 (bookworm)\"\n"
+        "ID=debian\n";
+    std::string value;
+    EXPECT_TRUE(sysinfo_sources::select(osRelease, "ID=", value));
+    EXPECT_THAT(value, Eq("debian"));
+    EXPECT_TRUE(sysinfo_sources::select(osRelease, "VERSION_ID=", value));
+    EXPECT_THAT(value, Eq("12"));
+    EXPECT_TRUE(sysinfo_sources::select(osRelease, "VERSION=", value));
+    EXPECT_THAT(value, Eq("12 (bookworm)"));
+    EXPECT_FALSE(sysinfo_sources::select(osRelease, "BUILD_ID=", value));
+
+    EXPECT_TRUE(sysinfo_sources::select("ID=\"opensuse-leap\"", "ID=", value));
+    EXPECT_THAT(value, Eq("opensuse-leap"));
+
+    EXPECT_TRUE(sysinfo_sources::select(std::string("/usr/bin/app\0--flag\0", 21), "^", value));
+    EXPECT_THAT(value, Eq("/usr/bin/app"));
+    EXPECT_TRUE(sysinfo_sources::select("Linux version 6.1\nsecond line\n", "^", value));
+    EXPECT_THAT(value, Eq("Linux version 6.1"));
+    EXPECT_TRUE(sysinfo_sources::select("whole\n", "*", value));
+    EXPECT_THAT(value, Eq("whole\n"));
+}
+#endif
+
 TEST_F(PalTests, SdkVersion)
 {
     std::string v = PAL::getSdkVersion();
@@ -0,0 +1,273 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "PayloadDecoder.hpp"
+#include "PayloadStreamDecoder.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
+#include "bond/generated/CsProtocol_readers.hpp"
+#include "zlib.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace testing;
+using namespace MAT;
+using namespace MAT::exporters;
+
+class PayloadStreamDecoderTests : public Test
+{
+  protected:
+    static ::CsProtocol::Record makeRecord(int index)
+    {
+        ::CsProtocol::Record record;
+        record.ver = "3.0";
+        record.name = "Test.Event." + std::to_string(index);
+        record.time = 1571263000000 + index;
+        record.iKey = "o:6d084bbf6a9644ef83f40a77c9e34580";
+        record.cV = "ABCDEFGHIJKLMNOP.1";
+        record.flags = 514;
+        record.baseType = "custom";
+        record.extApp.resize(1);
+        record.extApp[0].id = "com.microsoft.test";
+        record.extOs.resize(1);
+        record.extOs[0].name = "Linux";
+        // PayloadDecoder expects every extension the SDK always sends
+        record.extProtocol.resize(1);
+        record.extUser.resize(1);
+        record.extDevice.resize(1);
+        record.extNet.resize(1);
+        record.extSdk.resize(1);
+        record.extM365a.resize(1);
+        record.ext.resize(1);
+
+        record.data.resize(1);
+        auto& properties = record.data[0].properties;
+        properties["strKey"].stringValue = "value " + std::to_string(index);
+        properties["int64Key"].type = ::CsProtocol::ValueKind::ValueInt64;
+        properties["int64Key"].longValue = -index;
+        properties["dblKey"].type = ::CsProtocol::ValueKind::ValueDouble;
+        properties["dblKey"].doubleValue = 3.14 * index;
+        properties["guidKey"].type = ::CsProtocol::ValueKind::ValueGuid;
+        properties["guidKey"].guidValue.push_back(std::vector<uint8_t>(16, static_cast<uint8_t>(index)));
+        properties["arrKey"].type = ::CsProtocol::ValueKind::ValueArrayInt64;
+        properties["arrKey"].longArray.push_back({ 1, 2, 3 });
+        auto& pii = properties["piiKey"];
+        pii.stringValue = "jackfrost@fabrikam.com";
+        pii.attributes.resize(1);
+        pii.attributes[0].pii.resize(1);
+        pii.attributes[0].pii[0].Kind = ::CsProtocol::PIIKind::SmtpAddress;
+        for (int i = 0; i < 20; i++)
+        {
+            properties["filler" + std::to_string(i)].stringValue = std::string(20, static_cast<char>('a' + i));
+        }
+        return record;
+    }
+
+    static std::vector<uint8_t> makeBody(int count)
+    {
+        std::vector<uint8_t> body;
+        for (int i = 0; i < count; i++)
+        {
+            bond_lite::CompactBinaryProtocolWriter writer(body);
+            bond_lite::Serialize(writer, makeRecord(i));
+        }
+        return body;
+    }
+
+    static std::vector<uint8_t> deflateBody(std::vector<uint8_t> const& body, bool isGzip = false)
+    {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        EXPECT_THAT(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, isGzip ? (MAX_WBITS | 16) : -MAX_WBITS, 8, Z_DEFAULT_STRATEGY), Eq(Z_OK));
+        std::vector<uint8_t> output(deflateBound(&stream, static_cast<uLong>(body.size())) + 32);
+        stream.next_in = const_cast<Bytef*>(body.data());
+        stream.avail_in = static_cast<uInt>(body.size());
+        stream.next_out = output.data();
+        stream.avail_out = static_cast<uInt>(output.size());
+        EXPECT_THAT(deflate(&stream, Z_FINISH), Eq(Z_STREAM_END));
+        output.resize(stream.total_out);
+        deflateEnd(&stream);
+        return output;
+    }
+};
+
+TEST_F(PayloadStreamDecoderTests, RecordViewExposesTopLevelFields)
+{
+    auto expected = makeRecord(7);
+    std::vector<uint8_t> blob;
+    bond_lite::CompactBinaryProtocolWriter writer(blob);
+    bond_lite::Serialize(writer, expected);
+
+    RecordView view;
+    ASSERT_TRUE(view.parse(blob.data(), blob.size()));
+    EXPECT_THAT(view.size(), Eq(blob.size()));
+    EXPECT_THAT(view.ver().str(), Eq("3.0"));
+    EXPECT_THAT(view.name().str(), Eq(expected.name));
+    EXPECT_TRUE(view.name() == "Test.Event.7");
+    EXPECT_FALSE(view.name() == "Test.Event.70");
+    EXPECT_THAT(view.time(), Eq(expected.time));
+    EXPECT_THAT(view.popSample(), Eq(100.0));
+    EXPECT_THAT(view.iKey().str(), Eq(expected.iKey));
+    EXPECT_THAT(view.flags(), Eq(expected.flags));
+    EXPECT_THAT(view.cV().str(), Eq(expected.cV));
+    EXPECT_THAT(view.baseType().str(), Eq(expected.baseType));
+
+    ::CsProtocol::Record decoded;
+    ASSERT_TRUE(view.toRecord(decoded));
+    EXPECT_TRUE(decoded == expected);
+}
+
+TEST_F(PayloadStreamDecoderTests, RecordViewLooksUpProperties)
+{
+    std::vector<uint8_t> blob;
+    bond_lite::CompactBinaryProtocolWriter writer(blob);
+    bond_lite::Serialize(writer, makeRecord(5));
+
+    RecordView view;
+    ASSERT_TRUE(view.parse(blob.data(), blob.size()));
+
+    PropertyView value;
+    ASSERT_TRUE(view.getProperty("strKey", value));
+    EXPECT_THAT(value.type, Eq(static_cast<int32_t>(::CsProtocol::ValueKind::ValueString)));
+    EXPECT_THAT(value.stringValue.str(), Eq("value 5"));
+
+    ASSERT_TRUE(view.getProperty("int64Key", value));
+    EXPECT_THAT(value.type, Eq(static_cast<int32_t>(::CsProtocol::ValueKind::ValueInt64)));
+    EXPECT_THAT(value.longValue, Eq(-5));
+
+    ASSERT_TRUE(view.getProperty("dblKey", value));
+    EXPECT_THAT(value.doubleValue, DoubleEq(3.14 * 5));
+
+    ASSERT_TRUE(view.getProperty("guidKey", value));
+    EXPECT_THAT(value.guidValue.str(), Eq(std::string(16, '\x05')));
+
+    ASSERT_TRUE(view.getProperty("piiKey", value));
+    EXPECT_THAT(value.piiKind, Eq(static_cast<int32_t>(::CsProtocol::PIIKind::SmtpAddress)));
+    EXPECT_THAT(value.stringValue.str(), Eq("jackfrost@fabrikam.com"));
+
+    // Array kinds are reported but not expanded
+    ASSERT_TRUE(view.getProperty("arrKey", value));
+    EXPECT_THAT(value.type, Eq(static_cast<int32_t>(::CsProtocol::ValueKind::ValueArrayInt64)));
+
+    EXPECT_FALSE(view.getProperty("missing", value));
+
+    size_t count = 0;
+    EXPECT_TRUE(view.forEachProperty([&](const StringRef&, const PropertyView&) { return ++count < 3; }));
+    EXPECT_THAT(count, Eq(3u));
+}
+
+TEST_F(PayloadStreamDecoderTests, RecordViewDetectsTruncationAndCorruption)
+{
+    std::vector<uint8_t> blob;
+    bond_lite::CompactBinaryProtocolWriter writer(blob);
+    bond_lite::Serialize(writer, makeRecord(1));
+
+    RecordView view;
+    for (size_t size = 0; size < blob.size(); size++)
+    {
+        EXPECT_FALSE(view.parse(blob.data(), size)) << size;
+        EXPECT_TRUE(view.isTruncated()) << size;
+    }
+
+    // Invalid field type
+    std::vector<uint8_t> corrupt = { 0x1f, 0x00 };
+    EXPECT_FALSE(view.parse(corrupt.data(), corrupt.size()));
+    EXPECT_FALSE(view.isTruncated());
+}
+
+TEST_F(PayloadStreamDecoderTests, ForEachRecordWalksUncompressedBody)
+{
+    auto body = makeBody(10);
+    std::vector<std::string> names;
+    EXPECT_TRUE(ForEachRecord(body, [&](const RecordView& record) {
+        names.push_back(record.name().str());
+        return true;
+    }, false));
+    ASSERT_THAT(names.size(), Eq(10u));
+    EXPECT_THAT(names[0], Eq("Test.Event.0"));
+    EXPECT_THAT(names[9], Eq("Test.Event.9"));
+}
+
+TEST_F(PayloadStreamDecoderTests, StreamsCompressedBodyInSmallChunks)
+{
+    auto body = makeBody(50);
+    for (bool isGzip : { false, true })
+    {
+        auto compressed = deflateBody(body, isGzip);
+        int expected = 0;
+        PayloadStreamDecoder decoder([&](const RecordView& record) {
+            EXPECT_THAT(record.name().str(), Eq("Test.Event." + std::to_string(expected)));
+            expected++;
+            return true;
+        }, true, isGzip);
+
+        for (size_t ofs = 0; ofs < compressed.size(); ofs += 7)
+        {
+            ASSERT_TRUE(decoder.write(compressed.data() + ofs, std::min<size_t>(7, compressed.size() - ofs)));
+        }
+        EXPECT_TRUE(decoder.finish());
+        EXPECT_THAT(decoder.recordCount(), Eq(50u));
+        EXPECT_THAT(expected, Eq(50));
+    }
+}
+
+TEST_F(PayloadStreamDecoderTests, IncompleteBodyIsReported)
+{
+    auto body = makeBody(3);
+    body.pop_back();
+    size_t count = 0;
+    EXPECT_FALSE(ForEachRecord(body, [&](const RecordView&) { count++; return true; }, false));
+    EXPECT_THAT(count, Eq(2u));
+
+    auto compressed = deflateBody(makeBody(3));
+    compressed.resize(compressed.size() / 2);
+    EXPECT_FALSE(ForEachRecord(compressed, [](const RecordView&) { return true; }, true));
+}
+
+TEST_F(PayloadStreamDecoderTests, CallbackCanStopDecoding)
+{
+    auto body = makeBody(5);
+    size_t count = 0;
+    EXPECT_FALSE(ForEachRecord(body, [&](const RecordView&) { return ++count < 2; }, false));
+    EXPECT_THAT(count, Eq(2u));
+}
+
+TEST_F(PayloadStreamDecoderTests, StreamingVersusFullDecoder)
+{
+    auto compressed = deflateBody(makeBody(500));
+    const int rounds = 5;
+
+    auto start = std::chrono::steady_clock::now();
+    size_t jsonSize = 0;
+    for (int i = 0; i < rounds; i++)
+    {
+        std::string json;
+        EXPECT_TRUE(DecodeRequest(compressed, json, true));
+        jsonSize += json.size();
+    }
+    auto fullNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    size_t matches = 0;
+    for (int i = 0; i < rounds; i++)
+    {
+        EXPECT_TRUE(ForEachRecord(compressed, [&](const RecordView& record) {
+            PropertyView value;
+            if (record.getProperty("strKey", value) && !value.stringValue.empty())
+            {
+                matches++;
+            }
+            return true;
+        }, true));
+    }
+    auto streamNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Decoding 500 records: DecodeRequest " << fullNs / rounds / 1000
+              << " us, ForEachRecord " << streamNs / rounds / 1000 << " us" << std::endl;
+    EXPECT_THAT(jsonSize, Gt(0u));
+    EXPECT_THAT(matches, Eq(500u * rounds));
+}
@@ -0,0 +1,116 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "stats/PipelineStats.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+TEST(LatencyHistogramTests, EmptyHistogramReportsZero)
+{
+    LatencyHistogram histogram;
+    EXPECT_THAT(histogram.count(), Eq(0u));
+    EXPECT_THAT(histogram.min(), Eq(0u));
+    EXPECT_THAT(histogram.max(), Eq(0u));
+    EXPECT_THAT(histogram.percentile(50.0), Eq(0u));
+}
+
+TEST(LatencyHistogramTests, BucketBoundsAreContiguous)
+{
+    uint64_t expectedLower = 0;
+    for (unsigned i = 0; i < static_cast<unsigned>(LatencyHistogram::BucketCount); i++)
+    {
+        EXPECT_THAT(LatencyHistogram::bucketLowerBound(i), Eq(expectedLower));
+        EXPECT_THAT(LatencyHistogram::bucketIndex(LatencyHistogram::bucketLowerBound(i)), Eq(i));
+        EXPECT_THAT(LatencyHistogram::bucketIndex(LatencyHistogram::bucketUpperBound(i)), Eq(i));
+        expectedLower = LatencyHistogram::bucketUpperBound(i) + 1;
+    }
+    EXPECT_THAT(expectedLower - 1, Eq(static_cast<uint64_t>(LatencyHistogram::MaxValue)));
+}
+
+TEST(LatencyHistogramTests, PercentilesWithinRelativeError)
+{
+    LatencyHistogram histogram;
+    for (uint64_t v = 1; v <= 100000; v++)
+    {
+        histogram.record(v);
+    }
+    EXPECT_THAT(histogram.count(), Eq(100000u));
+    EXPECT_THAT(histogram.min(), Eq(1u));
+    EXPECT_THAT(histogram.max(), Eq(100000u));
+    EXPECT_THAT(histogram.mean(), Eq(50000u));
+
+    EXPECT_NEAR(static_cast<double>(histogram.percentile(50.0)), 50000.0, 50000.0 * 0.07);
+    EXPECT_NEAR(static_cast<double>(histogram.percentile(90.0)), 90000.0, 90000.0 * 0.07);
+    EXPECT_NEAR(static_cast<double>(histogram.percentile(99.0)), 99000.0, 99000.0 * 0.07);
+    EXPECT_THAT(histogram.percentile(100.0), Eq(100000u));
+
+    histogram.reset();
+    EXPECT_THAT(histogram.count(), Eq(0u));
+    EXPECT_THAT(histogram.percentile(99.0), Eq(0u));
+}
+
+TEST(LatencyHistogramTests, HugeValuesAreClamped)
+{
+    LatencyHistogram histogram;
+    histogram.record(UINT64_MAX);
+    EXPECT_THAT(histogram.max(), Eq(static_cast<uint64_t>(LatencyHistogram::MaxValue)));
+    EXPECT_THAT(histogram.percentile(50.0), Eq(static_cast<uint64_t>(LatencyHistogram::MaxValue)));
+}
+
+TEST(PipelineStatsTests, RecordsStagesAlongTheRoutes)
+{
+    PipelineStats stats;
+
+    ::CsProtocol::Record record;
+    IncomingEventContext event("id", "tenant-token", EventLatency_Normal, EventPersistence_Normal, &record);
+    event.createdUs -= 1000;
+    RouteSource<IncomingEventContextPtr const&> sending;
+    sending >> stats.onEventSerialized >> stats.onEventStored;
+    sending(&event);
+
+    PipelineStageStats serialize;
+    ASSERT_TRUE(stats.getStageStats(PipelineStage_Serialize, serialize));
+    EXPECT_THAT(serialize.count, Eq(1u));
+    EXPECT_THAT(serialize.minUs, Ge(1000u));
+
+    PipelineStageStats eventToQueue;
+    ASSERT_TRUE(stats.getStageStats(PipelineStage_EventToQueue, eventToQueue));
+    EXPECT_THAT(eventToQueue.count, Eq(1u));
+    EXPECT_THAT(eventToQueue.maxUs, Ge(serialize.maxUs));
+
+    auto ctx = std::make_shared<EventsUploadContext>();
+    RouteSource<EventsUploadContextPtr const&> uploading;
+    uploading >> stats.onUploadInitiated >> stats.onPackaged >> stats.onEncoded >> stats.onResponse >> stats.onDecoded >> stats.onAcked;
+    uploading(ctx);
+
+    for (auto stage : { PipelineStage_Retrieve, PipelineStage_Encode, PipelineStage_Send, PipelineStage_Decode, PipelineStage_Ack, PipelineStage_RetrieveToAck })
+    {
+        PipelineStageStats stageStats;
+        ASSERT_TRUE(stats.getStageStats(stage, stageStats));
+        EXPECT_THAT(stageStats.count, Eq(1u)) << PipelineStats::stageName(stage);
+    }
+
+    PipelineStageStats invalid;
+    EXPECT_FALSE(stats.getStageStats(PipelineStage_Max, invalid));
+
+    stats.reset();
+    ASSERT_TRUE(stats.getStageStats(PipelineStage_Serialize, serialize));
+    EXPECT_THAT(serialize.count, Eq(0u));
+}
+
+TEST(PipelineStatsTests, UnstampedUploadIsNotRecorded)
+{
+    PipelineStats stats;
+    auto ctx = std::make_shared<EventsUploadContext>();
+    RouteSource<EventsUploadContextPtr const&> acked;
+    acked >> stats.onAcked;
+    acked(ctx);
+
+    PipelineStageStats retrieveToAck;
+    ASSERT_TRUE(stats.getStageStats(PipelineStage_RetrieveToAck, retrieveToAck));
+    EXPECT_THAT(retrieveToAck.count, Eq(0u));
+}
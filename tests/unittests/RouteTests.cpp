@@ -5,6 +5,10 @@
 
 #include "common/Common.hpp"
 #include "system/Route.hpp"
+#include "system/Contexts.hpp"
+
+#include <chrono>
+#include <iostream>
 
 using namespace testing;
 using namespace MAT;
@@ -79,6 +83,11 @@ class RouteTests : public StrictMock<Test> {
         std::vector<int> x = std::move(e);
         handleSink5(a, b, c, d);
     }
+
+    StaticRouteHandler<decltype(&RouteTests::handleSink1), &RouteTests::handleSink1>                 staticSink1{this};
+    StaticRouteHandler<decltype(&RouteTests::handlePassThrough1a), &RouteTests::handlePassThrough1a> staticPassThrough1a{this};
+    StaticRouteHandler<decltype(&RouteTests::handlePassThrough1b), &RouteTests::handlePassThrough1b> staticPassThrough1b{this};
+    StaticRouteHandler<decltype(&RouteTests::handleSink5x), &RouteTests::handleSink5x>               staticSink5{this};
 };
 
 
@@ -208,3 +217,181 @@ TEST_F(RouteTests, RoutesCanCoexistsAcrossTheSamePath)
     sourceA(123);
 }
 
+TEST_F(RouteTests, StaticPassThroughsAreInvokedInBetween)
+{
+    RouteSource<int> source1;
+    source1 >> staticPassThrough1a >> staticPassThrough1b >> staticSink1;
+
+    InSequence order;
+    EXPECT_CALL(*this, handlePassThrough1a(123))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*this, handlePassThrough1b(123))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*this, handleSink1(123))
+        .WillOnce(Return());
+    source1(123);
+}
+
+TEST_F(RouteTests, StaticPassThroughsWithoutSinkAreOk)
+{
+    RouteSource<int> source1;
+    source1 >> staticPassThrough1a >> staticPassThrough1b;
+
+    InSequence order;
+    EXPECT_CALL(*this, handlePassThrough1a(123))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*this, handlePassThrough1b(123))
+        .WillOnce(Return(true));
+    source1(123);
+}
+
+TEST_F(RouteTests, StaticPassThroughCanStopTheFlow)
+{
+    RouteSource<int> source1;
+    source1 >> staticPassThrough1a >> staticPassThrough1b >> staticSink1;
+
+    InSequence order;
+    EXPECT_CALL(*this, handlePassThrough1a(123))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*this, handlePassThrough1b(123))
+        .WillOnce(Return(false));
+    source1(123);
+}
+
+TEST_F(RouteTests, StaticSinkPassesArgsAsDefined)
+{
+    RouteSource<int, bool&, NonCopyableThing const&, Canary, std::vector<int>&&> source5;
+    source5 >> staticSink5;
+
+    bool flag = false;
+    NonCopyableThing thing;
+    Canary canary;
+    canary.bear();
+    std::vector<int> data{1, 2, 3};
+
+    EXPECT_CALL(*this, handleSink5(123, _, Ref(thing), Eq("alive")))
+        .WillOnce(DoAll(
+        SetArgReferee<1>(true),
+        InvokeArgument<3>()
+        ));
+    source5(123, flag, thing, canary, std::move(data));
+    EXPECT_THAT(flag, true);
+    EXPECT_THAT(canary, Eq("alive"));
+    EXPECT_THAT(data, IsEmpty());
+}
+
+TEST_F(RouteTests, StaticAndDynamicRoutesCanCoexist)
+{
+    RouteSource<int> sourceA;
+    RouteSource<int> sourceB;
+    sourceA >> passThrough1a >> sink1;
+    sourceB >> staticPassThrough1b >> staticSink1;
+
+    InSequence order;
+    EXPECT_CALL(*this, handlePassThrough1b(123))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*this, handleSink1(123))
+        .WillOnce(Return());
+    sourceB(123);
+
+    EXPECT_CALL(*this, handlePassThrough1a(123))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*this, handleSink1(123))
+        .WillOnce(Return());
+    sourceA(123);
+}
+
+//
+// Benchmark of the dynamic vs compile-time composed routes, shaped after the
+// TelemetrySystem "sending" (2 pass-throughs and a sink) and "packagedEvents"
+// (6 pass-throughs and a sink) routes.
+//
+
+class RouteBenchmark {
+  public:
+    unsigned events = 0;
+    unsigned uploads = 0;
+
+    bool handleEvent(IncomingEventContextPtr const& ctx)
+    {
+        ctx->policyBitFlags++;
+        return true;
+    }
+
+    void handleEventDone(IncomingEventContextPtr const& ctx)
+    {
+        UNREFERENCED_PARAMETER(ctx);
+        events++;
+    }
+
+    bool handleUpload(EventsUploadContextPtr const& ctx)
+    {
+        ctx->maxRetryCountSeen++;
+        return true;
+    }
+
+    void handleUploadDone(EventsUploadContextPtr const& ctx)
+    {
+        UNREFERENCED_PARAMETER(ctx);
+        uploads++;
+    }
+
+    RoutePassThrough<RouteBenchmark, IncomingEventContextPtr const&> event{this, &RouteBenchmark::handleEvent};
+    RouteSink<RouteBenchmark, IncomingEventContextPtr const&>        eventDone{this, &RouteBenchmark::handleEventDone};
+    RoutePassThrough<RouteBenchmark, EventsUploadContextPtr const&>  upload{this, &RouteBenchmark::handleUpload};
+    RouteSink<RouteBenchmark, EventsUploadContextPtr const&>         uploadDone{this, &RouteBenchmark::handleUploadDone};
+
+    StaticRouteHandler<decltype(&RouteBenchmark::handleEvent), &RouteBenchmark::handleEvent>           eventStatic{this};
+    StaticRouteHandler<decltype(&RouteBenchmark::handleEventDone), &RouteBenchmark::handleEventDone>   eventDoneStatic{this};
+    StaticRouteHandler<decltype(&RouteBenchmark::handleUpload), &RouteBenchmark::handleUpload>         uploadStatic{this};
+    StaticRouteHandler<decltype(&RouteBenchmark::handleUploadDone), &RouteBenchmark::handleUploadDone> uploadDoneStatic{this};
+};
+
+template<typename TSource, typename TArg>
+static double RouteNanosPerCall(TSource const& source, TArg const& arg, unsigned iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; i++)
+    {
+        source(arg);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+TEST(RouteBenchmarkTests, StaticRoutesVersusDynamicRoutes)
+{
+    unsigned const iterations = 1000000;
+    RouteBenchmark dynamicRoutes;
+    RouteBenchmark staticRoutes;
+
+    RouteSource<IncomingEventContextPtr const&> sendingDynamic;
+    RouteSource<IncomingEventContextPtr const&> sendingStatic;
+    sendingDynamic >> dynamicRoutes.event >> dynamicRoutes.event >> dynamicRoutes.eventDone;
+    sendingStatic >> staticRoutes.eventStatic >> staticRoutes.eventStatic >> staticRoutes.eventDoneStatic;
+
+    RouteSource<EventsUploadContextPtr const&> packagedEventsDynamic;
+    RouteSource<EventsUploadContextPtr const&> packagedEventsStatic;
+    packagedEventsDynamic >> dynamicRoutes.upload >> dynamicRoutes.upload >> dynamicRoutes.upload >> dynamicRoutes.upload >> dynamicRoutes.upload >> dynamicRoutes.upload >> dynamicRoutes.uploadDone;
+    packagedEventsStatic >> staticRoutes.uploadStatic >> staticRoutes.uploadStatic >> staticRoutes.uploadStatic >> staticRoutes.uploadStatic >> staticRoutes.uploadStatic >> staticRoutes.uploadStatic >> staticRoutes.uploadDoneStatic;
+
+    IncomingEventContext dynamicEvent;
+    IncomingEventContext staticEvent;
+    IncomingEventContextPtr dynamicEventPtr = &dynamicEvent;
+    IncomingEventContextPtr staticEventPtr = &staticEvent;
+    double sendingDynamicNs = RouteNanosPerCall(sendingDynamic, dynamicEventPtr, iterations);
+    double sendingStaticNs = RouteNanosPerCall(sendingStatic, staticEventPtr, iterations);
+
+    auto dynamicUpload = std::make_shared<EventsUploadContext>();
+    auto staticUpload = std::make_shared<EventsUploadContext>();
+    double packagedDynamicNs = RouteNanosPerCall(packagedEventsDynamic, dynamicUpload, iterations);
+    double packagedStaticNs = RouteNanosPerCall(packagedEventsStatic, staticUpload, iterations);
+
+    std::cout << "sending:        dynamic " << sendingDynamicNs << " ns, static " << sendingStaticNs << " ns" << std::endl;
+    std::cout << "packagedEvents: dynamic " << packagedDynamicNs << " ns, static " << packagedStaticNs << " ns" << std::endl;
+
+    EXPECT_THAT(staticRoutes.events, Eq(dynamicRoutes.events));
+    EXPECT_THAT(staticRoutes.uploads, Eq(dynamicRoutes.uploads));
+    EXPECT_THAT(staticEvent.policyBitFlags, Eq(2u * iterations));
+    EXPECT_THAT(staticUpload->maxRetryCountSeen, Eq(6u * iterations));
+}
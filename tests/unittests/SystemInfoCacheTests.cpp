@@ -0,0 +1,232 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "common/MockIOfflineStorage.hpp"
+#include "offline/SystemInfoCache.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    // Keeps scheduled tasks until the test runs them
+    class ManualTaskDispatcher : public ITaskDispatcher
+    {
+    public:
+        std::vector<Task*> tasks;
+
+        virtual ~ManualTaskDispatcher()
+        {
+            for (Task* task : tasks)
+            {
+                delete task;
+            }
+        }
+
+        void RunAll()
+        {
+            std::vector<Task*> pending;
+            pending.swap(tasks);
+            for (Task* task : pending)
+            {
+                (*task)();
+                delete task;
+            }
+        }
+
+        virtual void Join() override {}
+
+        virtual void Queue(Task* task) override
+        {
+            tasks.push_back(task);
+        }
+
+        virtual bool Cancel(Task* task, uint64_t waitTime = 0) override
+        {
+            UNREFERENCED_PARAMETER(waitTime);
+            auto it = std::find(tasks.begin(), tasks.end(), task);
+            if (it != tasks.end())
+            {
+                delete *it;
+                tasks.erase(it);
+            }
+            return true;
+        }
+    };
+
+    class SystemInfoCache4Test : public SystemInfoCache
+    {
+    public:
+        SystemInfoCache4Test(IOfflineStorage& offlineStorage, ContextFieldsProvider& context, ITaskDispatcher& taskDispatcher) :
+            SystemInfoCache(offlineStorage, context, taskDispatcher)
+        {
+        }
+
+        std::string stamp { "host/1.0" };
+        std::map<std::string, std::string> fields { { COMMONFIELDS_DEVICE_ID, "{collected}" } };
+        int collections = 0;
+
+        virtual std::string GetStamp() override
+        {
+            return stamp;
+        }
+
+        virtual std::map<std::string, std::string> Collect() override
+        {
+            collections++;
+            return fields;
+        }
+    };
+
+    class SystemInfoCacheTests : public Test
+    {
+    protected:
+        NiceMock<MockIOfflineStorage> storage;
+        std::map<std::string, std::string> settings;
+        ContextFieldsProvider context;
+        ManualTaskDispatcher dispatcher;
+
+        virtual void SetUp() override
+        {
+            ON_CALL(storage, IsOpen()).WillByDefault(Return(true));
+            ON_CALL(storage, GetSetting(_)).WillByDefault(Invoke([this](std::string const& name)
+            {
+                return settings[name];
+            }));
+            ON_CALL(storage, StoreSetting(_, _)).WillByDefault(Invoke([this](std::string const& name, std::string const& value)
+            {
+                settings[name] = value;
+                return true;
+            }));
+            context.SetDeviceId("{default}");
+        }
+
+        std::string DeviceId()
+        {
+            return context.GetCommonFields()[COMMONFIELDS_DEVICE_ID].as_string;
+        }
+    };
+
+} // namespace
+
+TEST_F(SystemInfoCacheTests, CollectsInBackgroundAndPersists)
+{
+    SystemInfoCache4Test cache(storage, context, dispatcher);
+    cache.Start();
+    EXPECT_THAT(DeviceId(), Eq("{default}"));
+    ASSERT_THAT(dispatcher.tasks.size(), Eq(1u));
+
+    dispatcher.RunAll();
+    EXPECT_THAT(cache.collections, Eq(1));
+    EXPECT_THAT(DeviceId(), Eq("{collected}"));
+    EXPECT_THAT(settings["sysinfostamp"], Eq("host/1.0"));
+    EXPECT_THAT(settings["sysinfofields"], Eq(COMMONFIELDS_DEVICE_ID));
+    EXPECT_THAT(settings[std::string("sysinfo.") + COMMONFIELDS_DEVICE_ID], Eq("{collected}"));
+}
+
+TEST_F(SystemInfoCacheTests, UsesPersistedValuesWhileStampMatches)
+{
+    settings["sysinfostamp"] = "host/1.0";
+    settings["sysinfofields"] = COMMONFIELDS_DEVICE_ID;
+    settings[std::string("sysinfo.") + COMMONFIELDS_DEVICE_ID] = "{persisted}";
+
+    SystemInfoCache4Test cache(storage, context, dispatcher);
+    cache.Start();
+    EXPECT_THAT(DeviceId(), Eq("{default}"));
+    dispatcher.RunAll();
+    EXPECT_THAT(DeviceId(), Eq("{persisted}"));
+    EXPECT_THAT(cache.collections, Eq(0));
+}
+
+TEST_F(SystemInfoCacheTests, StartDoesNotWaitForStorage)
+{
+    // Reading settings may wait for a storage opened in the background
+    EXPECT_CALL(storage, GetSetting(_)).Times(0);
+    SystemInfoCache4Test cache(storage, context, dispatcher);
+    cache.Start();
+    EXPECT_THAT(dispatcher.tasks.size(), Eq(1u));
+    Mock::VerifyAndClearExpectations(&storage);
+}
+
+TEST_F(SystemInfoCacheTests, WaitsForStorageOpenWithoutBlockingDispatcher)
+{
+    settings["sysinfostamp"] = "host/1.0";
+    settings["sysinfofields"] = COMMONFIELDS_DEVICE_ID;
+    settings[std::string("sysinfo.") + COMMONFIELDS_DEVICE_ID] = "{persisted}";
+    bool open = false;
+    ON_CALL(storage, IsOpen()).WillByDefault(Invoke([&open]() { return open; }));
+    EXPECT_CALL(storage, GetSetting(_)).Times(0);
+
+    SystemInfoCache4Test cache(storage, context, dispatcher);
+    cache.Start();
+
+    // Every pass returns at once and comes back later, other tasks keep running
+    for (int i = 0; i < 3; i++)
+    {
+        dispatcher.RunAll();
+        EXPECT_THAT(dispatcher.tasks.size(), Eq(1u));
+    }
+    EXPECT_THAT(DeviceId(), Eq("{default}"));
+    Mock::VerifyAndClearExpectations(&storage);
+
+    open = true;
+    dispatcher.RunAll();
+    EXPECT_THAT(dispatcher.tasks.size(), Eq(0u));
+    EXPECT_THAT(DeviceId(), Eq("{persisted}"));
+    EXPECT_THAT(cache.collections, Eq(0));
+}
+
+TEST_F(SystemInfoCacheTests, StopEndsWaitForStorageOpen)
+{
+    ON_CALL(storage, IsOpen()).WillByDefault(Return(false));
+    SystemInfoCache4Test cache(storage, context, dispatcher);
+    cache.Start();
+    dispatcher.RunAll();
+    cache.Stop();
+    EXPECT_THAT(dispatcher.tasks.size(), Eq(0u));
+}
+
+TEST_F(SystemInfoCacheTests, CollectsAgainWhenStampChangesOrValueIsMissing)
+{
+    settings["sysinfostamp"] = "host/0.9";
+    settings["sysinfofields"] = COMMONFIELDS_DEVICE_ID;
+    settings[std::string("sysinfo.") + COMMONFIELDS_DEVICE_ID] = "{persisted}";
+
+    SystemInfoCache4Test cache(storage, context, dispatcher);
+    cache.Start();
+    EXPECT_THAT(DeviceId(), Eq("{default}"));
+    dispatcher.RunAll();
+    EXPECT_THAT(DeviceId(), Eq("{collected}"));
+
+    settings[std::string("sysinfo.") + COMMONFIELDS_DEVICE_ID] = "";
+    cache.Start();
+    dispatcher.RunAll();
+    EXPECT_THAT(cache.collections, Eq(2));
+}
+
+TEST_F(SystemInfoCacheTests, KeepsValueSetByApplication)
+{
+    SystemInfoCache4Test cache(storage, context, dispatcher);
+    cache.Start();
+    context.SetDeviceId("c:application");
+    dispatcher.RunAll();
+    EXPECT_THAT(DeviceId(), Eq("c:application"));
+    // Still persisted for the next run, which starts with the default again
+    EXPECT_THAT(settings["sysinfostamp"], Eq("host/1.0"));
+}
+
+TEST_F(SystemInfoCacheTests, NothingDeferredNothingToDo)
+{
+    EXPECT_CALL(storage, GetSetting(_)).Times(0);
+    SystemInfoCache4Test cache(storage, context, dispatcher);
+    cache.stamp.clear();
+    cache.Start();
+    EXPECT_THAT(dispatcher.tasks, IsEmpty());
+    cache.Stop();
+}
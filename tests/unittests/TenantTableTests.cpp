@@ -0,0 +1,35 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "system/TenantTable.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+TEST(TenantTableTests, InternAssignsStableIds)
+{
+    TenantTable tenants;
+    TenantId first = tenants.intern("tenant1-token");
+    TenantId second = tenants.intern("tenant2-token");
+    EXPECT_THAT(first, Ne(second));
+    EXPECT_THAT(tenants.intern("tenant1-token"), Eq(first));
+    EXPECT_THAT(tenants.intern(std::string("tenant2-token")), Eq(second));
+    EXPECT_THAT(tenants.size(), Eq(2u));
+}
+
+TEST(TenantTableTests, ResolvedTokensSurviveGrowth)
+{
+    TenantTable tenants;
+    TenantId id = tenants.intern("tenant-token");
+    std::string const& token = tenants.resolve(id);
+    for (int i = 0; i < 1000; i++)
+    {
+        tenants.intern("other-token-" + std::to_string(i));
+    }
+    EXPECT_THAT(token, Eq("tenant-token"));
+    EXPECT_THAT(&tenants.resolve(id), Eq(&token));
+    EXPECT_THAT(tenants.resolve(5000), Eq(""));
+}
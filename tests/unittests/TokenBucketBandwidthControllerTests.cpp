@@ -0,0 +1,125 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "bwcontrol/TokenBucketBandwidthController.hpp"
+#include "config/RuntimeConfig_Default.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+class TokenBucketBandwidthController4Test : public TokenBucketBandwidthController
+{
+  public:
+    TokenBucketBandwidthController4Test(IRuntimeConfig& config) :
+        TokenBucketBandwidthController(config)
+    {
+    }
+
+    uint64_t nowMs = 1000000;
+
+  protected:
+    virtual uint64_t now() const override
+    {
+        return nowMs;
+    }
+};
+
+class TokenBucketBandwidthControllerTests : public Test
+{
+  protected:
+    ILogConfiguration logConfig;
+    std::unique_ptr<RuntimeConfig_Default> config;
+
+    IRuntimeConfig& configure(unsigned bytesPerSecond, unsigned burstBytes = 0, unsigned linkSharePct = 0)
+    {
+        logConfig[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_BYTES_PER_SEC] = bytesPerSecond;
+        logConfig[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_BURST_BYTES] = burstBytes;
+        logConfig[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_LINK_SHARE_PCT] = linkSharePct;
+        config.reset(new RuntimeConfig_Default(logConfig));
+        return *config;
+    }
+};
+
+TEST_F(TokenBucketBandwidthControllerTests, DisabledByDefault)
+{
+    config.reset(new RuntimeConfig_Default(logConfig));
+    EXPECT_FALSE(TokenBucketBandwidthController::IsEnabled(*config));
+
+    EXPECT_TRUE(TokenBucketBandwidthController::IsEnabled(configure(10000)));
+    EXPECT_TRUE(TokenBucketBandwidthController::IsEnabled(configure(0, 0, 50)));
+}
+
+TEST_F(TokenBucketBandwidthControllerTests, DelaysClassThatOverdrewItsBucket)
+{
+    // Normal gets 30% of 10000 B/s = 3000 B/s, burst of one second
+    TokenBucketBandwidthController4Test controller(configure(10000));
+    EXPECT_THAT(controller.GetProposedBandwidthBps(), Eq(10000u));
+    EXPECT_THAT(controller.GetUploadDelayMs(EventLatency_Normal), Eq(0u));
+
+    controller.OnUploadCompleted(EventLatency_Normal, 2000, -1);
+    EXPECT_THAT(controller.GetUploadDelayMs(EventLatency_Normal), Eq(0u));
+
+    // 1000 bytes left, 7000 charged: 6000 bytes of debt take two seconds to refill
+    controller.OnUploadCompleted(EventLatency_Normal, 7000, -1);
+    EXPECT_THAT(controller.GetUploadDelayMs(EventLatency_Normal), Eq(2000u));
+
+    controller.nowMs += 500;
+    EXPECT_THAT(controller.GetUploadDelayMs(EventLatency_Normal), Eq(1500u));
+
+    controller.nowMs += 1500;
+    EXPECT_THAT(controller.GetUploadDelayMs(EventLatency_Normal), Eq(0u));
+}
+
+TEST_F(TokenBucketBandwidthControllerTests, RefillIsCappedAtBurst)
+{
+    TokenBucketBandwidthController4Test controller(configure(10000, 1000));
+    controller.GetUploadDelayMs(EventLatency_RealTime);
+
+    // A long idle period does not allow more than the 300 byte burst of RealTime
+    controller.nowMs += 60000;
+    controller.OnUploadCompleted(EventLatency_RealTime, 600, -1);
+    EXPECT_THAT(controller.GetUploadDelayMs(EventLatency_RealTime), Eq(100u));
+}
+
+TEST_F(TokenBucketBandwidthControllerTests, ClassesArePacedIndependently)
+{
+    TokenBucketBandwidthController4Test controller(configure(10000));
+    controller.OnUploadCompleted(EventLatency_CostDeferred, 3000, -1);
+    EXPECT_THAT(controller.GetUploadDelayMs(EventLatency_CostDeferred), Eq(2000u));
+    EXPECT_THAT(controller.GetUploadDelayMs(EventLatency_Normal), Eq(0u));
+    EXPECT_THAT(controller.GetUploadDelayMs(EventLatency_RealTime), Eq(0u));
+    EXPECT_THAT(controller.GetUploadDelayMs(EventLatency_Max), Eq(0u));
+}
+
+TEST_F(TokenBucketBandwidthControllerTests, ZeroShareLeavesClassUnpaced)
+{
+    logConfig[CFG_MAP_BANDWIDTH][CFG_INT_BANDWIDTH_MAX_PCT] = 0;
+    TokenBucketBandwidthController4Test controller(configure(10000));
+    controller.OnUploadCompleted(EventLatency_Max, 1000000, -1);
+    EXPECT_THAT(controller.GetUploadDelayMs(EventLatency_Max), Eq(0u));
+}
+
+TEST_F(TokenBucketBandwidthControllerTests, LinkShareFollowsMeasuredThroughput)
+{
+    TokenBucketBandwidthController4Test controller(configure(0, 0, 50));
+    EXPECT_THAT(controller.GetProposedBandwidthBps(), Eq(UINT_MAX));
+    EXPECT_THAT(controller.GetMeasuredThroughputBps(), Eq(0.0));
+
+    // 20000 bytes in 1 s: the SDK may use 10000 B/s, Normal 3000 B/s
+    controller.OnUploadCompleted(EventLatency_Normal, 20000, 1000);
+    EXPECT_THAT(controller.GetMeasuredThroughputBps(), DoubleEq(20000.0));
+    EXPECT_THAT(controller.GetProposedBandwidthBps(), Eq(10000u));
+
+    // A slower link lowers the budget with exponential smoothing
+    controller.OnUploadCompleted(EventLatency_Normal, 10000, 2000);
+    EXPECT_THAT(controller.GetMeasuredThroughputBps(), DoubleEq(17000.0));
+    EXPECT_THAT(controller.GetProposedBandwidthBps(), Eq(8500u));
+
+    // A configured rate caps the link share
+    TokenBucketBandwidthController4Test capped(configure(4000, 0, 50));
+    capped.OnUploadCompleted(EventLatency_Normal, 20000, 1000);
+    EXPECT_THAT(capped.GetProposedBandwidthBps(), Eq(4000u));
+}
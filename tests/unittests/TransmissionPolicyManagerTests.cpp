@@ -8,6 +8,9 @@
 #include "common/Common.hpp"
 #include "common/MockIRuntimeConfig.hpp"
 #include "common/MockIBandwidthController.hpp"
+#include "common/MockITelemetrySystem.hpp"
+#include "common/MockIHttpClient.hpp"
+#include "http/HttpRequestEncoder.hpp"
 #include "tpm/TransmissionPolicyManager.hpp"
 #include "TransmitProfiles.hpp"
 
@@ -46,6 +49,7 @@ class TransmissionPolicyManager4Test : public TransmissionPolicyManager {
     using TransmissionPolicyManager::m_timerdelay;
     using TransmissionPolicyManager::m_runningLatency;
     using TransmissionPolicyManager::m_backoffConfig;
+    using TransmissionPolicyManager::m_adaptiveUploads;
 
     MOCK_METHOD3(scheduleUpload, void(const std::chrono::milliseconds&, EventLatency,bool));
     MOCK_METHOD1(uploadAsync, void(EventLatency));
@@ -77,6 +81,8 @@ class TransmissionPolicyManagerTests : public StrictMock<Test> {
 
     RouteSink<TransmissionPolicyManagerTests, EventsUploadContextPtr const&> initiateUpload{this, &TransmissionPolicyManagerTests::resultInitiateUpload};
     RouteSink<TransmissionPolicyManagerTests>                                allUploadsFinished{this, &TransmissionPolicyManagerTests::resultAllUploadsFinished};
+    RouteSink<TransmissionPolicyManagerTests, EventsUploadContextPtr const&> sendPreparedUpload{this, &TransmissionPolicyManagerTests::resultSendPreparedUpload};
+    RouteSink<TransmissionPolicyManagerTests, EventsUploadContextPtr const&> preparedUploadDropped{this, &TransmissionPolicyManagerTests::resultPreparedUploadDropped};
 
   protected:
     TransmissionPolicyManagerTests()
@@ -84,15 +90,49 @@ class TransmissionPolicyManagerTests : public StrictMock<Test> {
     {
         tpm.initiateUpload     >> initiateUpload;
         tpm.allUploadsFinished >> allUploadsFinished;
+        tpm.sendPreparedUpload >> sendPreparedUpload;
+        tpm.preparedUploadDropped >> preparedUploadDropped;
     }
 
     MOCK_METHOD1(resultInitiateUpload, void(EventsUploadContextPtr const &));
     MOCK_METHOD0(resultAllUploadsFinished, void());
+    MOCK_METHOD1(resultSendPreparedUpload, void(EventsUploadContextPtr const &));
+    MOCK_METHOD1(resultPreparedUploadDropped, void(EventsUploadContextPtr const &));
+
+    void setPipeline(unsigned maxPendingRequests, unsigned pipelineDepth)
+    {
+        auto& config = testing::getSystem().getConfig();
+        config[CFG_INT_MAX_PENDING_REQ] = maxPendingRequests;
+        config[CFG_INT_UPLOAD_PIPELINE_DEPTH] = pipelineDepth;
+    }
+
+    void setAdaptiveUploads(bool enabled)
+    {
+        testing::getSystem().getConfig()[CFG_MAP_TPM][CFG_BOOL_TPM_ADAPTIVE_UPLOADS] = enabled;
+    }
+
+    void setPendingRecordCount(size_t count)
+    {
+        auto& system = static_cast<MockITelemetrySystem&>(testing::getSystem());
+        system.pendingRecordCountKnown = true;
+        system.pendingRecordCount = count;
+    }
+
+    virtual void TearDown() override
+    {
+        setPipeline(4, 0);
+        setAdaptiveUploads(false);
+        static_cast<MockITelemetrySystem&>(testing::getSystem()).pendingRecordCountKnown = false;
+    }
 
     virtual void SetUp() override
     {
         EXPECT_CALL(bandwidthControllerMock, GetProposedBandwidthBps())
             .WillRepeatedly(Return(1000000));
+        EXPECT_CALL(bandwidthControllerMock, GetUploadDelayMs(_))
+            .WillRepeatedly(Return(0));
+        EXPECT_CALL(bandwidthControllerMock, OnUploadCompleted(_, _, _))
+            .WillRepeatedly(Return());
         EXPECT_CALL(runtimeConfigMock, GetMinimumUploadBandwidthBps())
             .WillRepeatedly(Return(1000000));
 
@@ -248,6 +288,94 @@ TEST_F(TransmissionPolicyManagerTests, ImmediateIncomingEventStartsUploadImmedia
     EXPECT_THAT(upload->requestedMinLatency, EventLatency_Max);
 }
 
+class MaxLatencyWindowGuard
+{
+  public:
+    MaxLatencyWindowGuard(unsigned windowMs, unsigned batchSize)
+    {
+        set(windowMs, batchSize);
+    }
+
+    ~MaxLatencyWindowGuard()
+    {
+        set(0, 0);
+    }
+
+  protected:
+    static void set(unsigned windowMs, unsigned batchSize)
+    {
+        auto& config = testing::getSystem().getConfig();
+        config[CFG_MAP_TPM][CFG_INT_TPM_MAX_LATENCY_WINDOW_MS] = windowMs;
+        config[CFG_MAP_TPM][CFG_INT_TPM_MAX_LATENCY_BATCH] = batchSize;
+    }
+};
+
+TEST_F(TransmissionPolicyManagerTests, ImmediateIncomingEventsAreCoalescedUntilBatchIsFull)
+{
+    MaxLatencyWindowGuard window(60000, 3);
+    tpm.paused(false);
+
+    auto event = new IncomingEventContext();
+    event->record.latency = EventLatency_Max;
+    EXPECT_CALL(*this, resultInitiateUpload(_)).Times(0);
+    tpm.eventArrived(event);
+    tpm.eventArrived(event);
+    Mock::VerifyAndClearExpectations(this);
+
+    EventsUploadContextPtr upload;
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .WillOnce(SaveArg<0>(&upload));
+    tpm.eventArrived(event);
+    ASSERT_THAT(upload, NotNull());
+    EXPECT_THAT(upload->requestedMinLatency, EventLatency_Max);
+
+    tpm.pause();
+    delete event;
+}
+
+TEST_F(TransmissionPolicyManagerTests, ImmediateIncomingEventsAreUploadedWhenWindowCloses)
+{
+    MaxLatencyWindowGuard window(20, 0);
+    tpm.paused(false);
+
+    auto event = new IncomingEventContext();
+    event->record.latency = EventLatency_Max;
+    std::atomic<unsigned> uploads(0);
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .WillRepeatedly(Invoke([&uploads](EventsUploadContextPtr const& ctx) {
+            EXPECT_THAT(ctx->requestedMinLatency, EventLatency_Max);
+            uploads++;
+        }));
+    for (int i = 0; i < 10; i++)
+    {
+        tpm.eventArrived(event);
+    }
+
+    for (int i = 0; i < 100 && uploads == 0; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_THAT(uploads.load(), 1u);
+
+    tpm.pause();
+    delete event;
+}
+
+TEST_F(TransmissionPolicyManagerTests, PauseDiscardsCoalescingWindow)
+{
+    MaxLatencyWindowGuard window(20, 0);
+    tpm.paused(false);
+
+    auto event = new IncomingEventContext();
+    event->record.latency = EventLatency_Max;
+    EXPECT_CALL(*this, resultInitiateUpload(_)).Times(0);
+    tpm.eventArrived(event);
+    tpm.pause();
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    delete event;
+}
+
 TEST_F(TransmissionPolicyManagerTests, UploadDoesNothingWhenPaused)
 {
     tpm.uploadScheduled(true);
@@ -280,6 +408,83 @@ TEST_F(TransmissionPolicyManagerTests, UploadPostponedWithInsufficientAvailableB
 }
 #endif
 
+TEST_F(TransmissionPolicyManagerTests, UploadPacedByBandwidthController)
+{
+    tpm.uploadScheduled(true);
+    tpm.paused(false);
+
+    EXPECT_CALL(bandwidthControllerMock, GetUploadDelayMs(EventLatency_Normal))
+        .WillOnce(Return(250));
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds { 250 }, EventLatency_Normal, false))
+        .WillOnce(Return());
+    EXPECT_CALL(*this, resultInitiateUpload(_)).Times(0);
+    tpm.uploadAsync(EventLatency_Normal);
+
+    EXPECT_THAT(tpm.uploadScheduled(), false);
+}
+
+TEST_F(TransmissionPolicyManagerTests, LowProposedBandwidthDoesNotPostponeUpload)
+{
+    tpm.uploadScheduled(true);
+    tpm.paused(false);
+
+    // Only GetUploadDelayMs() paces uploads, the legacy minimum bandwidth gate stays off
+    EXPECT_CALL(bandwidthControllerMock, GetProposedBandwidthBps())
+        .WillRepeatedly(Return(1));
+    EXPECT_CALL(tpm, scheduleUpload(_, _, _)).Times(0);
+    EventsUploadContextPtr upload;
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .WillOnce(SaveArg<0>(&upload));
+    tpm.uploadAsync(EventLatency_Normal);
+
+    EXPECT_THAT(upload, NotNull());
+}
+
+TEST_F(TransmissionPolicyManagerTests, CompletedUploadIsChargedToBandwidthController)
+{
+    auto ctx = tpm.fakeActiveUpload(EventLatency_CostDeferred);
+    ctx->bodySize = 1234;
+    ctx->durationMs = 56;
+
+    EXPECT_CALL(bandwidthControllerMock, OnUploadCompleted(EventLatency_CostDeferred, 1234u, 56))
+        .WillOnce(Return());
+    EXPECT_CALL(tpm, scheduleUpload(_, _, _))
+        .WillRepeatedly(Return());
+    EXPECT_CALL(*this, resultAllUploadsFinished())
+        .WillRepeatedly(Return());
+    tpm.eventsUploadSuccessful(ctx);
+
+    // Aborted requests did not use the link and are not charged
+    ctx = tpm.fakeActiveUpload(EventLatency_CostDeferred);
+    ctx->bodySize = 1234;
+    EXPECT_CALL(bandwidthControllerMock, OnUploadCompleted(_, _, _)).Times(0);
+    tpm.eventsUploadAborted(ctx);
+}
+
+TEST_F(TransmissionPolicyManagerTests, EncodedBodyIsChargedToBandwidthController)
+{
+    NiceMock<MockIHttpClient> httpClient;
+    EXPECT_CALL(httpClient, CreateRequest())
+        .WillRepeatedly(Invoke([]() -> IHttpRequest* { return new SimpleHttpRequest("TPM"); }));
+    HttpRequestEncoder encoder(testing::getSystem(), httpClient);
+
+    auto ctx = tpm.fakeActiveUpload(EventLatency_CostDeferred);
+    ctx->body.resize(1234);
+    ctx->durationMs = 56;
+    encoder.encode(ctx);
+    // The encoder hands the body over to the request
+    EXPECT_THAT(ctx->body, IsEmpty());
+    EXPECT_THAT(ctx->bodySize, Eq(1234u));
+
+    EXPECT_CALL(bandwidthControllerMock, OnUploadCompleted(EventLatency_CostDeferred, 1234u, 56))
+        .WillOnce(Return());
+    EXPECT_CALL(tpm, scheduleUpload(_, _, _))
+        .WillRepeatedly(Return());
+    EXPECT_CALL(*this, resultAllUploadsFinished())
+        .WillRepeatedly(Return());
+    tpm.eventsUploadSuccessful(ctx);
+}
+
 TEST_F(TransmissionPolicyManagerTests, UploadInitiatesUpload)
 {
     tpm.uploadScheduled(true);
@@ -330,6 +535,90 @@ TEST_F(TransmissionPolicyManagerTests, SuccessfulUploadSchedulesNextOneImmediate
     tpm.eventsUploadSuccessful(upload);
 }
 
+TEST_F(TransmissionPolicyManagerTests, AdaptiveUploads_UploadUsesAdaptivePackageSize)
+{
+    setAdaptiveUploads(true);
+    tpm.uploadScheduled(true);
+    tpm.paused(false);
+
+    EventsUploadContextPtr upload;
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .WillOnce(SaveArg<0>(&upload));
+    tpm.uploadAsync(EventLatency_Normal);
+
+    ASSERT_THAT(upload, NotNull());
+    EXPECT_THAT(upload->maxUploadSize, Eq(32768u));
+}
+
+TEST_F(TransmissionPolicyManagerTests, AdaptiveUploads_FullPackageSchedulesNextOneImmediately)
+{
+    setAdaptiveUploads(true);
+    auto upload = tpm.fakeActiveUpload();
+    upload->maxUploadSize = 32768;
+    upload->packageFull = true;
+    upload->durationMs = 100;
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{ 0 }, EventLatency_Normal, false))
+        .WillOnce(Return());
+    tpm.eventsUploadSuccessful(upload);
+}
+
+TEST_F(TransmissionPolicyManagerTests, AdaptiveUploads_SlowRequestPacesBacklog)
+{
+    setAdaptiveUploads(true);
+    setPendingRecordCount(100);
+    auto upload = tpm.fakeActiveUpload();
+    upload->durationMs = 2500;
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{ 2000 }, EventLatency_Normal, false))
+        .WillOnce(Return());
+    tpm.eventsUploadSuccessful(upload);
+}
+
+TEST_F(TransmissionPolicyManagerTests, AdaptiveUploads_SlowRequestShrinksToBytesSent)
+{
+    setAdaptiveUploads(true);
+    EXPECT_CALL(tpm, scheduleUpload(_, _, _))
+        .WillRepeatedly(Return());
+    EXPECT_CALL(*this, resultAllUploadsFinished())
+        .WillRepeatedly(Return());
+
+    for (int i = 0; i < 3; i++)
+    {
+        auto upload = tpm.fakeActiveUpload();
+        upload->maxUploadSize = tpm.m_adaptiveUploads.GetPackageSize();
+        upload->bodySize = upload->maxUploadSize;
+        upload->packageFull = true;
+        upload->durationMs = 100;
+        tpm.eventsUploadSuccessful(upload);
+    }
+    ASSERT_THAT(tpm.m_adaptiveUploads.GetPackageSize(), Eq(262144u));
+
+    // Throughput is measured on the 16 KiB actually sent, not on the package limit
+    auto upload = tpm.fakeActiveUpload();
+    upload->maxUploadSize = tpm.m_adaptiveUploads.GetPackageSize();
+    upload->bodySize = 16384;
+    upload->durationMs = 4000;
+    tpm.eventsUploadSuccessful(upload);
+    EXPECT_THAT(tpm.m_adaptiveUploads.GetPackageSize(), Eq(32768u));
+}
+
+TEST_F(TransmissionPolicyManagerTests, AdaptiveUploads_DrainedStorageSkipsEmptyUpload)
+{
+    setAdaptiveUploads(true);
+    setPendingRecordCount(0);
+
+    auto upload = tpm.fakeActiveUpload(EventLatency_Normal);
+    EXPECT_CALL(tpm, scheduleUpload(_, _, false))
+        .Times(0);
+    tpm.eventsUploadSuccessful(upload);
+
+    upload = tpm.fakeActiveUpload(EventLatency_RealTime);
+    constexpr std::chrono::milliseconds delay { std::chrono::seconds(300) };
+    tpm.m_timerdelay = delay;
+    EXPECT_CALL(tpm, scheduleUpload(delay, EventLatency_Normal, false))
+        .WillOnce(Return());
+    tpm.eventsUploadSuccessful(upload);
+}
+
 #if 0
 TEST_F(TransmissionPolicyManagerTests, RejectedUploadSchedulesNextOneWithLargerDelay)
 {
@@ -564,6 +853,36 @@ TEST_F(TransmissionPolicyManagerTests, removeUpload_CalledTwiceContextAdded_Retu
     EXPECT_FALSE(tpm.removeUpload(ctx));
 }
 
+TEST_F(TransmissionPolicyManagerTests, removeUpload_WakesUpProgressWaiter)
+{
+    auto ctx = std::make_shared<EventsUploadContext>();
+    tpm.addUpload(ctx);
+    uint64_t progress = tpm.getUploadProgress();
+    EXPECT_FALSE(tpm.waitForUploadProgress(progress, std::chrono::milliseconds { 0 }));
+
+    std::thread finisher([this, ctx]() { tpm.removeUpload(ctx); });
+    EXPECT_TRUE(tpm.waitForUploadProgress(progress, std::chrono::seconds { 10 }));
+    finisher.join();
+    EXPECT_THAT(tpm.getUploadProgress(), Eq(progress + 1));
+}
+
+TEST_F(TransmissionPolicyManagerTests, Stop_WaitsForUploadFinishingOnAnotherThread)
+{
+    tpm.paused(false);
+    auto ctx = std::make_shared<EventsUploadContext>();
+    tpm.addUpload(ctx);
+    std::thread finisher([this, ctx]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds { 50 });
+        tpm.removeUpload(ctx);
+    });
+
+    EXPECT_CALL(*this, resultAllUploadsFinished())
+        .WillOnce(Return());
+    tpm.stop();
+    EXPECT_THAT(tpm.activeUploads(), IsEmpty());
+    finisher.join();
+}
+
 TEST_F(TransmissionPolicyManagerTests, getCancelWaitTime_ScheduledUploadAborted_ReturnsDefaultValue)
 {
     tpm.m_scheduledUploadAborted = true;
@@ -624,3 +943,105 @@ TEST_F(TransmissionPolicyManagerTests, increaseBackoff_CalledTwice_ReturnsHigher
     auto first = tpm.increaseBackoff();
     ASSERT_GT(tpm.increaseBackoff(), first);
 }
+
+TEST_F(TransmissionPolicyManagerTests, PipelineDisabled_PreparedUploadsAreSentRightAway)
+{
+    setPipeline(1, 0);
+    tpm.paused(false);
+    auto ctx1 = tpm.fakeActiveUpload();
+    auto ctx2 = tpm.fakeActiveUpload();
+    EXPECT_TRUE(tpm.uploadPreparedStatic(ctx1));
+    EXPECT_TRUE(tpm.uploadPreparedStatic(ctx2));
+}
+
+TEST_F(TransmissionPolicyManagerTests, Pipelined_PreparedUploadWaitsForFreeSlot)
+{
+    setPipeline(1, 2);
+    tpm.paused(false);
+    auto ctx1 = tpm.fakeActiveUpload();
+    auto ctx2 = tpm.fakeActiveUpload();
+    auto ctx3 = tpm.fakeActiveUpload();
+
+    // Every prepared package kicks off preparation of the next one
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{}, EventLatency_RealTime, false))
+        .Times(3)
+        .WillRepeatedly(Return());
+    EXPECT_TRUE(tpm.uploadPreparedStatic(ctx1));
+    EXPECT_FALSE(tpm.uploadPreparedStatic(ctx2));
+    EXPECT_FALSE(tpm.uploadPreparedStatic(ctx3));
+
+    // Completed request hands its slot to the oldest prepared package
+    EXPECT_CALL(*this, resultSendPreparedUpload(ctx2)).WillOnce(Return());
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{}, _, false)).WillOnce(Return());
+    tpm.eventsUploadSuccessful(ctx1);
+
+    EXPECT_CALL(*this, resultSendPreparedUpload(ctx3)).WillOnce(Return());
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{}, _, false)).WillOnce(Return());
+    tpm.eventsUploadSuccessful(ctx2);
+
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{}, _, false)).WillOnce(Return());
+    tpm.eventsUploadSuccessful(ctx3);
+    EXPECT_THAT(tpm.activeUploads(), IsEmpty());
+}
+
+TEST_F(TransmissionPolicyManagerTests, Pipelined_FailedUploadReturnsPreparedPackagesToStorage)
+{
+    setPipeline(1, 2);
+    tpm.paused(false);
+    auto ctx1 = tpm.fakeActiveUpload();
+    auto ctx2 = tpm.fakeActiveUpload();
+
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{}, EventLatency_RealTime, false))
+        .Times(2)
+        .WillRepeatedly(Return());
+    EXPECT_TRUE(tpm.uploadPreparedStatic(ctx1));
+    EXPECT_FALSE(tpm.uploadPreparedStatic(ctx2));
+
+    EXPECT_CALL(*this, resultPreparedUploadDropped(ctx2)).WillOnce(Return());
+    EXPECT_CALL(tpm, scheduleUpload(Gt(std::chrono::milliseconds{}), _, false)).WillOnce(Return());
+    tpm.eventsUploadFailed(ctx1);
+}
+
+TEST_F(TransmissionPolicyManagerTests, Pipelined_PauseReturnsPreparedPackagesToStorage)
+{
+    setPipeline(2, 1);
+    tpm.paused(false);
+    auto ctx1 = tpm.fakeActiveUpload();
+    auto ctx2 = tpm.fakeActiveUpload();
+    auto ctx3 = tpm.fakeActiveUpload();
+
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{}, EventLatency_RealTime, false))
+        .Times(3)
+        .WillRepeatedly(Return());
+    EXPECT_TRUE(tpm.uploadPreparedStatic(ctx1));
+    EXPECT_TRUE(tpm.uploadPreparedStatic(ctx2));
+    EXPECT_FALSE(tpm.uploadPreparedStatic(ctx3));
+
+    EXPECT_CALL(*this, resultPreparedUploadDropped(ctx3)).WillOnce(Return());
+    tpm.pause();
+
+    // Paused: in-flight requests complete, but no prepared package is sent anymore
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{}, _, false))
+        .Times(2)
+        .WillRepeatedly(Return());
+    tpm.eventsUploadSuccessful(ctx1);
+    tpm.eventsUploadSuccessful(ctx2);
+}
+
+TEST_F(TransmissionPolicyManagerTests, Pipelined_SchedulingStopsWhenPipelineIsFull)
+{
+    setPipeline(2, 1);
+    tpm.paused(false);
+    tpm.fakeActiveUpload();
+    tpm.fakeActiveUpload();
+    tpm.fakeActiveUpload();
+    tpm.uploadScheduled(false);
+    tpm.NotMockScheduleUpload(std::chrono::milliseconds{}, EventLatency_Normal, false);
+    EXPECT_FALSE(tpm.uploadScheduled());
+
+    setPipeline(2, 2);
+    EXPECT_CALL(tpm, uploadAsync(_)).WillRepeatedly(Return());
+    tpm.NotMockScheduleUpload(std::chrono::milliseconds{ 10000 }, EventLatency_Normal, false);
+    EXPECT_TRUE(tpm.uploadScheduled());
+    tpm.cancelUploadTask();
+}
@@ -0,0 +1,219 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "bond/TypedEventEncoder.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
+#include "decorators/EventPropertiesDecorator.hpp"
+#include "NullObjects.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    struct AllTypesEvent : TypedEvent<AllTypesEvent>
+    {
+        int64_t count = 0;
+        unsigned short small = 0;
+        double ratio = 0.0;
+        bool flag = false;
+        std::string text;
+        std::string email;
+        std::string content;
+        time_ticks_t when;
+        GUID_t id;
+
+        static const char* Name() { return "AllTypes"; }
+
+        static EventLatency Latency() { return EventLatency_RealTime; }
+
+        void Fields(TypedEventFields& fields) const
+        {
+            fields.Add("count", count);
+            fields.Add("small", small);
+            fields.Add("ratio", ratio);
+            fields.Add("flag", flag);
+            fields.Add("text", text);
+            fields.Add("email", email, PiiKind_Identity);
+            fields.Add("content", content, CustomerContentKind_GenericData);
+            fields.Add("when", when);
+            fields.Add("id", id);
+            fields.Add("literal", "value");
+        }
+    };
+
+    struct DuplicateEvent : TypedEvent<DuplicateEvent>
+    {
+        static const char* Name() { return "Duplicate"; }
+
+        void Fields(TypedEventFields& fields) const
+        {
+            fields.Add("b", 1);
+            fields.Add("a", "first");
+            fields.Add("a", "second");
+        }
+    };
+
+    struct InvalidEvent : TypedEvent<InvalidEvent>
+    {
+        static const char* Name() { return "Invalid"; }
+
+        void Fields(TypedEventFields& fields) const
+        {
+            fields.Add("bad name", 1);
+        }
+    };
+
+    class TypedEventTests : public ::testing::Test
+    {
+    protected:
+        NullLogManager logManager;
+        EventPropertiesDecorator decorator { logManager };
+
+        AllTypesEvent MakeEvent(bool zeroes)
+        {
+            AllTypesEvent event;
+            if (!zeroes)
+            {
+                event.count = -1234567890123LL;
+                event.small = 42;
+                event.ratio = 3.25;
+                event.flag = true;
+                event.text = "hello";
+                event.email = "someone@example.com";
+                event.content = "secret";
+                event.when = time_ticks_t(637000000000000000ULL);
+                event.id = GUID_t("01020304-0506-0708-090a-0b0c0d0e0f10");
+            }
+            return event;
+        }
+
+        // Serializes the event the dynamic way and the typed way on top of the same decorated
+        // record. The typed record keeps what the decorator adds for a name-only event and the
+        // context properties the typed fields would override.
+        void ExpectSameBytes(ITypedEvent const& event, std::map<std::string, ::CsProtocol::Value> const& context)
+        {
+            ::CsProtocol::Record dynamicRecord;
+            dynamicRecord.data.push_back(::CsProtocol::Data());
+            dynamicRecord.data[0].properties = context;
+            EventLatency latency = EventLatency_Normal;
+            ASSERT_TRUE(decorator.decorate(dynamicRecord, latency, event.ToEventProperties()));
+
+            EncodedPartC partC;
+            TypedEventEncoder encoder(partC);
+            event.VisitFields(encoder);
+            ASSERT_TRUE(encoder.Finish());
+
+            ::CsProtocol::Record typedRecord = dynamicRecord;
+            auto& properties = typedRecord.data[0].properties;
+            for (auto const& entry : partC.entries)
+            {
+                std::string name(entry.name, entry.nameSize);
+                auto it = context.find(name);
+                if (it != context.end())
+                {
+                    properties[name] = it->second;
+                }
+                else
+                {
+                    properties.erase(name);
+                }
+            }
+
+            std::vector<uint8_t> expected;
+            bond_lite::SerializeFast(expected, dynamicRecord);
+            std::vector<uint8_t> actual;
+            SerializeWithPartC(actual, typedRecord, partC);
+            EXPECT_THAT(actual, Eq(expected));
+
+            MaterializePartC(typedRecord, partC);
+            std::vector<uint8_t> materialized;
+            bond_lite::SerializeFast(materialized, typedRecord);
+            EXPECT_THAT(materialized, Eq(expected));
+        }
+    };
+
+} // namespace
+
+TEST_F(TypedEventTests, FieldKeyHasCompactBinaryPrefix)
+{
+    constexpr TypedFieldKey shortKey("count");
+    static_assert(shortKey.size == 5, "size");
+    static_assert(shortKey.prefixSize == 1, "prefix size");
+    EXPECT_THAT(shortKey.prefix[0], Eq(5));
+
+    TypedFieldKey longKey("a123456789b123456789c123456789d123456789e123456789f123456789g123456789h123456789i123456789j123456789k123456789l123456789m12345678");
+    EXPECT_THAT(longKey.size, Eq(129u));
+    EXPECT_THAT(longKey.prefixSize, Eq(2));
+    EXPECT_THAT(longKey.prefix[0], Eq(0x81));
+    EXPECT_THAT(longKey.prefix[1], Eq(0x01));
+}
+
+TEST_F(TypedEventTests, ToEventPropertiesMatchesFields)
+{
+    AllTypesEvent event = MakeEvent(false);
+    EventProperties props = event.ToEventProperties();
+
+    EXPECT_THAT(props.GetName(), Eq("AllTypes"));
+    EXPECT_THAT(props.GetLatency(), Eq(EventLatency_RealTime));
+    EXPECT_THAT(props.GetPersistence(), Eq(EventPersistence_Normal));
+    auto const& properties = props.GetProperties();
+    // EventProperties carries the default EventInfo.Level
+    ASSERT_THAT(properties.size(), Eq(11u));
+    EXPECT_THAT(properties.at("count").as_int64, Eq(-1234567890123LL));
+    EXPECT_THAT(properties.at("small").as_int64, Eq(42));
+    EXPECT_THAT(properties.at("flag").type, Eq(EventProperty::TYPE_BOOLEAN));
+    EXPECT_THAT(properties.at("email").piiKind, Eq(PiiKind_Identity));
+    EXPECT_THAT(properties.at("literal").as_string, StrEq("value"));
+}
+
+TEST_F(TypedEventTests, EncodesSameBytesAsEventProperties)
+{
+    ExpectSameBytes(MakeEvent(false), {});
+}
+
+TEST_F(TypedEventTests, EncodesDefaultValuesSameAsEventProperties)
+{
+    ExpectSameBytes(MakeEvent(true), {});
+}
+
+TEST_F(TypedEventTests, MergesWithContextProperties)
+{
+    std::map<std::string, ::CsProtocol::Value> context;
+    context["AppInfo.Version"].stringValue = "1.0";
+    context["flag"].stringValue = "overridden by the event";
+    context["zzz"].type = ::CsProtocol::ValueKind::ValueInt64;
+    context["zzz"].longValue = 7;
+
+    ExpectSameBytes(MakeEvent(false), context);
+}
+
+TEST_F(TypedEventTests, LastDuplicateFieldWins)
+{
+    EncodedPartC partC;
+    TypedEventEncoder encoder(partC);
+    DuplicateEvent().VisitFields(encoder);
+    ASSERT_TRUE(encoder.Finish());
+
+    ::CsProtocol::Record record;
+    ASSERT_TRUE(MaterializePartC(record, partC));
+    ASSERT_THAT(record.data.size(), Eq(1u));
+    auto const& properties = record.data[0].properties;
+    ASSERT_THAT(properties.size(), Eq(2u));
+    EXPECT_THAT(properties.at("a").stringValue, Eq("second"));
+    EXPECT_THAT(properties.at("b").longValue, Eq(1));
+
+    ExpectSameBytes(DuplicateEvent(), {});
+}
+
+TEST_F(TypedEventTests, RejectsInvalidFieldNames)
+{
+    EncodedPartC partC;
+    TypedEventEncoder encoder(partC);
+    InvalidEvent().VisitFields(encoder);
+    EXPECT_FALSE(encoder.Finish());
+}
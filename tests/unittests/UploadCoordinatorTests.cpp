@@ -0,0 +1,170 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "system/SharedRuntime.hpp"
+#include "tpm/TransmissionPolicyManager.hpp"
+#include "tpm/UploadCoordinator.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    class FakeUploader : public ICoordinatedUploader
+    {
+    public:
+        bool dueSoon = true;
+        int joins = 0;
+
+        virtual bool joinUpload(uint64_t windowMs) override
+        {
+            EXPECT_THAT(windowMs, Eq(1000u));
+            if (!dueSoon)
+            {
+                return false;
+            }
+            joins++;
+            return true;
+        }
+    };
+
+    // Keeps scheduled tasks without running them
+    class ParkingTaskDispatcher : public ITaskDispatcher
+    {
+    public:
+        std::vector<Task*> tasks;
+
+        virtual ~ParkingTaskDispatcher()
+        {
+            for (Task* task : tasks)
+            {
+                delete task;
+            }
+        }
+
+        virtual void Join() override {}
+
+        virtual void Queue(Task* task) override
+        {
+            tasks.push_back(task);
+        }
+
+        virtual bool Cancel(Task* task, uint64_t waitTime = 0) override
+        {
+            UNREFERENCED_PARAMETER(waitTime);
+            auto it = std::find(tasks.begin(), tasks.end(), task);
+            if (it != tasks.end())
+            {
+                delete *it;
+                tasks.erase(it);
+            }
+            return true;
+        }
+    };
+
+    class TransmissionPolicyManager4Join : public TransmissionPolicyManager
+    {
+    public:
+        TransmissionPolicyManager4Join(ITaskDispatcher& taskDispatcher) :
+            TransmissionPolicyManager(testing::getSystem(), taskDispatcher, nullptr)
+        {
+        }
+
+        using TransmissionPolicyManager::m_isPaused;
+        using TransmissionPolicyManager::m_scheduledUploadTime;
+        using TransmissionPolicyManager::scheduleUpload;
+    };
+
+} // namespace
+
+TEST(UploadCoordinatorTests, JoinsUploadersOfSameEndpoint)
+{
+    UploadCoordinator coordinator;
+    FakeUploader first, second, other;
+    coordinator.add(&first, "https://a");
+    coordinator.add(&second, "https://a");
+    coordinator.add(&other, "https://b");
+    EXPECT_THAT(coordinator.size(), Eq(3u));
+
+    EXPECT_THAT(coordinator.onUploadStarting(&first, 1000), Eq(1u));
+    EXPECT_THAT(first.joins, Eq(0));
+    EXPECT_THAT(second.joins, Eq(1));
+    EXPECT_THAT(other.joins, Eq(0));
+
+    // Moving to the other endpoint
+    coordinator.add(&second, "https://b");
+    EXPECT_THAT(coordinator.onUploadStarting(&other, 1000), Eq(1u));
+    EXPECT_THAT(second.joins, Eq(2));
+    EXPECT_THAT(coordinator.size(), Eq(3u));
+}
+
+TEST(UploadCoordinatorTests, SkipsUploadersNotDueOrRemoved)
+{
+    UploadCoordinator coordinator;
+    FakeUploader first, second, third;
+    coordinator.add(&first, "https://a");
+    coordinator.add(&second, "https://a");
+    coordinator.add(&third, "https://a");
+
+    second.dueSoon = false;
+    EXPECT_THAT(coordinator.onUploadStarting(&first, 1000), Eq(1u));
+    EXPECT_THAT(third.joins, Eq(1));
+
+    coordinator.remove(&third);
+    EXPECT_THAT(coordinator.onUploadStarting(&first, 1000), Eq(0u));
+    EXPECT_THAT(third.joins, Eq(1));
+
+    // A window of 0 disables joining, an unregistered caller joins nobody
+    second.dueSoon = true;
+    EXPECT_THAT(coordinator.onUploadStarting(&first, 0), Eq(0u));
+    EXPECT_THAT(coordinator.onUploadStarting(&third, 1000), Eq(0u));
+    EXPECT_THAT(second.joins, Eq(0));
+}
+
+TEST(UploadCoordinatorTests, TransmissionPolicyManagerJoinsUploadDueSoon)
+{
+    ParkingTaskDispatcher dispatcher;
+    TransmissionPolicyManager4Join tpm(dispatcher);
+
+    // Nothing scheduled yet
+    EXPECT_FALSE(tpm.joinUpload(1000));
+
+    tpm.m_isPaused = false;
+    tpm.scheduleUpload(std::chrono::milliseconds { 5000 }, EventLatency_Normal);
+    ASSERT_THAT(dispatcher.tasks.size(), Eq(1u));
+    EXPECT_FALSE(tpm.joinUpload(1000));
+    EXPECT_THAT(dispatcher.tasks.size(), Eq(1u));
+
+    // Due within the window: the upload is rescheduled to run now
+    EXPECT_TRUE(tpm.joinUpload(6000));
+    ASSERT_THAT(dispatcher.tasks.size(), Eq(1u));
+    EXPECT_THAT(tpm.m_scheduledUploadTime, Le(static_cast<uint64_t>(PAL::getMonotonicTimeMs())));
+    EXPECT_THAT(dispatcher.tasks[0]->TargetTime, Le(static_cast<uint64_t>(PAL::getMonotonicTimeMs())));
+
+    // Already due, and paused uploads are left alone
+    EXPECT_FALSE(tpm.joinUpload(6000));
+    tpm.m_isPaused = true;
+    EXPECT_FALSE(tpm.joinUpload(6000));
+}
+
+TEST(UploadCoordinatorTests, SharedRuntimeLivesWhileHeld)
+{
+    auto first = SharedRuntime::acquire();
+    auto second = SharedRuntime::acquire();
+    EXPECT_THAT(first.get(), Eq(second.get()));
+    EXPECT_THAT(&first->getUploadCoordinator(), Eq(&second->getUploadCoordinator()));
+
+    auto client = first->getHttpClient();
+    EXPECT_THAT(second->getHttpClient().get(), Eq(client.get()));
+
+    std::weak_ptr<SharedRuntime> released = first;
+    first.reset();
+    second.reset();
+    EXPECT_TRUE(released.expired());
+}